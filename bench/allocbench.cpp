@@ -0,0 +1,99 @@
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <filesystem>
+#include "bench.h"
+#include "../logisticsengine.h"
+#include "../nullbuffer.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// =====================================================
+// Counting Allocator (replaces global new/delete)
+// =====================================================
+static atomic<long long> allocCount(0);
+static atomic<long long> allocBytes(0);
+
+// The replacements allocate with malloc and release with free, a matched
+// pair. GCC inlines operator delete into callers it can see calling the
+// builtin operator new and reports a mismatch there; the warning is off
+// for these definitions only.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t n) {
+    allocCount.fetch_add(1, memory_order_relaxed);
+    allocBytes.fetch_add((long long)n, memory_order_relaxed);
+    void* p = malloc(n ? n : 1);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+long long benchAllocCount() { return allocCount.load(); }
+long long benchAllocBytes() { return allocBytes.load(); }
+
+// =====================================================
+// Pickup -> Dispatch -> Track Flow
+// =====================================================
+int runAllocBench(int iterations) {
+    const char* dests[] = { "Karachi", "Islamabad", "Multan", "Peshawar", "Quetta",
+                            "Faisalabad", "Rawalpindi", "Sakhar", "Chichawatni" };
+    const int destCount = 9;
+
+    // IDs are built up front so the harness' own strings are not counted
+    string* ids = new string[iterations];
+    for (int i = 0; i < iterations; i++)
+        ids[i] = "BENCH-" + to_string(100000 + i);
+
+    NullBuffer nullBuf;
+    streambuf* saved = cout.rdbuf(&nullBuf);
+
+    // Road events are off: closures would pile up over the run and turn
+    // dispatches into quick "no route" returns. The fixed seed makes the
+    // lifecycle dice roll the same on every run.
+    // Engine construction is outside the measured windows.
+    // A scratch data dir, so the bench never loads or writes a real database
+    const string dir = "allocbench.d";
+    error_code ec;
+    fs::remove_all(dir, ec);
+    long long pickupAllocs = 0, dispatchAllocs = 0, trackAllocs = 0;
+    LogisticsEngine* engine = new LogisticsEngine(dir);
+    engine->setRoadEventRate(0);
+    engine->setSeed(42);
+    for (int i = 0; i < iterations; i++) {
+        long long before = allocCount.load();
+        engine->requestPickup(ids[i], dests[i % destCount], 1.0 + (i % 30), 1 + (i % 3));
+        long long afterPickup = allocCount.load();
+        engine->processNextAuto(-1);
+        long long afterDispatch = allocCount.load();
+        engine->viewParcel(ids[i]);
+        long long afterTrack = allocCount.load();
+
+        pickupAllocs += afterPickup - before;
+        dispatchAllocs += afterDispatch - afterPickup;
+        trackAllocs += afterTrack - afterDispatch;
+    }
+    delete engine;
+    fs::remove_all(dir, ec);
+
+    cout.rdbuf(saved);
+    delete[] ids;
+
+    cout << "  " << iterations << " requests\n";
+    benchReport("pickup", (double)pickupAllocs / iterations, "allocs/request", 1);
+    benchReport("dispatch", (double)dispatchAllocs / iterations, "allocs/request", 1);
+    benchReport("track", (double)trackAllocs / iterations, "allocs/request", 1);
+    benchReport("total", (double)(pickupAllocs + dispatchAllocs + trackAllocs) / iterations, "allocs/request", 1);
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+
+inline double secondsSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+// One result line: the label, then the value in its unit. Every benchmark
+// reports through this, so their columns line up.
+void benchReport(const char* what, double value, const char* unit, int precision = 2);
+
+// Allocation counters maintained by the replaced global operator new
+long long benchAllocCount();
+long long benchAllocBytes();
+
+int runAllocBench(int iterations);
+int runSerializeBench(int parcelCount);
+int runBloomBench(int keyCount);
+int runHubBench(int orders);
+int runQueueBench(int ops);
+int runSchedBench(int ops);
+int runLifecycleBench(int parcelCount);
+int runGeoBench(int pointCount);
+int runOverlayBench(int side);
+
+#endif
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include "bench.h"
+
+using namespace std;
+
+// The engine links against the console's clearScreen(); benchmarks never clear
+void clearScreen() {}
+
+void benchReport(const char* what, double value, const char* unit, int precision) {
+    cout << "  " << left << setw(34) << what << right << fixed << setprecision(precision)
+         << setw(10) << value << " " << unit << "\n";
+    cout.unsetf(ios::fixed);
+}
+
+static void usage() {
+    cout << "usage: swiftex-bench <benchmark> [iterations]\n"
+         << "  alloc       allocations per pickup -> dispatch -> track request\n"
+         << "  serialize   JSON / MessagePack bulk export throughput\n"
+         << "  bloom       known-ID filter false-positive rate and lookup cost\n"
+         << "  hubs        pickup -> dispatch throughput with 1, 2 and 4 hub shards\n"
+         << "  queue       ring buffer vs linked queue, SPSC vs MPMC hand-over\n"
+         << "  sched       dispatch order: SLA calendar queue vs the old score heap\n"
+         << "  lifecycle   transit sweep: column kernel vs the old linked list\n"
+         << "  geo         nearest / radius queries on the R-tree; A* vs Dijkstra\n"
+         << "  overlay     zone overlay queries and per-cell re-customization\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    string which = argv[1];
+    int iterations = (argc > 2) ? atoi(argv[2]) : 0;
+
+    if (which == "alloc") return runAllocBench(iterations > 0 ? iterations : 2000);
+    if (which == "serialize") return runSerializeBench(iterations > 0 ? iterations : 50000);
+    if (which == "bloom") return runBloomBench(iterations > 0 ? iterations : 1000000);
+    if (which == "hubs") return runHubBench(iterations > 0 ? iterations : 20000);
+    if (which == "queue") return runQueueBench(iterations > 0 ? iterations : 4000000);
+    if (which == "sched") return runSchedBench(iterations > 0 ? iterations : 1000000);
+    if (which == "lifecycle") return runLifecycleBench(iterations > 0 ? iterations : 1000000);
+    if (which == "geo") return runGeoBench(iterations > 0 ? iterations : 1000000);
+    if (which == "overlay") return runOverlayBench(iterations > 0 ? iterations : 200);
+
+    usage();
+    return 1;
+}
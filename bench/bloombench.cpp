@@ -0,0 +1,66 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include "bench.h"
+#include "../bloomfilter.h"
+#include "../datastructures.h"
+
+using namespace std;
+
+// =====================================================
+// Known-ID Filter (Bloom) vs Hash Table Misses
+// =====================================================
+int runBloomBench(int keyCount) {
+    const int probes = 1000000;
+    const double rates[] = { 0.05, 0.01, 0.001 };
+
+    string* ids = new string[keyCount];
+    for (int i = 0; i < keyCount; i++) ids[i] = "SWX-" + to_string(1000000 + i);
+    // Never-issued IDs shaped like real ones: the pickup path's usual case
+    string* misses = new string[4096];
+    for (int i = 0; i < 4096; i++) misses[i] = "SWX-" + to_string(9000000 + i * 7);
+
+    cout << "  " << keyCount << " known IDs, " << probes << " lookups of unknown IDs\n";
+    volatile long long sink = 0;
+    for (double rate : rates) {
+        BloomFilter f(keyCount, rate);
+        for (int i = 0; i < keyCount; i++) f.add(ids[i]);
+
+        long long falsePositives = 0;
+        auto t = chrono::steady_clock::now();
+        for (int i = 0; i < probes; i++) falsePositives += f.mayContain(misses[i & 4095]) ? 1 : 0;
+        double secs = secondsSince(t);
+
+        // Separate pass over fresh keys for the measured rate
+        long long fp = 0;
+        for (int i = 0; i < probes; i++) fp += f.mayContain("MISS-" + to_string(i)) ? 1 : 0;
+        sink += falsePositives;
+
+        cout << "  target " << setw(6) << fixed << setprecision(3) << rate * 100 << "%  measured "
+             << setw(6) << (double)fp / probes * 100 << "%  " << setprecision(1)
+             << setw(6) << secs * 1e9 / probes << " ns/lookup  "
+             << f.memoryBytes() / 1024 << " KB\n";
+    }
+
+    // The table this filter sits in front of (capped; every entry is a
+    // full Parcel)
+    ParcelHashTable table;
+    int inTable = keyCount < 100000 ? keyCount : 100000;
+    Parcel** parcels = new Parcel*[inTable];
+    for (int i = 0; i < inTable; i++) {
+        parcels[i] = new Parcel(ids[i], "Karachi", 1, 1, "Zone C");
+        table.insert(ids[i], parcels[i]);
+    }
+    auto t = chrono::steady_clock::now();
+    for (int i = 0; i < probes; i++) sink += table.search(misses[i & 4095]) ? 1 : 0;
+    double secs = secondsSince(t);
+    cout << "  hash table miss (" << inTable << " parcels) " << setprecision(1)
+         << secs * 1e9 / probes << " ns/lookup\n";
+
+    for (int i = 0; i < inTable; i++) delete parcels[i];
+    delete[] parcels;
+    delete[] ids;
+    delete[] misses;
+    return sink < 0;
+}
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <cstdlib>
+#include "bench.h"
+#include "../geoindex.h"
+#include "../mapgraph.h"
+
+using namespace std;
+
+// =====================================================
+// Geospatial Index and A* Routing
+// =====================================================
+
+static double uniform(double lo, double hi) {
+    return lo + (hi - lo) * (rand() / (double)RAND_MAX);
+}
+
+// Points spread over Pakistan's bounding box
+static void indexQueries(int pointCount) {
+    double* lat = new double[pointCount];
+    double* lon = new double[pointCount];
+    srand(5);
+    for (int i = 0; i < pointCount; i++) {
+        lat[i] = uniform(24.0, 37.0);
+        lon[i] = uniform(61.0, 77.0);
+    }
+    GeoIndex index;
+    auto t = chrono::steady_clock::now();
+    index.build(lat, lon, pointCount);
+    cout << "  " << pointCount << " points, built in " << fixed << setprecision(1)
+         << secondsSince(t) * 1e3 << " ms\n";
+    cout.unsetf(ios::fixed);
+
+    const int queries = 10000, scans = 50;
+    double* qLat = new double[queries];
+    double* qLon = new double[queries];
+    for (int q = 0; q < queries; q++) {
+        qLat[q] = uniform(24.0, 37.0);
+        qLon[q] = uniform(61.0, 77.0);
+    }
+
+    // 5 nearest
+    volatile long long sink = 0;
+    int ids[5];
+    t = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) sink += index.nearest(qLat[q], qLon[q], 5, ids);
+    benchReport("5 nearest, R-tree", secondsSince(t) * 1e6 / queries, "us/query");
+    t = chrono::steady_clock::now();
+    for (int q = 0; q < scans; q++) {
+        double best[5] = { 1e30, 1e30, 1e30, 1e30, 1e30 };
+        for (int i = 0; i < pointCount; i++) {
+            double d = geoDistanceKm(qLat[q], qLon[q], lat[i], lon[i]);
+            if (d >= best[4]) continue;
+            int j = 4;
+            while (j > 0 && best[j - 1] > d) {
+                best[j] = best[j - 1];
+                j--;
+            }
+            best[j] = d;
+        }
+        sink += (long long)best[0];
+    }
+    benchReport("5 nearest, full scan", secondsSince(t) * 1e6 / scans, "us/query");
+
+    // Everything within 25 km
+    long long hits = 0;
+    t = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        IntArrayList out;
+        index.within(qLat[q], qLon[q], 25.0, out);
+        hits += out.size();
+    }
+    benchReport("within 25 km, R-tree", secondsSince(t) * 1e6 / queries, "us/query");
+    t = chrono::steady_clock::now();
+    for (int q = 0; q < scans; q++)
+        for (int i = 0; i < pointCount; i++)
+            sink += geoDistanceKm(qLat[q], qLon[q], lat[i], lon[i]) <= 25.0;
+    benchReport("within 25 km, full scan", secondsSince(t) * 1e6 / scans, "us/query");
+    cout << "  (" << hits / queries << " points within 25 km on average)\n";
+
+    delete[] lat;
+    delete[] lon;
+    delete[] qLat;
+    delete[] qLon;
+}
+
+// A side x side grid of cities 10 km apart, roads 0-50% longer than the
+// straight line, on a motorway or a rural profile
+static void routing(int side) {
+    const unsigned char fast[24] = { 110,110,110,110,110,105, 95,75,70,85,100,100,
+                                     100,100,100, 95, 80,70,75, 95,105,110,110,110 };
+    const unsigned char slow[24] = {  40, 40, 40, 40, 45, 50, 55,55,55,55, 55, 55,
+                                      55, 55, 55, 55, 55,50,45, 40, 40, 40, 40, 40 };
+    MapGraph map;
+    int mwy = map.addSpeedProfile("Motorway", fast);
+    int rur = map.addSpeedProfile("Rural", slow);
+    srand(9);
+    for (int i = 0; i < side * side; i++)
+        map.addCity("G" + to_string(i), "Zone A", 28.0 + (i / side) * 0.09, 68.0 + (i % side) * 0.1);
+    for (int i = 0; i < side * side; i++) {
+        int next[2] = { i % side + 1 < side ? i + 1 : -1, i / side + 1 < side ? i + side : -1 };
+        for (int v : next) {
+            if (v < 0) continue;
+            double straight = geoDistanceKm(map.cities[i].lat, map.cities[i].lon, map.cities[v].lat, map.cities[v].lon);
+            map.addRoad(i, v, (int)(straight * uniform(1.0, 1.5)) + 1, rand() % 4 == 0 ? mwy : rur);
+        }
+    }
+
+    const int queries = 200;
+    int* from = new int[queries];
+    int* to = new int[queries];
+    double* depart = new double[queries];
+    for (int q = 0; q < queries; q++) {
+        from[q] = rand() % (side * side);
+        to[q] = rand() % (side * side);
+        depart[q] = uniform(0, 24);
+    }
+
+    double sum = 0;
+    auto t = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) sum += map.fastestArrival(from[q], to[q], depart[q]);
+    double aStar = secondsSince(t);
+
+    // The same searches without the bound
+    double bound = map.hoursPerKmBound;
+    map.hoursPerKmBound = 0;
+    double check = 0;
+    t = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) check += map.fastestArrival(from[q], to[q], depart[q]);
+    double dijkstra = secondsSince(t);
+    map.hoursPerKmBound = bound;
+
+    cout << "  " << side * side << "-city grid, " << queries << " fastest-arrival queries\n";
+    benchReport("time-dependent Dijkstra", dijkstra * 1e6 / queries, "us/query");
+    benchReport("A* (straight-line bound)", aStar * 1e6 / queries, "us/query");
+    if (sum - check > 1e-6 || check - sum > 1e-6) cout << "  [!] A* and Dijkstra disagree\n";
+    delete[] from;
+    delete[] to;
+    delete[] depart;
+}
+
+int runGeoBench(int pointCount) {
+    indexQueries(pointCount);
+    routing(100);
+    return 0;
+}
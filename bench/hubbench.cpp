@@ -0,0 +1,72 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <iomanip>
+#include <filesystem>
+#include "bench.h"
+#include "../hubcluster.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// =====================================================
+// Sharded Hubs: Pickup -> Dispatch Throughput
+// =====================================================
+static const char* BENCH_CITIES[] = { "Chichawatni", "Islamabad", "Karachi", "Peshawar", "Multan",
+                                      "Faisalabad", "Quetta", "Lahore", "Rawalpindi", "Sakhar" };
+static const char* HUB_CITIES[] = { "Lahore", "Islamabad", "Karachi", "Quetta" };
+static const char* HUB_ZONES[] = { "Zone A", "Zone B", "Zone C", "Zone D" };
+
+static double runShards(int hubs, int orders) {
+    const string dir = "hubbench.d";
+    error_code ec;
+    fs::remove_all(dir, ec);
+
+    HubCluster cluster(dir);
+    for (int h = 0; h < hubs; h++) cluster.addHub(HUB_CITIES[h], HUB_ZONES[h]);
+    // Random closures pile up over a run and turn most dispatches into
+    // quick "no route" returns; keep every run doing the full route search
+    cluster.setRoadEventRate(0);
+    cluster.start();
+
+    auto t = chrono::steady_clock::now();
+    for (int i = 0; i < orders; i++) {
+        string id = "HB-" + to_string(i);
+        const char* origin = HUB_CITIES[i % hubs];
+        const char* dest = BENCH_CITIES[(i * 7) % 10];
+        while (!cluster.submitPickup(origin, id, dest, 1.0 + (i % 20), 1 + i % 3))
+            this_thread::yield();
+    }
+    for (;;) {
+        long long done = 0;
+        for (int h = 0; h < hubs; h++) {
+            HubCluster::HubStats st = cluster.stats(h);
+            done += st.dispatched + st.rejected;
+        }
+        if (done >= orders) break;
+        this_thread::yield();
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t).count();
+
+    cluster.stop();
+    fs::remove_all(dir, ec);
+    return secs;
+}
+
+int runHubBench(int orders) {
+    unsigned int cores = thread::hardware_concurrency();
+    cout << "  " << orders << " pickups submitted and dispatched, " << cores << " hardware thread(s)\n";
+    if (cores < 4) cout << "  (shards only scale with free cores; expect flat numbers here)\n";
+
+    double base = 0;
+    for (int hubs = 1; hubs <= 4; hubs *= 2) {
+        double secs = runShards(hubs, orders);
+        if (hubs == 1) base = secs;
+        cout << "  " << hubs << " hub(s)   " << fixed << setprecision(3) << secs << " s   "
+             << setprecision(0) << orders / secs << " parcels/s   x" << setprecision(2)
+             << base / secs << "\n";
+        cout.unsetf(ios::fixed);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <cstdlib>
+#include "bench.h"
+#include "../transittable.h"
+
+using namespace std;
+
+// =====================================================
+// Lifecycle Sweep: Column Kernel vs Linked List
+// =====================================================
+
+// The shipping list before TransitTable: one node per parcel, each
+// parcel's fields read through the node and rand() rolled per parcel
+class LinkedShippingList {
+private:
+    struct Node {
+        Parcel* data;
+        Node* next;
+    };
+    Node* head;
+    Node* tail;
+public:
+    LinkedShippingList() : head(nullptr), tail(nullptr) {}
+    ~LinkedShippingList() {
+        while (head) {
+            Node* n = head->next;
+            delete head;
+            head = n;
+        }
+    }
+    void pushBack(Parcel* p) {
+        Node* n = new Node{ p, nullptr };
+        if (!tail) head = tail = n;
+        else {
+            tail->next = n;
+            tail = n;
+        }
+    }
+    void updateLifecycle(long long currentTime) {
+        for (Node* curr = head; curr; curr = curr->next) {
+            Parcel* p = curr->data;
+            if (p->status == STATUS_LOADING) {
+                if (currentTime >= p->lastUpdateTime + 5)
+                    p->updateStatus(STATUS_IN_TRANSIT, "Vehicle Departed", "On Road");
+            }
+            else if (p->status == STATUS_IN_TRANSIT) {
+                if (rand() % 1000 == 0)
+                    p->updateStatus(STATUS_MISSING, "Signal Lost - Investigation Started", "Unknown");
+                else if (currentTime >= p->arrivalTime)
+                    p->updateStatus(STATUS_DELIVERY_ATTEMPT, "Arrived at Destination Hub", p->destination);
+            }
+            else if (p->status == STATUS_DELIVERY_ATTEMPT) {
+                if (rand() % 10 < 8) p->updateStatus(STATUS_DELIVERED, "Handed to Recipient", "Doorstep");
+                else {
+                    p->deliveryAttempts++;
+                    if (p->deliveryAttempts >= 3) p->updateStatus(STATUS_RETURNED, "Max Attempts Reached - RTS", "Local Hub");
+                    else {
+                        p->updateStatus(STATUS_IN_TRANSIT, "Recipient Unavailable - Retrying", "Local Hub");
+                        p->arrivalTime = currentTime + 5;
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Everyone on the road, due in an hour
+static void resetRoad(Parcel** all, int n, long long now) {
+    for (int i = 0; i < n; i++) {
+        all[i]->status = STATUS_IN_TRANSIT;
+        all[i]->arrivalTime = now + 3600;
+        all[i]->deliveryAttempts = 0;
+    }
+}
+
+static int countStatus(Parcel** all, int n, int status) {
+    int c = 0;
+    for (int i = 0; i < n; i++) c += all[i]->status == status;
+    return c;
+}
+
+int runLifecycleBench(int parcelCount) {
+    const int sweeps = 5;
+    long long now = 1700000000;
+    cout << "  " << parcelCount << " parcels on the road, " << sweeps << " sweeps each\n";
+
+    Parcel** all = new Parcel*[parcelCount];
+    for (int i = 0; i < parcelCount; i++)
+        all[i] = new Parcel("LB-" + to_string(i), "Karachi", 2.0, 1, "Zone A");
+
+    // A quiet road: nobody is due, the dice still roll for everyone
+    resetRoad(all, parcelCount, now);
+    LinkedShippingList* linked = new LinkedShippingList();
+    for (int i = 0; i < parcelCount; i++) linked->pushBack(all[i]);
+    auto t = chrono::steady_clock::now();
+    for (int s = 0; s < sweeps; s++) linked->updateLifecycle(now);
+    benchReport("quiet road, linked list", secondsSince(t) * 1e3 / sweeps, "ms/sweep");
+    int linkedLost = countStatus(all, parcelCount, STATUS_MISSING);
+
+    resetRoad(all, parcelCount, now);
+    TransitTable* table = new TransitTable();
+    table->setSeed(7);
+    for (int i = 0; i < parcelCount; i++) table->pushBack(all[i]);
+    TransitTable::Transition* out = new TransitTable::Transition[parcelCount];
+    t = chrono::steady_clock::now();
+    int found = 0;
+    for (int s = 0; s < sweeps; s++) found += table->sweep(now, out);
+    benchReport("quiet road, kernel only", secondsSince(t) * 1e3 / sweeps, "ms/sweep");
+    t = chrono::steady_clock::now();
+    for (int s = 0; s < sweeps; s++) table->updateLifecycle(now);
+    benchReport("quiet road, column table", secondsSince(t) * 1e3 / sweeps, "ms/sweep");
+    int tableLost = countStatus(all, parcelCount, STATUS_MISSING);
+    cout << "  gone missing: linked " << linkedLost << ", table " << tableLost
+         << " (expected about " << parcelCount / 1000 * sweeps << "); kernel flagged " << found << "\n";
+
+    // Rush hour: everyone arrives, then the delivery attempts are settled
+    resetRoad(all, parcelCount, now);
+    delete linked;
+    linked = new LinkedShippingList();
+    for (int i = 0; i < parcelCount; i++) linked->pushBack(all[i]);
+    t = chrono::steady_clock::now();
+    linked->updateLifecycle(now + 3600);
+    linked->updateLifecycle(now + 3600);
+    benchReport("arrive + attempt, linked list", secondsSince(t) * 1e3 / 2, "ms/sweep");
+    int linkedDelivered = countStatus(all, parcelCount, STATUS_DELIVERED);
+
+    resetRoad(all, parcelCount, now);
+    delete table;
+    table = new TransitTable();
+    table->setSeed(7);
+    for (int i = 0; i < parcelCount; i++) table->pushBack(all[i]);
+    t = chrono::steady_clock::now();
+    table->updateLifecycle(now + 3600);
+    table->updateLifecycle(now + 3600);
+    benchReport("arrive + attempt, column table", secondsSince(t) * 1e3 / 2, "ms/sweep");
+    int tableDelivered = countStatus(all, parcelCount, STATUS_DELIVERED);
+    cout << "  delivered first time: linked " << linkedDelivered << ", table " << tableDelivered
+         << " (expected about " << (long long)parcelCount * 8 / 10 << "); " << table->size()
+         << " still on the road\n";
+
+    delete linked;
+    delete table;
+    delete[] out;
+    for (int i = 0; i < parcelCount; i++) delete all[i];
+    delete[] all;
+    return 0;
+}
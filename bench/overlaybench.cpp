@@ -0,0 +1,132 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <cstdlib>
+#include "bench.h"
+#include "../mapgraph.h"
+#include "../minheap.h"
+
+using namespace std;
+
+// =====================================================
+// Zone Overlay vs Plain Dijkstra
+// =====================================================
+
+// Point-to-point Dijkstra over the open roads, stopping at the target
+static int plainDistance(const MapGraph& map, int s, int t, int* dist, MinHeapItem<int>* heap) {
+    for (int i = 0; i < map.cityCount; i++) dist[i] = DIST_INFINITY;
+    int heapSize = 0;
+    dist[s] = 0;
+    minHeapPush(heap, heapSize, 0, s);
+    while (heapSize > 0) {
+        MinHeapItem<int> top = minHeapPop(heap, heapSize);
+        int u = top.node;
+        if (top.key != dist[u]) continue;
+        if (u == t) break;
+        for (const Edge& e : map.cities[u].edges) {
+            if (e.blocked) continue;
+            int nd = top.key + e.weight;
+            if (nd < dist[e.dest]) {
+                dist[e.dest] = nd;
+                minHeapPush(heap, heapSize, nd, e.dest);
+            }
+        }
+    }
+    return dist[t];
+}
+
+// Sums the roads along a city path, or -1 if a hop is not an open road
+static int pathKm(MapGraph& map, const IntArrayList& path) {
+    int km = 0;
+    for (int i = 0; i + 1 < path.size(); i++) {
+        int id = map.findEdgeId(path[i], path[i + 1]);
+        if (id < 0 || map.getEdge(id).blocked) return -1;
+        km += map.getEdge(id).weight;
+    }
+    return km;
+}
+
+// A side x side grid, 10 km apart, roads 10-15 km; the four quadrants are
+// the zones
+int runOverlayBench(int side) {
+    MapGraph map;
+    srand(11);
+    for (int i = 0; i < side * side; i++) {
+        int row = i / side, col = i % side;
+        string zone = string("Zone ") + (char)('A' + (row >= side / 2) * 2 + (col >= side / 2));
+        map.addCity("G" + to_string(i), zone, 28.0 + row * 0.09, 68.0 + col * 0.1);
+    }
+    for (int i = 0; i < side * side; i++) {
+        if (i % side + 1 < side) map.addRoad(i, i + 1, 10 + rand() % 6);
+        if (i / side + 1 < side) map.addRoad(i, i + side, 10 + rand() % 6);
+    }
+    int n = side * side;
+
+    map.overlay.refresh(map);
+    cout << "  " << n << "-city grid, 4 zones: " << map.overlay.levelCount() << " levels (";
+    for (int l = map.overlay.levelCount() - 1; l >= 0; l--)
+        cout << map.overlay.cellCount(l) << (l > 0 ? " / " : " cells)");
+    cout << fixed << setprecision(1) << ", partitioned in " << map.overlay.buildMs << " ms, customized in "
+         << map.overlay.customizeMs << " ms\n";
+    cout.unsetf(ios::fixed);
+
+    const int queries = 500;
+    int* from = new int[queries];
+    int* to = new int[queries];
+    for (int q = 0; q < queries; q++) {
+        from[q] = rand() % n;
+        to[q] = rand() % n;
+    }
+    int* dist = new int[n];
+    MinHeapItem<int>* heap = new MinHeapItem<int>[4 * n + 1];
+
+    long long plainSum = 0, overlaySum = 0;
+    auto t = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) plainSum += plainDistance(map, from[q], to[q], dist, heap);
+    benchReport("plain Dijkstra", secondsSince(t) * 1e6 / queries, "us/query");
+    t = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) overlaySum += map.shortestDistance(from[q], to[q]);
+    benchReport("overlay", secondsSince(t) * 1e6 / queries, "us/query");
+    IntArrayList path;
+    t = chrono::steady_clock::now();
+    int badPaths = 0;
+    for (int q = 0; q < queries; q++) {
+        int km = map.shortestDistance(from[q], to[q], &path);
+        badPaths += pathKm(map, path) != km;
+    }
+    benchReport("overlay + unpacked path", secondsSince(t) * 1e6 / queries, "us/query");
+    if (plainSum != overlaySum || badPaths) cout << "  [!] overlay disagrees with Dijkstra\n";
+
+    // Road blocks: only the cells around the road are customized again
+    const int blocks = 200;
+    double worst = 0, total = 0;
+    double spentSorted[blocks];
+    int mismatches = 0, cells = 0;
+    for (int b = 0; b < blocks; b++) {
+        int edgeId;
+        do edgeId = rand() % map.edgeCount;
+        while (map.getEdge(edgeId).blocked);
+        map.blockRoad(edgeId);
+        double spent = map.overlay.customizeMs;
+        total += spent;
+        if (spent > worst) worst = spent;
+        int at = b;
+        for (; at > 0 && spentSorted[at - 1] > spent; at--) spentSorted[at] = spentSorted[at - 1];
+        spentSorted[at] = spent;
+        cells += map.overlay.customizedCells;
+        int s = rand() % n, d = rand() % n;
+        mismatches += map.shortestDistance(s, d) != plainDistance(map, s, d, dist, heap);
+    }
+    cout << "  " << blocks << " road blocks: re-customized in " << fixed << setprecision(3)
+         << total / blocks << " ms on average, " << spentSorted[blocks / 2] << " median, " << worst << " at worst ("
+         << setprecision(1) << (double)cells / blocks << " cells each)\n";
+    cout.unsetf(ios::fixed);
+    if (mismatches) cout << "  [!] " << mismatches << " queries disagree after road blocks\n";
+
+    delete[] from;
+    delete[] to;
+    delete[] dist;
+    delete[] heap;
+    return 0;
+}
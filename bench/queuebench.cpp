@@ -0,0 +1,171 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <iomanip>
+#include <cstdio>
+#include "bench.h"
+#include "../ringqueue.h"
+#include "../spscqueue.h"
+#include "../mpmcqueue.h"
+
+using namespace std;
+
+// =====================================================
+// Ring Buffer vs Linked Queue
+// =====================================================
+
+// The queue the rider rotation used before RingQueue: one heap node per
+// enqueue, freed again by the dequeue
+class LinkedStringQueue {
+private:
+    struct Node {
+        string data;
+        Node* next;
+        Node(string&& d) : data(move(d)), next(nullptr) {}
+    };
+    Node* front;
+    Node* rear;
+public:
+    LinkedStringQueue() : front(nullptr), rear(nullptr) {}
+    ~LinkedStringQueue() {
+        while (front) {
+            Node* n = front->next;
+            delete front;
+            front = n;
+        }
+    }
+    void enqueue(string&& val) {
+        Node* n = new Node(move(val));
+        if (!rear) front = rear = n;
+        else {
+            rear->next = n;
+            rear = n;
+        }
+    }
+    string dequeue() {
+        if (!front) return "";
+        Node* temp = front;
+        string val = move(front->data);
+        front = front->next;
+        if (!front) rear = nullptr;
+        delete temp;
+        return val;
+    }
+};
+
+// Time per operation, with the allocations it made alongside
+static void report(const char* what, int ops, double secs, long long allocs) {
+    char unit[40];
+    snprintf(unit, sizeof(unit), "ns/op  %6.2f allocs/op", (double)allocs / ops);
+    benchReport(what, secs * 1e9 / ops, unit, 1);
+}
+
+static const char* RIDERS[] = { "InamUllah (Light Load)", "Haris Waheed (Heavy Load)",
+                                "Ahmad Gulzar (Priority)", "Hurarah (General)" };
+
+// `producers` threads push 0..ops-1 between them, this thread pops them;
+// returns seconds
+template <typename Q>
+static double crossThread(Q& q, int ops, int producers) {
+    auto t = chrono::steady_clock::now();
+    thread* workers = new thread[producers];
+    for (int p = 0; p < producers; p++) {
+        workers[p] = thread([&q, ops, producers, p] {
+            for (int i = p; i < ops; i += producers)
+                while (!q.push(i)) this_thread::yield();
+        });
+    }
+    long long sum = 0;
+    int v;
+    for (int got = 0; got < ops;) {
+        if (q.pop(v)) {
+            sum += v;
+            got++;
+        }
+        else this_thread::yield();
+    }
+    for (int p = 0; p < producers; p++) workers[p].join();
+    delete[] workers;
+    double secs = secondsSince(t);
+    if (sum != (long long)ops * (ops - 1) / 2) cout << "  [!] lost or repeated values\n";
+    return secs;
+}
+
+int runQueueBench(int ops) {
+    cout << "  " << ops << " operations per run\n";
+    volatile size_t sink = 0;
+
+    // Rider rotation: the dispatcher takes the front rider and sends them
+    // to the back, once per dispatch
+    {
+        LinkedStringQueue linked;
+        for (const char* r : RIDERS) linked.enqueue(r);
+        long long a = benchAllocCount();
+        auto t = chrono::steady_clock::now();
+        for (int i = 0; i < ops; i++) {
+            string rider = linked.dequeue();
+            sink += rider.size();
+            linked.enqueue(move(rider));
+        }
+        report("rider rotation, linked", ops, secondsSince(t), benchAllocCount() - a);
+
+        RingQueue<string> ring;
+        for (const char* r : RIDERS) ring.enqueue(r);
+        a = benchAllocCount();
+        t = chrono::steady_clock::now();
+        for (int i = 0; i < ops; i++) {
+            sink += ring.front().size();
+            ring.rotate();
+        }
+        report("rider rotation, ring", ops, secondsSince(t), benchAllocCount() - a);
+    }
+
+    // FIFO churn at a standing depth of 256: one dequeue and one enqueue
+    // per operation
+    {
+        const int depth = 256;
+        LinkedStringQueue linked;
+        for (int i = 0; i < depth; i++) linked.enqueue(string(RIDERS[i & 3]));
+        long long a = benchAllocCount();
+        auto t = chrono::steady_clock::now();
+        for (int i = 0; i < ops; i++) {
+            string s = linked.dequeue();
+            sink += s.size();
+            linked.enqueue(move(s));
+        }
+        report("FIFO depth 256, linked", ops, secondsSince(t), benchAllocCount() - a);
+
+        RingQueue<string> ring;
+        for (int i = 0; i < depth; i++) ring.enqueue(string(RIDERS[i & 3]));
+        a = benchAllocCount();
+        t = chrono::steady_clock::now();
+        for (int i = 0; i < ops; i++) {
+            string s = ring.dequeue();
+            sink += s.size();
+            ring.enqueue(move(s));
+        }
+        report("FIFO depth 256, ring", ops, secondsSince(t), benchAllocCount() - a);
+    }
+
+    // Cross-thread hand-over of plain values through the bounded queues
+    unsigned int cores = thread::hardware_concurrency();
+    cout << "  cross-thread, " << cores << " hardware thread(s)";
+    if (cores < 2) cout << " (both ends share one core; expect yield-bound numbers)";
+    cout << "\n";
+    {
+        SpscQueue<int> spsc(4096);
+        long long a = benchAllocCount();
+        double secs = crossThread(spsc, ops, 1);
+        report("SPSC, 1 producer", ops, secs, benchAllocCount() - a);
+
+        MpmcQueue<int> mpmc(4096);
+        a = benchAllocCount();
+        secs = crossThread(mpmc, ops, 1);
+        report("MPMC, 1 producer", ops, secs, benchAllocCount() - a);
+        a = benchAllocCount();
+        secs = crossThread(mpmc, ops, 4);
+        report("MPMC, 4 producers", ops, secs, benchAllocCount() - a);
+    }
+    return sink == 0;
+}
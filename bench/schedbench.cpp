@@ -0,0 +1,181 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <cstdlib>
+#include "bench.h"
+#include "../dispatchscheduler.h"
+
+using namespace std;
+
+// =====================================================
+// Dispatch Order: SLA Calendar Queue vs Score Heap
+// =====================================================
+
+// The sorting queue before DispatchScheduler: a max-heap on
+// priority * 1000 + weight
+class ScoreHeap {
+private:
+    Parcel** heap;
+    int count;
+    static int score(const Parcel* p) { return p->priority * 1000 + (int)p->weight; }
+
+public:
+    explicit ScoreHeap(int capacity) : heap(new Parcel*[capacity]), count(0) {}
+    ~ScoreHeap() { delete[] heap; }
+    void insert(Parcel* p) {
+        int i = count++;
+        heap[i] = p;
+        while (i > 0 && score(heap[i]) > score(heap[(i - 1) / 2])) {
+            swap(heap[i], heap[(i - 1) / 2]);
+            i = (i - 1) / 2;
+        }
+    }
+    Parcel* extractMax() {
+        if (count == 0) return nullptr;
+        Parcel* top = heap[0];
+        heap[0] = heap[--count];
+        int i = 0;
+        for (;;) {
+            int l = 2 * i + 1, r = l + 1, m = i;
+            if (l < count && score(heap[l]) > score(heap[m])) m = l;
+            if (r < count && score(heap[r]) > score(heap[m])) m = r;
+            if (m == i) break;
+            swap(heap[i], heap[m]);
+            i = m;
+        }
+        return top;
+    }
+};
+
+static const char* DESTINATIONS[] = { "Chichawatni", "Islamabad", "Karachi", "Peshawar", "Multan",
+                                      "Faisalabad", "Quetta", "Rawalpindi", "Sakhar" };
+
+static Parcel* makeParcel(int i, long long now) {
+    Parcel* p = new Parcel("SB-" + to_string(i), DESTINATIONS[rand() % 9], 1.0 + rand() % 30,
+                           1 + rand() % 3, "Zone A");
+    p->queuedSince = now;
+    return p;
+}
+
+// The parcel that just left comes back as a new pickup
+static void renew(Parcel* p, long long now, int i) {
+    p->priority = 1 + (i * 7) % 3;
+    p->weight = 1.0 + (i * 13) % 30;
+    p->queuedSince = now;
+}
+
+// Steady state at a standing depth: one pickup in, one dispatch out; a
+// second passes every 64 pickups
+static void throughput(int depth, int ops) {
+    Parcel** pool = new Parcel*[depth + 1];
+    long long now = 1700000000;
+    srand(1);
+    for (int i = 0; i <= depth; i++) pool[i] = makeParcel(i, now);
+
+    ScoreHeap heap(depth + 1);
+    for (int i = 0; i < depth; i++) heap.insert(pool[i]);
+    Parcel* spare = pool[depth];
+    auto t = chrono::steady_clock::now();
+    for (int i = 0; i < ops; i++) {
+        renew(spare, now + i / 64, i);
+        heap.insert(spare);
+        spare = heap.extractMax();
+    }
+    double heapSecs = secondsSince(t);
+
+    // Same parcels again for the scheduler
+    srand(1);
+    for (int i = 0; i <= depth; i++) {
+        delete pool[i];
+        pool[i] = makeParcel(i, now);
+    }
+    DispatchScheduler sched;
+    for (int i = 0; i < depth; i++) sched.insert(pool[i]);
+    spare = pool[depth];
+    long long allocs = benchAllocCount();
+    t = chrono::steady_clock::now();
+    for (int i = 0; i < ops; i++) {
+        renew(spare, now + i / 64, i);
+        sched.insert(spare);
+        spare = sched.extractNext();
+    }
+    double schedSecs = secondsSince(t);
+    allocs = benchAllocCount() - allocs;
+
+    cout << "  depth " << setw(7) << depth << "   score heap " << fixed << setprecision(1) << setw(6)
+         << heapSecs * 1e9 / ops << " ns/op   calendar " << setw(6) << schedSecs * 1e9 / ops
+         << " ns/op  " << setprecision(2) << (double)allocs / ops << " allocs/op\n";
+    cout.unsetf(ios::fixed);
+
+    for (int i = 0; i <= depth; i++) delete pool[i];
+    delete[] pool;
+}
+
+// A day with a twelve-hour peak: 5 pickups a minute against 4 dispatches,
+// then 3 a minute while the backlog clears. The order decides who waits.
+struct WaitStats {
+    long long total[4];
+    long long longest[4];
+    int dispatched[4];
+    int late[4];            // left after their SLA (default policy)
+    int waiting[4];
+};
+
+template <typename Queue, typename Take>
+static WaitStats simulate(Queue& q, Take take, int minutes) {
+    DispatchPolicy sla;
+    WaitStats st = {};
+    Parcel** all = new Parcel*[minutes * 5];
+    int made = 0, queued = 0;
+    long long start = 1700000000;
+    srand(2);
+    for (int m = 0; m < minutes; m++) {
+        long long now = start + m * 60LL;
+        int arrivals = m < minutes / 2 ? 5 : 3;
+        for (int k = 0; k < arrivals; k++) {
+            all[made] = makeParcel(made, now);
+            q.insert(all[made++]);
+            queued++;
+        }
+        for (int k = 0; k < 4 && queued > 0; k++, queued--) {
+            Parcel* p = take(q);
+            p->dispatchTime = now;
+            long long wait = now - p->queuedSince;
+            st.dispatched[p->priority]++;
+            st.total[p->priority] += wait;
+            if (wait > st.longest[p->priority]) st.longest[p->priority] = wait;
+            if (wait > sla.slaSeconds[p->priority]) st.late[p->priority]++;
+        }
+    }
+    for (int i = 0; i < made; i++) {
+        if (all[i]->dispatchTime == 0) st.waiting[all[i]->priority]++;
+        delete all[i];
+    }
+    delete[] all;
+    return st;
+}
+
+static void printWaits(const char* name, const WaitStats& st) {
+    cout << "  " << name << "\n";
+    for (int pr = 3; pr >= 1; pr--) {
+        cout << "    priority " << pr << ": " << setw(5) << st.dispatched[pr] << " sent, mean wait "
+             << setw(4) << (st.dispatched[pr] ? st.total[pr] / st.dispatched[pr] / 60 : 0)
+             << " min, longest " << setw(4) << st.longest[pr] / 60 << " min, "
+             << setw(4) << st.late[pr] << " past SLA, " << st.waiting[pr] << " still waiting\n";
+    }
+}
+
+int runSchedBench(int ops) {
+    cout << "  " << ops << " pickup + dispatch pairs per depth\n";
+    throughput(1000, ops);
+    throughput(100000, ops);
+
+    const int minutes = 24 * 60;
+    cout << "  one day: 12 h at 5 pickups a minute, 12 h at 3; 4 dispatches a minute\n";
+    ScoreHeap heap(minutes * 5);
+    printWaits("score heap (priority, then weight)", simulate(heap, [](ScoreHeap& q) { return q.extractMax(); }, minutes));
+    DispatchScheduler sched;
+    printWaits("SLA calendar queue (default policy)", simulate(sched, [](DispatchScheduler& q) { return q.extractNext(); }, minutes));
+    return 0;
+}
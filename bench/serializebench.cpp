@@ -0,0 +1,102 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include "bench.h"
+#include "../serializer.h"
+
+using namespace std;
+
+// =====================================================
+// Bulk Export Throughput (JSON / MessagePack)
+// =====================================================
+static const char* BENCH_DESTS[] = { "Karachi", "Islamabad", "Multan", "Peshawar", "Quetta" };
+static const char* BENCH_ZONES[] = { "Zone C", "Zone B", "Zone A", "Zone B", "Zone D" };
+
+// iostream version of the same document, for comparison
+static void streamParcel(ostream& os, const Parcel& p) {
+    os << "{\"id\":\"" << p.id << "\",\"destination\":\"" << p.destination
+       << "\",\"zone\":\"" << p.zone << "\",\"weight\":" << p.weight
+       << ",\"weightCategory\":\"" << p.weightCategory << "\",\"priority\":" << p.priority
+       << ",\"status\":" << p.status << ",\"statusText\":\"" << p.getStatusName()
+       << "\",\"rider\":\"" << p.assignedRider << "\",\"dispatchTime\":" << p.dispatchTime
+       << ",\"arrivalTime\":" << p.arrivalTime << ",\"etaSeconds\":0,\"deliveryAttempts\":"
+       << p.deliveryAttempts << ",\"history\":[";
+    bool first = true;
+    for (const HistoryEvent* e = p.history->first(); e; e = e->next) {
+        if (!first) os << ',';
+        first = false;
+        os << "{\"time\":\"" << e->time << "\",\"description\":\"" << e->description
+           << "\",\"location\":\"" << e->location << "\"}";
+    }
+    os << "]}";
+}
+
+template <class Writer>
+static size_t encodeAll(OutBuffer& buf, Parcel** parcels, int n, long long now) {
+    buf.clear();
+    Writer w(buf);
+    w.beginArray(n);
+    for (int i = 0; i < n; i++) writeParcel(w, *parcels[i], true, now);
+    w.endArray();
+    return buf.size();
+}
+
+// Throughput in bytes and in parcels
+static void report(const char* label, size_t bytes, int parcels, double secs) {
+    char unit[64];
+    snprintf(unit, sizeof(unit), "MB/s  %8.1f M parcels/s  (%zu B/parcel)", parcels / secs / 1e6, bytes / parcels);
+    benchReport(label, bytes / 1e6 / secs, unit, 1);
+}
+
+int runSerializeBench(int parcelCount) {
+    // A realistic inventory: delivered parcels carry a full timeline
+    Parcel** parcels = new Parcel*[parcelCount];
+    for (int i = 0; i < parcelCount; i++) {
+        Parcel* p = new Parcel("SWX-" + to_string(1000000 + i), BENCH_DESTS[i % 5], 0.5 + (i % 40), 1 + i % 3, BENCH_ZONES[i % 5]);
+        p->updateStatus(STATUS_WAREHOUSE, "Arrived at Warehouse", "Central Hub");
+        p->updateStatus(STATUS_LOADING, "Loading onto Truck", "Bay 4");
+        p->updateStatus(STATUS_IN_TRANSIT, "Vehicle Departed", "On Road");
+        p->updateStatus(STATUS_DELIVERY_ATTEMPT, "Arrived at Destination Hub", p->destination);
+        p->updateStatus(STATUS_DELIVERED, "Handed to Recipient", "Doorstep");
+        p->assignedRider = "Rider " + to_string(i % 12);
+        p->dispatchTime = 1700000000LL + i;
+        p->arrivalTime = p->dispatchTime + 90;
+        parcels[i] = p;
+    }
+
+    const int rounds = 10;
+    OutBuffer buf;
+    long long now = 1700000000LL;
+    typedef chrono::steady_clock Clock;
+    cout << "serialize bench: " << parcelCount << " parcels with timelines, " << rounds << " rounds\n";
+
+    size_t bytes = 0;
+    auto t0 = Clock::now();
+    for (int r = 0; r < rounds; r++) bytes += encodeAll<JsonWriter>(buf, parcels, parcelCount, now);
+    report("json", bytes, parcelCount * rounds, secondsSince(t0));
+
+    bytes = 0;
+    t0 = Clock::now();
+    for (int r = 0; r < rounds; r++) bytes += encodeAll<MsgPackWriter>(buf, parcels, parcelCount, now);
+    report("msgpack", bytes, parcelCount * rounds, secondsSince(t0));
+
+    bytes = 0;
+    t0 = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        ostringstream os;
+        os << '[';
+        for (int i = 0; i < parcelCount; i++) {
+            if (i) os << ',';
+            streamParcel(os, *parcels[i]);
+        }
+        os << ']';
+        bytes += os.str().size();
+    }
+    report("iostream", bytes, parcelCount * rounds, secondsSince(t0));
+
+    for (int i = 0; i < parcelCount; i++) delete parcels[i];
+    delete[] parcels;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "bloomfilter.h"
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+// =====================================================
+// BloomFilter Implementation (Cache-Line Blocked)
+// =====================================================
+// Squeezing every key into one 512-bit block costs accuracy against a
+// classic filter, more so at low rates (more bits per block crowd together).
+// Extra space of 15% per decade of the rate buys it back.
+static double blockingOverhead(double fpRate) {
+    return 1.0 + 0.15 * log10(1.0 / fpRate);
+}
+
+static unsigned long long mix64(unsigned long long h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// FNV-1a over the bytes, then a full avalanche so short, similar IDs
+// ("P1001", "P1002") land far apart
+unsigned long long BloomFilter::hash(string_view key) {
+    unsigned long long h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return mix64(h);
+}
+
+BloomFilter::BloomFilter(long long expectedKeys, double fpRate, long long minKeys) : keys(0) {
+    if (minKeys < 1) minKeys = 1;
+    if (expectedKeys < minKeys) expectedKeys = minKeys;
+    if (!(fpRate > 0.0) || fpRate >= 1.0) fpRate = 0.01;
+    capacity = expectedKeys;
+    falsePositiveRate = fpRate;
+
+    double ln2 = log(2.0);
+    double classicBits = -log(fpRate) / (ln2 * ln2);
+    double bitsPerKey = classicBits * blockingOverhead(fpRate);
+    hashes = (int)(classicBits * ln2 + 0.5);
+    if (hashes < 1) hashes = 1;
+    if (hashes > 16) hashes = 16;
+
+    double totalBits = bitsPerKey * (double)expectedKeys;
+    blockCount = (unsigned int)(totalBits / 512.0) + 1;
+    blocks = new Block[blockCount];
+    for (unsigned int i = 0; i < blockCount; i++)
+        for (int w = 0; w < 8; w++) blocks[i].words[w] = 0;
+}
+
+BloomFilter::~BloomFilter() {
+    delete[] blocks;
+}
+
+// Top 32 bits pick the block (multiply-shift instead of a modulo); the bit
+// positions come from double hashing a remixed copy
+const BloomFilter::Block& BloomFilter::blockFor(unsigned long long h) const {
+    return blocks[(unsigned int)(((h >> 32) * blockCount) >> 32)];
+}
+
+void BloomFilter::makeMask(unsigned long long h, unsigned long long mask[8]) const {
+    for (int w = 0; w < 8; w++) mask[w] = 0;
+    unsigned long long g = mix64(h ^ 0x9e3779b97f4a7c15ULL);
+    unsigned int pos = (unsigned int)g;
+    unsigned int step = (unsigned int)(g >> 32) | 1;
+    for (int i = 0; i < hashes; i++) {
+        unsigned int bit = pos & 511;
+        mask[bit >> 6] |= 1ULL << (bit & 63);
+        pos += step;
+    }
+}
+
+void BloomFilter::add(string_view key) {
+    unsigned long long h = hash(key);
+    unsigned long long mask[8];
+    makeMask(h, mask);
+    Block& b = const_cast<Block&>(blockFor(h));
+    for (int w = 0; w < 8; w++) b.words[w] |= mask[w];
+    keys++;
+}
+
+bool BloomFilter::restore(const void* bits, size_t n, long long keyCount) {
+    if (n != memoryBytes()) return false;
+    memcpy(blocks, bits, n);
+    keys = keyCount;
+    return true;
+}
+
+bool BloomFilter::mayContain(string_view key) const {
+    unsigned long long h = hash(key);
+    unsigned long long mask[8];
+    makeMask(h, mask);
+    const Block& b = blockFor(h);
+    // No early exit: a branch-free fold over the eight words vectorizes
+    unsigned long long missing = 0;
+    for (int w = 0; w < 8; w++) missing |= mask[w] & ~b.words[w];
+    return missing == 0;
+}
@@ -0,0 +1,55 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <string_view>
+
+// Blocked Bloom filter: each key sets all of its k bits inside one 64-byte
+// block, so a lookup touches a single cache line. The block is checked as
+// eight 64-bit words against a precomputed mask, which compilers turn into
+// a couple of vector compares.
+class BloomFilter {
+private:
+    struct alignas(64) Block {
+        unsigned long long words[8];
+    };
+
+    Block* blocks;
+    unsigned int blockCount;
+    int hashes;              // k, bits set per key
+    long long keys;
+    long long capacity;      // keys it was sized for
+    double falsePositiveRate;
+
+    void makeMask(unsigned long long h, unsigned long long mask[8]) const;
+    const Block& blockFor(unsigned long long h) const;
+
+public:
+    // expectedKeys is raised to at least minKeys, so a filter sized from a
+    // small table still has room to grow; a fixed key set (one archive
+    // block) passes its own count as the minimum to be sized exactly
+    BloomFilter(long long expectedKeys, double fpRate, long long minKeys = 1024);
+    ~BloomFilter();
+    BloomFilter(const BloomFilter&) = delete;
+    BloomFilter& operator=(const BloomFilter&) = delete;
+
+    static unsigned long long hash(std::string_view key);
+
+    void add(std::string_view key);
+    // false means definitely never added
+    bool mayContain(std::string_view key) const;
+
+    long long size() const { return keys; }
+    long long sizedFor() const { return capacity; }
+    double targetRate() const { return falsePositiveRate; }
+    // Past its sizing the real false-positive rate climbs; time to rebuild
+    bool saturated() const { return keys > capacity; }
+    size_t memoryBytes() const { return (size_t)blockCount * sizeof(Block); }
+
+    // The raw bits, memoryBytes() long, for storing the filter. restore()
+    // loads them into a filter built with the same sizing; false if the
+    // length does not match it.
+    const void* bits() const { return blocks; }
+    bool restore(const void* bits, size_t n, long long keyCount);
+};
+
+#endif
@@ -0,0 +1,258 @@
+#include "cityindex.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CITYINDEX_SSE2 1
+#endif
+
+using namespace std;
+
+static const unsigned char CTRL_EMPTY = 0x80;
+static const int GROUP_WIDTH = 16;
+
+static inline char foldChar(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool equalsFolded(const string& key, string_view query) {
+    if (key.size() != query.size()) return false;
+    for (size_t i = 0; i < query.size(); i++)
+        if (key[i] != foldChar(query[i])) return false;
+    return true;
+}
+
+// Bitmask of the positions in a 16-byte control group equal to b
+static inline unsigned matchGroup(const unsigned char* group, unsigned char b) {
+#ifdef CITYINDEX_SSE2
+    __m128i ctrlBytes = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrlBytes, _mm_set1_epi8((char)b)));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; i++)
+        if (group[i] == b) mask |= 1u << i;
+    return mask;
+#endif
+}
+
+static inline int lowestBit(unsigned mask) {
+    int i = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+}
+
+// =====================================================
+// CityHashIndex Implementation (Swiss-Style Table)
+// =====================================================
+CityHashIndex::CityHashIndex() : keys(nullptr), keyCapacity(0), capacity(32), count(0) {
+    ctrl = new unsigned char[capacity];
+    slots = new int[capacity];
+    for (int i = 0; i < capacity; i++) ctrl[i] = CTRL_EMPTY;
+}
+
+CityHashIndex::~CityHashIndex() {
+    delete[] ctrl;
+    delete[] slots;
+    delete[] keys;
+}
+
+// FNV-1a over the folded bytes, then a multiply-shift so both the group
+// bits (high) and the 7-bit tag (low) are well mixed
+unsigned long long CityHashIndex::hashName(string_view name) {
+    unsigned long long h = 1469598103934665603ULL;
+    for (char c : name) {
+        h ^= (unsigned char)foldChar(c);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 29;
+    h *= 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 32);
+}
+
+int CityHashIndex::findSlot(string_view name, unsigned long long h) const {
+    unsigned char tag = (unsigned char)(h & 0x7F);
+    int groups = capacity / GROUP_WIDTH;
+    int g = (int)((h >> 7) % (unsigned long long)groups);
+
+    for (int step = 0; step < groups; step++) {
+        const unsigned char* group = ctrl + g * GROUP_WIDTH;
+        unsigned hits = matchGroup(group, tag);
+        while (hits) {
+            int i = lowestBit(hits);
+            int slot = g * GROUP_WIDTH + i;
+            if (equalsFolded(keys[slots[slot]], name)) return slot;
+            hits &= hits - 1;
+        }
+        if (matchGroup(group, CTRL_EMPTY)) return -1;
+        g = (g + step + 1) % groups;
+    }
+    return -1;
+}
+
+void CityHashIndex::placeSlot(int cityIdx, unsigned long long h) {
+    int groups = capacity / GROUP_WIDTH;
+    int g = (int)((h >> 7) % (unsigned long long)groups);
+    for (int step = 0; step < groups; step++) {
+        unsigned empties = matchGroup(ctrl + g * GROUP_WIDTH, CTRL_EMPTY);
+        if (empties) {
+            int slot = g * GROUP_WIDTH + lowestBit(empties);
+            ctrl[slot] = (unsigned char)(h & 0x7F);
+            slots[slot] = cityIdx;
+            return;
+        }
+        g = (g + step + 1) % groups;
+    }
+}
+
+void CityHashIndex::rehash(int newCapacity) {
+    unsigned char* oldCtrl = ctrl;
+    int* oldSlots = slots;
+    int oldCapacity = capacity;
+
+    capacity = newCapacity;
+    ctrl = new unsigned char[capacity];
+    slots = new int[capacity];
+    for (int i = 0; i < capacity; i++) ctrl[i] = CTRL_EMPTY;
+
+    for (int i = 0; i < oldCapacity; i++)
+        if (oldCtrl[i] != CTRL_EMPTY)
+            placeSlot(oldSlots[i], hashName(keys[oldSlots[i]]));
+
+    delete[] oldCtrl;
+    delete[] oldSlots;
+}
+
+void CityHashIndex::insert(string_view name, int cityIdx) {
+    unsigned long long h = hashName(name);
+    if (findSlot(name, h) != -1) return;
+
+    if (cityIdx >= keyCapacity) {
+        int newKeyCapacity = keyCapacity > 0 ? keyCapacity : 16;
+        while (newKeyCapacity <= cityIdx) newKeyCapacity *= 2;
+        string* newKeys = new string[newKeyCapacity];
+        for (int i = 0; i < keyCapacity; i++) newKeys[i].swap(keys[i]);
+        delete[] keys;
+        keys = newKeys;
+        keyCapacity = newKeyCapacity;
+    }
+    keys[cityIdx].resize(name.size());
+    for (size_t i = 0; i < name.size(); i++) keys[cityIdx][i] = foldChar(name[i]);
+
+    // Keep load under 7/8 so every probe sequence meets an empty slot
+    if ((count + 1) * 8 > capacity * 7) rehash(capacity * 2);
+    placeSlot(cityIdx, h);
+    count++;
+}
+
+int CityHashIndex::find(string_view name) const {
+    int slot = findSlot(name, hashName(name));
+    return (slot == -1) ? -1 : slots[slot];
+}
+
+// =====================================================
+// CityTrie Implementation (Typo Tolerant Lookup)
+// =====================================================
+CityTrie::CityTrie() : nodeCount(0), nodeCapacity(64), maxDepth(0) {
+    nodes = new TrieNode[nodeCapacity];
+    newNode('\0'); // root
+}
+
+CityTrie::~CityTrie() {
+    delete[] nodes;
+}
+
+int CityTrie::newNode(char c) {
+    if (nodeCount >= nodeCapacity) {
+        int newCapacity = nodeCapacity * 2;
+        TrieNode* newNodes = new TrieNode[newCapacity];
+        for (int i = 0; i < nodeCount; i++) newNodes[i] = nodes[i];
+        delete[] nodes;
+        nodes = newNodes;
+        nodeCapacity = newCapacity;
+    }
+    nodes[nodeCount].c = c;
+    nodes[nodeCount].firstChild = -1;
+    nodes[nodeCount].nextSibling = -1;
+    nodes[nodeCount].cityIdx = -1;
+    return nodeCount++;
+}
+
+void CityTrie::insert(string_view name, int cityIdx) {
+    int cur = 0;
+    for (char raw : name) {
+        char c = foldChar(raw);
+        int child = nodes[cur].firstChild;
+        while (child != -1 && nodes[child].c != c) child = nodes[child].nextSibling;
+        if (child == -1) {
+            child = newNode(c);
+            nodes[child].nextSibling = nodes[cur].firstChild;
+            nodes[cur].firstChild = child;
+        }
+        cur = child;
+    }
+    if (nodes[cur].cityIdx == -1) nodes[cur].cityIdx = cityIdx;
+    if ((int)name.size() > maxDepth) maxDepth = (int)name.size();
+}
+
+// Classic trie-walk edit distance: one DP row per trie depth, pruned as soon
+// as the whole row exceeds the budget. rows holds a row for every depth; the
+// node at depth d fills row d from row d - 1, so siblings reuse the same row.
+void CityTrie::fuzzyWalk(int node, int depth, int* rows, string_view word,
+                         int maxDist, int& bestIdx, int& bestDist) const {
+    int cols = (int)word.size() + 1;
+    const int* prevRow = rows + (depth - 1) * cols;
+    int* row = rows + depth * cols;
+    char c = nodes[node].c;
+    row[0] = prevRow[0] + 1;
+    int rowMin = row[0];
+    for (int i = 1; i < cols; i++) {
+        int insertCost = row[i - 1] + 1;
+        int deleteCost = prevRow[i] + 1;
+        int replaceCost = prevRow[i - 1] + (foldChar(word[i - 1]) == c ? 0 : 1);
+        int best = insertCost < deleteCost ? insertCost : deleteCost;
+        row[i] = best < replaceCost ? best : replaceCost;
+        if (row[i] < rowMin) rowMin = row[i];
+    }
+
+    if (nodes[node].cityIdx != -1 && row[cols - 1] <= maxDist && row[cols - 1] < bestDist) {
+        bestDist = row[cols - 1];
+        bestIdx = nodes[node].cityIdx;
+    }
+
+    if (rowMin <= maxDist) {
+        for (int child = nodes[node].firstChild; child != -1; child = nodes[child].nextSibling)
+            fuzzyWalk(child, depth + 1, rows, word, maxDist, bestIdx, bestDist);
+    }
+}
+
+int CityTrie::closest(string_view name, int maxDist, int* distOut) const {
+    // One allocation per query: a row for the root and one per trie depth
+    int cols = (int)name.size() + 1;
+    int* rows = new int[(maxDepth + 1) * cols];
+    for (int i = 0; i < cols; i++) rows[i] = i;
+
+    int bestIdx = -1;
+    int bestDist = maxDist + 1;
+    for (int child = nodes[0].firstChild; child != -1; child = nodes[child].nextSibling)
+        fuzzyWalk(child, 1, rows, name, maxDist, bestIdx, bestDist);
+    delete[] rows;
+
+    if (distOut) *distOut = bestDist;
+    return bestIdx;
+}
+
+int CityTrie::completePrefix(string_view prefix) const {
+    if (prefix.empty()) return -1;
+    int cur = 0;
+    for (char raw : prefix) {
+        char c = foldChar(raw);
+        int child = nodes[cur].firstChild;
+        while (child != -1 && nodes[child].c != c) child = nodes[child].nextSibling;
+        if (child == -1) return -1;
+        cur = child;
+    }
+    while (cur != -1 && nodes[cur].cityIdx == -1) cur = nodes[cur].firstChild;
+    return (cur == -1) ? -1 : nodes[cur].cityIdx;
+}
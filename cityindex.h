@@ -0,0 +1,58 @@
+#ifndef CITYINDEX_H
+#define CITYINDEX_H
+
+#include <string>
+#include <string_view>
+
+// Case-insensitive city name -> city index map.
+// Swiss-table layout: one control byte per slot (0x80 = empty, otherwise the
+// low 7 hash bits) scanned 16 at a time, so a lookup usually touches one
+// control group and compares a single key.
+class CityHashIndex {
+private:
+    unsigned char* ctrl;
+    int* slots;
+    std::string* keys;      // folded names, indexed by city index
+    int keyCapacity;
+    int capacity;           // slot count, power of two, multiple of 16
+    int count;
+
+    static unsigned long long hashName(std::string_view name);
+    int findSlot(std::string_view folded, unsigned long long h) const;
+    void rehash(int newCapacity);
+    void placeSlot(int cityIdx, unsigned long long h);
+public:
+    CityHashIndex();
+    ~CityHashIndex();
+    void insert(std::string_view name, int cityIdx);
+    int find(std::string_view name) const;
+};
+
+// Prefix trie over folded city names for operator typos and completion
+class CityTrie {
+private:
+    struct TrieNode {
+        char c;
+        int firstChild;
+        int nextSibling;
+        int cityIdx;
+    };
+    TrieNode* nodes;
+    int nodeCount;
+    int nodeCapacity;
+    int maxDepth;           // longest name inserted
+
+    int newNode(char c);
+    void fuzzyWalk(int node, int depth, int* rows, std::string_view word,
+                   int maxDist, int& bestIdx, int& bestDist) const;
+public:
+    CityTrie();
+    ~CityTrie();
+    void insert(std::string_view name, int cityIdx);
+    // Closest city within maxDist edits (Levenshtein), or -1
+    int closest(std::string_view name, int maxDist, int* distOut = nullptr) const;
+    // Any city whose name starts with prefix, or -1 (also for an empty prefix)
+    int completePrefix(std::string_view prefix) const;
+};
+
+#endif
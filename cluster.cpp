@@ -0,0 +1,835 @@
+#include "cluster.h"
+#include <iostream>
+#include <cstring>
+#include <ctime>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <csignal>
+#include <cerrno>
+#endif
+
+using namespace std;
+
+// The router asks every node for new road closures this often
+static const long long MAP_SYNC_SECONDS = 1;
+
+#ifdef __linux__
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+static void installStopHandlers() {
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+// Reads everything the socket has; false once the peer has gone
+static bool readAvailable(int fd, string& in) {
+    char buf[16384];
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            in.append(buf, (size_t)n);
+            continue;
+        }
+        if (n == 0) return false;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+}
+
+// Sends what the socket will take; false on a broken connection
+static bool writePending(int fd, string& out, size_t& sent) {
+    while (sent < out.size()) {
+        ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        sent += (size_t)n;
+    }
+    if (sent == out.size()) {
+        out.clear();
+        sent = 0;
+    }
+    else if (sent >= 65536) {
+        out.erase(0, sent);
+        sent = 0;
+    }
+    return true;
+}
+
+static void watchSocket(int epollFd, int fd, int op, bool wantWrite) {
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | (wantWrite ? (uint32_t)EPOLLOUT : 0u);
+    ev.data.fd = fd;
+    epoll_ctl(epollFd, op, fd, &ev);
+}
+
+static void setNoDelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   // fails harmlessly on Unix sockets
+}
+
+// fd-indexed slot arrays for both servers
+template <class T>
+static void growSlots(T**& slots, int& capacity, int fd) {
+    if (fd < capacity) return;
+    int newCapacity = capacity > 0 ? capacity : 64;
+    while (newCapacity <= fd) newCapacity *= 2;
+    T** grown = new T * [newCapacity];
+    for (int i = 0; i < newCapacity; i++) grown[i] = (i < capacity) ? slots[i] : nullptr;
+    delete[] slots;
+    slots = grown;
+    capacity = newCapacity;
+}
+
+// =====================================================
+// ClusterNode Implementation (RPC over one engine)
+// =====================================================
+ClusterNode::ClusterNode(LogisticsEngine& e, int nodeIndex, int nodeCount, const string& listenAddress)
+    : engine(e), index(nodeIndex), count(nodeCount), address(listenAddress), listenFd(-1), epollFd(-1),
+      conns(nullptr), connCapacity(0), lastTick(0), reply(4096), writer(reply) {}
+
+ClusterNode::~ClusterNode() {
+    for (int i = 0; i < connCapacity; i++)
+        if (conns[i]) {
+            close(conns[i]->fd);
+            delete conns[i];
+        }
+    delete[] conns;
+    if (listenFd >= 0) close(listenFd);
+    if (epollFd >= 0) close(epollFd);
+}
+
+void ClusterNode::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        setNoDelay(fd);
+        growSlots(conns, connCapacity, fd);
+
+        Connection* c = new Connection();
+        c->fd = fd;
+        c->outSent = 0;
+        c->wantWrite = false;
+        conns[fd] = c;
+        watchSocket(epollFd, fd, EPOLL_CTL_ADD, false);
+    }
+}
+
+void ClusterNode::closeConnection(Connection* c) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+    close(c->fd);
+    conns[c->fd] = nullptr;
+    delete c;
+}
+
+void ClusterNode::flush(Connection* c) {
+    if (!writePending(c->fd, c->out, c->outSent)) {
+        closeConnection(c);
+        return;
+    }
+    bool pending = !c->out.empty();
+    if (pending != c->wantWrite) {
+        c->wantWrite = pending;
+        watchSocket(epollFd, c->fd, EPOLL_CTL_MOD, pending);
+    }
+}
+
+void ClusterNode::onReadable(Connection* c) {
+    bool open = readAvailable(c->fd, c->in);
+
+    size_t used = 0;
+    while (used < c->in.size()) {
+        size_t frame = rpcFrameSize(c->in.data() + used, c->in.size() - used);
+        if (frame == (size_t)-1) {
+            closeConnection(c);
+            return;
+        }
+        if (frame == 0) break;
+        handle(c, c->in.data() + used, frame);
+        used += frame;
+    }
+    c->in.erase(0, used);
+
+    if (!open && c->out.empty()) {
+        closeConnection(c);
+        return;
+    }
+    flush(c);
+}
+
+void ClusterNode::writeParcel(const Parcel& p, bool archived) {
+    writer.str(p.id);
+    writer.str(p.destination);
+    writer.str(p.zone);
+    writer.u8((unsigned int)p.status);
+    writer.str(p.getStatusName());
+    writer.str(p.assignedRider);
+    writer.f64(p.weight);
+    writer.u32((unsigned int)p.priority);
+    writer.i64(p.dispatchTime);
+    writer.i64(p.arrivalTime);
+    writer.u32((unsigned int)p.deliveryAttempts);
+    writer.u8(archived ? 1 : 0);
+
+    int events = 0;
+    for (const HistoryEvent* e = p.history->first(); e; e = e->next) events++;
+    writer.u32((unsigned int)events);
+    for (const HistoryEvent* e = p.history->first(); e; e = e->next) {
+        writer.str(e->description);
+        writer.str(e->time);
+        writer.str(e->location);
+    }
+}
+
+// One request in, exactly one reply out (replies keep request order)
+void ClusterNode::handle(Connection* c, const char* frame, size_t len) {
+    RpcReader r(frame, len);
+    unsigned int tag = r.tag();
+    reply.clear();
+
+    switch (r.op()) {
+    case RPC_TRACK: {
+        string_view id = r.str();
+        if (!r.ok()) break;
+        Parcel* p = engine.findParcel(id);
+        Parcel* archivedCopy = nullptr;
+        if (!p) p = archivedCopy = engine.loadArchived(id);
+        if (!p) {
+            writer.begin(RPC_NOT_FOUND, tag);
+        }
+        else {
+            writer.begin(RPC_OK, tag);
+            writeParcel(*p, archivedCopy != nullptr);
+        }
+        delete archivedCopy;
+        break;
+    }
+    case RPC_PICKUP: {
+        string_view id = r.str();
+        string_view dest = r.str();
+        double w = r.f64();
+        int priority = (int)r.u32();
+        if (!r.ok() || id.empty()) break;
+        if (rpcOwner(id, count) != index) {
+            writer.begin(RPC_NOT_OWNER, tag);
+            break;
+        }
+        PickupResult result = engine.addParcel(id, dest, w, priority);
+        writer.begin(result == PICKUP_OK ? RPC_OK : RPC_REJECTED, tag);
+        writer.u32((unsigned int)result);
+        break;
+    }
+    case RPC_CANCEL: {
+        string_view id = r.str();
+        if (!r.ok()) break;
+        if (engine.tryCancel(id)) writer.begin(RPC_OK, tag);
+        else writer.begin(engine.findParcel(id) ? RPC_REJECTED : RPC_NOT_FOUND, tag);
+        break;
+    }
+    case RPC_DISPATCH: {
+        int max = (int)r.u32();
+        if (!r.ok()) break;
+        int dispatched = max > 0 ? engine.dispatchBatch(max) : 0;
+        writer.begin(RPC_OK, tag);
+        writer.u32((unsigned int)dispatched);
+        break;
+    }
+    case RPC_STATS:
+        writer.begin(RPC_OK, tag);
+        writer.u32((unsigned int)engine.parcelCount());
+        writer.i64(engine.archivedCount());
+        break;
+    case RPC_MAP_SYNC: {
+        unsigned int since = r.u32();
+        if (!r.ok()) break;
+        IntArrayList& log = engine.getMap().closures;
+        unsigned int total = (unsigned int)log.size();
+        if (since > total) since = 0;    // this node restarted; send it all
+        writer.begin(RPC_OK, tag);
+        writer.u32(total);
+        writer.u32(total - since);
+        for (unsigned int i = since; i < total; i++) writer.u32((unsigned int)log.get((int)i));
+        break;
+    }
+    case RPC_MAP_APPLY: {
+        unsigned int n = r.u32();
+        unsigned int newlyClosed = 0;
+        for (unsigned int i = 0; i < n && r.ok(); i++) {
+            int edge = (int)r.u32();
+            if (r.ok() && engine.closeRoad(edge)) newlyClosed++;
+        }
+        if (!r.ok()) break;
+        writer.begin(RPC_OK, tag);
+        writer.u32(newlyClosed);
+        break;
+    }
+    default:
+        break;
+    }
+
+    if (reply.size() == 0) writer.begin(RPC_BAD_REQUEST, tag);
+    writer.end();
+    c->out.append(reply.data(), reply.size());
+}
+
+bool ClusterNode::run() {
+    listenFd = rpcListen(address);
+    if (listenFd < 0) {
+        cerr << "swiftex: node " << index << " cannot listen on " << address << "\n";
+        return false;
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) return false;
+    watchSocket(epollFd, listenFd, EPOLL_CTL_ADD, false);
+    installStopHandlers();
+    cerr << "swiftex: node " << index << "/" << count << " serving RPC on " << address << "\n";
+
+    epoll_event events[256];
+    while (!stopRequested) {
+        int n = epoll_wait(epollFd, events, 256, 250);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            Connection* c = (fd < connCapacity) ? conns[fd] : nullptr;
+            if (!c) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(c);
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                onReadable(c);
+                c = conns[fd];
+                if (!c) continue;
+            }
+            if (events[i].events & EPOLLOUT) flush(c);
+        }
+
+        long long now = (long long)time(0);
+        if (now != lastTick) {
+            lastTick = now;
+            engine.updateRealTime();
+        }
+    }
+    return true;
+}
+
+// =====================================================
+// ClusterRouter Implementation (Owner Forwarding)
+// =====================================================
+// Closures number a few dozen at most; a scan is fine
+static bool listHas(const IntArrayList& list, int value) {
+    for (int i = 0; i < list.size(); i++)
+        if (list.get(i) == value) return true;
+    return false;
+}
+
+ClusterRouter::ClusterRouter(const string& listenAddress, const string* nodeAddresses, int count)
+    : address(listenAddress), nodeCount(count), listenFd(-1), epollFd(-1), clients(nullptr),
+      clientCapacity(0), nextSerial(1), lastSync(0), reading(nullptr), requests(4096),
+      requestWriter(requests), replies(4096), replyWriter(replies) {
+    nodes = new Node[nodeCount];
+    for (int i = 0; i < nodeCount; i++) {
+        Node& n = nodes[i];
+        n.address = nodeAddresses[i];
+        n.fd = -1;
+        n.outSent = 0;
+        n.wantWrite = false;
+        n.queueCapacity = 64;
+        n.queue = new Pending[n.queueCapacity];
+        n.head = 0;
+        n.queued = 0;
+        n.mapSeen = 0;
+        n.syncing = false;
+        n.connecting = false;
+    }
+}
+
+ClusterRouter::~ClusterRouter() {
+    for (int i = 0; i < nodeCount; i++) {
+        if (nodes[i].fd >= 0) dropNode(i);
+        delete[] nodes[i].queue;
+    }
+    delete[] nodes;
+    for (int i = 0; i < clientCapacity; i++)
+        if (clients[i]) {
+            close(clients[i]->fd);
+            delete clients[i];
+        }
+    delete[] clients;
+    if (listenFd >= 0) close(listenFd);
+    if (epollFd >= 0) close(epollFd);
+}
+
+// Starts a connect without waiting for it: the socket is watched for
+// writability and finishConnect completes it. A node that comes (back) up
+// gets every closure the cluster knows about, queued behind the connect.
+bool ClusterRouter::connectNode(int n) {
+    Node& node = nodes[n];
+    node.fd = rpcConnect(node.address, false);
+    if (node.fd < 0) return false;
+    setNoDelay(node.fd);
+    node.wantWrite = true;
+    node.connecting = true;
+    watchSocket(epollFd, node.fd, EPOLL_CTL_ADD, true);
+    node.mapSeen = 0;
+    node.syncing = false;
+
+    if (closures.size() > 0) {
+        requests.clear();
+        requestWriter.begin(RPC_MAP_APPLY, 0);
+        requestWriter.u32((unsigned int)closures.size());
+        for (int i = 0; i < closures.size(); i++) requestWriter.u32((unsigned int)closures.get(i));
+        requestWriter.end();
+        Pending p = { -1, 0, 0, nullptr, RPC_MAP_APPLY };
+        sendToNode(n, requests.data(), requests.size(), p);
+    }
+    return nodes[n].fd >= 0;
+}
+
+void ClusterRouter::finishConnect(int n) {
+    Node& node = nodes[n];
+    if (!rpcConnectFinished(node.fd)) {
+        dropNode(n);
+        return;
+    }
+    node.connecting = false;
+    cerr << "swiftex: router connected to node " << n << " at " << node.address << "\n";
+    flushNode(n);
+}
+
+void ClusterRouter::replyStatus(int fd, unsigned int serial, unsigned int tag, int status) {
+    Client* c = clientFor(fd, serial);
+    if (!c) return;
+    replies.clear();
+    replyWriter.begin(status, tag);
+    replyWriter.end();
+    c->out.append(replies.data(), replies.size());
+    flushClient(c);
+}
+
+// Everything still waiting on the node is answered as unavailable
+void ClusterRouter::dropNode(int n) {
+    Node& node = nodes[n];
+    if (node.fd < 0) return;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, node.fd, nullptr);
+    close(node.fd);
+    node.fd = -1;
+    node.in.clear();
+    node.out.clear();
+    node.outSent = 0;
+    node.syncing = false;
+    // A node that never answered the connect was not lost; it is retried
+    // quietly on the next sync
+    if (!node.connecting) cerr << "swiftex: router lost node " << n << " at " << node.address << "\n";
+    node.connecting = false;
+
+    while (node.queued > 0) {
+        Pending p = node.queue[node.head];
+        node.head = (node.head + 1) % node.queueCapacity;
+        node.queued--;
+        if (p.fan) {
+            p.fan->failed = true;
+            if (--p.fan->waiting == 0) finishFan(p.fan);
+        }
+        else if (p.fd >= 0) {
+            replyStatus(p.fd, p.serial, p.tag, RPC_UNAVAILABLE);
+        }
+    }
+}
+
+// A node that is down fails the request at once; reconnecting is left to
+// syncMaps, so a dead node costs one connect attempt a sync, not one a request
+void ClusterRouter::sendToNode(int n, const char* frame, size_t len, const Pending& pending) {
+    Node& node = nodes[n];
+    if (node.fd < 0) {
+        if (pending.fan) {
+            pending.fan->failed = true;
+            if (--pending.fan->waiting == 0) finishFan(pending.fan);
+        }
+        else if (pending.fd >= 0) {
+            replyStatus(pending.fd, pending.serial, pending.tag, RPC_UNAVAILABLE);
+        }
+        return;
+    }
+
+    if (node.queued == node.queueCapacity) {
+        int newCapacity = node.queueCapacity * 2;
+        Pending* grown = new Pending[newCapacity];
+        for (int i = 0; i < node.queued; i++) grown[i] = node.queue[(node.head + i) % node.queueCapacity];
+        delete[] node.queue;
+        node.queue = grown;
+        node.head = 0;
+        node.queueCapacity = newCapacity;
+    }
+    node.queue[(node.head + node.queued) % node.queueCapacity] = pending;
+    node.queued++;
+    node.out.append(frame, len);
+    flushNode(n);
+}
+
+void ClusterRouter::flushNode(int n) {
+    Node& node = nodes[n];
+    if (node.connecting) return;
+    if (!writePending(node.fd, node.out, node.outSent)) {
+        dropNode(n);
+        return;
+    }
+    updateInterest(node.fd, !node.out.empty(), node.wantWrite);
+}
+
+void ClusterRouter::onNodeReadable(int n) {
+    Node& node = nodes[n];
+    bool open = readAvailable(node.fd, node.in);
+
+    size_t used = 0;
+    while (used < node.in.size()) {
+        size_t frame = rpcFrameSize(node.in.data() + used, node.in.size() - used);
+        if (frame == (size_t)-1 || (frame > 0 && node.queued == 0)) {
+            open = false;    // garbage or an unasked-for reply
+            break;
+        }
+        if (frame == 0) break;
+        onNodeReply(n, node.in.data() + used, frame);
+        used += frame;
+    }
+    if (!open) {
+        dropNode(n);
+        return;
+    }
+    node.in.erase(0, used);
+}
+
+void ClusterRouter::onNodeReply(int n, const char* frame, size_t len) {
+    Node& node = nodes[n];
+    Pending p = node.queue[node.head];
+    node.head = (node.head + 1) % node.queueCapacity;
+    node.queued--;
+
+    RpcReader r(frame, len);
+    if (p.fan) {
+        FanOut* fan = p.fan;
+        if (r.op() != RPC_OK) fan->failed = true;
+        else {
+            fan->sum += r.u32();
+            if (fan->op == RPC_STATS) fan->archived += r.i64();
+        }
+        if (--fan->waiting == 0) finishFan(fan);
+        return;
+    }
+    if (p.fd < 0) {
+        if (p.op != RPC_MAP_SYNC) return;
+        node.syncing = false;
+        if (r.op() != RPC_OK) return;
+        unsigned int version = r.u32();
+        unsigned int count = r.u32();
+        int* fresh = new int[count > 0 ? count : 1];
+        int freshCount = 0;
+        for (unsigned int i = 0; i < count && r.ok(); i++) {
+            int edge = (int)r.u32();
+            if (!r.ok() || listHas(closures, edge)) continue;
+            closures.add(edge);
+            fresh[freshCount++] = edge;
+        }
+        if (r.ok()) node.mapSeen = version;
+        if (freshCount > 0) applyClosures(n, fresh, freshCount);
+        delete[] fresh;
+        return;
+    }
+
+    // Owner-routed request: the node already echoed the client's tag
+    Client* c = clientFor(p.fd, p.serial);
+    if (!c) return;
+    c->out.append(frame, len);
+    flushClient(c);
+}
+
+void ClusterRouter::applyClosures(int except, const int* edges, int n) {
+    requests.clear();
+    requestWriter.begin(RPC_MAP_APPLY, 0);
+    requestWriter.u32((unsigned int)n);
+    for (int i = 0; i < n; i++) requestWriter.u32((unsigned int)edges[i]);
+    requestWriter.end();
+    Pending p = { -1, 0, 0, nullptr, RPC_MAP_APPLY };
+    for (int i = 0; i < nodeCount; i++)
+        if (i != except && nodes[i].fd >= 0) sendToNode(i, requests.data(), requests.size(), p);
+}
+
+// Also where nodes that were down get reconnected
+void ClusterRouter::syncMaps() {
+    for (int i = 0; i < nodeCount; i++) {
+        Node& node = nodes[i];
+        if (node.fd < 0 && !connectNode(i)) continue;
+        if (node.syncing) continue;
+        requests.clear();
+        requestWriter.begin(RPC_MAP_SYNC, 0);
+        requestWriter.u32(node.mapSeen);
+        requestWriter.end();
+        node.syncing = true;
+        Pending p = { -1, 0, 0, nullptr, RPC_MAP_SYNC };
+        sendToNode(i, requests.data(), requests.size(), p);
+    }
+}
+
+ClusterRouter::Client* ClusterRouter::clientFor(int fd, unsigned int serial) {
+    if (fd < 0 || fd >= clientCapacity) return nullptr;
+    Client* c = clients[fd];
+    return (c && c->serial == serial) ? c : nullptr;
+}
+
+void ClusterRouter::finishFan(FanOut* fan) {
+    Client* c = clientFor(fan->fd, fan->serial);
+    if (c) {
+        replies.clear();
+        replyWriter.begin(fan->failed ? RPC_UNAVAILABLE : RPC_OK, fan->tag);
+        if (!fan->failed) {
+            replyWriter.u32((unsigned int)fan->sum);
+            if (fan->op == RPC_STATS) replyWriter.i64(fan->archived);
+        }
+        replyWriter.end();
+        c->out.append(replies.data(), replies.size());
+        flushClient(c);
+    }
+    delete fan;
+}
+
+void ClusterRouter::updateInterest(int fd, bool pending, bool& wantWrite) {
+    if (pending == wantWrite) return;
+    wantWrite = pending;
+    watchSocket(epollFd, fd, EPOLL_CTL_MOD, pending);
+}
+
+void ClusterRouter::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        setNoDelay(fd);
+        growSlots(clients, clientCapacity, fd);
+
+        Client* c = new Client();
+        c->fd = fd;
+        c->serial = nextSerial++;
+        c->outSent = 0;
+        c->wantWrite = false;
+        clients[fd] = c;
+        watchSocket(epollFd, fd, EPOLL_CTL_ADD, false);
+    }
+}
+
+void ClusterRouter::closeClient(Client* c) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+    close(c->fd);
+    clients[c->fd] = nullptr;
+    delete c;
+}
+
+// The client being read is flushed once its whole batch is handled
+void ClusterRouter::flushClient(Client* c) {
+    if (c == reading) return;
+    if (!writePending(c->fd, c->out, c->outSent)) {
+        closeClient(c);
+        return;
+    }
+    updateInterest(c->fd, !c->out.empty(), c->wantWrite);
+}
+
+void ClusterRouter::onClientReadable(Client* c) {
+    bool open = readAvailable(c->fd, c->in);
+
+    reading = c;
+    size_t used = 0;
+    while (used < c->in.size()) {
+        size_t frame = rpcFrameSize(c->in.data() + used, c->in.size() - used);
+        if (frame == (size_t)-1) {
+            open = false;
+            break;
+        }
+        if (frame == 0) break;
+        handleClient(c, c->in.data() + used, frame);
+        used += frame;
+    }
+    reading = nullptr;
+    c->in.erase(0, used);
+
+    if (!open && c->out.empty()) {
+        closeClient(c);
+        return;
+    }
+    flushClient(c);
+}
+
+void ClusterRouter::handleClient(Client* c, const char* frame, size_t len) {
+    RpcReader r(frame, len);
+    unsigned int tag = r.tag();
+    int op = (int)r.op();
+
+    switch (op) {
+    case RPC_TRACK:
+    case RPC_PICKUP:
+    case RPC_CANCEL: {
+        string_view id = r.str();
+        if (!r.ok()) break;
+        Pending p = { c->fd, c->serial, tag, nullptr, op };
+        sendToNode(rpcOwner(id, nodeCount), frame, len, p);
+        return;
+    }
+    case RPC_DISPATCH:
+    case RPC_STATS: {
+        unsigned int max = (op == RPC_DISPATCH) ? r.u32() : 0;
+        if (!r.ok()) break;
+        // One extra count held while sending, so a node failing on the
+        // spot cannot finish (and free) the fan-out mid-loop
+        FanOut* fan = new FanOut{ c->fd, c->serial, tag, op, nodeCount + 1, false, 0, 0 };
+        Pending p = { -1, 0, tag, fan, op };
+        for (int i = 0; i < nodeCount; i++) {
+            requests.clear();
+            requestWriter.begin(op, tag);
+            if (op == RPC_DISPATCH)
+                requestWriter.u32(max / nodeCount + ((unsigned int)i < max % nodeCount ? 1 : 0));
+            requestWriter.end();
+            sendToNode(i, requests.data(), requests.size(), p);
+        }
+        if (--fan->waiting == 0) finishFan(fan);
+        return;
+    }
+    case RPC_MAP_SYNC: {
+        // The cluster-wide closure list, in the same shape a node sends
+        unsigned int since = r.u32();
+        if (!r.ok()) break;
+        unsigned int total = (unsigned int)closures.size();
+        if (since > total) since = 0;
+        replies.clear();
+        replyWriter.begin(RPC_OK, tag);
+        replyWriter.u32(total);
+        replyWriter.u32(total - since);
+        for (unsigned int i = since; i < total; i++) replyWriter.u32((unsigned int)closures.get((int)i));
+        replyWriter.end();
+        c->out.append(replies.data(), replies.size());
+        return;
+    }
+    case RPC_MAP_APPLY: {
+        // An operator closing roads by hand; goes to every node
+        unsigned int n = r.u32();
+        int* fresh = new int[n > 0 && n < 65536 ? n : 1];
+        int freshCount = 0;
+        for (unsigned int i = 0; i < n && i < 65536 && r.ok(); i++) {
+            int edge = (int)r.u32();
+            if (!r.ok() || listHas(closures, edge)) continue;
+            closures.add(edge);
+            fresh[freshCount++] = edge;
+        }
+        bool ok = r.ok();
+        if (ok && freshCount > 0) applyClosures(-1, fresh, freshCount);
+        delete[] fresh;
+        if (!ok) break;
+        replies.clear();
+        replyWriter.begin(RPC_OK, tag);
+        replyWriter.u32((unsigned int)freshCount);
+        replyWriter.end();
+        c->out.append(replies.data(), replies.size());
+        return;
+    }
+    default:
+        break;
+    }
+    replyStatus(c->fd, c->serial, tag, RPC_BAD_REQUEST);
+}
+
+bool ClusterRouter::run() {
+    listenFd = rpcListen(address);
+    if (listenFd < 0) {
+        cerr << "swiftex: router cannot listen on " << address << "\n";
+        return false;
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) return false;
+    watchSocket(epollFd, listenFd, EPOLL_CTL_ADD, false);
+    installStopHandlers();
+    for (int i = 0; i < nodeCount; i++) connectNode(i);
+    cerr << "swiftex: router on " << address << " for " << nodeCount << " node(s)\n";
+
+    epoll_event events[256];
+    while (!stopRequested) {
+        int n = epoll_wait(epollFd, events, 256, 250);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+
+            int node = -1;
+            for (int k = 0; k < nodeCount; k++)
+                if (nodes[k].fd == fd) node = k;
+            if (node >= 0) {
+                if (nodes[node].connecting) {
+                    if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) finishConnect(node);
+                    if (nodes[node].fd != fd || nodes[node].connecting) continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) onNodeReadable(node);
+                if (nodes[node].fd == fd && (events[i].events & EPOLLOUT)) flushNode(node);
+                continue;
+            }
+
+            Client* c = (fd < clientCapacity) ? clients[fd] : nullptr;
+            if (!c) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeClient(c);
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                onClientReadable(c);
+                c = clients[fd];
+                if (!c) continue;
+            }
+            if (events[i].events & EPOLLOUT) flushClient(c);
+        }
+
+        long long now = (long long)time(0);
+        if (now - lastSync >= MAP_SYNC_SECONDS) {
+            lastSync = now;
+            syncMaps();
+        }
+    }
+    return true;
+}
+
+#else
+
+ClusterNode::ClusterNode(LogisticsEngine& e, int nodeIndex, int nodeCount, const string& listenAddress)
+    : engine(e), index(nodeIndex), count(nodeCount), address(listenAddress), listenFd(-1), epollFd(-1),
+      conns(nullptr), connCapacity(0), lastTick(0), reply(64), writer(reply) {}
+
+ClusterNode::~ClusterNode() {}
+
+bool ClusterNode::run() {
+    cerr << "swiftex: cluster mode needs Linux (epoll); not available on this platform\n";
+    return false;
+}
+
+ClusterRouter::ClusterRouter(const string& listenAddress, const string*, int count)
+    : address(listenAddress), nodes(nullptr), nodeCount(count), listenFd(-1), epollFd(-1), clients(nullptr),
+      clientCapacity(0), nextSerial(1), lastSync(0), reading(nullptr), requests(64),
+      requestWriter(requests), replies(64), replyWriter(replies) {}
+
+ClusterRouter::~ClusterRouter() {}
+
+bool ClusterRouter::run() {
+    cerr << "swiftex: cluster mode needs Linux (epoll); not available on this platform\n";
+    return false;
+}
+
+#endif
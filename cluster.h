@@ -0,0 +1,145 @@
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <string>
+#include "logisticsengine.h"
+#include "rpc.h"
+
+// Multi-process mode: N engine processes ("nodes"), each owning the
+// tracking IDs that hash to it (see rpcOwner), plus a router that clients
+// talk to. Every node keeps its own copy of the road map; closures are the
+// only map change, and the router copies each one to every other node.
+// Both sides are single-threaded epoll loops, like the HTTP server. Linux
+// only.
+
+// One node: serves its engine over RPC and runs the engine's clock
+class ClusterNode {
+private:
+    struct Connection {
+        int fd;
+        std::string in;
+        std::string out;
+        size_t outSent;
+        bool wantWrite;
+    };
+
+    LogisticsEngine& engine;
+    int index;
+    int count;
+    std::string address;
+    int listenFd;
+    int epollFd;
+    Connection** conns;      // indexed by fd
+    int connCapacity;
+    long long lastTick;
+    OutBuffer reply;
+    RpcWriter writer;
+
+    void acceptClients();
+    void onReadable(Connection* c);
+    void flush(Connection* c);
+    void closeConnection(Connection* c);
+    void handle(Connection* c, const char* frame, size_t len);
+    void writeParcel(const Parcel& p, bool archived);
+
+public:
+    ClusterNode(LogisticsEngine& e, int nodeIndex, int nodeCount, const std::string& listenAddress);
+    ~ClusterNode();
+    // Blocks until SIGINT / SIGTERM; false if the address cannot be used
+    bool run();
+};
+
+// Forwards each request to the node owning its tracking ID, fans
+// dispatch / stats out to every node, and replicates road closures
+class ClusterRouter {
+private:
+    struct FanOut {
+        int fd;
+        unsigned int serial;
+        unsigned int tag;
+        int op;
+        int waiting;
+        bool failed;
+        long long sum;       // dispatched, or hot parcels for stats
+        long long archived;
+    };
+
+    // One outstanding request on a node connection; nodes reply in order
+    struct Pending {
+        int fd;              // client to answer (-1: the router's own request)
+        unsigned int serial; // guards against a reused fd
+        unsigned int tag;
+        FanOut* fan;
+        int op;
+    };
+
+    struct Client {
+        int fd;
+        unsigned int serial;
+        std::string in;
+        std::string out;
+        size_t outSent;
+        bool wantWrite;
+    };
+
+    struct Node {
+        std::string address;
+        int fd;
+        std::string in;
+        std::string out;
+        size_t outSent;
+        bool wantWrite;
+        Pending* queue;      // ring of outstanding requests
+        int head;
+        int queued;
+        int queueCapacity;
+        unsigned int mapSeen;    // closures already collected from this node
+        bool syncing;
+        bool connecting;         // connect in progress; requests wait in out
+    };
+
+    std::string address;
+    Node* nodes;
+    int nodeCount;
+    int listenFd;
+    int epollFd;
+    Client** clients;        // indexed by fd
+    int clientCapacity;
+    unsigned int nextSerial;
+    IntArrayList closures;   // every closure seen, in arrival order
+    long long lastSync;
+    Client* reading;         // client whose input is being handled
+    // Frames bound for nodes and for clients are built in separate buffers:
+    // a failed node write answers its clients while a request is half sent
+    OutBuffer requests;
+    RpcWriter requestWriter;
+    OutBuffer replies;
+    RpcWriter replyWriter;
+
+    bool connectNode(int n);
+    void finishConnect(int n);
+    void dropNode(int n);
+    void sendToNode(int n, const char* frame, size_t len, const Pending& pending);
+    void flushNode(int n);
+    void onNodeReadable(int n);
+    void onNodeReply(int n, const char* frame, size_t len);
+    void syncMaps();
+    void applyClosures(int except, const int* edges, int n);
+
+    void acceptClients();
+    void onClientReadable(Client* c);
+    void flushClient(Client* c);
+    void closeClient(Client* c);
+    void handleClient(Client* c, const char* frame, size_t len);
+    void replyStatus(int fd, unsigned int serial, unsigned int tag, int status);
+    Client* clientFor(int fd, unsigned int serial);
+    void finishFan(FanOut* fan);
+    void updateInterest(int fd, bool pending, bool& wantWrite);
+
+public:
+    ClusterRouter(const std::string& listenAddress, const std::string* nodeAddresses, int count);
+    ~ClusterRouter();
+    bool run();
+};
+
+#endif
@@ -0,0 +1,590 @@
+#include "coldstore.h"
+#include "trackinghistory.h"
+#include "filesync.h"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// =====================================================
+// LZ Block Codec
+// =====================================================
+static const int LZ_MIN_MATCH = 4;
+static const int LZ_HASH_BITS = 12;
+static const size_t LZ_MAX_OFFSET = 65535;
+
+size_t lzBound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+static char* lzPutLength(char* op, size_t v) {
+    while (v >= 255) {
+        *op++ = (char)255;
+        v -= 255;
+    }
+    *op++ = (char)v;
+    return op;
+}
+
+static char* lzEmit(char* op, const unsigned char* literals, size_t litLen, size_t offset, size_t matchLen) {
+    size_t m = matchLen ? matchLen - LZ_MIN_MATCH : 0;
+    unsigned char token = (unsigned char)(((litLen < 15 ? litLen : 15) << 4) | (m < 15 ? m : 15));
+    *op++ = (char)token;
+    if (litLen >= 15) op = lzPutLength(op, litLen - 15);
+    memcpy(op, literals, litLen);
+    op += litLen;
+    if (!matchLen) return op;   // final literal run
+
+    *op++ = (char)(offset & 0xff);
+    *op++ = (char)(offset >> 8);
+    if (m >= 15) op = lzPutLength(op, m - 15);
+    return op;
+}
+
+// Greedy single-probe matcher, the same trade-off LZ4's fast mode makes
+size_t lzCompress(const char* src, size_t n, char* dst) {
+    const unsigned char* s = (const unsigned char*)src;
+    long long table[1 << LZ_HASH_BITS];
+    for (int i = 0; i < (1 << LZ_HASH_BITS); i++) table[i] = -1;
+
+    char* op = dst;
+    size_t ip = 0, anchor = 0;
+    while (ip + LZ_MIN_MATCH <= n) {
+        unsigned int seq;
+        memcpy(&seq, s + ip, 4);
+        unsigned int h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+        long long ref = table[h];
+        table[h] = (long long)ip;
+
+        if (ref < 0 || ip - (size_t)ref > LZ_MAX_OFFSET || memcmp(s + ref, s + ip, LZ_MIN_MATCH) != 0) {
+            ip++;
+            continue;
+        }
+        size_t len = LZ_MIN_MATCH;
+        while (ip + len < n && s[ref + len] == s[ip + len]) len++;
+
+        op = lzEmit(op, s + anchor, ip - anchor, ip - (size_t)ref, len);
+        ip += len;
+        anchor = ip;
+    }
+    op = lzEmit(op, s + anchor, n - anchor, 0, 0);
+    return (size_t)(op - dst);
+}
+
+static bool lzGetLength(const unsigned char*& ip, const unsigned char* end, size_t& len) {
+    unsigned char b;
+    do {
+        if (ip >= end) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+size_t lzDecompress(const char* src, size_t n, char* dst, size_t dstCapacity) {
+    const size_t BAD = (size_t)-1;
+    const unsigned char* ip = (const unsigned char*)src;
+    const unsigned char* end = ip + n;
+    char* op = dst;
+    char* opEnd = dst + dstCapacity;
+
+    while (ip < end) {
+        unsigned char token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && !lzGetLength(ip, end, lit)) return BAD;
+        if (lit > (size_t)(end - ip) || lit > (size_t)(opEnd - op)) return BAD;
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == end) break;   // the last sequence has no match
+
+        if (end - ip < 2) return BAD;
+        size_t offset = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return BAD;
+
+        size_t len = token & 15;
+        if (len == 15 && !lzGetLength(ip, end, len)) return BAD;
+        len += LZ_MIN_MATCH;
+        if (len > (size_t)(opEnd - op)) return BAD;
+        // Byte copy: the match may overlap what it is producing
+        const char* from = op - offset;
+        for (size_t i = 0; i < len; i++) op[i] = from[i];
+        op += len;
+    }
+    return (size_t)(op - dst);
+}
+
+// =====================================================
+// Column Encoding Helpers
+// =====================================================
+enum ColdColumn {
+    COL_ID,
+    COL_DESTINATION,
+    COL_ZONE,
+    COL_RIDER,
+    COL_WEIGHT,
+    COL_PRIORITY,
+    COL_STATUS,
+    COL_ATTEMPTS,
+    COL_DISPATCH_TIME,   // zigzag delta from the previous row
+    COL_ARRIVAL_TIME,    // "
+    COL_UPDATE_TIME,     // "
+    COL_HISTORY,         // per row: event count, then time/description/location
+    COL_ROUTE,           // route code (see encodeRoute); absent in older blocks
+    COL_ID_FILTER,       // per block, not per row: the ID filter's raw bits; absent in older blocks
+    COLUMN_COUNT
+};
+
+static const unsigned int BLOCK_MAGIC = 0x43585753;   // "SWXC"
+
+static void putVarint(string& out, unsigned long long v) {
+    while (v >= 0x80) {
+        out += (char)(v | 0x80);
+        v >>= 7;
+    }
+    out += (char)v;
+}
+
+static void putString(string& out, string_view s) {
+    putVarint(out, s.size());
+    out.append(s.data(), s.size());
+}
+
+static unsigned long long zigzag(long long v) {
+    return ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63);
+}
+
+static long long unzigzag(unsigned long long v) {
+    return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+static void putU32(string& out, unsigned int v) {
+    out.append((const char*)&v, 4);
+}
+
+static void putU16(string& out, unsigned short v) {
+    out.append((const char*)&v, 2);
+}
+
+// Bounds-checked reader over one decoded column
+struct ColumnReader {
+    const char* p;
+    const char* end;
+    bool ok;
+
+    ColumnReader(string_view s) : p(s.data()), end(s.data() + s.size()), ok(true) {}
+
+    unsigned long long varint() {
+        unsigned long long v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p >= end) break;
+            unsigned char b = (unsigned char)*p++;
+            v |= (unsigned long long)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+    string_view str() {
+        unsigned long long n = varint();
+        if (!ok || n > (unsigned long long)(end - p)) {
+            ok = false;
+            return string_view();
+        }
+        string_view s(p, (size_t)n);
+        p += n;
+        return s;
+    }
+    double f64() {
+        double v = 0;
+        if (end - p < 8) {
+            ok = false;
+            return v;
+        }
+        memcpy(&v, p, 8);
+        p += 8;
+        return v;
+    }
+};
+
+static unsigned int getU32(const char* p) {
+    unsigned int v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static unsigned short getU16(const char* p) {
+    unsigned short v;
+    memcpy(&v, p, 2);
+    return v;
+}
+
+// Shell sort by ID; blocks are small, and the rows arrive mostly unsorted
+static void sortById(Parcel** rows, int n) {
+    for (int gap = n / 2; gap > 0; gap /= 2) {
+        for (int i = gap; i < n; i++) {
+            Parcel* tmp = rows[i];
+            int j = i;
+            for (; j >= gap && rows[j - gap]->id > tmp->id; j -= gap) rows[j] = rows[j - gap];
+            rows[j] = tmp;
+        }
+    }
+}
+
+// =====================================================
+// ColdStore Implementation
+// =====================================================
+ColdStore::ColdStore(const string& filePath)
+    : path(filePath), blocks(nullptr), blockCount(0), blockCapacity(0), fileEnd(0), archived(0) {}
+
+ColdStore::~ColdStore() {
+    for (int i = 0; i < blockCount; i++) delete blocks[i].ids;
+    delete[] blocks;
+}
+
+void ColdStore::addBlock(const BlockInfo& b) {
+    if (blockCount == blockCapacity) {
+        int newCap = blockCapacity ? blockCapacity * 2 : 16;
+        BlockInfo* bigger = new BlockInfo[newCap];
+        for (int i = 0; i < blockCount; i++) bigger[i] = move(blocks[i]);
+        delete[] blocks;
+        blocks = bigger;
+        blockCapacity = newCap;
+    }
+    blocks[blockCount++] = b;
+    archived += b.rows;
+}
+
+void ColdStore::open() {
+    ifstream f(path, ios::binary);
+    if (!f.is_open()) return;
+    f.seekg(0, ios::end);
+    long long total = (long long)f.tellg();
+    f.seekg(0, ios::beg);
+
+    long long offset = 0;
+    char fixed[16];
+    string ids, table, packed, bits;
+    while (offset + 16 <= total) {
+        f.seekg(offset);
+        if (!f.read(fixed, 16) || getU32(fixed) != BLOCK_MAGIC) break;
+        unsigned int payload = getU32(fixed + 4);
+        unsigned int rows = getU32(fixed + 8);
+        unsigned short minLen = getU16(fixed + 12), maxLen = getU16(fixed + 14);
+
+        // Each block says how many columns it has; older ones have fewer
+        ids.resize(minLen + maxLen + 4);
+        if (!f.read(&ids[0], ids.size())) break;
+        unsigned int columns = getU32(&ids[minLen + maxLen]);
+        unsigned int headerLen = 16 + minLen + maxLen + 4 + 8 * columns;
+        if (columns > COLUMN_COUNT || offset + headerLen + payload > total) break;   // torn by a crash mid-append
+        table.resize(8 * columns);
+        if (!f.read(&table[0], table.size())) break;
+        ids.resize(minLen + maxLen);
+        BlockInfo b;
+        b.minId = ids.substr(0, minLen);
+        b.maxId = ids.substr(minLen);
+        b.offset = offset;
+        b.length = headerLen + payload;
+        b.rows = rows;
+        b.ids = nullptr;
+
+        // Only the filter column is read here; a block without one (or
+        // with a bad one, or one sized before block filters were exact)
+        // gets its filter from the IDs on first lookup
+        if (columns > COL_ID_FILTER) {
+            long long at = offset + headerLen;
+            for (int k = 0; k < COL_ID_FILTER; k++) at += getU32(&table[8 * k + 4]);
+            unsigned int raw = getU32(&table[8 * COL_ID_FILTER]), comp = getU32(&table[8 * COL_ID_FILTER + 4]);
+            packed.resize(comp);
+            bits.resize(raw);
+            f.seekg(at);
+            if (raw > 0 && f.read(&packed[0], comp) && lzDecompress(packed.data(), comp, &bits[0], raw) == raw) {
+                b.ids = new BloomFilter(rows, ID_FILTER_RATE, rows);
+                if (!b.ids->restore(bits.data(), raw, rows)) {
+                    delete b.ids;
+                    b.ids = nullptr;
+                }
+            }
+            f.clear();
+        }
+        addBlock(b);
+        offset += b.length;
+    }
+    fileEnd = offset;
+    f.close();
+
+    if (fileEnd < total) {
+        error_code ec;
+        fs::resize_file(path, (uintmax_t)fileEnd, ec);
+    }
+}
+
+bool ColdStore::archive(Parcel** parcels, int n) {
+    for (int start = 0; start < n; start += ROWS_PER_BLOCK) {
+        int rows = (n - start < ROWS_PER_BLOCK) ? n - start : ROWS_PER_BLOCK;
+        if (!appendBlock(parcels + start, rows)) return false;
+    }
+    return true;
+}
+
+bool ColdStore::appendBlock(Parcel** rows, int n) {
+    sortById(rows, n);
+
+    string cols[COLUMN_COUNT];
+    long long prevDispatch = 0, prevArrival = 0, prevUpdate = 0;
+    for (int r = 0; r < n; r++) {
+        const Parcel* p = rows[r];
+        putString(cols[COL_ID], p->id);
+        putString(cols[COL_DESTINATION], p->destination);
+        putString(cols[COL_ZONE], p->zone);
+        putString(cols[COL_RIDER], p->assignedRider);
+        cols[COL_WEIGHT].append((const char*)&p->weight, 8);
+        putVarint(cols[COL_PRIORITY], (unsigned long long)p->priority);
+        cols[COL_STATUS] += (char)p->status;
+        putVarint(cols[COL_ATTEMPTS], (unsigned long long)p->deliveryAttempts);
+        putVarint(cols[COL_DISPATCH_TIME], zigzag(p->dispatchTime - prevDispatch));
+        putVarint(cols[COL_ARRIVAL_TIME], zigzag(p->arrivalTime - prevArrival));
+        putVarint(cols[COL_UPDATE_TIME], zigzag(p->lastUpdateTime - prevUpdate));
+        prevDispatch = p->dispatchTime;
+        prevArrival = p->arrivalTime;
+        prevUpdate = p->lastUpdateTime;
+
+        int events = 0;
+        for (const HistoryEvent* e = p->history->first(); e; e = e->next) events++;
+        putVarint(cols[COL_HISTORY], (unsigned long long)events);
+        for (const HistoryEvent* e = p->history->first(); e; e = e->next) {
+            putString(cols[COL_HISTORY], e->time);
+            putString(cols[COL_HISTORY], e->description);
+            putString(cols[COL_HISTORY], e->location);
+        }
+        putString(cols[COL_ROUTE], p->routeCode);
+    }
+    BloomFilter* filter = new BloomFilter(n, ID_FILTER_RATE, n);
+    for (int r = 0; r < n; r++) filter->add(rows[r]->id);
+    cols[COL_ID_FILTER].assign((const char*)filter->bits(), filter->memoryBytes());
+
+    string payload;
+    unsigned int compLen[COLUMN_COUNT];
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        size_t at = payload.size();
+        payload.resize(at + lzBound(cols[c].size()));
+        compLen[c] = (unsigned int)lzCompress(cols[c].data(), cols[c].size(), &payload[at]);
+        payload.resize(at + compLen[c]);
+    }
+
+    const string& minId = rows[0]->id;
+    const string& maxId = rows[n - 1]->id;
+    string header;
+    putU32(header, BLOCK_MAGIC);
+    putU32(header, (unsigned int)payload.size());
+    putU32(header, (unsigned int)n);
+    putU16(header, (unsigned short)minId.size());
+    putU16(header, (unsigned short)maxId.size());
+    header += minId;
+    header += maxId;
+    putU32(header, COLUMN_COUNT);
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        putU32(header, (unsigned int)cols[c].size());
+        putU32(header, compLen[c]);
+    }
+
+    // The hot copies are dropped once this returns true, so the block must
+    // be on the disk by then - and so must the file's name, the first time
+    error_code ec;
+    fs::path parent = fs::path(path).parent_path();
+    if (!parent.empty()) fs::create_directories(parent, ec);
+    bool created = !fs::exists(path, ec);
+    {
+        ofstream f(path, ios::binary | ios::app);
+        bool ok = f.is_open();
+        if (ok) {
+            f.write(header.data(), (streamsize)header.size());
+            f.write(payload.data(), (streamsize)payload.size());
+            f.flush();
+            ok = (bool)f;
+        }
+        if (!ok) {
+            delete filter;
+            return false;
+        }
+    }
+    if (!syncFile(path) || (created && !syncDirectory(parent.string()))) {
+        delete filter;
+        return false;
+    }
+
+    BlockInfo b;
+    b.minId = minId;
+    b.maxId = maxId;
+    b.offset = fileEnd;
+    b.length = (unsigned int)(header.size() + payload.size());
+    b.rows = (unsigned int)n;
+    b.ids = filter;
+    addBlock(b);
+    fileEnd += b.length;
+    return true;
+}
+
+bool ColdStore::readBlock(const BlockInfo& b, string& bytes) {
+    ifstream f(path, ios::binary);
+    if (!f.is_open()) return false;
+    bytes.resize(b.length);
+    f.seekg(b.offset);
+    return (bool)f.read(&bytes[0], b.length);
+}
+
+bool ColdStore::decodeColumn(const string& bytes, int c, string& out) {
+    const char* base = bytes.data();
+    unsigned short minLen = getU16(base + 12), maxLen = getU16(base + 14);
+    unsigned int columns = getU32(base + 16 + minLen + maxLen);
+    const char* table = base + 16 + minLen + maxLen + 4;
+    const char* payload = table + 8 * columns;
+    if (c >= (int)columns) {
+        out.clear();   // written before the column existed
+        return true;
+    }
+
+    size_t at = 0;
+    for (int k = 0; k < c; k++) at += getU32(table + 8 * k + 4);
+    unsigned int raw = getU32(table + 8 * c), comp = getU32(table + 8 * c + 4);
+    if (payload + at + comp > base + bytes.size()) return false;
+    out.resize(raw);
+    return lzDecompress(payload + at, comp, raw ? &out[0] : nullptr, raw) == raw;
+}
+
+// Decodes the ID column, then the other columns only if the ID is there
+Parcel* ColdStore::findInBlock(const BlockInfo& b, string_view id, bool materialize, bool* found) {
+    *found = false;
+    string bytes;
+    if (!readBlock(b, bytes)) return nullptr;
+
+    string_view column[COLUMN_COUNT];
+    string decoded[COLUMN_COUNT];
+    auto decode = [&](int c) -> bool {
+        if (!decodeColumn(bytes, c, decoded[c])) return false;
+        column[c] = decoded[c];
+        return true;
+    };
+
+    if (!decode(COL_ID)) return nullptr;
+    ColumnReader ids(column[COL_ID]);
+    int row = -1;
+    for (unsigned int r = 0; r < b.rows && ids.ok; r++) {
+        string_view s = ids.str();
+        if (s == id) {
+            row = (int)r;
+            break;
+        }
+        if (s > id) break;   // rows are sorted
+    }
+    if (row < 0) return nullptr;
+    *found = true;
+    if (!materialize) return nullptr;
+
+    for (int c = COL_DESTINATION; c <= COL_ROUTE; c++)
+        if (!decode(c)) return nullptr;
+
+    ColumnReader dest(column[COL_DESTINATION]), zone(column[COL_ZONE]), rider(column[COL_RIDER]);
+    ColumnReader weight(column[COL_WEIGHT]), prio(column[COL_PRIORITY]), attempts(column[COL_ATTEMPTS]);
+    ColumnReader dispatch(column[COL_DISPATCH_TIME]), arrival(column[COL_ARRIVAL_TIME]), updated(column[COL_UPDATE_TIME]);
+    ColumnReader hist(column[COL_HISTORY]), route(column[COL_ROUTE]);
+    bool hasRoute = !column[COL_ROUTE].empty();
+    long long dispatchAt = 0, arrivalAt = 0, updatedAt = 0;
+    for (int r = 0; r < row; r++) {
+        dest.str(); zone.str(); rider.str(); weight.f64(); prio.varint(); attempts.varint();
+        dispatchAt += unzigzag(dispatch.varint());
+        arrivalAt += unzigzag(arrival.varint());
+        updatedAt += unzigzag(updated.varint());
+        unsigned long long events = hist.varint();
+        for (unsigned long long e = 0; e < events && hist.ok; e++) {
+            hist.str(); hist.str(); hist.str();
+        }
+        if (hasRoute) route.str();
+    }
+
+    Parcel* p = new Parcel(string(id), string(dest.str()), weight.f64(), (int)prio.varint(), string(zone.str()));
+    p->assignedRider = string(rider.str());
+    p->status = (row < (int)column[COL_STATUS].size()) ? (unsigned char)column[COL_STATUS][row] : STATUS_CANCELLED;
+    p->deliveryAttempts = (int)attempts.varint();
+    p->dispatchTime = dispatchAt + unzigzag(dispatch.varint());
+    p->arrivalTime = arrivalAt + unzigzag(arrival.varint());
+    p->lastUpdateTime = updatedAt + unzigzag(updated.varint());
+
+    // Swap the fresh "Pickup Request Created" timeline for the stored one
+    delete p->history;
+    p->history = new TrackingHistory();
+    unsigned long long events = hist.varint();
+    for (unsigned long long e = 0; e < events && hist.ok; e++) {
+        string_view t = hist.str();
+        string_view d = hist.str();
+        string_view l = hist.str();
+        p->history->restoreEvent(string(d), string(t), string(l));
+    }
+    if (hasRoute) p->routeCode = string(route.str());
+
+    if (!(dest.ok && zone.ok && rider.ok && weight.ok && prio.ok && attempts.ok && hist.ok && route.ok)) {
+        delete p;
+        return nullptr;
+    }
+    return p;
+}
+
+static void addToFilter(string_view id, void* ctx) {
+    ((BloomFilter*)ctx)->add(id);
+}
+
+// False means the block certainly does not hold the ID
+bool ColdStore::mayHold(BlockInfo& b, string_view id) {
+    if (id < b.minId || id > b.maxId) return false;
+    if (!b.ids) {
+        BloomFilter* filter = new BloomFilter(b.rows, ID_FILTER_RATE, b.rows);
+        if (!forEachId((int)(&b - blocks), addToFilter, filter)) {
+            delete filter;
+            return true;   // unreadable; let the lookup find out
+        }
+        b.ids = filter;
+    }
+    return b.ids->mayContain(id);
+}
+
+bool ColdStore::contains(string_view id) {
+    // Newest blocks first: recently archived IDs are the likeliest lookups
+    for (int i = blockCount - 1; i >= 0; i--) {
+        BlockInfo& b = blocks[i];
+        if (!mayHold(b, id)) continue;
+        bool found;
+        findInBlock(b, id, false, &found);
+        if (found) return true;
+    }
+    return false;
+}
+
+bool ColdStore::forEachId(int block, void (*visit)(string_view id, void* ctx), void* ctx) {
+    if (block < 0 || block >= blockCount) return false;
+    const BlockInfo& b = blocks[block];
+    string bytes, ids;
+    if (!readBlock(b, bytes) || !decodeColumn(bytes, COL_ID, ids)) return false;
+
+    ColumnReader r(ids);
+    for (unsigned int i = 0; i < b.rows; i++) {
+        string_view id = r.str();
+        if (!r.ok) return false;
+        visit(id, ctx);
+    }
+    return true;
+}
+
+Parcel* ColdStore::load(string_view id) {
+    for (int i = blockCount - 1; i >= 0; i--) {
+        BlockInfo& b = blocks[i];
+        if (!mayHold(b, id)) continue;
+        bool found;
+        Parcel* p = findInBlock(b, id, true, &found);
+        if (found) return p;
+    }
+    return nullptr;
+}
@@ -0,0 +1,79 @@
+#ifndef COLDSTORE_H
+#define COLDSTORE_H
+
+#include <string>
+#include <string_view>
+#include "parcel.h"
+#include "bloomfilter.h"
+
+// Archive tier for parcels that reached a final state. Parcels are appended
+// in blocks of up to ROWS_PER_BLOCK, sorted by ID, one column per field and
+// every column LZ-compressed on its own (repetitive columns like zone or
+// history text shrink the most). The in-memory index is sparse: each
+// block's ID range, file offset and a Bloom filter of its IDs, read back
+// from the block headers and filter columns at start. IDs are random, so
+// the ranges overlap; the filters are what keep a lookup from decoding
+// every block.
+class ColdStore {
+public:
+    static const int ROWS_PER_BLOCK = 512;
+    // Per block; a miss costs one false decode per thousand blocks
+    static constexpr double ID_FILTER_RATE = 0.001;
+
+private:
+    struct BlockInfo {
+        std::string minId;
+        std::string maxId;
+        long long offset;      // start of the block header in the file
+        unsigned int length;   // header + payload bytes
+        unsigned int rows;
+        BloomFilter* ids;      // nullptr until built, for blocks older than the filter column
+    };
+
+    std::string path;
+    BlockInfo* blocks;
+    int blockCount;
+    int blockCapacity;
+    long long fileEnd;     // append position (a torn tail is overwritten)
+    long long archived;    // rows across all blocks
+
+    void addBlock(const BlockInfo& b);
+    bool appendBlock(Parcel** rows, int n);
+    bool readBlock(const BlockInfo& b, std::string& bytes);
+    bool decodeColumn(const std::string& bytes, int column, std::string& out);
+    bool mayHold(BlockInfo& b, std::string_view id);
+    Parcel* findInBlock(const BlockInfo& b, std::string_view id, bool materialize, bool* found);
+
+public:
+    ColdStore(const std::string& filePath = "parcels.d/cold.col");
+    ~ColdStore();
+    ColdStore(const ColdStore&) = delete;
+    ColdStore& operator=(const ColdStore&) = delete;
+
+    // Scans block headers to rebuild the sparse index
+    void open();
+    // Writes the parcels out (reordering the array); false on I/O error,
+    // in which case nothing may be dropped from the hot tier
+    bool archive(Parcel** parcels, int n);
+
+    bool contains(std::string_view id);
+    // Visits every ID stored in one block (rebuilding filters, a block at
+    // a time); false if the block cannot be read
+    bool forEachId(int block, void (*visit)(std::string_view id, void* ctx), void* ctx);
+    // Rebuilds an archived parcel, history included; the caller owns it.
+    // nullptr if the ID was never archived.
+    Parcel* load(std::string_view id);
+
+    long long size() const { return archived; }
+    int blocksWritten() const { return blockCount; }
+};
+
+// In-tree LZ77 block codec (LZ4 sequence layout: token, literals, 16-bit
+// offset, match length). dst needs lzBound(n) bytes; returns bytes written.
+size_t lzBound(size_t n);
+size_t lzCompress(const char* src, size_t n, char* dst);
+// Returns the decoded size, or (size_t)-1 if the input is corrupt or would
+// overflow dst
+size_t lzDecompress(const char* src, size_t n, char* dst, size_t dstCapacity);
+
+#endif
@@ -0,0 +1,409 @@
+#include "dispatchscheduler.h"
+#include "datastructures.h"
+#include <fstream>
+#include <cstdlib>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+// =====================================================
+// DispatchPolicy Implementation (SLA Due Times)
+// =====================================================
+DispatchPolicy::DispatchPolicy() : zoneCount(0), affinitySeconds(5 * 60), affinityMax(4) {
+    for (int i = 0; i <= MAX_PRIORITY; i++) slaSeconds[i] = 30 * 60;
+    slaSeconds[0] = slaSeconds[1] = 8 * 3600;
+    slaSeconds[2] = 2 * 3600;
+    for (int i = 0; i < MAX_ZONES; i++) zoneSeconds[i] = 0;
+}
+
+static string trim(const string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// Whole text as a number, or false
+static bool parseNumber(const string& text, double& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    out = strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+bool DispatchPolicy::load(const string& path, string& error) {
+    ifstream f(path);
+    if (!f.is_open()) {
+        error = "cannot read the file";
+        return false;
+    }
+
+    // Filled in a copy, so a bad file changes nothing
+    DispatchPolicy next = *this;
+    string line;
+    int lineNo = 0;
+    while (getline(f, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != string::npos) line.erase(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        string where = "line " + to_string(lineNo) + ": ";
+        size_t eq = line.find('=');
+        if (eq == string::npos) {
+            error = where + "expected key = value";
+            return false;
+        }
+        string key = trim(line.substr(0, eq));
+        double value = 0;
+        if (!parseNumber(trim(line.substr(eq + 1)), value)) {
+            error = where + "'" + key + "' needs a number";
+            return false;
+        }
+
+        if (key.compare(0, 4, "sla.") == 0) {
+            double pr = 0;
+            if (!parseNumber(key.substr(4), pr) || pr < 0 || pr > MAX_PRIORITY || pr != (int)pr) {
+                error = where + "priorities run from 0 to " + to_string(MAX_PRIORITY);
+                return false;
+            }
+            if (value < 0) {
+                error = where + "an SLA cannot be negative";
+                return false;
+            }
+            next.slaSeconds[(int)pr] = (long long)(value * 60);
+        }
+        else if (key.compare(0, 5, "zone.") == 0) {
+            string zone = trim(key.substr(5));
+            int z = 0;
+            while (z < next.zoneCount && next.zoneNames[z] != zone) z++;
+            if (z == next.zoneCount) {
+                if (zone.empty() || next.zoneCount == MAX_ZONES) {
+                    error = where + (zone.empty() ? "missing zone name" : "too many zones");
+                    return false;
+                }
+                next.zoneNames[next.zoneCount++] = zone;
+            }
+            next.zoneSeconds[z] = (long long)(value * 60);
+        }
+        else if (key == "affinity" || key == "affinity.max") {
+            if (value < 0) {
+                error = where + "'" + key + "' cannot be negative";
+                return false;
+            }
+            if (key == "affinity") next.affinitySeconds = (long long)(value * 60);
+            else next.affinityMax = (int)value;
+        }
+        else {
+            error = where + "unknown setting '" + key + "'";
+            return false;
+        }
+    }
+
+    *this = next;
+    return true;
+}
+
+long long DispatchPolicy::dueTime(const Parcel& p, int sharing) const {
+    int pr = p.priority < 0 ? 0 : (p.priority > MAX_PRIORITY ? MAX_PRIORITY : p.priority);
+    long long due = p.queuedSince + slaSeconds[pr];
+    for (int z = 0; z < zoneCount; z++) {
+        if (zoneNames[z] == p.zone) {
+            due += zoneSeconds[z];
+            break;
+        }
+    }
+    due -= affinitySeconds * (sharing < affinityMax ? sharing : affinityMax);
+    return due > 0 ? due : 0;
+}
+
+// =====================================================
+// DispatchScheduler Implementation (Calendar Queue)
+// =====================================================
+// Index of the lowest set bit; x must not be 0
+static int lowestBit(unsigned long long x) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return (int)i;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+DispatchScheduler::DispatchScheduler()
+    : buckets(nullptr), bucketCount(0), occupied(nullptr), cursor(0), resumeAt(0), early(0), count(0),
+      groups(nullptr), groupUsed(nullptr), groupCapacity(0), groupCount(0) {
+    resize(MIN_BUCKETS);
+    growGroups();
+}
+
+DispatchScheduler::~DispatchScheduler() {
+    delete[] buckets;
+    delete[] occupied;
+    delete[] groups;
+    delete[] groupUsed;
+}
+
+void DispatchScheduler::place(Parcel* p) {
+    int b = (int)(p->dueTime & (bucketCount - 1));
+    buckets[b].add(p);
+    occupied[b >> 6] |= 1ULL << (b & 63);
+    p->queueBucket = b;
+    p->queueSlot = buckets[b].size() - 1;
+}
+
+// The bucket's last parcel fills the hole
+void DispatchScheduler::unlink(Parcel* p) {
+    Bucket& bucket = buckets[p->queueBucket];
+    int slot = p->queueSlot;
+    Parcel* moved = bucket[bucket.size() - 1];
+    bucket[slot] = moved;
+    moved->queueSlot = slot;
+    bucket.removeLast();
+    if (bucket.isEmpty()) occupied[p->queueBucket >> 6] &= ~(1ULL << (p->queueBucket & 63));
+    p->queueSlot = -1;
+    if (p->dueTime < resumeAt) early--;
+
+    leaveGroup(p);
+    count--;
+}
+
+// Files every waiting parcel again over newBucketCount buckets
+void DispatchScheduler::resize(int newBucketCount) {
+    Bucket* old = buckets;
+    int oldCount = bucketCount;
+
+    bucketCount = newBucketCount;
+    buckets = new Bucket[bucketCount];
+    delete[] occupied;
+    occupied = new unsigned long long[bucketCount / 64];
+    for (int w = 0; w < bucketCount / 64; w++) occupied[w] = 0;
+    for (int b = 0; b < oldCount; b++)
+        for (Parcel* p : old[b]) place(p);
+    delete[] old;
+}
+
+// FNV-1a over the name
+static unsigned int hashName(const string& name) {
+    unsigned int h = 2166136261u;
+    for (char c : name) {
+        h ^= (unsigned char)c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+DispatchScheduler::Group& DispatchScheduler::groupFor(const string& destination) {
+    unsigned int h = hashName(destination);
+    int mask = groupCapacity - 1;
+    int i = (int)(h & (unsigned int)mask);
+    while (groupUsed[i]) {
+        if (groups[i].hash == h && groups[i].destination == destination) return groups[i];
+        i = (i + 1) & mask;
+    }
+    if ((groupCount + 1) * 2 > groupCapacity) {
+        growGroups();
+        return groupFor(destination);
+    }
+    groupUsed[i] = true;
+    groupCount++;
+    groups[i].destination = destination;
+    groups[i].hash = h;
+    groups[i].waiting = 0;
+    groups[i].added.clear();
+    groups[i].left.clear();
+    return groups[i];
+}
+
+void DispatchScheduler::growGroups() {
+    Group* old = groups;
+    bool* oldUsed = groupUsed;
+    int oldCapacity = groupCapacity;
+
+    groupCapacity = oldCapacity > 0 ? oldCapacity * 2 : 16;
+    groups = new Group[groupCapacity];
+    groupUsed = new bool[groupCapacity];
+    for (int i = 0; i < groupCapacity; i++) groupUsed[i] = false;
+    for (int k = 0; k < oldCapacity; k++) {
+        if (!oldUsed[k]) continue;
+        int i = (int)(old[k].hash & (unsigned int)(groupCapacity - 1));
+        while (groupUsed[i]) i = (i + 1) & (groupCapacity - 1);
+        groups[i] = move(old[k]);
+        groupUsed[i] = true;
+    }
+    delete[] old;
+    delete[] oldUsed;
+}
+
+// Backward-shift delete: later entries of the probe run move up into the
+// hole, so lookups never need tombstones
+void DispatchScheduler::eraseGroup(int slot) {
+    int mask = groupCapacity - 1;
+    groupUsed[slot] = false;
+    groupCount--;
+    for (int j = (slot + 1) & mask; groupUsed[j]; j = (j + 1) & mask) {
+        int home = (int)(groups[j].hash & (unsigned int)mask);
+        // Stays put if its home lies cyclically in (slot, j]
+        bool stays = (slot <= j) ? (home > slot && home <= j) : (home > slot || home <= j);
+        if (stays) continue;
+        groups[slot] = move(groups[j]);
+        groupUsed[slot] = true;
+        groupUsed[j] = false;
+        slot = j;
+    }
+}
+
+void DispatchScheduler::clearGroups() {
+    for (int i = 0; i < groupCapacity; i++) {
+        groupUsed[i] = false;
+        groups[i].added.clear();
+        groups[i].left.clear();
+    }
+    groupCount = 0;
+}
+
+void DispatchScheduler::pushDue(DueHeap& heap, long long due) {
+    int n = heap.size();
+    heap.add(MinHeapItem<long long>{ 0, 0 });
+    minHeapPush(&heap[0], n, due, 0);
+}
+
+void DispatchScheduler::popDue(DueHeap& heap) {
+    int n = heap.size();
+    minHeapPop(&heap[0], n);
+    heap.removeLast();
+}
+
+long long DispatchScheduler::firstDue(Group& g) {
+    while (!g.left.isEmpty() && g.left[0].key == g.added[0].key) {
+        popDue(g.added);
+        popDue(g.left);
+    }
+    return g.added[0].key;
+}
+
+void DispatchScheduler::leaveGroup(Parcel* p) {
+    unsigned int h = hashName(p->destination);
+    int mask = groupCapacity - 1;
+    int i = (int)(h & (unsigned int)mask);
+    while (groupUsed[i] && !(groups[i].hash == h && groups[i].destination == p->destination)) i = (i + 1) & mask;
+    if (!groupUsed[i]) return;
+
+    Group& g = groups[i];
+    if (--g.waiting == 0) {
+        eraseGroup(i);
+        return;
+    }
+    // Parcels mostly leave in due order, so it is usually the first
+    if (p->dueTime == g.added[0].key) popDue(g.added);
+    else pushDue(g.left, p->dueTime);
+    firstDue(g);
+}
+
+void DispatchScheduler::setPolicy(const DispatchPolicy& p) {
+    ParcelArrayList waiting;
+    waiting.reserve(count);
+    for (int b = 0; b < bucketCount; b++) {
+        for (Parcel* q : buckets[b]) {
+            q->queueSlot = -1;
+            waiting.add(q);
+        }
+        buckets[b].clear();
+    }
+    for (int w = 0; w < bucketCount / 64; w++) occupied[w] = 0;
+    clearGroups();
+    count = 0;
+
+    policy = p;
+    for (Parcel* q : waiting) insert(q);
+}
+
+const DispatchPolicy& DispatchScheduler::getPolicy() const {
+    return policy;
+}
+
+void DispatchScheduler::insert(Parcel* p) {
+    Group& g = groupFor(p->destination);
+    p->dueTime = policy.dueTime(*p, 0);
+    if (g.waiting > 0) {
+        // The credit may bring it level with the group's first, not past it
+        long long first = firstDue(g);
+        long long credited = policy.dueTime(*p, g.waiting);
+        long long limit = p->dueTime < first ? p->dueTime : first;
+        p->dueTime = credited > limit ? credited : limit;
+    }
+    pushDue(g.added, p->dueTime);
+    g.waiting++;
+    if (count == 0) {
+        cursor = resumeAt = p->dueTime;
+        early = 0;
+    }
+    if (p->dueTime < resumeAt) early++;
+    if (p->dueTime < cursor) cursor = p->dueTime;
+    place(p);
+    count++;
+    if (count > 2 * bucketCount) resize(bucketCount * 2);
+}
+
+Parcel* DispatchScheduler::extractNext() {
+    if (count == 0) return nullptr;
+    if (early == 0 && cursor < resumeAt) cursor = resumeAt;
+
+    // Walk one lap of days from the cursor, over non-empty buckets only;
+    // the first parcel due on the day it is filed under is the earliest
+    Parcel* next = nullptr;
+    long long day = cursor;
+    for (int walked = 0; walked < bucketCount && !next;) {
+        int b = (int)(day & (bucketCount - 1));
+        unsigned long long bits = occupied[b >> 6] >> (b & 63);
+        if (bits == 0) {
+            int skip = 64 - (b & 63);
+            day += skip;
+            walked += skip;
+            continue;
+        }
+        int skip = lowestBit(bits);
+        day += skip;
+        walked += skip;
+        for (Parcel* p : buckets[b + skip]) {
+            if (p->dueTime == day) {
+                next = p;
+                cursor = day;
+                break;
+            }
+        }
+        day++;
+        walked++;
+    }
+
+    // Nothing due within a lap: look at everything and jump ahead
+    if (!next) {
+        for (int b = 0; b < bucketCount; b++)
+            for (Parcel* p : buckets[b])
+                if (!next || p->dueTime < next->dueTime) next = p;
+        cursor = next->dueTime;
+    }
+    if (cursor > resumeAt) resumeAt = cursor;
+
+    unlink(next);
+    return next;
+}
+
+bool DispatchScheduler::remove(Parcel* p) {
+    if (!contains(p)) return false;
+    unlink(p);
+    return true;
+}
+
+bool DispatchScheduler::contains(const Parcel* p) const {
+    return p->queueSlot >= 0 && p->queueBucket >= 0 && p->queueBucket < bucketCount &&
+           p->queueSlot < buckets[p->queueBucket].size() && buckets[p->queueBucket][p->queueSlot] == p;
+}
+
+bool DispatchScheduler::isEmpty() const { return count == 0; }
+
+int DispatchScheduler::size() const { return count; }
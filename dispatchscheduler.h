@@ -0,0 +1,135 @@
+#ifndef DISPATCHSCHEDULER_H
+#define DISPATCHSCHEDULER_H
+
+#include <string>
+#include "parcel.h"
+#include "smallvector.h"
+#include "minheap.h"
+
+// When a waiting parcel is due to leave the warehouse:
+//
+//   due = time it joined the queue + SLA for its priority
+//         + allowance for its destination zone - affinity credit
+//
+// and the sorting queue always hands out the earliest due time. Waiting is
+// built in: a parcel's due time stays put while newer parcels arrive behind
+// it, so a low priority parcel is eventually first in line instead of
+// starving. Weight plays no part. The affinity credit moves a parcel
+// forward for each parcel already waiting for the same destination (up to
+// affinityMax of them), so parcels that can share the road leave together;
+// it never moves one ahead of the first parcel waiting for that destination.
+struct DispatchPolicy {
+    static const int MAX_PRIORITY = 9;
+    static const int MAX_ZONES = 8;
+
+    long long slaSeconds[MAX_PRIORITY + 1];     // by priority (out of range: nearest)
+    std::string zoneNames[MAX_ZONES];
+    long long zoneSeconds[MAX_ZONES];           // added to the due time (may be negative)
+    int zoneCount;
+    long long affinitySeconds;                  // credit per parcel sharing the destination
+    int affinityMax;
+
+    // Priority 3 within 30 minutes, 2 within 2 hours, 1 within 8 hours; no
+    // zone allowances; 5 minutes' credit for each of up to 4 sharers
+    DispatchPolicy();
+
+    // Reads a policy file of "key = value" lines, times in minutes:
+    //   sla.<priority> = <minutes>
+    //   zone.<zone name> = <minutes>
+    //   affinity = <minutes>
+    //   affinity.max = <parcels>
+    // '#' starts a comment. Settings the file leaves out keep their value.
+    // False, with error describing the problem, if the file cannot be read
+    // or a line makes no sense.
+    bool load(const std::string& path, std::string& error);
+
+    long long dueTime(const Parcel& p, int sharing) const;
+};
+
+// The warehouse sorting queue, ordered by DispatchPolicy due times: a
+// calendar queue with one-second days (due times are whole seconds). Day d
+// files into bucket d mod bucketCount, so every parcel of a day shares one
+// due time and any of them is the earliest. The cursor never passes the
+// earliest waiting parcel: taking the next one checks the cursor's day and
+// walks forward; inserting is a single append. The buckets double as the
+// queue grows, keeping a couple of parcels per bucket, and a bitmap of
+// non-empty buckets lets the walk cross empty stretches 64 days at a time.
+// Parcels due more than a lap ahead share a bucket with nearer ones and
+// are stepped over.
+//
+// Due times do not arrive in order (a priority parcel can be due before
+// one already waiting), which rules out a radix heap; a calendar queue
+// just moves its cursor back, and jumps forward again once those parcels
+// have gone.
+class DispatchScheduler {
+private:
+    static const int MIN_BUCKETS = 64;
+
+    // Most buckets hold zero to two parcels
+    typedef SmallVector<Parcel*, 2> Bucket;
+
+    // Due times as a min-heap (the node field is unused)
+    typedef SmallVector<MinHeapItem<long long>, 4> DueHeap;
+
+    // The parcels waiting for one destination. Their first - the one the
+    // affinity credit never moves a newcomer past - is the least due time
+    // added and not yet left; a due time leaving is pushed on the second
+    // heap and both tops come off together when they match.
+    struct Group {
+        std::string destination;
+        unsigned int hash;
+        int waiting;
+        DueHeap added;
+        DueHeap left;
+    };
+
+    Bucket* buckets;
+    int bucketCount;            // power of two
+    unsigned long long* occupied;   // bit per non-empty bucket
+    long long cursor;           // no waiting parcel is due before this
+    // Where the walk had got to before parcels due earlier pulled the
+    // cursor back, and how many of those are waiting: once they are gone
+    // the walk resumes there instead of crossing the gap again
+    long long resumeAt;
+    int early;
+    int count;
+    DispatchPolicy policy;
+    // Groups by destination, for the affinity credit: open addressing on
+    // the name, at most half full. A group goes when its last parcel does.
+    Group* groups;
+    bool* groupUsed;
+    int groupCapacity;          // power of two
+    int groupCount;
+
+    void place(Parcel* p);
+    void unlink(Parcel* p);
+    void resize(int newBucketCount);
+    Group& groupFor(const std::string& destination);
+    void leaveGroup(Parcel* p);
+    void eraseGroup(int slot);
+    void growGroups();
+    void clearGroups();
+    static void pushDue(DueHeap& heap, long long due);
+    static void popDue(DueHeap& heap);
+    static long long firstDue(Group& g);
+
+public:
+    DispatchScheduler();
+    ~DispatchScheduler();
+    DispatchScheduler(const DispatchScheduler&) = delete;
+    DispatchScheduler& operator=(const DispatchScheduler&) = delete;
+
+    // Re-files every waiting parcel under the new policy
+    void setPolicy(const DispatchPolicy& p);
+    const DispatchPolicy& getPolicy() const;
+
+    void insert(Parcel* p);
+    // Earliest due parcel, or nullptr when empty
+    Parcel* extractNext();
+    bool remove(Parcel* p);
+    bool contains(const Parcel* p) const;
+    bool isEmpty() const;
+    int size() const;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "fastrandom.h"
+
+using namespace std;
+
+// =====================================================
+// FastRandom Implementation (xorshift64*)
+// =====================================================
+FastRandom::FastRandom(unsigned long long seed) {
+    reseed(seed);
+}
+
+// splitmix64 of the seed, so small or consecutive seeds still start far
+// apart and the state is never zero
+void FastRandom::reseed(unsigned long long seed) {
+    unsigned long long z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    state = (z ^ (z >> 31)) | 1;
+}
+
+unsigned long long FastRandom::next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+int FastRandom::below(int n) {
+    return n > 0 ? (int)((next() >> 32) * (unsigned long long)n >> 32) : 0;
+}
+
+double FastRandom::unit() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,21 @@
+#ifndef FASTRANDOM_H
+#define FASTRANDOM_H
+
+// xorshift64*: a few cycles a draw and eight bytes of state, so every
+// engine (and its map) can own one. rand() keeps one hidden state for the
+// whole process, shared by the hub shards' threads; this is the per-owner
+// replacement. Not for anything that must be unpredictable.
+class FastRandom {
+private:
+    unsigned long long state;
+public:
+    explicit FastRandom(unsigned long long seed);
+    void reseed(unsigned long long seed);
+    unsigned long long next();
+    // Uniform in [0, n)
+    int below(int n);
+    // Uniform in [0, 1)
+    double unit();
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "filesync.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// =====================================================
+// File Sync Implementation (fsync / _commit)
+// =====================================================
+#ifdef _WIN32
+
+bool syncFile(const string& path) {
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) return false;
+    bool ok = _commit(fd) == 0;
+    _close(fd);
+    return ok;
+}
+
+bool syncDirectory(const string&) {
+    return true;
+}
+
+#else
+
+// fsync on any descriptor of a file writes out all of its dirty pages,
+// including those written through another one
+static bool syncPath(const string& path, int flags) {
+    int fd = open(path.c_str(), flags | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+bool syncFile(const string& path) {
+    return syncPath(path, O_RDONLY);
+}
+
+bool syncDirectory(const string& dir) {
+    return syncPath(dir.empty() ? "." : dir, O_RDONLY | O_DIRECTORY);
+}
+
+#endif
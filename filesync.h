@@ -0,0 +1,15 @@
+#ifndef FILESYNC_H
+#define FILESYNC_H
+
+#include <string>
+
+// A flushed stream has only handed its bytes to the OS; these wait until
+// they are on the disk. A write that must survive a power cut syncs the
+// file, and a file that was just created or renamed also needs its
+// directory synced, or the name can be lost while the data is not.
+// Both return false if the sync failed.
+bool syncFile(const std::string& path);
+// No-op on Windows, where directory entries are journaled with the file
+bool syncDirectory(const std::string& dir);
+
+#endif
@@ -0,0 +1,261 @@
+#include "geoindex.h"
+#include "minheap.h"
+#include <cmath>
+
+using namespace std;
+
+static const double EARTH_RADIUS_KM = 6371.0;
+static const double DEG = 3.14159265358979323846 / 180.0;
+
+double geoDistanceKm(double lat1, double lon1, double lat2, double lon2) {
+    // Haversine: stays accurate for the short hops a city map is made of
+    double dLat = (lat2 - lat1) * DEG;
+    double dLon = (lon2 - lon1) * DEG;
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(lat1 * DEG) * cos(lat2 * DEG) * sin(dLon / 2) * sin(dLon / 2);
+    if (a > 1) a = 1;
+    return 2 * EARTH_RADIUS_KM * asin(sqrt(a));
+}
+
+static void unitVector(double lat, double lon, double* p) {
+    double c = cos(lat * DEG);
+    p[0] = c * cos(lon * DEG);
+    p[1] = c * sin(lon * DEG);
+    p[2] = sin(lat * DEG);
+}
+
+void geoPointKm(double lat, double lon, double* xyz) {
+    unitVector(lat, lon, xyz);
+    for (int a = 0; a < 3; a++) xyz[a] *= EARTH_RADIUS_KM;
+}
+
+// Chord between two unit vectors <-> distance along the surface
+static double chordToKm(double chordSquared) {
+    double half = sqrt(chordSquared) / 2;
+    if (half > 1) half = 1;
+    return 2 * EARTH_RADIUS_KM * asin(half);
+}
+
+static double kmToChordSquared(double km) {
+    double angle = km / EARTH_RADIUS_KM;
+    if (angle >= 3.14159265358979323846) return 4;
+    double chord = 2 * sin(angle / 2);
+    return chord * chord;
+}
+
+// Position along a Hilbert curve over a 65536 x 65536 grid (the classic
+// rotate-and-flip walk from the top bit down)
+static unsigned int hilbertIndex(unsigned int x, unsigned int y) {
+    unsigned int d = 0;
+    for (unsigned int s = 1u << 15; s > 0; s >>= 1) {
+        unsigned int rx = (x & s) ? 1 : 0;
+        unsigned int ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = 0xFFFF - x;
+                y = 0xFFFF - y;
+            }
+            unsigned int t = x;
+            x = y;
+            y = t;
+        }
+    }
+    return d;
+}
+
+// Two 16-bit LSD radix passes; order[] ends up sorted by key
+static void radixSortByKey(unsigned int* key, int* order, int n) {
+    unsigned int* keyTmp = new unsigned int[n];
+    int* orderTmp = new int[n];
+    for (int shift = 0; shift < 32; shift += 16) {
+        int* count = new int[65537]();
+        for (int i = 0; i < n; i++) count[((key[i] >> shift) & 0xFFFF) + 1]++;
+        for (int b = 0; b < 65536; b++) count[b + 1] += count[b];
+        for (int i = 0; i < n; i++) {
+            int at = count[(key[i] >> shift) & 0xFFFF]++;
+            keyTmp[at] = key[i];
+            orderTmp[at] = order[i];
+        }
+        for (int i = 0; i < n; i++) {
+            key[i] = keyTmp[i];
+            order[i] = orderTmp[i];
+        }
+        delete[] count;
+    }
+    delete[] keyTmp;
+    delete[] orderTmp;
+}
+
+// =====================================================
+// GeoIndex Implementation (Packed Hilbert R-Tree)
+// =====================================================
+GeoIndex::GeoIndex() : boxes(nullptr), ids(nullptr), points(nullptr), levels(0), itemCount(0) {}
+
+GeoIndex::~GeoIndex() {
+    clear();
+}
+
+void GeoIndex::clear() {
+    delete[] boxes;
+    delete[] ids;
+    delete[] points;
+    boxes = nullptr;
+    ids = nullptr;
+    points = nullptr;
+    levels = 0;
+    itemCount = 0;
+}
+
+int GeoIndex::size() const { return itemCount; }
+
+void GeoIndex::build(const double* lat, const double* lon, int n) {
+    clear();
+    if (n <= 0) return;
+    itemCount = n;
+
+    unsigned int* key = new unsigned int[n];
+    ids = new int[n];
+    for (int i = 0; i < n; i++) {
+        unsigned int x = (unsigned int)((lon[i] + 180.0) / 360.0 * 65535.0) & 0xFFFF;
+        unsigned int y = (unsigned int)((lat[i] + 90.0) / 180.0 * 65535.0) & 0xFFFF;
+        key[i] = hilbertIndex(x, y);
+        ids[i] = i;
+    }
+    radixSortByKey(key, ids, n);
+    delete[] key;
+
+    // Level sizes: n items, then ceil(/16) per level up to a single root
+    int total = 0;
+    int width = n;
+    levels = 0;
+    while (true) {
+        levelStart[levels++] = total;
+        total += width;
+        if (width == 1) break;
+        width = (width + NODE_SIZE - 1) / NODE_SIZE;
+    }
+    levelStart[levels] = total;
+
+    boxes = new Box[total];
+    points = new double[3 * n];
+    for (int i = 0; i < n; i++) {
+        double* p = points + 3 * i;
+        unitVector(lat[ids[i]], lon[ids[i]], p);
+        // Widened by a float step either way, so a box never shrinks
+        // below the points it covers
+        for (int a = 0; a < 3; a++) {
+            boxes[i].lo[a] = (float)p[a] - 1e-6f;
+            boxes[i].hi[a] = (float)p[a] + 1e-6f;
+        }
+    }
+    for (int l = 1; l < levels; l++) {
+        for (int b = levelStart[l]; b < levelStart[l + 1]; b++) {
+            int first, last;
+            children(b, l, first, last);
+            Box box = boxes[first];
+            for (int c = first + 1; c < last; c++) {
+                for (int a = 0; a < 3; a++) {
+                    if (boxes[c].lo[a] < box.lo[a]) box.lo[a] = boxes[c].lo[a];
+                    if (boxes[c].hi[a] > box.hi[a]) box.hi[a] = boxes[c].hi[a];
+                }
+            }
+            boxes[b] = box;
+        }
+    }
+}
+
+// Entries [first, last) one level below node b
+void GeoIndex::children(int b, int level, int& first, int& last) const {
+    int below = levelStart[level - 1];
+    first = below + (b - levelStart[level]) * NODE_SIZE;
+    last = first + NODE_SIZE;
+    if (last > levelStart[level]) last = levelStart[level];
+}
+
+double GeoIndex::boxDistance(int b, const double* p) const {
+    if (b < itemCount) {
+        const double* q = points + 3 * b;
+        double dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+    double sum = 0;
+    for (int a = 0; a < 3; a++) {
+        double d = 0;
+        if (p[a] < boxes[b].lo[a]) d = boxes[b].lo[a] - p[a];
+        else if (p[a] > boxes[b].hi[a]) d = p[a] - boxes[b].hi[a];
+        sum += d * d;
+    }
+    return sum;
+}
+
+// Best-first: the heap holds nodes and items by their distance lower
+// bound, so items come off nearest first and the search stops at k
+int GeoIndex::nearest(double lat, double lon, int k, int* idsOut, double* kmOut) const {
+    if (itemCount == 0 || k <= 0) return 0;
+    double p[3];
+    unitVector(lat, lon, p);
+
+    // Grows by doubling; a query seldom holds more than a few hundred
+    int capacity = 256;
+    MinHeapItem<double>* heap = new MinHeapItem<double>[capacity];
+    int heapSize = 0;
+    int root = levelStart[levels - 1];
+    minHeapPush(heap, heapSize, boxDistance(root, p), root);
+
+    int found = 0;
+    while (heapSize > 0 && found < k) {
+        MinHeapItem<double> top = minHeapPop(heap, heapSize);
+        int b = top.node;
+        if (b < itemCount) {
+            idsOut[found] = ids[b];
+            if (kmOut) kmOut[found] = chordToKm(top.key);
+            found++;
+            continue;
+        }
+        int level = 1;
+        while (b >= levelStart[level + 1]) level++;
+        int first, last;
+        children(b, level, first, last);
+        if (heapSize + NODE_SIZE > capacity) {
+            MinHeapItem<double>* bigger = new MinHeapItem<double>[capacity * 2];
+            for (int i = 0; i < heapSize; i++) bigger[i] = heap[i];
+            delete[] heap;
+            heap = bigger;
+            capacity *= 2;
+        }
+        for (int c = first; c < last; c++) minHeapPush(heap, heapSize, boxDistance(c, p), c);
+    }
+    delete[] heap;
+    return found;
+}
+
+void GeoIndex::within(double lat, double lon, double km, IntArrayList& out) const {
+    if (itemCount == 0) return;
+    double p[3];
+    unitVector(lat, lon, p);
+    double limit = kmToChordSquared(km);
+
+    // Depth-first with an explicit stack: at most 15 siblings wait per level
+    int stack[16 * NODE_SIZE];
+    int levelOf[16 * NODE_SIZE];
+    int depth = 0;
+    stack[depth] = levelStart[levels - 1];
+    levelOf[depth++] = levels - 1;
+    while (depth > 0) {
+        depth--;
+        int b = stack[depth];
+        int level = levelOf[depth];
+        if (boxDistance(b, p) > limit) continue;
+        if (level == 0) {
+            out.add(ids[b]);
+            continue;
+        }
+        int first, last;
+        children(b, level, first, last);
+        for (int c = first; c < last; c++) {
+            stack[depth] = c;
+            levelOf[depth++] = level - 1;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef GEOINDEX_H
+#define GEOINDEX_H
+
+#include "datastructures.h"
+
+// Great-circle distance between two points in degrees, in km
+double geoDistanceKm(double lat1, double lon1, double lat2, double lon2);
+// The point in km from the earth's centre. The straight line between two
+// such points is never longer than the way round the surface, and costs a
+// square root instead of the trigonometry.
+void geoPointKm(double lat, double lon, double* xyz);
+
+// Packed static R-tree over points on the globe, for nearest-neighbour and
+// radius queries. build() sorts the points along a Hilbert curve and packs
+// them sixteen to a leaf, then sixteen boxes to each node above, so the
+// whole tree is a handful of flat arrays and neighbours on the map are
+// neighbours in memory. Nothing is inserted afterwards; when the points
+// move, build again.
+//
+// Boxes are kept around the points' 3-D unit vectors rather than their
+// latitude and longitude, so the straight-line distance to a box is a
+// true lower bound on the distance along the surface, with no special
+// cases at the date line or the poles.
+class GeoIndex {
+private:
+    static const int NODE_SIZE = 16;
+
+    struct Box {
+        float lo[3];
+        float hi[3];
+    };
+
+    Box* boxes;         // the items (level 0), then each level of nodes up to the root
+    int* ids;           // item id for each level-0 entry
+    double* points;     // x, y, z per level-0 entry
+    int levelStart[16];
+    int levels;
+    int itemCount;
+
+    // Squared chord length from p to the nearest point of box b
+    double boxDistance(int b, const double* p) const;
+    void children(int b, int level, int& first, int& last) const;
+
+public:
+    GeoIndex();
+    ~GeoIndex();
+    GeoIndex(const GeoIndex&) = delete;
+    GeoIndex& operator=(const GeoIndex&) = delete;
+
+    // Indexes n points; point i is reported as id i
+    void build(const double* lat, const double* lon, int n);
+    void clear();
+    int size() const;
+
+    // Up to k ids, nearest first, with their distances in km when kmOut is
+    // given. Returns how many were written.
+    int nearest(double lat, double lon, int k, int* idsOut, double* kmOut = nullptr) const;
+    // Every id within km of the point, in no particular order
+    void within(double lat, double lon, double km, IntArrayList& out) const;
+};
+
+#endif
@@ -0,0 +1,1202 @@
+#include "httpserver.h"
+#include "serializer.h"
+#include "replication.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <csignal>
+#include <cerrno>
+#endif
+
+using namespace std;
+
+// Request size limits; anything larger is rejected
+static const size_t MAX_HEADER_BYTES = 8192;
+static const size_t MAX_BODY_BYTES = 65536;
+
+// Push feed tuning: bursts inside one window go out as one event per parcel,
+// and a subscriber that falls this far behind is told to resync instead
+static const long long PUSH_INTERVAL_MS = 100;
+static const size_t MAX_STREAM_BACKLOG = 256 * 1024;
+static const long long HEARTBEAT_SECONDS = 15;
+
+// =====================================================
+// Form Helpers
+// =====================================================
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void urlDecode(string_view in, string& out) {
+    out.clear();
+    for (size_t i = 0; i < in.size(); i++) {
+        char c = in[i];
+        if (c == '+') out += ' ';
+        else if (c == '%' && i + 2 < in.size() && hexValue(in[i + 1]) >= 0 && hexValue(in[i + 2]) >= 0) {
+            out += (char)(hexValue(in[i + 1]) * 16 + hexValue(in[i + 2]));
+            i += 2;
+        }
+        else out += c;
+    }
+}
+
+// Looks a key up in an "a=1&b=2" string (query or form body)
+static bool getParam(string_view src, string_view name, string& out) {
+    size_t pos = 0;
+    while (pos <= src.size()) {
+        size_t amp = src.find('&', pos);
+        if (amp == string_view::npos) amp = src.size();
+        string_view pair = src.substr(pos, amp - pos);
+        size_t eq = pair.find('=');
+        string_view key = pair.substr(0, eq);
+        if (key == name) {
+            urlDecode(eq == string_view::npos ? string_view() : pair.substr(eq + 1), out);
+            return true;
+        }
+        pos = amp + 1;
+    }
+    return false;
+}
+
+// Reads a parameter from the query string first, then a form-encoded body
+static bool requestParam(const HttpRequest& req, string_view name, string& out) {
+    return getParam(req.query, name, out) || getParam(req.body, name, out);
+}
+
+static const char* statusText(int code) {
+    switch (code) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 503: return "Service Unavailable";
+    default: return "Internal Server Error";
+    }
+}
+
+static bool equalsNoCase(string_view a, string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = (char)(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = (char)(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// Runs one encoder against whichever writer the client asked for, so each
+// endpoint describes its payload once for both JSON and MessagePack
+template <class Encode>
+static void encodeBody(OutBuffer& body, bool msgpack, Encode encode) {
+    body.clear();
+    if (msgpack) {
+        MsgPackWriter w(body);
+        encode(w);
+    }
+    else {
+        JsonWriter w(body);
+        encode(w);
+    }
+}
+
+template <class Writer>
+static void writeCityList(Writer& w, const MapGraph& map, const IntArrayList& path) {
+    w.beginArray(path.size());
+    for (int j = 0; j < path.size(); j++) w.value(map.cities[path.get(j)].name);
+    w.endArray();
+}
+
+// =====================================================
+// HttpServer: Routing and Handlers (platform neutral)
+// =====================================================
+HttpServer::HttpServer(LogisticsEngine& e, int listenPort, const string& listenHost)
+    : engine(e), publisher(nullptr), follower(nullptr), host(listenHost), port(listenPort), listenFd(-1), epollFd(-1), running(false),
+    lastTick(0), anyOrigin(false),
+    conns(nullptr), connCapacity(0), body(16384), frames(16384), deltaCount(0), deltaCapacity(64),
+    slotCapacity(128), eventSeq(0), lastPushMs(0), lastHeartbeat(0), streamCount(0) {
+    deltas = new StatusDelta[deltaCapacity];
+    deltaSlots = new int[slotCapacity];
+    for (int i = 0; i < slotCapacity; i++) deltaSlots[i] = -1;
+}
+
+// Only reads are shared with other sites; changes answer their own origin
+void HttpServer::respond(Connection* c, int code, const char* contentType, string_view payload, bool keepAlive) {
+    char head[256];
+    int n = snprintf(head, sizeof(head),
+        "HTTP/1.1 %d %s\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %zu\r\n"
+        "%s"
+        "Connection: %s\r\n\r\n",
+        code, statusText(code), contentType, payload.size(),
+        anyOrigin ? "Access-Control-Allow-Origin: *\r\n" : "", keepAlive ? "keep-alive" : "close");
+    c->out.append(head, n);
+    c->out.append(payload.data(), payload.size());
+    if (!keepAlive) c->closeAfterWrite = true;
+}
+
+void HttpServer::respondEncoded(Connection* c, int code, const HttpRequest& req) {
+    respond(c, code, req.msgpack ? "application/msgpack" : "application/json", body.view(), req.keepAlive);
+}
+
+// Errors are always JSON; they are read by people as often as by code
+void HttpServer::respondError(Connection* c, int code, const char* message, bool keepAlive) {
+    body.clear();
+    JsonWriter w(body);
+    w.beginObject(1);
+    w.key("error"); w.value(message);
+    w.endObject();
+    respond(c, code, "application/json", body.view(), keepAlive);
+}
+
+void HttpServer::route(Connection* c, const HttpRequest& req) {
+    const string_view parcels = "/api/parcels";
+
+    if (req.method == "OPTIONS") {
+        const char* preflight =
+            "HTTP/1.1 204 No Content\r\n"
+            "Access-Control-Allow-Origin: *\r\n"
+            "Access-Control-Allow-Methods: GET, OPTIONS\r\n"
+            "Access-Control-Allow-Headers: Content-Type, Accept\r\n"
+            "Content-Length: 0\r\n\r\n";
+        c->out += preflight;
+        return;
+    }
+
+    if (req.path == "/api/replication") {
+        if (req.method == "GET") handleReplication(c, req);
+        else respondError(c, 405, "use GET", req.keepAlive);
+        return;
+    }
+    if (req.path == "/api/startup") {
+        if (req.method == "GET") handleStartup(c, req);
+        else respondError(c, 405, "use GET", req.keepAlive);
+        return;
+    }
+    if (req.path == "/api/promote") {
+        if (req.method == "POST") handlePromote(c, req);
+        else respondError(c, 405, "use POST", req.keepAlive);
+        return;
+    }
+
+    // A standby answers reads from its replica; every change goes to the
+    // primary until this one is promoted
+    if (req.method == "POST" && engine.isReadOnly()) {
+        respondError(c, 503, "read-only standby; send changes to the primary", req.keepAlive);
+        return;
+    }
+
+    if (req.path.substr(0, parcels.size()) == parcels) {
+        string_view rest = req.path.substr(parcels.size());
+        if (rest.empty() || rest == "/") {
+            if (req.method == "GET") handleList(c, req);
+            else if (req.method == "POST") handlePickup(c, req);
+            else respondError(c, 405, "method not allowed", req.keepAlive);
+            return;
+        }
+        rest.remove_prefix(1);
+        size_t slash = rest.find('/');
+        string_view id = rest.substr(0, slash);
+        string_view action = (slash == string_view::npos) ? string_view() : rest.substr(slash + 1);
+
+        if (action.empty() && req.method == "GET") handleTrack(c, req, id);
+        else if (action == "cancel" && req.method == "POST") handleCancel(c, req, id);
+        else respondError(c, 404, "unknown parcel endpoint", req.keepAlive);
+        return;
+    }
+
+    if (req.path == "/api/dispatch") {
+        if (req.method == "POST") handleDispatch(c, req);
+        else respondError(c, 405, "use POST", req.keepAlive);
+        return;
+    }
+
+    if (req.path == "/api/undo" || req.path == "/api/redo") {
+        if (req.method == "POST") handleUndo(c, req, req.path == "/api/redo");
+        else respondError(c, 405, "use POST", req.keepAlive);
+        return;
+    }
+
+    if (req.path == "/api/events" && req.method == "GET") {
+        handleEvents(c, req);
+        return;
+    }
+
+    if (req.path == "/api/route") {
+        handleRoute(c, req);
+        return;
+    }
+
+    if (req.path == "/api/geo/cities" || req.path == "/api/geo/parcels") {
+        if (req.method == "GET") handleGeo(c, req, req.path == "/api/geo/parcels");
+        else respondError(c, 405, "use GET", req.keepAlive);
+        return;
+    }
+
+    if (req.path == "/api/analytics/roads" || req.path == "/api/analytics/routes") {
+        if (req.method == "GET") handleAnalytics(c, req, req.path == "/api/analytics/routes");
+        else respondError(c, 405, "use GET", req.keepAlive);
+        return;
+    }
+
+    if (req.method == "GET" && serveStatic(c, req)) return;
+    respondError(c, 404, "not found", req.keepAlive);
+}
+
+void HttpServer::setReplication(ReplicationPublisher* pub, ReplicationFollower* fol) {
+    publisher = pub;
+    follower = fol;
+}
+
+void HttpServer::handleReplication(Connection* c, const HttpRequest& req) {
+    if (!publisher && !follower) {
+        respondError(c, 404, "replication is not enabled", req.keepAlive);
+        return;
+    }
+    if (follower) follower->applyPending(engine);
+    ReplicationStatus st = follower ? follower->status() : publisher->status();
+    encodeBody(body, req.msgpack, [&](auto& w) {
+        if (follower && !follower->isPromoted()) {
+            w.beginObject(9);
+            w.key("role"); w.value("standby");
+            w.key("connected"); w.value(st.connected);
+            w.key("appliedSeq"); w.value(st.seq);
+            w.key("primarySeq"); w.value(st.primarySeq);
+            w.key("lagCommits"); w.value(st.primarySeq > st.seq ? st.primarySeq - st.seq : 0LL);
+            w.key("lagMs"); w.value(st.lagMs);
+            w.key("applyDelayMs"); w.value(st.applyDelayMs);
+            w.key("sinceContactMs"); w.value(st.sinceContactMs);
+            w.key("queuedBytes"); w.value(st.backlogBytes);
+            w.endObject();
+        }
+        else {
+            w.beginObject(4);
+            w.key("role"); w.value("primary");
+            w.key("seq"); w.value(st.seq);
+            w.key("standbys"); w.value(st.followers);
+            w.key(follower ? "promoteMs" : "backlogBytes"); w.value(follower ? st.promoteMs : st.backlogBytes);
+            w.endObject();
+        }
+    });
+    respondEncoded(c, 200, req);
+}
+
+void HttpServer::handleStartup(Connection* c, const HttpRequest& req) {
+    const LogisticsEngine::StartupStats& st = engine.startupStats();
+    encodeBody(body, req.msgpack, [&](auto& w) {
+        w.beginObject(9);
+        w.key("parcels"); w.value(st.parcels);
+        w.key("mapMs"); w.value(st.mapMs);
+        w.key("ridersMs"); w.value(st.ridersMs);
+        w.key("archiveMs"); w.value(st.archiveMs);
+        w.key("snapshotMs"); w.value(st.snapshotMs);
+        w.key("indexMs"); w.value(st.indexMs);
+        w.key("readyMs"); w.value(st.readyMs);
+        w.key("warm"); w.value(engine.isWarm());
+        w.key("warmMs"); w.value(st.warmMs);
+        w.endObject();
+    });
+    respondEncoded(c, 200, req);
+}
+
+void HttpServer::handlePromote(Connection* c, const HttpRequest& req) {
+    if (!follower) {
+        respondError(c, 409, "not a standby", req.keepAlive);
+        return;
+    }
+    bool already = follower->isPromoted();
+    long long ms = follower->promote(engine);
+    ReplicationStatus st = follower->status();
+    encodeBody(body, req.msgpack, [&](auto& w) {
+        w.beginObject(4);
+        w.key("role"); w.value("primary");
+        w.key("alreadyPromoted"); w.value(already);
+        w.key("seq"); w.value(st.seq);
+        w.key("promoteMs"); w.value(ms);
+        w.endObject();
+    });
+    respondEncoded(c, 200, req);
+}
+
+void HttpServer::handleTrack(Connection* c, const HttpRequest& req, string_view id) {
+    Parcel* p = engine.findParcel(id);
+    Parcel* archivedCopy = nullptr;
+    if (!p) p = archivedCopy = engine.loadArchived(id);
+    if (!p) {
+        respondError(c, 404, "tracking id not found", req.keepAlive);
+        return;
+    }
+    long long now = (long long)time(0);
+    encodeBody(body, req.msgpack, [&](auto& w) { writeParcel(w, *p, true, now); });
+    delete archivedCopy;
+    respondEncoded(c, 200, req);
+}
+
+template <class Writer>
+struct ListContext {
+    Writer* w;
+    long long now;
+};
+
+template <class Writer>
+static void writeListEntry(Parcel* p, void* ctx) {
+    ListContext<Writer>* lc = (ListContext<Writer>*)ctx;
+    writeParcel(*lc->w, *p, false, lc->now);
+}
+
+void HttpServer::handleList(Connection* c, const HttpRequest& req) {
+    long long now = (long long)time(0);
+    encodeBody(body, req.msgpack, [&](auto& w) {
+        typedef typename std::remove_reference<decltype(w)>::type Writer;
+        ListContext<Writer> ctx = { &w, now };
+        w.beginObject(1);
+        w.key("parcels");
+        w.beginArray();
+        engine.forEachParcel(writeListEntry<Writer>, &ctx);
+        w.endArray();
+        w.endObject();
+    });
+    respondEncoded(c, 200, req);
+}
+
+void HttpServer::handlePickup(Connection* c, const HttpRequest& req) {
+    string id, dest, weight, priority;
+    if (!requestParam(req, "id", id) || !requestParam(req, "dest", dest) || id.empty()) {
+        respondError(c, 400, "id and dest are required", req.keepAlive);
+        return;
+    }
+    double w = requestParam(req, "weight", weight) ? atof(weight.c_str()) : 1.0;
+    int p = requestParam(req, "priority", priority) ? atoi(priority.c_str()) : 2;
+
+    Parcel* created = nullptr;
+    PickupResult result = engine.addParcel(id, dest, w, p, &created);
+    if (result == PICKUP_UNKNOWN_CITY) {
+        int guess = engine.getMap().suggestCity(dest);
+        body.clear();
+        JsonWriter json(body);
+        json.beginObject();
+        json.key("error"); json.value("destination city not found");
+        if (guess != -1) {
+            json.key("suggestion"); json.value(engine.getMap().cities[guess].name);
+        }
+        json.endObject();
+        respond(c, 400, "application/json", body.view(), req.keepAlive);
+        return;
+    }
+    if (result == PICKUP_DUPLICATE_ID) {
+        respondError(c, 409, "tracking id already exists", req.keepAlive);
+        return;
+    }
+    long long now = (long long)time(0);
+    encodeBody(body, req.msgpack, [&](auto& out) { writeParcel(out, *created, true, now); });
+    respondEncoded(c, 201, req);
+}
+
+void HttpServer::handleDispatch(Connection* c, const HttpRequest& req) {
+    string routeParam;
+    // count=N dispatches a batch that undoes as one unit
+    if (requestParam(req, "count", routeParam)) {
+        int sent = engine.dispatchBatch(atoi(routeParam.c_str()));
+        if (sent == 0) {
+            respondError(c, 409, "nothing to dispatch", req.keepAlive);
+            return;
+        }
+        encodeBody(body, req.msgpack, [&](auto& w) {
+            w.beginObject(1);
+            w.key("dispatched"); w.value(sent);
+            w.endObject();
+        });
+        respondEncoded(c, 200, req);
+        return;
+    }
+    int choice = requestParam(req, "route", routeParam) ? atoi(routeParam.c_str()) : -1;
+    Parcel* p = engine.processNextAuto(choice);
+    if (!p) {
+        respondError(c, 409, "nothing to dispatch", req.keepAlive);
+        return;
+    }
+    long long now = (long long)time(0);
+    encodeBody(body, req.msgpack, [&](auto& w) { writeParcel(w, *p, false, now); });
+    respondEncoded(c, 200, req);
+}
+
+void HttpServer::handleCancel(Connection* c, const HttpRequest& req, string_view id) {
+    Parcel* p = engine.findParcel(id);
+    if (!p) {
+        respondError(c, 404, "tracking id not found", req.keepAlive);
+        return;
+    }
+    if (!engine.tryCancel(id)) {
+        respondError(c, 409, "parcel already left the warehouse", req.keepAlive);
+        return;
+    }
+    long long now = (long long)time(0);
+    encodeBody(body, req.msgpack, [&](auto& w) { writeParcel(w, *p, false, now); });
+    respondEncoded(c, 200, req);
+}
+
+void HttpServer::handleUndo(Connection* c, const HttpRequest& req, bool redo) {
+    int parcels = 0;
+    const char* label = redo ? engine.tryRedo(&parcels) : engine.tryUndo(&parcels);
+    if (!label) {
+        respondError(c, 409, redo ? "nothing to redo" : "nothing to undo", req.keepAlive);
+        return;
+    }
+    encodeBody(body, req.msgpack, [&](auto& w) {
+        w.beginObject(2);
+        w.key(redo ? "redone" : "undone"); w.value(label);
+        w.key("parcels"); w.value(parcels);
+        w.endObject();
+    });
+    respondEncoded(c, 200, req);
+}
+
+void HttpServer::handleRoute(Connection* c, const HttpRequest& req) {
+    MapGraph& map = engine.getMap();
+    string from, to;
+    if (!requestParam(req, "from", from)) from = engine.getHubCity();
+    if (!requestParam(req, "to", to)) {
+        respondError(c, 400, "to is required", req.keepAlive);
+        return;
+    }
+    int start = map.getCityIndex(from);
+    int end = map.getCityIndex(to);
+    if (start == -1 || end == -1) {
+        respondError(c, 404, "unknown city", req.keepAlive);
+        return;
+    }
+
+    double departHour = currentHourOfDay();
+    map.findAllPaths(start, end);
+    int best = engine.recommendedRoute();
+
+    IntArrayList fastestPath;
+    double arrive = map.fastestArrival(start, end, departHour, &fastestPath);
+
+    encodeBody(body, req.msgpack, [&](auto& w) {
+        w.beginObject(arrive >= 0 ? 5 : 4);
+        w.key("from"); w.value(map.cities[start].name);
+        w.key("to"); w.value(map.cities[end].name);
+        w.key("recommended"); w.value(best);
+        w.key("routes");
+        w.beginArray(map.pathCount);
+        for (int i = 0; i < map.pathCount; i++) {
+            w.beginObject(4);
+            w.key("distanceKm"); w.value(map.availablePathDistances[i]);
+            w.key("driveHours"); w.value(map.routeTravelHours(map.availablePaths[i], departHour));
+            w.key("closureRiskKm"); w.value(engine.routeRiskKm(i));
+            w.key("cities"); writeCityList(w, map, map.availablePaths[i]);
+            w.endObject();
+        }
+        w.endArray();
+        if (arrive >= 0) {
+            w.key("fastest");
+            w.beginObject(2);
+            w.key("driveHours"); w.value(arrive - departHour);
+            w.key("cities"); writeCityList(w, map, fastestPath);
+            w.endObject();
+        }
+        w.endObject();
+    });
+    respondEncoded(c, 200, req);
+}
+
+// cities: the k nearest to lat/lon (default 3).
+// parcels: every hot parcel within km (default 25) of lat/lon, or of the
+// road from one city to another
+void HttpServer::handleGeo(Connection* c, const HttpRequest& req, bool parcels) {
+    MapGraph& map = engine.getMap();
+    string latParam, lonParam, from, to, param;
+    bool point = requestParam(req, "lat", latParam) && requestParam(req, "lon", lonParam);
+    int edgeId = -1;
+    if (parcels && requestParam(req, "from", from) && requestParam(req, "to", to)) {
+        int u = map.getCityIndex(from), v = map.getCityIndex(to);
+        edgeId = (u == -1 || v == -1) ? -1 : map.findEdgeId(u, v);
+        if (edgeId == -1) {
+            respondError(c, 404, "no road between those cities", req.keepAlive);
+            return;
+        }
+    }
+    else if (!point) {
+        respondError(c, 400, parcels ? "lat and lon, or from and to, are required" : "lat and lon are required",
+                     req.keepAlive);
+        return;
+    }
+    double lat = atof(latParam.c_str()), lon = atof(lonParam.c_str());
+
+    if (!parcels) {
+        int k = requestParam(req, "k", param) ? atoi(param.c_str()) : 3;
+        if (k < 1) k = 1;
+        if (k > map.cityCount) k = map.cityCount;
+        int* found = new int[k > 0 ? k : 1];
+        double* km = new double[k > 0 ? k : 1];
+        int n = map.nearestCities(lat, lon, k, found, km);
+        encodeBody(body, req.msgpack, [&](auto& w) {
+            w.beginObject(1);
+            w.key("cities");
+            w.beginArray(n);
+            for (int i = 0; i < n; i++) {
+                const CityNode& city = map.cities[found[i]];
+                w.beginObject(5);
+                w.key("name"); w.value(city.name);
+                w.key("zone"); w.value(city.zone);
+                w.key("lat"); w.value(city.lat);
+                w.key("lon"); w.value(city.lon);
+                w.key("km"); w.value(km[i]);
+                w.endObject();
+            }
+            w.endArray();
+            w.endObject();
+        });
+        delete[] found;
+        delete[] km;
+        respondEncoded(c, 200, req);
+        return;
+    }
+
+    double radius = requestParam(req, "km", param) ? atof(param.c_str()) : 25.0;
+    ParcelArrayList hits;
+    if (edgeId >= 0) engine.parcelsNearRoad(edgeId, radius, hits);
+    else engine.parcelsNear(lat, lon, radius, hits);
+    long long now = (long long)time(0);
+    encodeBody(body, req.msgpack, [&](auto& w) {
+        w.beginObject(1);
+        w.key("parcels");
+        w.beginArray(hits.size());
+        for (int i = 0; i < hits.size(); i++) {
+            const Parcel* p = hits[i];
+            double plat = 0, plon = 0;
+            engine.parcelPosition(p, now, plat, plon);
+            w.beginObject(4);
+            w.key("id"); w.value(p->id);
+            w.key("status"); w.value(p->getStatusName());
+            w.key("lat"); w.value(plat);
+            w.key("lon"); w.value(plon);
+            w.endObject();
+        }
+        w.endArray();
+        w.endObject();
+    });
+    respondEncoded(c, 200, req);
+}
+
+// Busiest roads or routes from the engine's running totals (top, default
+// 10); answering never walks the parcels
+void HttpServer::handleAnalytics(Connection* c, const HttpRequest& req, bool routes) {
+    const int MAX_TOP = 100;
+    MapGraph& map = engine.getMap();
+    const RouteAnalytics& analytics = engine.routeAnalytics();
+    string param;
+    int top = requestParam(req, "top", param) ? atoi(param.c_str()) : 10;
+    if (top < 1) top = 1;
+    if (top > MAX_TOP) top = MAX_TOP;
+
+    if (!routes) {
+        int roads[MAX_TOP];
+        int n = analytics.busiestRoads(roads, top);
+        encodeBody(body, req.msgpack, [&](auto& w) {
+            w.beginObject(1);
+            w.key("roads");
+            w.beginArray(n);
+            for (int i = 0; i < n; i++) {
+                RoadStats r = analytics.road(roads[i]);
+                w.beginObject(6);
+                w.key("from"); w.value(map.cities[map.edgeSource(roads[i])].name);
+                w.key("to"); w.value(map.cities[map.getEdge(roads[i]).dest].name);
+                w.key("shipments"); w.value(r.shipments);
+                w.key("closures"); w.value(r.closures);
+                w.key("turnedBack"); w.value(r.disrupted);
+                w.key("closureShare"); w.value(analytics.closureShare(roads[i]));
+                w.endObject();
+            }
+            w.endArray();
+            w.endObject();
+        });
+        respondEncoded(c, 200, req);
+        return;
+    }
+
+    const RouteStats* found[MAX_TOP];
+    int n = analytics.busiestRoutes(found, top);
+    encodeBody(body, req.msgpack, [&](auto& w) {
+        w.beginObject(2);
+        w.key("known"); w.value(analytics.routesKnown());
+        w.key("routes");
+        w.beginArray(n);
+        for (int i = 0; i < n; i++) {
+            const RouteStats& r = *found[i];
+            // Codes outlive map edits in the archive; unknown ids are left out
+            IntArrayList cities, known;
+            decodeRoute(r.code, cities);
+            for (int j = 0; j < cities.size(); j++)
+                if (cities[j] >= 0 && cities[j] < map.cityCount) known.add(cities[j]);
+            w.beginObject(6);
+            w.key("cities"); writeCityList(w, map, known);
+            w.key("shipments"); w.value(r.shipments);
+            w.key("arrived"); w.value(r.arrived);
+            w.key("lost"); w.value(r.lost);
+            w.key("meanRoadSeconds"); w.value(r.arrived > 0 ? (double)r.roadSeconds / r.arrived : 0.0);
+            w.key("rerouted"); w.value(r.blocked);
+            w.endObject();
+        }
+        w.endArray();
+        w.endObject();
+    });
+    respondEncoded(c, 200, req);
+}
+
+// =====================================================
+// Push Feed: status deltas over server-sent events
+// =====================================================
+void HttpServer::onStatusChange(const Parcel& p, int, void* ctx) {
+    ((HttpServer*)ctx)->queueDelta(p);
+}
+
+static unsigned int hashId(string_view id) {
+    unsigned int h = 2166136261u;
+    for (char ch : id) {
+        h ^= (unsigned char)ch;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Records the parcel's latest state; a parcel that changes several times
+// before the next publish keeps only one slot (burst coalescing)
+void HttpServer::queueDelta(const Parcel& p) {
+    if (streamCount == 0) return;   // nobody is listening
+
+    unsigned int mask = (unsigned int)slotCapacity - 1;
+    unsigned int slot = hashId(p.id) & mask;
+    while (deltaSlots[slot] != -1 && deltas[deltaSlots[slot]].id != p.id)
+        slot = (slot + 1) & mask;
+
+    int idx = deltaSlots[slot];
+    if (idx == -1) {
+        if (deltaCount == deltaCapacity) {
+            int newCapacity = deltaCapacity * 2;
+            StatusDelta* grown = new StatusDelta[newCapacity];
+            for (int i = 0; i < deltaCount; i++) grown[i] = std::move(deltas[i]);
+            delete[] deltas;
+            deltas = grown;
+            deltaCapacity = newCapacity;
+
+            // Keep the slot table at half load; rebuild it from the deltas
+            delete[] deltaSlots;
+            slotCapacity = newCapacity * 2;
+            deltaSlots = new int[slotCapacity];
+            for (int i = 0; i < slotCapacity; i++) deltaSlots[i] = -1;
+            mask = (unsigned int)slotCapacity - 1;
+            for (int i = 0; i < deltaCount; i++) {
+                unsigned int s = hashId(deltas[i].id) & mask;
+                while (deltaSlots[s] != -1) s = (s + 1) & mask;
+                deltaSlots[s] = i;
+            }
+            slot = hashId(p.id) & mask;
+            while (deltaSlots[slot] != -1) slot = (slot + 1) & mask;
+        }
+        idx = deltaCount++;
+        deltaSlots[slot] = idx;
+        deltas[idx].id = p.id;
+    }
+
+    StatusDelta& d = deltas[idx];
+    d.zone = p.zone;
+    d.status = p.status;
+    d.statusName = p.getStatusName();
+    d.arrivalTime = p.arrivalTime;
+    const HistoryEvent* latest = p.history->last();
+    d.description = latest ? latest->description : "";
+    d.location = latest ? latest->location : "";
+}
+
+// GET /api/events?id=&zone=&status=1,3 turns the connection into an SSE
+// subscription; every filter is optional and they combine with AND
+void HttpServer::handleEvents(Connection* c, const HttpRequest& req) {
+    string value;
+    c->filterId.clear();
+    c->filterZone.clear();
+    c->statusMask = 0;
+    if (getParam(req.query, "id", value)) c->filterId = value;
+    if (getParam(req.query, "zone", value)) c->filterZone = value;
+    if (getParam(req.query, "status", value)) {
+        size_t pos = 0;
+        while (pos < value.size()) {
+            int s = atoi(value.c_str() + pos);
+            if (s >= 0 && s <= STATUS_CANCELLED) c->statusMask |= 1 << s;
+            size_t comma = value.find(',', pos);
+            if (comma == string::npos) break;
+            pos = comma + 1;
+        }
+    }
+    if (c->statusMask == 0) c->statusMask = ~0;
+
+    c->out +=
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Connection: keep-alive\r\n\r\n"
+        "retry: 2000\n\n";
+    c->streaming = true;
+    c->lagged = false;
+    streamCount++;
+}
+
+// Queues one frame unless the client is too far behind; a slow reader
+// never holds more than MAX_STREAM_BACKLOG of unsent events
+bool HttpServer::appendStreamEvent(Connection* c, string_view event) {
+    if (c->out.size() - c->outSent + event.size() > MAX_STREAM_BACKLOG) {
+        c->lagged = true;
+        return false;
+    }
+    c->out.append(event.data(), event.size());
+    return true;
+}
+
+// Serves the dashboard pages (and their /static/ assets) from the working
+// directory so the frontend can be opened from the engine itself
+bool HttpServer::serveStatic(Connection* c, const HttpRequest& req) {
+    string_view name = req.path;
+    if (name == "/") name = "/dashboard.html";
+    if (name.substr(0, 8) == "/static/") name.remove_prefix(7);
+    name.remove_prefix(1);
+    if (name.empty()) return false;
+
+    for (char ch : name) {
+        bool ok = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') ||
+            ch == '_' || ch == '-' || ch == '.';
+        if (!ok) return false;
+    }
+    if (name.find("..") != string_view::npos) return false;
+
+    const char* type = nullptr;
+    size_t dot = name.rfind('.');
+    string_view ext = (dot == string_view::npos) ? string_view() : name.substr(dot);
+    if (ext == ".html") type = "text/html; charset=utf-8";
+    else if (ext == ".css") type = "text/css";
+    else if (ext == ".js") type = "application/javascript";
+    else return false;
+
+    ifstream f(string(name), ios::binary | ios::ate);
+    if (!f.is_open()) return false;
+    size_t fileSize = (size_t)f.tellg();
+    f.seekg(0);
+    body.clear();
+    f.read(body.reserve(fileSize), (streamsize)fileSize);
+    body.commit((size_t)f.gcount());
+    respond(c, 200, type, body.view(), req.keepAlive);
+    return true;
+}
+
+// Parses and answers every complete request in the input buffer (pipelining)
+bool HttpServer::processInput(Connection* c) {
+    size_t consumed = 0;
+    while (true) {
+        string_view pending(c->in.data() + consumed, c->in.size() - consumed);
+        size_t headerEnd = pending.find("\r\n\r\n");
+        if (headerEnd == string_view::npos) {
+            if (pending.size() > MAX_HEADER_BYTES) return false;
+            break;
+        }
+
+        string_view head = pending.substr(0, headerEnd);
+        size_t lineEnd = head.find("\r\n");
+        string_view requestLine = head.substr(0, lineEnd);
+
+        size_t sp1 = requestLine.find(' ');
+        size_t sp2 = requestLine.rfind(' ');
+        if (sp1 == string_view::npos || sp2 == sp1) return false;
+
+        HttpRequest req;
+        req.method = requestLine.substr(0, sp1);
+        string_view target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+        string_view version = requestLine.substr(sp2 + 1);
+        size_t q = target.find('?');
+        req.path = target.substr(0, q);
+        req.query = (q == string_view::npos) ? string_view() : target.substr(q + 1);
+        req.keepAlive = (version == "HTTP/1.1");
+        req.msgpack = false;
+
+        size_t contentLength = 0;
+        size_t pos = (lineEnd == string_view::npos) ? head.size() : lineEnd + 2;
+        while (pos < head.size()) {
+            size_t eol = head.find("\r\n", pos);
+            if (eol == string_view::npos) eol = head.size();
+            string_view line = head.substr(pos, eol - pos);
+            size_t colon = line.find(':');
+            if (colon != string_view::npos) {
+                string_view key = line.substr(0, colon);
+                string_view value = line.substr(colon + 1);
+                while (!value.empty() && value[0] == ' ') value.remove_prefix(1);
+                if (equalsNoCase(key, "Content-Length")) contentLength = (size_t)atol(string(value).c_str());
+                else if (equalsNoCase(key, "Accept")) {
+                    if (value.find("msgpack") != string_view::npos) req.msgpack = true;
+                }
+                else if (equalsNoCase(key, "Connection")) {
+                    if (equalsNoCase(value, "close")) req.keepAlive = false;
+                    else if (equalsNoCase(value, "keep-alive")) req.keepAlive = true;
+                }
+            }
+            pos = eol + 2;
+        }
+
+        anyOrigin = false;
+        if (contentLength > MAX_BODY_BYTES) {
+            respondError(c, 413, "request body too large", false);
+            c->in.clear();
+            return true;
+        }
+        size_t total = headerEnd + 4 + contentLength;
+        if (pending.size() < total) break;
+
+        req.body = pending.substr(headerEnd + 4, contentLength);
+        string format;
+        if (getParam(req.query, "format", format)) req.msgpack = (format == "msgpack");
+        anyOrigin = (req.method == "GET");
+        route(c, req);
+        consumed += total;
+        if (c->closeAfterWrite) break;
+        if (c->streaming) {
+            consumed = c->in.size();   // subscribers only listen from here on
+            break;
+        }
+    }
+    c->in.erase(0, consumed);
+    return true;
+}
+
+#ifdef __linux__
+// =====================================================
+// HttpServer: epoll Event Loop (Linux)
+// =====================================================
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+HttpServer::~HttpServer() {
+    removeStatusListener(onStatusChange, this);
+    delete[] deltas;
+    delete[] deltaSlots;
+    for (int i = 0; i < connCapacity; i++)
+        if (conns[i]) {
+            close(conns[i]->fd);
+            delete conns[i];
+        }
+    delete[] conns;
+    if (listenFd >= 0) close(listenFd);
+    if (epollFd >= 0) close(epollFd);
+}
+
+bool HttpServer::openListener() {
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) return false;
+
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) return false;
+    addr.sin_port = htons((unsigned short)port);
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0) return false;
+    if (listen(listenFd, 1024) < 0) return false;
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) return false;
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) == 0;
+}
+
+void HttpServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;   // EAGAIN: backlog drained
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (fd >= connCapacity) {
+            int newCapacity = connCapacity > 0 ? connCapacity : 64;
+            while (newCapacity <= fd) newCapacity *= 2;
+            Connection** grown = new Connection * [newCapacity];
+            for (int i = 0; i < newCapacity; i++) grown[i] = (i < connCapacity) ? conns[i] : nullptr;
+            delete[] conns;
+            conns = grown;
+            connCapacity = newCapacity;
+        }
+
+        Connection* c = new Connection();
+        c->fd = fd;
+        c->outSent = 0;
+        c->closeAfterWrite = false;
+        c->wantWrite = false;
+        c->streaming = false;
+        c->lagged = false;
+        c->statusMask = 0;
+        conns[fd] = c;
+
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void HttpServer::closeConnection(Connection* c) {
+    if (c->streaming) streamCount--;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+    close(c->fd);
+    conns[c->fd] = nullptr;
+    delete c;
+}
+
+void HttpServer::updateInterest(Connection* c) {
+    bool pending = c->outSent < c->out.size();
+    if (pending == c->wantWrite) return;
+    c->wantWrite = pending;
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | (pending ? (uint32_t)EPOLLOUT : 0u);
+    ev.data.fd = c->fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+void HttpServer::flush(Connection* c) {
+    while (c->outSent < c->out.size()) {
+        ssize_t n = send(c->fd, c->out.data() + c->outSent, c->out.size() - c->outSent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            closeConnection(c);
+            return;
+        }
+        c->outSent += (size_t)n;
+
+        // A lagging subscriber that has caught up learns it missed events
+        if (c->lagged && c->out.size() - c->outSent < MAX_STREAM_BACKLOG / 2) {
+            c->out += "event: resync\ndata: {}\n\n";
+            c->lagged = false;
+        }
+    }
+
+    if (c->outSent == c->out.size()) {
+        c->out.clear();
+        c->outSent = 0;
+        if (c->closeAfterWrite) {
+            closeConnection(c);
+            return;
+        }
+    }
+    else if (c->outSent >= 65536) {
+        // Long-lived streams never fully drain; drop the sent prefix
+        c->out.erase(0, c->outSent);
+        c->outSent = 0;
+    }
+    updateInterest(c);
+}
+
+void HttpServer::onReadable(Connection* c) {
+    char buf[16384];
+    bool peerClosed = false;
+    while (true) {
+        ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            c->in.append(buf, (size_t)n);
+            continue;
+        }
+        if (n == 0) peerClosed = true;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) peerClosed = true;
+        break;
+    }
+
+    if (!processInput(c)) {
+        closeConnection(c);
+        return;
+    }
+    if (peerClosed && c->out.empty()) {
+        closeConnection(c);
+        return;
+    }
+    if (peerClosed) c->closeAfterWrite = true;
+    flush(c);
+}
+
+static long long monotonicMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Renders each pending delta once and fans it out to matching subscribers
+void HttpServer::publishDeltas() {
+    long long now = (long long)time(0);
+    frames.clear();
+    for (int i = 0; i < deltaCount; i++) {
+        StatusDelta& d = deltas[i];
+        long long eta = (d.status == STATUS_IN_TRANSIT || d.status == STATUS_LOADING) ? d.arrivalTime - now : 0;
+        d.frameStart = frames.size();
+
+        char* p = frames.reserve(48);
+        int n = snprintf(p, 48, "id: %lld\nevent: status\ndata: ", ++eventSeq);
+        frames.commit((size_t)n);
+        JsonWriter w(frames);
+        w.beginObject(7);
+        w.key("id"); w.value(d.id);
+        w.key("status"); w.value(d.status);
+        w.key("statusText"); w.value(d.statusName);
+        w.key("zone"); w.value(d.zone);
+        w.key("event"); w.value(d.description);
+        w.key("location"); w.value(d.location);
+        w.key("etaSeconds"); w.value(eta > 0 ? eta : 0LL);
+        w.endObject();
+        frames.append("\n\n", 2);
+        d.frameLen = frames.size() - d.frameStart;
+    }
+
+    for (int fd = 0; fd < connCapacity; fd++) {
+        Connection* c = conns[fd];
+        if (!c || !c->streaming) continue;
+
+        size_t before = c->out.size();
+        for (int i = 0; i < deltaCount; i++) {
+            const StatusDelta& d = deltas[i];
+            if (!(c->statusMask & (1 << d.status))) continue;
+            if (!c->filterId.empty() && c->filterId != d.id) continue;
+            if (!c->filterZone.empty() && !equalsNoCase(c->filterZone, d.zone)) continue;
+            if (!appendStreamEvent(c, string_view(frames.data() + d.frameStart, d.frameLen))) break;
+        }
+        if (c->out.size() != before) flush(c);
+    }
+
+    for (int i = 0; i < slotCapacity; i++) deltaSlots[i] = -1;
+    deltaCount = 0;
+}
+
+// SSE comment line so idle proxies keep the stream open
+void HttpServer::sendHeartbeat() {
+    for (int fd = 0; fd < connCapacity; fd++) {
+        Connection* c = conns[fd];
+        if (c && c->streaming && appendStreamEvent(c, ": ping\n\n")) flush(c);
+    }
+}
+
+bool HttpServer::run() {
+    if (!openListener()) {
+        cerr << "swiftex: cannot listen on " << host << ":" << port << "\n";
+        return false;
+    }
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (follower) {
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = follower->notifyFd();
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, ev.data.fd, &ev);
+    }
+
+    cerr << "swiftex: API server listening on http://" << host << ":" << port << "/\n";
+    addStatusListener(onStatusChange, this);
+    running = true;
+    epoll_event events[256];
+
+    while (running && !stopRequested) {
+        int n = epoll_wait(epollFd, events, 256, deltaCount > 0 ? (int)PUSH_INTERVAL_MS : 250);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            if (follower && fd == follower->notifyFd()) {
+                follower->applyPending(engine);
+                continue;
+            }
+            Connection* c = (fd < connCapacity) ? conns[fd] : nullptr;
+            if (!c) continue;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(c);
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                onReadable(c);
+                c = conns[fd];
+                if (!c) continue;
+            }
+            if (events[i].events & EPOLLOUT) flush(c);
+        }
+
+        // Drive the parcel lifecycle once a second, as the console loop does
+        long long now = (long long)time(0);
+        if (now != lastTick) {
+            lastTick = now;
+            engine.updateRealTime();
+        }
+
+        long long nowMs = monotonicMs();
+        if (deltaCount > 0 && nowMs - lastPushMs >= PUSH_INTERVAL_MS) {
+            lastPushMs = nowMs;
+            publishDeltas();
+        }
+        if (streamCount > 0 && now - lastHeartbeat >= HEARTBEAT_SECONDS) {
+            lastHeartbeat = now;
+            sendHeartbeat();
+        }
+    }
+    removeStatusListener(onStatusChange, this);
+    running = false;
+    return true;
+}
+
+void HttpServer::stop() {
+    running = false;
+}
+
+#else
+
+HttpServer::~HttpServer() {
+    delete[] deltas;
+    delete[] deltaSlots;
+}
+
+bool HttpServer::run() {
+    cerr << "swiftex: the API server needs Linux (epoll); not available on this platform\n";
+    return false;
+}
+
+void HttpServer::stop() {}
+
+#endif
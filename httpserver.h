@@ -0,0 +1,135 @@
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <string>
+#include <string_view>
+#include "logisticsengine.h"
+#include "serializer.h"
+
+class ReplicationPublisher;
+class ReplicationFollower;
+
+// Parsed view of one HTTP/1.1 request; all views point into the
+// connection's input buffer and are only valid while it is handled
+struct HttpRequest {
+    std::string_view method;
+    std::string_view path;
+    std::string_view query;
+    std::string_view body;
+    bool keepAlive;
+    bool msgpack;            // ?format=msgpack or Accept: application/msgpack
+};
+
+// One coalesced status change waiting to be pushed; a snapshot, so it
+// stays valid even if the parcel is gone by the time it is published
+struct StatusDelta {
+    std::string id;
+    std::string zone;
+    std::string description;
+    std::string location;
+    const char* statusName;
+    int status;
+    long long arrivalTime;
+    size_t frameStart;       // rendered SSE frame inside HttpServer::frames
+    size_t frameLen;
+};
+
+// Embedded JSON API over the live engine.
+// Single-threaded and event driven: one epoll loop owns every socket
+// (non-blocking, HTTP/1.1 keep-alive, pipelined requests) and also drives
+// the engine's real-time lifecycle tick, so the engine is never shared
+// between threads. Linux only; other platforms report it as unavailable.
+class HttpServer {
+private:
+    struct Connection {
+        int fd;
+        std::string in;
+        std::string out;
+        size_t outSent;
+        bool closeAfterWrite;
+        bool wantWrite;
+
+        // Server-sent events subscription (GET /api/events)
+        bool streaming;
+        bool lagged;             // events were dropped; owes the client a resync
+        std::string filterId;
+        std::string filterZone;
+        int statusMask;          // bit per STATUS_* value
+    };
+
+    LogisticsEngine& engine;
+    ReplicationPublisher* publisher;   // set on a primary that has standbys
+    ReplicationFollower* follower;     // set on a standby
+    std::string host;        // IPv4 address to listen on
+    int port;
+    int listenFd;
+    int epollFd;
+    bool running;
+    long long lastTick;
+    bool anyOrigin;          // the request being answered is a GET; any site may read it
+
+    Connection** conns;      // indexed by fd
+    int connCapacity;
+
+    OutBuffer body;          // reused response body buffer
+    OutBuffer frames;        // SSE frames rendered by the current publish
+
+    // Pending push events, one slot per parcel id (later changes overwrite)
+    StatusDelta* deltas;
+    int deltaCount;
+    int deltaCapacity;
+    int* deltaSlots;         // open-addressed id hash -> index into deltas
+    int slotCapacity;
+    long long eventSeq;
+    long long lastPushMs;
+    long long lastHeartbeat;
+    int streamCount;
+
+    static void onStatusChange(const Parcel& p, int oldStatus, void* ctx);
+    void queueDelta(const Parcel& p);
+    void publishDeltas();
+    void sendHeartbeat();
+    bool appendStreamEvent(Connection* c, std::string_view event);
+
+    bool openListener();
+    void acceptClients();
+    void onReadable(Connection* c);
+    void flush(Connection* c);
+    void closeConnection(Connection* c);
+    void updateInterest(Connection* c);
+
+    // Returns false on a malformed request (the connection is then closed)
+    bool processInput(Connection* c);
+    void route(Connection* c, const HttpRequest& req);
+    void respond(Connection* c, int code, const char* contentType, std::string_view payload, bool keepAlive);
+    void respondEncoded(Connection* c, int code, const HttpRequest& req);
+    void respondError(Connection* c, int code, const char* message, bool keepAlive);
+    bool serveStatic(Connection* c, const HttpRequest& req);
+
+    void handleTrack(Connection* c, const HttpRequest& req, std::string_view id);
+    void handleList(Connection* c, const HttpRequest& req);
+    void handlePickup(Connection* c, const HttpRequest& req);
+    void handleDispatch(Connection* c, const HttpRequest& req);
+    void handleCancel(Connection* c, const HttpRequest& req, std::string_view id);
+    void handleUndo(Connection* c, const HttpRequest& req, bool redo);
+    void handleRoute(Connection* c, const HttpRequest& req);
+    void handleGeo(Connection* c, const HttpRequest& req, bool parcels);
+    void handleAnalytics(Connection* c, const HttpRequest& req, bool routes);
+    void handleEvents(Connection* c, const HttpRequest& req);
+    void handleReplication(Connection* c, const HttpRequest& req);
+    void handlePromote(Connection* c, const HttpRequest& req);
+    void handleStartup(Connection* c, const HttpRequest& req);
+public:
+    // Listens on the loopback interface unless given another address; the
+    // API has no authentication, so exposing it is an explicit choice
+    HttpServer(LogisticsEngine& e, int listenPort, const std::string& listenHost = "127.0.0.1");
+    ~HttpServer();
+    // Either may be nullptr. A standby serves reads from its replica and
+    // refuses changes until promoted (POST /api/promote).
+    void setReplication(ReplicationPublisher* pub, ReplicationFollower* fol);
+    // Blocks until stop() or SIGINT; false if the address could not be opened
+    bool run();
+    void stop();
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include "hubcluster.h"
+#include <iostream>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+// Queue sizes: orders from the submitters, and parcels between each pair of
+// hubs. A full handoff queue is not an error; the sender keeps the parcel
+// in its backlog and tries again next loop.
+const size_t ORDER_QUEUE_SIZE = 4096;
+const size_t HANDOFF_QUEUE_SIZE = 1024;
+
+// Dispatches per loop before the shard looks at its queues again, and the
+// engine clock (lifecycle, archive sweep, filter rebuild) interval: once a
+// second, like the API server, since the lifecycle odds are per tick
+const int DISPATCH_BURST = 64;
+const long long TICK_MILLIS = 1000;
+
+static long long nowMillis() {
+    return chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// False if src does not fit; a shortened ID would name another parcel
+static bool copyField(char* dst, size_t cap, string_view src) {
+    if (src.size() >= cap) return false;
+    memcpy(dst, src.data(), src.size());
+    dst[src.size()] = '\0';
+    return true;
+}
+
+// =====================================================
+// HubCluster Implementation (One Engine Shard per Zone)
+// =====================================================
+HubCluster::Shard::Shard(HubCluster* owner, int idx, string_view hubCity, string_view hubZone,
+                         const string& dir)
+    : cluster(owner), index(idx), city(hubCity), zone(hubZone), dataDir(dir), engine(nullptr),
+      orders(ORDER_QUEUE_SIZE), backlogCount(0), pickups(0), rejected(0), dispatched(0),
+      handedOut(0), received(0), hotParcels(0), ready(false), quiet(false) {
+    for (int i = 0; i < MAX_HUBS; i++) {
+        inbound[i] = nullptr;
+        backlog[i] = nullptr;
+    }
+}
+
+HubCluster::Shard::~Shard() {
+    for (int i = 0; i < MAX_HUBS; i++) {
+        delete inbound[i];
+        delete backlog[i];
+    }
+}
+
+HubCluster::HubCluster(const string& dataDir)
+    : shardCount(0), baseDir(dataDir), retentionSeconds(-1), idFalsePositiveRate(0),
+      roadEventPercent(-1), stopTicking(false), exiting(false), running(false) {
+    for (int i = 0; i < MAX_HUBS; i++) shards[i] = nullptr;
+}
+
+HubCluster::~HubCluster() {
+    stop();
+    for (int i = 0; i < shardCount; i++) delete shards[i];
+}
+
+int HubCluster::addHub(string_view city, string_view zone) {
+    if (running || shardCount >= MAX_HUBS) return -1;
+    string dir = baseDir + "/hub-";
+    for (char c : zone) dir += (c == ' ') ? '-' : c;
+    shards[shardCount] = new Shard(this, shardCount, city, zone, dir);
+    return shardCount++;
+}
+
+void HubCluster::addDefaultHubs() {
+    addHub("Lahore", "Zone A");
+    addHub("Islamabad", "Zone B");
+    addHub("Karachi", "Zone C");
+    addHub("Quetta", "Zone D");
+}
+
+void HubCluster::setRetention(long long seconds) {
+    retentionSeconds = seconds;
+}
+
+void HubCluster::setIdFalsePositiveRate(double rate) {
+    idFalsePositiveRate = rate;
+}
+
+void HubCluster::setRoadEventRate(int percent) {
+    roadEventPercent = percent;
+}
+
+void HubCluster::setDispatchPolicy(const DispatchPolicy& policy) {
+    dispatchPolicy = policy;
+}
+
+int HubCluster::shardForZone(const string& zone) const {
+    for (int i = 0; i < shardCount; i++)
+        if (shards[i]->zone == zone) return i;
+    return -1;
+}
+
+// Hub names never change once the cluster runs, so any shard may read them
+const char* HubCluster::hubForZone(const string& zone, void* ctx) {
+    Shard* s = (Shard*)ctx;
+    int target = s->cluster->shardForZone(zone);
+    return target >= 0 ? s->cluster->shards[target]->city.c_str() : nullptr;
+}
+
+// Called from the sending shard's engine tick. Only the sender writes its
+// own queue into each peer, which is what keeps every queue single-producer.
+void HubCluster::handOff(Parcel* p, void* ctx) {
+    Shard* s = (Shard*)ctx;
+    int target = s->cluster->shardForZone(p->zone);
+    s->handedOut.fetch_add(1, memory_order_relaxed);
+    if (s->backlogCount == 0 && s->cluster->shards[target]->inbound[s->index]->push(p)) return;
+
+    if (!s->backlog[target]) s->backlog[target] = new ParcelArrayList();
+    s->backlog[target]->add(p);
+    s->backlogCount++;
+}
+
+// Oldest first; stops at the first queue that is still full
+bool HubCluster::pushBacklog(Shard* s) {
+    bool moved = false;
+    for (int t = 0; t < s->cluster->shardCount && s->backlogCount > 0; t++) {
+        ParcelArrayList* list = s->backlog[t];
+        if (!list || list->isEmpty()) continue;
+        SpscQueue<Parcel*>* q = s->cluster->shards[t]->inbound[s->index];
+        int sent = 0;
+        while (sent < list->size() && q->push(list->get(sent))) sent++;
+        if (sent == 0) continue;
+
+        int left = list->size() - sent;
+        for (int i = 0; i < left; i++) list->set(i, list->get(i + sent));
+        for (int i = 0; i < sent; i++) list->removeLast();
+        s->backlogCount -= sent;
+        moved = true;
+    }
+    return moved;
+}
+
+bool HubCluster::drainInbound(Shard* s) {
+    bool any = false;
+    Parcel* p;
+    for (int src = 0; src < s->cluster->shardCount; src++) {
+        SpscQueue<Parcel*>* q = s->inbound[src];
+        if (!q) continue;
+        while (q->pop(p)) {
+            s->engine->adoptParcel(p);
+            s->received.fetch_add(1, memory_order_relaxed);
+            any = true;
+        }
+    }
+    return any;
+}
+
+bool HubCluster::drainOrders(Shard* s) {
+    bool any = false;
+    PickupOrder o;
+    while (s->orders.pop(o)) {
+        if (s->engine->addParcel(o.id, o.destination, o.weight, o.priority) == PICKUP_OK)
+            s->pickups.fetch_add(1, memory_order_relaxed);
+        else
+            s->rejected.fetch_add(1, memory_order_relaxed);
+        any = true;
+    }
+    return any;
+}
+
+void HubCluster::workerLoop(Shard* s) {
+    HubCluster* c = s->cluster;
+    // Built here so the engine's status listeners register on this thread
+    // (they are per thread; see addStatusListener)
+    ostream quietConsole(nullptr);
+    s->engine = new LogisticsEngine(s->dataDir, s->zone);
+    LogisticsEngine::HubLink link = { hubForZone, handOff, s };
+    s->engine->setHub(s->city, link);
+    s->engine->setConsole(quietConsole);
+    if (c->retentionSeconds >= 0) s->engine->setRetention(c->retentionSeconds);
+    if (c->idFalsePositiveRate > 0) s->engine->setIdFalsePositiveRate(c->idFalsePositiveRate);
+    if (c->roadEventPercent >= 0) s->engine->setRoadEventRate(c->roadEventPercent);
+    s->engine->setDispatchPolicy(c->dispatchPolicy);
+    s->hotParcels.store(s->engine->parcelCount(), memory_order_relaxed);
+    s->ready.store(true, memory_order_release);
+
+    long long lastTick = nowMillis();
+    while (!c->exiting.load(memory_order_acquire)) {
+        bool busy = drainOrders(s);
+        busy |= drainInbound(s);
+        if (s->backlogCount > 0) busy |= pushBacklog(s);
+
+        for (int i = 0; i < DISPATCH_BURST && s->engine->processNextAuto(); i++) {
+            s->dispatched.fetch_add(1, memory_order_relaxed);
+            busy = true;
+        }
+
+        if (!c->stopTicking.load(memory_order_acquire)) {
+            long long now = nowMillis();
+            if (now - lastTick >= TICK_MILLIS) {
+                lastTick = now;
+                s->engine->updateRealTime();
+            }
+        }
+        // With the clock stopped nothing new leaves for another hub; once
+        // the backlog is out this shard sends nothing more
+        else if (s->backlogCount == 0 && !s->quiet.load(memory_order_relaxed)) {
+            s->quiet.store(true, memory_order_release);
+        }
+
+        s->hotParcels.store(s->engine->parcelCount(), memory_order_relaxed);
+        if (!busy) this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    // Every sender is quiet, so what is in the queues now is all there is
+    drainOrders(s);
+    drainInbound(s);
+    s->engine->saveToFile();
+    s->hotParcels.store(s->engine->parcelCount(), memory_order_relaxed);
+    delete s->engine;   // the store's writer finishes its queue first
+    s->engine = nullptr;
+}
+
+void HubCluster::start() {
+    if (running || shardCount == 0) return;
+    for (int i = 0; i < shardCount; i++)
+        for (int src = 0; src < shardCount; src++)
+            if (src != i) shards[i]->inbound[src] = new SpscQueue<Parcel*>(HANDOFF_QUEUE_SIZE);
+
+    stopTicking.store(false);
+    exiting.store(false);
+    running = true;
+    for (int i = 0; i < shardCount; i++) shards[i]->worker = thread(workerLoop, shards[i]);
+    // Orders may be queued right away, but callers expect the hubs' loaded
+    // inventory to be in place when start() returns
+    for (int i = 0; i < shardCount; i++)
+        while (!shards[i]->ready.load(memory_order_acquire)) this_thread::sleep_for(chrono::milliseconds(1));
+}
+
+bool HubCluster::submitPickup(string_view originHub, string_view id, string_view dest,
+                              double weight, int priority) {
+    for (int i = 0; i < shardCount; i++) {
+        if (shards[i]->city != originHub) continue;
+        PickupOrder o;
+        if (!copyField(o.id, sizeof(o.id), id) || !copyField(o.destination, sizeof(o.destination), dest)) {
+            shards[i]->rejected.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+        o.weight = weight;
+        o.priority = priority;
+        return shards[i]->orders.push(o);
+    }
+    return false;
+}
+
+void HubCluster::stop() {
+    if (!running) return;
+    stopTicking.store(true, memory_order_release);
+    for (int i = 0; i < shardCount; i++)
+        while (!shards[i]->quiet.load(memory_order_acquire)) this_thread::sleep_for(chrono::milliseconds(1));
+
+    exiting.store(true, memory_order_release);
+    for (int i = 0; i < shardCount; i++) shards[i]->worker.join();
+    running = false;
+}
+
+const string& HubCluster::hubCity(int hub) const {
+    return shards[hub]->city;
+}
+
+const string& HubCluster::hubZone(int hub) const {
+    return shards[hub]->zone;
+}
+
+HubCluster::HubStats HubCluster::stats(int hub) const {
+    const Shard* s = shards[hub];
+    HubStats st;
+    st.pickups = s->pickups.load(memory_order_relaxed);
+    st.rejected = s->rejected.load(memory_order_relaxed);
+    st.dispatched = s->dispatched.load(memory_order_relaxed);
+    st.handedOut = s->handedOut.load(memory_order_relaxed);
+    st.received = s->received.load(memory_order_relaxed);
+    st.hotParcels = s->hotParcels.load(memory_order_relaxed);
+    return st;
+}
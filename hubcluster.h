@@ -0,0 +1,123 @@
+#ifndef HUBCLUSTER_H
+#define HUBCLUSTER_H
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include "logisticsengine.h"
+#include "spscqueue.h"
+#include "mpmcqueue.h"
+
+// Several hubs run side by side, one LogisticsEngine per zone. Each shard
+// owns its engine outright (hash table, sorting queue, riders, map, store)
+// and drives it from its own thread, so no engine state is ever shared or
+// locked. Shards talk only through lock-free queues: pickup orders come
+// in from any submitting thread, and a parcel bound for another zone
+// rides to that zone's hub, then moves over through the destination
+// shard's inbound queue for the source shard.
+//
+// Tracking IDs are checked for duplicates per hub; keeping them unique
+// across hubs is up to whoever issues them.
+class HubCluster {
+public:
+    static const int MAX_HUBS = 8;
+
+    struct HubStats {
+        long long pickups;      // accepted orders
+        long long rejected;     // unknown destination, duplicate ID, or a field too long
+        long long dispatched;
+        long long handedOut;    // parcels passed on to another hub
+        long long received;     // parcels taken over from another hub
+        int hotParcels;
+    };
+
+private:
+    struct PickupOrder {
+        char id[32];
+        char destination[32];
+        double weight;
+        int priority;
+    };
+
+    struct Shard {
+        HubCluster* cluster;
+        int index;
+        std::string city;
+        std::string zone;
+        std::string dataDir;
+        LogisticsEngine* engine;        // created, used and freed on the worker
+        MpmcQueue<PickupOrder> orders;
+        SpscQueue<Parcel*>* inbound[MAX_HUBS];   // inbound[src]: from shard src
+        ParcelArrayList* backlog[MAX_HUBS];      // handoffs waiting for room
+        int backlogCount;
+        std::thread worker;
+
+        std::atomic<long long> pickups;
+        std::atomic<long long> rejected;
+        std::atomic<long long> dispatched;
+        std::atomic<long long> handedOut;
+        std::atomic<long long> received;
+        std::atomic<int> hotParcels;
+        std::atomic<bool> ready;
+        std::atomic<bool> quiet;        // acknowledged the stop, nothing in flight
+
+        Shard(HubCluster* owner, int idx, std::string_view hubCity, std::string_view hubZone,
+              const std::string& dir);
+        ~Shard();
+    };
+
+    Shard* shards[MAX_HUBS];
+    int shardCount;
+    std::string baseDir;
+    long long retentionSeconds;     // < 0: engine default
+    double idFalsePositiveRate;     // <= 0: engine default
+    int roadEventPercent;           // < 0: engine default
+    DispatchPolicy dispatchPolicy;
+    std::atomic<bool> stopTicking;
+    std::atomic<bool> exiting;
+    bool running;
+
+    static void workerLoop(Shard* s);
+    static const char* hubForZone(const std::string& zone, void* ctx);
+    static void handOff(Parcel* p, void* ctx);
+    static bool drainInbound(Shard* s);
+    static bool drainOrders(Shard* s);
+    static bool pushBacklog(Shard* s);
+    int shardForZone(const std::string& zone) const;
+
+public:
+    HubCluster(const std::string& dataDir = "parcels.d");
+    ~HubCluster();
+    HubCluster(const HubCluster&) = delete;
+    HubCluster& operator=(const HubCluster&) = delete;
+
+    // Before start(): one hub per zone, dispatching from city. Each keeps
+    // its data in <dataDir>/hub-<zone>. Returns the hub index, or -1.
+    int addHub(std::string_view city, std::string_view zone);
+    // Lahore, Islamabad, Karachi and Quetta for zones A to D
+    void addDefaultHubs();
+    // Applied to every shard's engine; call before start()
+    void setRetention(long long seconds);
+    void setIdFalsePositiveRate(double rate);
+    void setRoadEventRate(int percent);
+    void setDispatchPolicy(const DispatchPolicy& policy);
+
+    void start();
+    // Safe from any number of threads. Queues a pickup at the named hub city;
+    // false if there is no such hub or its order queue is full (retry later).
+    // An ID or destination that does not fit an order is never cut short:
+    // the order is counted as rejected at that hub instead.
+    bool submitPickup(std::string_view originHub, std::string_view id, std::string_view dest,
+                      double weight, int priority);
+    // Stops the engines' clocks, waits until no parcel is between hubs,
+    // then lets every shard take in what is left, save and shut down
+    void stop();
+
+    int hubCount() const { return shardCount; }
+    const std::string& hubCity(int hub) const;
+    const std::string& hubZone(int hub) const;
+    HubStats stats(int hub) const;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "loadgen.h"
+#include <cmath>
+
+using namespace std;
+
+// =====================================================
+// ZipfGenerator Implementation (rejection-inversion)
+// =====================================================
+
+// log(1 + x) / x and (exp(x) - 1) / x, by series near 0 where the direct
+// forms lose every digit
+static double log1pOverX(double x) {
+    if (fabs(x) > 1e-8) return log1p(x) / x;
+    return 1 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+static double expm1OverX(double x) {
+    if (fabs(x) > 1e-8) return expm1(x) / x;
+    return 1 + x * 0.5 * (1 + x * (1.0 / 3.0) * (1 + 0.25 * x));
+}
+
+ZipfGenerator::ZipfGenerator(double s) : exponent(s > 0 ? s : 1e-9) {
+    hIntegralX1 = hIntegral(1.5) - 1;
+    squeeze = 2 - hIntegralInverse(hIntegral(2.5) - h(2));
+}
+
+// The density 1 / x^exponent, its integral, and the integral's inverse
+double ZipfGenerator::h(double x) const {
+    return exp(-exponent * log(x));
+}
+
+double ZipfGenerator::hIntegral(double x) const {
+    double logX = log(x);
+    return expm1OverX((1 - exponent) * logX) * logX;
+}
+
+double ZipfGenerator::hIntegralInverse(double x) const {
+    double t = x * (1 - exponent);
+    if (t < -1) t = -1;   // rounding; the true value is never below -1
+    return exp(log1pOverX(t) * x);
+}
+
+// A point drawn uniformly under the continuous density is rounded to the
+// nearest rank and kept if it also falls under that rank's bar; well over
+// nine draws in ten are kept on the first try
+int ZipfGenerator::next(int n, FastRandom& rng) const {
+    if (n <= 1) return 1;
+    double hIntegralN = hIntegral(n + 0.5);
+    while (true) {
+        double u = hIntegralN + rng.unit() * (hIntegralX1 - hIntegralN);
+        double x = hIntegralInverse(u);
+        int k = (int)(x + 0.5);
+        if (k < 1) k = 1;
+        else if (k > n) k = n;
+        if (k - x <= squeeze || u >= hIntegral(k + 0.5) - h(k)) return k;
+    }
+}
+
+// =====================================================
+// LatencyHistogram Implementation (log-linear buckets)
+// =====================================================
+LatencyHistogram::LatencyHistogram() : total(0), sum(0), largest(0) {
+    for (int i = 0; i < BUCKETS; i++) buckets[i] = 0;
+}
+
+// Values under 2^SUB_BITS get a bucket each; above that, the bucket is the
+// position of the top bit and the SUB_BITS bits just below it
+int LatencyHistogram::bucketOf(long long nanos) {
+    if (nanos < (1LL << SUB_BITS)) return nanos < 0 ? 0 : (int)nanos;
+    int top = 0;
+    for (unsigned long long v = (unsigned long long)nanos; v > 1; v >>= 1) top++;
+    int shift = top - SUB_BITS;
+    return ((shift + 1) << SUB_BITS) + (int)((nanos >> shift) & ((1 << SUB_BITS) - 1));
+}
+
+long long LatencyHistogram::bucketTop(int b) {
+    if (b < (1 << SUB_BITS)) return b;
+    int shift = (b >> SUB_BITS) - 1;
+    long long low = (long long)((1 << SUB_BITS) + (b & ((1 << SUB_BITS) - 1))) << shift;
+    return low + (1LL << shift) - 1;
+}
+
+void LatencyHistogram::record(long long nanos) {
+    buckets[bucketOf(nanos)]++;
+    total++;
+    sum += nanos;
+    if (nanos > largest) largest = nanos;
+}
+
+long long LatencyHistogram::count() const {
+    return total;
+}
+
+long long LatencyHistogram::totalNanos() const {
+    return sum;
+}
+
+double LatencyHistogram::meanNanos() const {
+    return total > 0 ? (double)sum / total : 0;
+}
+
+long long LatencyHistogram::maxNanos() const {
+    return largest;
+}
+
+long long LatencyHistogram::percentile(double q) const {
+    if (total == 0) return 0;
+    long long rank = (long long)ceil(q * total);
+    if (rank < 1) rank = 1;
+    long long seen = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            long long top = bucketTop(b);
+            return top < largest ? top : largest;
+        }
+    }
+    return largest;
+}
@@ -0,0 +1,57 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include "../fastrandom.h"
+
+// Dice for the workload are FastRandom (xorshift64*), a few cycles a draw,
+// so choosing the next operation stays out of the latencies being measured
+
+// Zipf-distributed ranks in [1, n]: rank k comes up in proportion to
+// 1 / k^exponent. Drawn by rejection-inversion (Hormann and Derflinger),
+// which needs no table, so n may change between draws - the set of issued
+// tracking IDs grows as the run goes on.
+class ZipfGenerator {
+private:
+    double exponent;
+    double hIntegralX1;     // hIntegral(1.5) - 1
+    double squeeze;         // accept without the second test within this of x
+
+    double h(double x) const;
+    double hIntegral(double x) const;
+    double hIntegralInverse(double x) const;
+public:
+    explicit ZipfGenerator(double exponent);
+    int next(int n, FastRandom& rng) const;
+};
+
+// Log-linear latency histogram in nanoseconds: exact below 32 ns, then 32
+// buckets per power of two, so a percentile is within about 3% of the
+// true value whatever the range. Recording is an increment.
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 5;
+    static const int BUCKETS = 64 << SUB_BITS;
+
+private:
+    long long buckets[BUCKETS];
+    long long total;
+    long long sum;
+    long long largest;
+
+    static int bucketOf(long long nanos);
+    // Highest value that lands in bucket b
+    static long long bucketTop(int b);
+
+public:
+    LatencyHistogram();
+    void record(long long nanos);
+    long long count() const;
+    long long totalNanos() const;
+    double meanNanos() const;
+    long long maxNanos() const;
+    // The latency a fraction q (0..1) of the samples stayed within,
+    // rounded up to the top of its bucket
+    long long percentile(double q) const;
+};
+
+#endif
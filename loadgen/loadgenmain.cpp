@@ -0,0 +1,312 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include "loadgen.h"
+#include "../logisticsengine.h"
+#include "../nullbuffer.h"
+
+using namespace std;
+
+// The engine links against the console's clearScreen(); the load generator
+// never clears
+void clearScreen() {}
+
+// =====================================================
+// End-to-End Load Generator
+// =====================================================
+
+enum LoadOp { OP_PICKUP, OP_DISPATCH, OP_TRACK, OP_CANCEL, OP_UNDO, OP_TICK, OP_COUNT };
+static const char* const OP_NAMES[OP_COUNT] = { "pickup", "dispatch", "track", "cancel", "undo", "tick" };
+// The five that --mix weighs; ticks run on their own clock (--tick)
+const int MIXED_OPS = 5;
+
+// One tracking lookup in twenty asks for an ID that was never issued (a
+// typo, a scan), which is what the known-ID filter is there for
+const int UNKNOWN_TRACK_PERCENT = 5;
+
+struct LoadOptions {
+    long long ops = 200000;
+    int preload = 10000;
+    int mix[MIXED_OPS] = { 40, 15, 35, 5, 5 };
+    double zipf = 0.99;
+    unsigned long long seed = 42;
+    int tickEvery = 1000;
+    int roadEvents = -1;
+    long long retention = -1;
+    string dir = "loadgen.d";
+};
+
+// Left in every directory the load generator makes; only a directory that
+// has it (or holds nothing) is ever emptied
+static const char* const DIR_MARKER = ".swiftex-loadgen";
+
+// A fresh directory each run, so every run starts from the same state.
+// Refuses a path that exists and was not made here: --dir pointed at the
+// wrong place must not wipe it.
+static bool prepareDirectory(const string& dir) {
+    error_code ec;
+    filesystem::path marker = filesystem::path(dir) / DIR_MARKER;
+    if (filesystem::exists(dir, ec)) {
+        if (!filesystem::is_directory(dir, ec)) {
+            cerr << "swiftex-loadgen: " << dir << " is not a directory\n";
+            return false;
+        }
+        if (!filesystem::exists(marker, ec) && !filesystem::is_empty(dir, ec)) {
+            cerr << "swiftex-loadgen: " << dir << " is not empty and was not made by swiftex-loadgen; "
+                 << "refusing to empty it\n";
+            return false;
+        }
+        filesystem::remove_all(dir, ec);
+    }
+    filesystem::create_directories(dir, ec);
+    if (ec) {
+        cerr << "swiftex-loadgen: cannot create " << dir << "\n";
+        return false;
+    }
+    ofstream(marker).put('\n');
+    return true;
+}
+
+static void usage() {
+    cout << "usage: swiftex-loadgen [options]\n"
+         << "  --ops <n>             operations to run (200000)\n"
+         << "  --preload <n>         pickups logged before the clock starts (10000)\n"
+         << "  --mix <p,d,t,c,u>     weights of pickup, dispatch, track, cancel, undo (40,15,35,5,5)\n"
+         << "  --zipf <s>            skew of destinations and of which parcels are asked about (0.99)\n"
+         << "  --seed <n>            workload seed (42)\n"
+         << "  --tick <n>            run the engine's clock every n operations (1000; 0: never)\n"
+         << "  --road-events <pct>   chance a dispatch meets a road block (engine default)\n"
+         << "  --retention <secs>    how long finished parcels stay hot (engine default)\n"
+         << "  --dir <path>          scratch data directory, emptied first (loadgen.d); must be\n"
+         << "                        missing, empty, or one an earlier run made\n";
+}
+
+static bool parseMix(const char* text, int* mix) {
+    int total = 0;
+    for (int i = 0; i < MIXED_OPS; i++) {
+        char* end;
+        long v = strtol(text, &end, 10);
+        if (end == text || v < 0) return false;
+        mix[i] = (int)v;
+        total += mix[i];
+        text = end;
+        if (i + 1 < MIXED_OPS) {
+            if (*text != ',') return false;
+            text++;
+        }
+    }
+    return *text == '\0' && total > 0;
+}
+
+static bool parseOptions(int argc, char** argv, LoadOptions& o) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) return false;
+        const char* flag = argv[i];
+        const char* value = argv[i + 1];
+        if (strcmp(flag, "--ops") == 0) o.ops = atoll(value);
+        else if (strcmp(flag, "--preload") == 0) o.preload = atoi(value);
+        else if (strcmp(flag, "--mix") == 0) {
+            if (!parseMix(value, o.mix)) return false;
+        }
+        else if (strcmp(flag, "--zipf") == 0) o.zipf = atof(value);
+        else if (strcmp(flag, "--seed") == 0) o.seed = strtoull(value, nullptr, 10);
+        else if (strcmp(flag, "--tick") == 0) o.tickEvery = atoi(value);
+        else if (strcmp(flag, "--road-events") == 0) o.roadEvents = atoi(value);
+        else if (strcmp(flag, "--retention") == 0) o.retention = atoll(value);
+        else if (strcmp(flag, "--dir") == 0) o.dir = value;
+        else return false;
+    }
+    return o.ops > 0 && o.preload >= 0;
+}
+
+// Tracking IDs are issued in sequence; the newest parcels are the ones
+// customers ask about, so Zipf rank 1 is the latest pickup
+static void trackingId(char* buf, size_t size, long long seq) {
+    snprintf(buf, size, "LG-%08lld", seq);
+}
+
+struct Workload {
+    LogisticsEngine* engine;
+    FastRandom rng;
+    ZipfGenerator zipf;
+    int* cityOrder;         // Zipf rank - 1 -> city; shuffled by the seed
+    int cityCount;
+    long long issued;
+
+    // What the operations ran into, so a run that did nothing is obvious
+    long long pickupsRefused;
+    long long dispatchesIdle;
+    long long trackHot;
+    long long trackArchived;
+    long long trackMissing;
+    long long cancelsDone;
+    long long undosDone;
+
+    Workload(LogisticsEngine* e, const LoadOptions& o)
+        : engine(e), rng(o.seed), zipf(o.zipf), issued(0), pickupsRefused(0), dispatchesIdle(0),
+          trackHot(0), trackArchived(0), trackMissing(0), cancelsDone(0), undosDone(0) {
+        MapGraph& map = engine->getMap();
+        cityCount = map.cityCount;
+        cityOrder = new int[cityCount > 0 ? cityCount : 1];
+        for (int i = 0; i < cityCount; i++) cityOrder[i] = i;
+        for (int i = cityCount - 1; i > 0; i--) {
+            int j = rng.below(i + 1);
+            int t = cityOrder[i];
+            cityOrder[i] = cityOrder[j];
+            cityOrder[j] = t;
+        }
+    }
+    ~Workload() {
+        delete[] cityOrder;
+    }
+
+    // An issued ID, newest most likely
+    long long popularSeq() {
+        return issued - zipf.next((int)issued, rng);
+    }
+
+    void pickupArgs(char* id, size_t size, const string*& dest, double& weight, int& priority) {
+        trackingId(id, size, issued);
+        dest = &engine->getMap().cities[cityOrder[zipf.next(cityCount, rng) - 1]].name;
+        weight = 0.5 + rng.unit() * 29.5;
+        priority = 1 + rng.below(3);
+    }
+
+    void pickup(const char* id, const string& dest, double weight, int priority) {
+        if (engine->addParcel(id, dest, weight, priority) == PICKUP_OK) issued++;
+        else pickupsRefused++;
+    }
+};
+
+// Picks the operation and its arguments, then times only the engine call
+static void runOp(Workload& w, int op, LatencyHistogram* latency) {
+    char id[24];
+    const string* dest = nullptr;
+    double weight = 0;
+    int priority = 0;
+    bool unknown = false;
+    if (op == OP_PICKUP) w.pickupArgs(id, sizeof(id), dest, weight, priority);
+    if (op == OP_TRACK || op == OP_CANCEL) {
+        unknown = w.issued == 0 || (op == OP_TRACK && w.rng.below(100) < UNKNOWN_TRACK_PERCENT);
+        // A well-formed ID past the last one issued
+        trackingId(id, sizeof(id), unknown ? w.issued + 1 + w.rng.below(1000000) : w.popularSeq());
+    }
+
+    auto start = chrono::steady_clock::now();
+    switch (op) {
+    case OP_PICKUP:
+        w.pickup(id, *dest, weight, priority);
+        break;
+    case OP_DISPATCH:
+        if (!w.engine->processNextAuto(-1)) w.dispatchesIdle++;
+        break;
+    case OP_TRACK: {
+        // As the API does it: the hot table, then the archive
+        if (w.engine->findParcel(id)) {
+            w.trackHot++;
+            break;
+        }
+        Parcel* archived = w.engine->loadArchived(id);
+        if (archived) w.trackArchived++;
+        else w.trackMissing++;
+        delete archived;
+        break;
+    }
+    case OP_CANCEL:
+        if (w.engine->tryCancel(id)) w.cancelsDone++;
+        break;
+    case OP_UNDO:
+        if (w.engine->tryUndo()) w.undosDone++;
+        break;
+    case OP_TICK:
+        w.engine->updateRealTime();
+        break;
+    }
+    latency[op].record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+}
+
+static void printMicros(long long nanos) {
+    cout << setw(10) << nanos / 1000.0;
+}
+
+static void report(const LatencyHistogram* latency, double wallSeconds, long long ops) {
+    cout << "\n  " << ops << " operations in " << fixed << setprecision(2) << wallSeconds << " s: "
+         << setprecision(0) << ops / wallSeconds << " ops/s end to end\n\n";
+    cout << "  " << left << setw(10) << "op" << right << setw(9) << "count" << setw(11) << "ops/s"
+         << setw(10) << "mean" << setw(10) << "p50" << setw(10) << "p99" << setw(10) << "p999"
+         << setw(10) << "max" << "  (us)\n";
+    for (int op = 0; op < OP_COUNT; op++) {
+        const LatencyHistogram& h = latency[op];
+        if (h.count() == 0) continue;
+        // Throughput of the operation on its own: how many the engine
+        // would get through back to back at the measured cost
+        double busy = h.totalNanos() / 1e9;
+        cout << "  " << left << setw(10) << OP_NAMES[op] << right << setw(9) << h.count()
+             << setprecision(0) << setw(11) << (busy > 0 ? h.count() / busy : 0) << setprecision(2);
+        printMicros((long long)h.meanNanos());
+        printMicros(h.percentile(0.50));
+        printMicros(h.percentile(0.99));
+        printMicros(h.percentile(0.999));
+        printMicros(h.maxNanos());
+        cout << "\n";
+    }
+    cout.unsetf(ios::fixed);
+}
+
+int main(int argc, char** argv) {
+    LoadOptions o;
+    if (!parseOptions(argc, argv, o)) {
+        usage();
+        return 1;
+    }
+
+    if (!prepareDirectory(o.dir)) return 1;
+
+    NullBuffer sink;
+    ostream quiet(&sink);
+    LogisticsEngine engine(o.dir);
+    engine.setConsole(quiet);
+    if (o.roadEvents >= 0) engine.setRoadEventRate(o.roadEvents);
+    if (o.retention >= 0) engine.setRetention(o.retention);
+
+    Workload w(&engine, o);
+    for (int i = 0; i < o.preload; i++) {
+        char id[24];
+        const string* dest;
+        double weight;
+        int priority;
+        w.pickupArgs(id, sizeof(id), dest, weight, priority);
+        w.pickup(id, *dest, weight, priority);
+    }
+
+    int mixTotal = 0;
+    for (int i = 0; i < MIXED_OPS; i++) mixTotal += o.mix[i];
+    cout << "  SwiftEX load: " << o.ops << " ops after " << w.issued << " preloaded pickups, mix "
+         << o.mix[0] << "/" << o.mix[1] << "/" << o.mix[2] << "/" << o.mix[3] << "/" << o.mix[4]
+         << " (pickup/dispatch/track/cancel/undo), zipf " << o.zipf << ", seed " << o.seed << "\n";
+
+    LatencyHistogram* latency = new LatencyHistogram[OP_COUNT];
+    auto began = chrono::steady_clock::now();
+    for (long long i = 0; i < o.ops; i++) {
+        int roll = w.rng.below(mixTotal);
+        int op = 0;
+        while (roll >= o.mix[op]) roll -= o.mix[op++];
+        runOp(w, op, latency);
+        if (o.tickEvery > 0 && (i + 1) % o.tickEvery == 0) runOp(w, OP_TICK, latency);
+    }
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - began).count();
+
+    report(latency, wall, o.ops);
+    cout << "\n  pickups refused " << w.pickupsRefused << ", idle dispatches " << w.dispatchesIdle
+         << ", tracked hot/archived/missing " << w.trackHot << "/" << w.trackArchived << "/" << w.trackMissing
+         << ", cancelled " << w.cancelsDone << ", undone " << w.undosDone << "\n";
+    cout << "  " << engine.parcelCount() << " parcels hot, " << engine.archivedCount() << " archived\n";
+    delete[] latency;
+    return 0;
+}
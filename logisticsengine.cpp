@@ -1,289 +1,1540 @@
-﻿#include "logisticsengine.h"
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <ctime>
-#include <cstdlib>
-#include <iomanip>
-
-using namespace std;
-
-// --- IMPORTANT: UI Helpers ---
-// If these are defined in main.cpp, we declare them here as 'extern' 
-// so this file knows they exist without redefining them.
-extern void clearScreen();
-
-// UI Color Palette
-#define RESET   "\033[0m"
-#define BOLD    "\033[1m"
-#define CYAN    "\033[1;36m"
-#define GOLD    "\033[1;33m"
-#define RED     "\033[1;31m"
-#define GREEN   "\033[1;32m"
-#define GRAY    "\033[90m"
-#define BG_BLUE "\033[44m"
-
-LogisticsEngine::LogisticsEngine() {
-    srand(static_cast<unsigned int>(time(0)));
-    setupMap();
-    setupRiders();
-    loadFromFile();
-}
-
-void LogisticsEngine::setupRiders() {
-    riderQueue.enqueue("InamUllah (Light Load)");
-    riderQueue.enqueue("Haris Waheed (Heavy Load)");
-    riderQueue.enqueue("Ahmad Gulzar (Priority)");
-    riderQueue.enqueue("Hurarah (General)");
-}
-
-void LogisticsEngine::setupMap() {
-    int ccw = map.addCity("Chichawatni", "Zone A");
-    int isb = map.addCity("Islamabad", "Zone B");
-    int khi = map.addCity("Karachi", "Zone C");
-    int psw = map.addCity("Peshawar", "Zone B");
-    int mul = map.addCity("Multan", "Zone A");
-    int fsd = map.addCity("Faisalabad", "Zone A");
-    int que = map.addCity("Quetta", "Zone D");
-    int lhr = map.addCity("Lahore", "Zone A");
-    int rwp = map.addCity("Rawalpindi", "Zone B");
-    int sak = map.addCity("Sakhar", "Zone C");
-
-    map.addRoad(ccw, isb, 375);
-    map.addRoad(ccw, fsd, 180);
-    map.addRoad(ccw, mul, 345);
-    map.addRoad(ccw, lhr, 105);
-    map.addRoad(isb, psw, 155);
-    map.addRoad(isb, rwp, 20);
-    map.addRoad(fsd, lhr, 90);
-    map.addRoad(fsd, mul, 240);
-    map.addRoad(mul, sak, 490);
-    map.addRoad(sak, khi, 470);
-    map.addRoad(sak, que, 390);
-    map.addRoad(que, khi, 690);
-}
-
-void LogisticsEngine::requestPickup(string id, string dest, double w, int p) {
-    if (map.getCityIndex(dest) == -1) {
-        cout << RED << " [!] Error: Destination city not found in system.\n" << RESET;
-        return;
-    }
-
-    if (database.search(id)) {
-        cout << RED << " [!] Error: Tracking ID " << id << " already exists.\n" << RESET;
-        return;
-    }
-
-    string zone = map.getZone(dest);
-    Parcel* newP = new Parcel(id, dest, w, p, zone);
-    database.insert(id, newP);
-
-    newP->updateStatus(STATUS_WAREHOUSE, "Arrived at Warehouse", "Central Hub");
-    sortingQueue.insert(newP);
-    undoStack.push("ADD", id);
-
-    cout << "\n" << CYAN << " ┌─── SUCCESS: PICKUP LOGGED ───────────────┐" << RESET << endl;
-    cout << "   ID: " << BOLD << id << RESET << " | Zone: " << CYAN << zone << RESET << endl;
-    cout << "   Destination: " << BOLD << dest << RESET << endl;
-    cout << "   Category: " << newP->weightCategory << endl;
-    cout << "   Status: " << GREEN << "Sorting Queue" << RESET << endl;
-    cout << CYAN << " └──────────────────────────────────────────┘" << RESET << endl;
-}
-
-void LogisticsEngine::processNext() {
-    if (sortingQueue.isEmpty()) {
-        cout << GOLD << " [!] Warehouse Sorting Queue is currently empty.\n" << RESET;
-        return;
-    }
-
-    if (riderQueue.isEmpty()) {
-        cout << RED << " [!] CRITICAL: No Riders available for dispatch!\n" << RESET;
-        return;
-    }
-
-    Parcel* p = sortingQueue.extractMax();
-    string rider = riderQueue.dequeue();
-    p->assignedRider = rider;
-
-    int start = map.getCityIndex("Lahore");
-    int end = map.getCityIndex(p->destination);
-
-    cout << "\n" << BOLD << " [SYSTEM] Calculating routes for " << p->id << " to " << p->destination << "..." << RESET << endl;
-    map.findAllPaths(start, end);
-
-    // FIX: Check pathCount to prevent buffer overruns in availablePaths
-    if (map.pathCount <= 0) {
-        cout << RED << " [!] ALERT: No valid paths. Returning to Sender.\n" << RESET;
-        p->updateStatus(STATUS_RETURNED, "No Route Available", "Warehouse");
-        riderQueue.enqueue(rider);
-        return;
-    }
-
-    int minIdx = map.getMinRouteIndex();
-    cout << GRAY << " ──────────────────────────────────────────────────────────" << RESET << endl;
-    for (int i = 0; i < map.pathCount; i++) {
-        // Safety check for array bounds
-        if (i >= 100) break; // Assuming 100 is max capacity
-
-        cout << "  [" << i << "] Distance: " << map.availablePathDistances[i] << " km ";
-        if (i == minIdx) cout << GREEN << "(RECOMMENDED)" << RESET;
-        cout << "\n   Path: ";
-        IntArrayList& path = map.availablePaths[i];
-        for (int j = 0; j < path.size(); j++) {
-            cout << map.cities[path.get(j)].name << (j < path.size() - 1 ? " -> " : "");
-        }
-        cout << "\n";
-    }
-    cout << GRAY << " ──────────────────────────────────────────────────────────" << RESET << endl;
-
-    int choice;
-    cout << " Select Route ID to Dispatch " << CYAN << "» " << RESET;
-    cin >> choice;
-
-    if (choice < 0 || choice >= map.pathCount) choice = minIdx;
-
-    // Simulate Dynamic Events (Road Blocks)
-    if (rand() % 10 < 2) {
-        cout << RED << "\n [!] LIVE UPDATE: Road Blockage detected on selected route!" << RESET << endl;
-        map.blockRandomRoad();
-        cout << " [!] Re-calculating live GPS route..." << endl;
-        map.findAllPaths(start, end);
-        if (map.pathCount > 0) {
-            choice = map.getMinRouteIndex();
-            cout << GREEN << " [✓] Rerouted to new shortest path." << RESET << endl;
-        }
-    }
-
-    p->updateStatus(STATUS_LOADING, "Loading onto Truck", "Bay 4");
-    long long travelSecs = 15 + (rand() % 30);
-    p->dispatchTime = time(0);
-    p->arrivalTime = time(0) + travelSecs;
-
-    shippingList.pushBack(p);
-    undoStack.push("DISPATCH", p->id);
-
-    cout << "\n" << GREEN << " [✓] DISPATCH SUCCESSFUL" << RESET << endl;
-    cout << "   Rider: " << rider << " | ETA: " << travelSecs << "s\n";
-
-    riderQueue.enqueue(rider);
-}
-
-void LogisticsEngine::showMap() {
-    cout << CYAN << "\n [ GEOGRAPHIC LOGISTICS NETWORK ]\n" << RESET;
-    map.displayNetwork();
-}
-
-void LogisticsEngine::undoLast() {
-    UndoAction act;
-    if (undoStack.pop(act)) {
-        Parcel* p = database.search(act.parcelId);
-        if (p) {
-            if (act.type == "ADD") {
-                p->updateStatus(STATUS_CANCELLED, "Undo: Creation Reverted", "N/A");
-                cout << GOLD << " [Undo] Parcel " << p->id << " creation cancelled.\n" << RESET;
-            }
-            else if (act.type == "DISPATCH") {
-                p->updateStatus(STATUS_WAREHOUSE, "Undo: Dispatch Reverted", "Warehouse");
-                p->arrivalTime = 0;
-                sortingQueue.insert(p);
-                cout << GOLD << " [Undo] Parcel " << p->id << " pulled back to warehouse.\n" << RESET;
-            }
-        }
-    }
-    else {
-        cout << GRAY << " [!] Nothing to undo.\n" << RESET;
-    }
-}
-
-void LogisticsEngine::updateRealTime() {
-    shippingList.updateLifecycle(static_cast<long long>(time(0)));
-}
-
-void LogisticsEngine::liveMonitor() {
-    char cmd = 'r';
-    while (cmd == 'r' || cmd == 'R') {
-        clearScreen();
-        cout << BG_BLUE << "   LIVE TRANSIT MONITOR   " << RESET << "\n\n";
-        updateRealTime();
-        shippingList.showTransitStatus(static_cast<long long>(time(0)));
-        cout << GRAY << "\n ──────────────────────────────────────────" << RESET << endl;
-        cout << " [r] Refresh Data   [x] Main Menu » ";
-        cin >> cmd;
-    }
-}
-
-void LogisticsEngine::viewParcel(string id) {
-    Parcel* p = database.search(id);
-    if (p) {
-        cout << "\n" << BOLD << CYAN << " ════════════ TRACKING: " << p->id << " ════════════" << RESET << endl;
-        cout << *p << endl;
-
-        cout << " Progress: [";
-        for (int i = 0; i < 6; i++) {
-            if (i <= p->status) cout << GREEN << "■" << RESET;
-            else cout << GRAY << "□" << RESET;
-        }
-        cout << "]\n\n";
-
-        p->history->printTimeline();
-
-        if (p->status == STATUS_IN_TRANSIT) {
-            long long rem = p->arrivalTime - static_cast<long long>(time(0));
-            if (rem > 0) cout << CYAN << "\n >>> LIVE ETA: " << rem << " seconds" << RESET << endl;
-        }
-    }
-    else {
-        cout << RED << " [!] Tracking ID not found in database.\n" << RESET;
-    }
-}
-
-void LogisticsEngine::listAll() {
-    cout << CYAN << "\n [ COMPLETE INVENTORY RECORDS ]\n" << RESET;
-    database.printAll();
-}
-
-void LogisticsEngine::saveToFile() {
-    ofstream f("parcels.txt");
-    if (f.is_open()) {
-        database.saveToFile(f);
-        f.close();
-        cout << GREEN << " [✓] Data synced to parcels.txt\n" << RESET;
-    }
-}
-
-void LogisticsEngine::loadFromFile() {
-    ifstream f("parcels.txt");
-    if (f.is_open()) {
-        string line, id, dest, temp, zone;
-        while (getline(f, line)) {
-            stringstream ss(line);
-            getline(ss, id, ',');
-            getline(ss, dest, ',');
-            getline(ss, temp, ',');
-            if (temp.empty()) continue;
-            double w = stod(temp);
-            getline(ss, temp, ','); int p = stoi(temp);
-            getline(ss, temp, ','); int s = stoi(temp);
-            getline(ss, zone, ',');
-
-            Parcel* newP = new Parcel(id, dest, w, p, zone);
-            newP->status = s;
-            database.insert(id, newP);
-
-            if (s == STATUS_WAREHOUSE) sortingQueue.insert(newP);
-            if (s >= STATUS_LOADING && s <= STATUS_DELIVERY_ATTEMPT) shippingList.pushBack(newP);
-        }
-        f.close();
-    }
-}
-
-void LogisticsEngine::cancelParcel(string id) {
-    Parcel* p = database.search(id);
-    if (p && p->status <= STATUS_WAREHOUSE) {
-        p->updateStatus(STATUS_CANCELLED, "Cancelled by Admin", "Warehouse");
-        cout << GREEN << " [✓] Parcel " << id << " cancelled successfully.\n" << RESET;
-    }
-    else {
-        cout << RED << " [!] Cannot cancel: Parcel is already in transit or missing.\n" << RESET;
-    }
+﻿#include "logisticsengine.h"
+#include "serializer.h"
+#include "replication.h"
+#include "terminalframe.h"
+#include <iostream>
+#include <fstream>
+#include <ctime>
+#include <cstdlib>
+#include <iomanip>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <climits>
+#include <atomic>
+
+using namespace std;
+
+// --- IMPORTANT: UI Helpers ---
+// If these are defined in main.cpp, we declare them here as 'extern' 
+// so this file knows they exist without redefining them.
+extern void clearScreen();
+
+// UI Color Palette
+#define RESET   "\033[0m"
+#define BOLD    "\033[1m"
+#define CYAN    "\033[1;36m"
+#define GOLD    "\033[1;33m"
+#define RED     "\033[1;31m"
+#define GREEN   "\033[1;32m"
+#define GRAY    "\033[90m"
+#define BG_BLUE "\033[44m"
+
+// Road hours are compressed for the live simulation: one hour on the road
+// plays out as this many real seconds in the transit monitor.
+const int SIM_SECONDS_PER_ROAD_HOUR = 10;
+
+// Final-state parcels stay in the hot structures for an hour, and the
+// archive sweep looks for them twice a minute
+const long long DEFAULT_RETENTION_SECONDS = 3600;
+const long long ARCHIVE_SWEEP_SECONDS = 30;
+
+// Known-ID filter: 1% false positives by default, and a rebuild gets this
+// much time per engine tick so it never stalls the console or the server
+const double DEFAULT_ID_FALSE_POSITIVE_RATE = 0.01;
+const long long ID_REBUILD_SLICE_MICROS = 5000;
+
+// Queueing the loaded parcels after startup gets the same allowance
+const long long WARMUP_SLICE_MICROS = 5000;
+
+// One dispatch in five runs into a simulated road block
+const int DEFAULT_ROAD_EVENT_PERCENT = 20;
+
+// A closure alert counts the parcels this close to the road
+const double ROAD_ALERT_KM = 25.0;
+
+// Road and route totals, saved next to the parcel segments
+const char* const ANALYTICS_FILE = "/analytics.txt";
+
+// The distance matrix fits an 80-column screen up to this many cities; a
+// bigger map shows its first ones (and only computes those)
+const int MATRIX_MAX_CITIES = 10;
+
+double currentHourOfDay() {
+    time_t now = time(nullptr);
+    tm localTime;
+
+#ifdef _WIN32
+    localtime_s(&localTime, &now);
+#else
+    localtime_r(&now, &localTime);
+#endif
+
+    return localTime.tm_hour + localTime.tm_min / 60.0 + localTime.tm_sec / 3600.0;
+}
+
+// One-decimal hours without leaving std::fixed set on cout; short enough
+// to stay in the small-string buffer
+static string formatHours(double h) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%.1f", h);
+    return string(buf);
+}
+
+// City names along a route code; ids the map does not have print as '?'
+static void printRoute(ostream& out, MapGraph& map, string_view code) {
+    IntArrayList cities;
+    decodeRoute(code, cities);
+    for (int i = 0; i < cities.size(); i++) {
+        if (i > 0) out << " -> ";
+        int c = cities[i];
+        out << (c >= 0 && c < map.cityCount ? map.cities[c].name : string("?"));
+    }
+}
+
+// Hub shards are built in the same second; the count keeps their dice apart
+static unsigned long long engineSeed() {
+    static atomic<unsigned int> enginesBuilt(0);
+    return (unsigned long long)time(0) * 0x9E3779B97F4A7C15ULL + enginesBuilt.fetch_add(1);
+}
+
+static double msSince(chrono::steady_clock::time_point t) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t).count();
+}
+
+LogisticsEngine::LogisticsEngine(const string& dataDir, string_view ownZone)
+    : analyticsRestored(false), store(dataDir), cold(dataDir + "/cold.col"), retentionSeconds(DEFAULT_RETENTION_SECONDS), lastArchiveSweep(0),
+      knownIds(nullptr), nextIds(nullptr), nextIdsBlock(0), idFalsePositiveRate(DEFAULT_ID_FALSE_POSITIVE_RATE),
+      hubCity("Lahore"), hubZone(ownZone), hubLink{ nullptr, nullptr, nullptr }, roadEventPercent(DEFAULT_ROAD_EVENT_PERCENT), dice(engineSeed()),
+      console(&cout), publisher(nullptr), closuresPublished(0), readOnly(false), geoBuiltAt(0), geoStale(true),
+      warmNext(0), startup(), startedAt(chrono::steady_clock::now()) {
+    shippingList.setSeed(static_cast<unsigned int>(dice.next()));
+    map.setSeed(dice.next());
+
+    // The map, the parcel snapshot, and the riders with the archive index
+    // share no members, so they load side by side
+    thread mapLoader([this] {
+        auto t = chrono::steady_clock::now();
+        setupMap();
+        startup.mapMs = msSince(t);
+    });
+    bool stored = false;
+    thread snapshotLoader([this, &stored] {
+        auto t = chrono::steady_clock::now();
+        stored = store.load(parseRecord, warmBacklog);
+        startup.snapshotMs = msSince(t);
+    });
+    auto t = chrono::steady_clock::now();
+    setupRiders();
+    startup.ridersMs = msSince(t);
+    t = chrono::steady_clock::now();
+    cold.open();
+    startup.archiveMs = msSince(t);
+    mapLoader.join();
+    snapshotLoader.join();
+
+    // Tracking lookups only need the hot table
+    t = chrono::steady_clock::now();
+    if (stored) {
+        database.reserve(warmBacklog.size());
+        for (int i = 0; i < warmBacklog.size(); i++) database.insert(warmBacklog[i]->id, warmBacklog[i]);
+    }
+    else {
+        importFlatFile();
+    }
+    // Without the snapshot the totals would not match the parcels
+    analyticsRestored = stored && analytics.load(map, dataDir + ANALYTICS_FILE);
+    startup.indexMs = msSince(t);
+    startup.parcels = database.size();
+    startup.readyMs = msSince(startedAt);
+
+    // The rest comes in from updateRealTime(), or all at once when an
+    // action needs the queues
+    continueWarmup(WARMUP_SLICE_MICROS);
+}
+
+LogisticsEngine::~LogisticsEngine() {
+    if (publisher) removeStatusListener(onStatusChange, this);
+    delete knownIds;
+    delete nextIds;
+}
+
+void LogisticsEngine::setConsole(ostream& os) {
+    console = &os;
+}
+
+void LogisticsEngine::setHub(string_view city, const HubLink& link) {
+    hubCity = city;
+    hubLink = link;
+}
+
+const string& LogisticsEngine::getHubCity() const {
+    return hubCity;
+}
+
+void LogisticsEngine::setRoadEventRate(int percent) {
+    roadEventPercent = percent < 0 ? 0 : (percent > 100 ? 100 : percent);
+}
+
+void LogisticsEngine::setSeed(unsigned long long seed) {
+    dice.reseed(seed);
+    shippingList.setSeed(static_cast<unsigned int>(dice.next()));
+    map.setSeed(dice.next());
+}
+
+bool LogisticsEngine::ownsZone(const string& zone) const {
+    return hubZone.empty() || zone == hubZone;
+}
+
+// Hub city a parcel changes hands at, or nullptr if this engine delivers it
+const char* LogisticsEngine::transferHub(const Parcel* p) const {
+    if (ownsZone(p->zone) || !hubLink.hubFor) return nullptr;
+    return hubLink.hubFor(p->zone, hubLink.ctx);
+}
+
+void LogisticsEngine::setupRiders() {
+    riderQueue.enqueue("InamUllah (Light Load)");
+    riderQueue.enqueue("Haris Waheed (Heavy Load)");
+    riderQueue.enqueue("Ahmad Gulzar (Priority)");
+    riderQueue.enqueue("Hurarah (General)");
+}
+
+void LogisticsEngine::setupMap() {
+    // Speeds in km/h for each hour of the day (00:00 .. 23:00)
+    const unsigned char motorway[24] = { 110,110,110,110,110,105, 95,75,70,85,100,100,
+                                         100,100,100, 95, 80,70,75, 95,105,110,110,110 };
+    const unsigned char highway[24]  = {  80, 80, 80, 80, 80, 75, 65,50,45,60, 70, 70,
+                                          70, 70, 70, 65, 55,45,50, 65, 75, 80, 80, 80 };
+    const unsigned char rural[24]    = {  40, 40, 40, 40, 45, 50, 55,55,55,55, 55, 55,
+                                          55, 55, 55, 55, 55,50,45, 40, 40, 40, 40, 40 };
+    int mwy = map.addSpeedProfile("Motorway", motorway);
+    int hwy = map.addSpeedProfile("Highway", highway);
+    int rur = map.addSpeedProfile("Rural", rural);
+
+    // Latitude, longitude of each city centre
+    int ccw = map.addCity("Chichawatni", "Zone A", 30.5301, 72.6916);
+    int isb = map.addCity("Islamabad", "Zone B", 33.6844, 73.0479);
+    int khi = map.addCity("Karachi", "Zone C", 24.8607, 67.0011);
+    int psw = map.addCity("Peshawar", "Zone B", 34.0151, 71.5249);
+    int mul = map.addCity("Multan", "Zone A", 30.1575, 71.5249);
+    int fsd = map.addCity("Faisalabad", "Zone A", 31.4504, 73.1350);
+    int que = map.addCity("Quetta", "Zone D", 30.1798, 66.9750);
+    int lhr = map.addCity("Lahore", "Zone A", 31.5204, 74.3587);
+    int rwp = map.addCity("Rawalpindi", "Zone B", 33.5651, 73.0169);
+    int sak = map.addCity("Sakhar", "Zone C", 27.7052, 68.8574);
+
+    map.addRoad(ccw, isb, 375, mwy);
+    map.addRoad(ccw, fsd, 180, hwy);
+    map.addRoad(ccw, mul, 345, hwy);
+    map.addRoad(ccw, lhr, 105, hwy);
+    map.addRoad(isb, psw, 155, mwy);
+    map.addRoad(isb, rwp, 20, hwy);
+    map.addRoad(fsd, lhr, 90, mwy);
+    map.addRoad(fsd, mul, 240, mwy);
+    map.addRoad(mul, sak, 490, mwy);
+    map.addRoad(sak, khi, 470, mwy);
+    map.addRoad(sak, que, 390, rur);
+    map.addRoad(que, khi, 690, rur);
+}
+
+PickupResult LogisticsEngine::addParcel(string_view id, string_view dest, double w, int p, Parcel** created) {
+    const string* zonePtr = nullptr;
+    int cityIdx = map.resolveCity(dest, &zonePtr);
+    if (cityIdx == -1) return PICKUP_UNKNOWN_CITY;
+    if (maybeKnownId(id) && (database.search(id) || cold.contains(id))) return PICKUP_DUPLICATE_ID;
+
+    // Store the canonical spelling so later lookups and listings agree
+    Parcel* newP = new Parcel(string(id), map.cities[cityIdx].name, w, p, *zonePtr);
+    newP->queuedSince = time(0);
+    database.insert(newP->id, newP);
+    store.track(newP);
+    rememberId(newP->id);
+
+    // The ID stays registered, so undoing a pickup voids it as cancelled
+    journal.begin("Pickup");
+    journal.recordValue(newP, UF_STATUS, STATUS_CANCELLED, STATUS_WAREHOUSE);
+    newP->updateStatus(STATUS_WAREHOUSE, "Arrived at Warehouse", "Central Hub");
+    journal.recordValue(newP, UF_IN_QUEUE, 0, 1);
+    sortingQueue.insert(newP);
+    journal.commit();
+    publishChanges();
+
+    if (created) *created = newP;
+    return PICKUP_OK;
+}
+
+void LogisticsEngine::requestPickup(string_view id, string_view dest, double w, int p) {
+    Parcel* newP = nullptr;
+    PickupResult result = addParcel(id, dest, w, p, &newP);
+
+    if (result == PICKUP_UNKNOWN_CITY) {
+        *console << RED << " [!] Error: Destination city not found in system.\n" << RESET;
+        int guess = map.suggestCity(dest);
+        if (guess != -1)
+            *console << GOLD << "     Did you mean '" << map.cities[guess].name << "'?\n" << RESET;
+        return;
+    }
+
+    if (result == PICKUP_DUPLICATE_ID) {
+        *console << RED << " [!] Error: Tracking ID " << id << " already exists.\n" << RESET;
+        return;
+    }
+
+    *console << "\n" << CYAN << " ┌─── SUCCESS: PICKUP LOGGED ───────────────┐" << RESET << "\n";
+    *console << "   ID: " << BOLD << newP->id << RESET << " | Zone: " << CYAN << newP->zone << RESET << "\n";
+    *console << "   Destination: " << BOLD << newP->destination << RESET << "\n";
+    *console << "   Category: " << newP->weightCategory << "\n";
+    *console << "   Status: " << GREEN << "Sorting Queue" << RESET << "\n";
+    *console << CYAN << " └──────────────────────────────────────────┘" << RESET << "\n";
+}
+
+void LogisticsEngine::processNext() {
+    dispatchNext(true, -1);
+    publishChanges();
+}
+
+// Non-interactive dispatch for scripted callers; -1 picks the recommended route.
+// Returns the parcel that left the warehouse (it may have been returned to
+// sender if no route exists), or nullptr if nothing could be dispatched.
+Parcel* LogisticsEngine::processNextAuto(int routeChoice) {
+    Parcel* p = dispatchNext(false, routeChoice);
+    publishChanges();
+    return p;
+}
+
+Parcel* LogisticsEngine::dispatchNext(bool askRoute, int routeChoice) {
+    finishWarmup();
+    if (sortingQueue.isEmpty()) {
+        *console << GOLD << " [!] Warehouse Sorting Queue is currently empty.\n" << RESET;
+        return nullptr;
+    }
+
+    if (riderQueue.isEmpty()) {
+        *console << RED << " [!] CRITICAL: No Riders available for dispatch!\n" << RESET;
+        return nullptr;
+    }
+
+    journal.begin("Dispatch");
+    Parcel* p = sortingQueue.extractNext();
+    journal.recordValue(p, UF_IN_QUEUE, 1, 0);
+    // The rider at the front takes this parcel, then goes to the back
+    const string& rider = riderQueue.front();
+    journal.recordBytes(p, UF_RIDER, p->assignedRider, rider);
+    p->assignedRider = rider;
+
+    // Parcels for another hub's zone only ride as far as that hub
+    int start = map.getCityIndex(hubCity);
+    const char* via = transferHub(p);
+    int end = map.getCityIndex(via ? string_view(via) : string_view(p->destination));
+
+    *console << "\n" << BOLD << " [SYSTEM] Calculating routes for " << p->id << " to " << p->destination;
+    if (via) *console << " (via the " << via << " hub)";
+    *console << "..." << RESET << "\n";
+    map.findAllPaths(start, end);
+
+    // FIX: Check pathCount to prevent buffer overruns in availablePaths
+    if (map.pathCount <= 0) {
+        *console << RED << " [!] ALERT: No valid paths. Returning to Sender.\n" << RESET;
+        return returnUnroutable(p);
+    }
+
+    int minIdx = recommendedRoute();
+    double departHour = currentHourOfDay();
+    *console << GRAY << " ──────────────────────────────────────────────────────────" << RESET << "\n";
+    for (int i = 0; i < map.pathCount; i++) {
+        // Safety check for array bounds
+        if (i >= 100) break; // Assuming 100 is max capacity
+
+        *console << "  [" << i << "] Distance: " << map.availablePathDistances[i] << " km "
+             << "| Drive: " << formatHours(map.routeTravelHours(map.availablePaths[i], departHour)) << " h ";
+        int riskKm = (int)(routeRiskKm(i) + 0.5);
+        if (riskKm > 0) *console << GOLD << "| Closures: +" << riskKm << " km " << RESET;
+        if (i == minIdx) *console << GREEN << "(RECOMMENDED)" << RESET;
+        *console << "\n   Path: ";
+        IntArrayList& path = map.availablePaths[i];
+        for (int j = 0; j < path.size(); j++) {
+            *console << map.cities[path.get(j)].name << (j < path.size() - 1 ? " -> " : "");
+        }
+        *console << "\n";
+    }
+    double fastest = map.fastestArrival(start, end, departHour);
+    if (fastest >= 0)
+        *console << GRAY << "  Fastest possible at this hour: " << formatHours(fastest - departHour)
+             << " h on the road" << RESET << "\n";
+    *console << GRAY << " ──────────────────────────────────────────────────────────" << RESET << "\n";
+
+    int choice = routeChoice;
+    if (askRoute) {
+        *console << " Select Route ID to Dispatch " << CYAN << "» " << RESET;
+        cin >> choice;
+    }
+
+    if (choice < 0 || choice >= map.pathCount) choice = minIdx;
+
+    // Simulate Dynamic Events (Road Blocks)
+    if (dice.below(100) < roadEventPercent) {
+        *console << RED << "\n [!] LIVE UPDATE: Road Blockage detected on selected route!" << RESET << "\n";
+        int blocked = map.blockRandomRoad();
+        if (blocked >= 0) {
+            *console << RED << "\n [!] LIVE TRAFFIC ALERT: Road near " << map.cities[map.edgeSource(blocked)].name
+                 << " is now BLOCKED due to weather/construction!" << RESET << "\n";
+            ParcelArrayList nearby;
+            parcelsNearRoad(blocked, ROAD_ALERT_KM, nearby);
+            if (nearby.size() > 0)
+                *console << GOLD << " [!] " << nearby.size() << " parcel(s) within " << ROAD_ALERT_KM
+                         << " km of the closure." << RESET << "\n";
+        }
+        rerouteAffected(blocked);
+        *console << " [!] Re-calculating live GPS route...\n";
+        map.findAllPaths(start, end);
+        // The closure may have cut the last road there; choice indexed the
+        // paths from before it
+        if (map.pathCount <= 0) {
+            *console << RED << " [!] ALERT: The blockage left no valid paths. Returning to Sender.\n" << RESET;
+            return returnUnroutable(p);
+        }
+        choice = recommendedRoute();
+        *console << GREEN << " [✓] Rerouted to new shortest path." << RESET << "\n";
+    }
+
+    // ETA follows the chosen roads at their speeds for the current hour of day
+    double roadHours = map.routeTravelHours(map.availablePaths[choice], departHour);
+    long long travelSecs = (long long)ceil(roadHours * SIM_SECONDS_PER_ROAD_HOUR);
+    if (travelSecs < 1) travelSecs = 1;
+    long long now = time(0);
+    journal.recordValue(p, UF_DISPATCH_TIME, p->dispatchTime, now);
+    journal.recordValue(p, UF_ARRIVAL_TIME, p->arrivalTime, now + travelSecs);
+    p->dispatchTime = now;
+    p->arrivalTime = now + travelSecs;
+    // Status last, so observers see the ETA along with it
+    journal.recordValue(p, UF_STATUS, p->status, STATUS_LOADING);
+    p->updateStatus(STATUS_LOADING, "Loading onto Truck", "Bay 4");
+
+    IntArrayList& chosen = map.availablePaths[choice];
+    int* edges = new int[chosen.size()];
+    int edgeCount = map.pathToEdges(chosen, edges);
+    recordRoute(p, edges, edgeCount, departHour);
+    changeRoute(p, edges, edgeCount, departHour);
+    delete[] edges;
+
+    journal.recordValue(p, UF_ON_ROAD, 0, 1);
+    routeIndex.add(p);
+    shippingList.pushBack(p);
+    journal.commit();
+
+    *console << "\n" << GREEN << " [✓] DISPATCH SUCCESSFUL" << RESET << "\n";
+    *console << "   Rider: " << rider << " | ETA: " << travelSecs << "s ("
+         << formatHours(roadHours) << " h on the road)\n";
+
+    riderQueue.rotate();
+    return p;
+}
+
+// Ends an open dispatch for a parcel no road reaches
+Parcel* LogisticsEngine::returnUnroutable(Parcel* p) {
+    journal.recordValue(p, UF_STATUS, p->status, STATUS_RETURNED);
+    p->updateStatus(STATUS_RETURNED, "No Route Available", "Warehouse");
+    journal.commit();
+    riderQueue.rotate();
+    return p;
+}
+
+void LogisticsEngine::showMap() {
+    *console << CYAN << "\n [ GEOGRAPHIC LOGISTICS NETWORK ]\n" << RESET;
+    map.displayNetwork(*console);
+    showDistanceMatrix();
+
+    RouteOverlay& overlay = map.overlay;
+    overlay.refresh(map);
+    *console << CYAN << "\n [ ROUTING OVERLAY ]\n" << RESET;
+    if (overlay.levelCount() == 0) *console << "  One zone and a small map: routes search the roads directly\n";
+    for (int l = overlay.levelCount() - 1; l >= 0; l--)
+        *console << "  Level " << l + 1 << ": " << overlay.cellCount(l) << " cell(s), "
+                 << overlay.boundaryCount(l) << " boundary cities\n";
+    char timing[96];
+    snprintf(timing, sizeof(timing), "  Built in %.3f ms; last customization %.3f ms (%d cell(s))",
+             overlay.buildMs, overlay.customizeMs, overlay.customizedCells);
+    *console << GRAY << timing << RESET << "\n";
+
+    // Running totals; nothing here walks the parcels
+    const int SHOWN = 5;
+    int roads[SHOWN];
+    int n = analytics.busiestRoads(roads, SHOWN);
+    *console << CYAN << "\n [ BUSIEST ROADS ]\n" << RESET;
+    if (n == 0) *console << "  No shipments routed yet\n";
+    for (int i = 0; i < n; i++) {
+        RoadStats r = analytics.road(roads[i]);
+        *console << "  " << map.cities[map.edgeSource(roads[i])].name << " -> "
+                 << map.cities[map.getEdge(roads[i]).dest].name << ": " << r.shipments << " shipment(s)";
+        if (r.closures > 0) *console << GOLD << ", closed " << r.closures << "x, " << r.disrupted << " turned back" << RESET;
+        *console << "\n";
+    }
+
+    const RouteStats* routes[SHOWN];
+    n = analytics.busiestRoutes(routes, SHOWN);
+    if (n > 0) *console << CYAN << "\n [ BUSIEST ROUTES ]\n" << RESET;
+    for (int i = 0; i < n; i++) {
+        const RouteStats& r = *routes[i];
+        *console << "  ";
+        printRoute(*console, map, r.code);
+        *console << "\n" << GRAY << "     " << r.shipments << " shipment(s)";
+        if (r.arrived > 0)
+            *console << ", " << formatHours((double)r.roadSeconds / r.arrived / SIM_SECONDS_PER_ROAD_HOUR)
+                     << " h on the road on average";
+        if (r.lost > 0) *console << ", " << r.lost << " lost";
+        if (r.blocked > 0) *console << ", " << r.blocked << " rerouted off it";
+        *console << RESET << "\n";
+    }
+}
+
+// Zone planning view: shortest open-road distance between every pair of cities
+void LogisticsEngine::showDistanceMatrix() {
+    int n = map.cityCount < MATRIX_MAX_CITIES ? map.cityCount : MATRIX_MAX_CITIES;
+    int* all = new int[n];
+    for (int i = 0; i < n; i++) all[i] = i;
+
+    DistanceMatrix dm;
+    map.computeDistanceMatrix(all, n, all, n, dm);
+
+    *console << CYAN << "\n [ ROAD DISTANCE MATRIX (km) ]\n" << RESET;
+    if (n < map.cityCount)
+        *console << GRAY << "  First " << n << " of " << map.cityCount << " cities" << RESET << "\n";
+    *console << "  " << left << setw(12) << " ";
+    for (int c = 0; c < n; c++)
+        *console << GOLD << right << setw(6) << map.cities[c].name.substr(0, 5) << RESET;
+    *console << "\n";
+
+    for (int r = 0; r < n; r++) {
+        *console << "  " << left << setw(12) << map.cities[r].name;
+        const int* row = dm.row(r);
+        for (int c = 0; c < n; c++) {
+            if (row[c] == DIST_INFINITY) *console << RED << right << setw(6) << "--" << RESET;
+            else if (r == c) *console << GRAY << right << setw(6) << 0 << RESET;
+            else *console << right << setw(6) << row[c];
+        }
+        *console << "\n";
+    }
+    delete[] all;
+}
+
+// Route images are [depart hour][edge ids]; an empty image means no route
+void LogisticsEngine::recordRoute(Parcel* p, const int* edges, int n, double departHour) {
+    routeScratch.clear();
+    if (p->routeLength > 0) {
+        routeScratch.append((const char*)&p->routeDepartHour, sizeof(double));
+        routeScratch.append((const char*)p->routeEdges, p->routeLength * sizeof(int));
+    }
+    size_t beforeLen = routeScratch.size();
+    routeScratch.append((const char*)&departHour, sizeof(double));
+    routeScratch.append((const char*)edges, n * sizeof(int));
+
+    string_view all = routeScratch.view();
+    journal.recordBytes(p, UF_ROUTE, all.substr(0, beforeLen), all.substr(beforeLen));
+}
+
+// Every route change goes through here - dispatch, reroute, undo, replicas -
+// so the route code and the analytics always match the edges. A reroute
+// keeps the status, so the segment is marked here rather than by the
+// status listener, or the next save would keep the old route.
+void LogisticsEngine::changeRoute(Parcel* p, const int* edges, int n, double departHour) {
+    store.markDirty(p);
+    analytics.routeDropped(map, p->routeCode);
+    p->routeCode.clear();
+    if (n <= 0) {
+        p->clearRoute();
+        return;
+    }
+    // edges may be the parcel's own (a replica's image); read the copy
+    p->setRoute(edges, n, departHour);
+    IntArrayList path;
+    map.edgesToPath(p->routeEdges, n, path);
+    encodeRoute(path, p->routeCode);
+    analytics.routeTaken(map, p->routeCode);
+}
+
+void LogisticsEngine::applyUndoStep(const UndoStep& step, void* ctx) {
+    UndoContext* uc = (UndoContext*)ctx;
+    LogisticsEngine* eng = uc->engine;
+    Parcel* p = step.parcel;
+    eng->markChanged(p);
+    if (p != uc->lastParcel) {
+        uc->lastParcel = p;
+        uc->parcels++;
+    }
+
+    switch (step.field) {
+    case UF_STATUS: {
+        char desc[64];
+        snprintf(desc, sizeof(desc), step.undoing ? "Undo: %s Reverted" : "Redo: %s Reapplied", step.label);
+        p->updateStatus((int)step.value, desc, "Warehouse");
+        eng->shippingList.refresh(p);
+        break;
+    }
+    case UF_DISPATCH_TIME:
+        p->dispatchTime = step.value;
+        break;
+    case UF_ARRIVAL_TIME:
+        p->arrivalTime = step.value;
+        eng->shippingList.refresh(p);
+        break;
+    case UF_RIDER:
+        p->assignedRider.assign(step.bytes.data(), step.bytes.size());
+        break;
+    case UF_ROUTE:
+        if (step.bytes.size() < sizeof(double)) {
+            eng->changeRoute(p, nullptr, 0, 0);
+        }
+        else {
+            double departHour;
+            memcpy(&departHour, step.bytes.data(), sizeof(double));
+            int n = (int)((step.bytes.size() - sizeof(double)) / sizeof(int));
+            int* edges = new int[n > 0 ? n : 1];
+            memcpy(edges, step.bytes.data() + sizeof(double), n * sizeof(int));
+            eng->changeRoute(p, edges, n, departHour);
+            delete[] edges;
+        }
+        break;
+    case UF_IN_QUEUE:
+        if (step.value && !eng->sortingQueue.contains(p)) eng->sortingQueue.insert(p);
+        else if (!step.value) eng->sortingQueue.remove(p);
+        break;
+    case UF_ON_ROAD:
+        if (step.value && p->shipRow < 0) {
+            eng->shippingList.pushBack(p);
+            eng->routeIndex.add(p);
+        }
+        else if (!step.value && p->shipRow >= 0) {
+            eng->routeIndex.remove(p);
+            eng->shippingList.remove(p);
+        }
+        break;
+    }
+}
+
+const char* LogisticsEngine::tryUndo(int* parcels) {
+    UndoContext uc = { this, nullptr, 0 };
+    const char* label = journal.undo(applyUndoStep, &uc);
+    publishChanges();
+    if (parcels) *parcels = uc.parcels;
+    return label;
+}
+
+const char* LogisticsEngine::tryRedo(int* parcels) {
+    UndoContext uc = { this, nullptr, 0 };
+    const char* label = journal.redo(applyUndoStep, &uc);
+    publishChanges();
+    if (parcels) *parcels = uc.parcels;
+    return label;
+}
+
+int LogisticsEngine::dispatchBatch(int count) {
+    int sent = 0;
+    journal.begin("Batch Dispatch");
+    while (sent < count && dispatchNext(false, -1)) sent++;
+    journal.commit();
+    publishChanges();
+    return sent;
+}
+
+void LogisticsEngine::undoLast() {
+    int parcels = 0;
+    const char* label = tryUndo(&parcels);
+    if (!label) {
+        *console << GRAY << " [!] Nothing to undo.\n" << RESET;
+        return;
+    }
+    *console << GOLD << " [Undo] " << label << " reverted";
+    if (parcels > 1) *console << " (" << parcels << " parcels)";
+    *console << ".\n" << RESET;
+}
+
+void LogisticsEngine::redoLast() {
+    int parcels = 0;
+    const char* label = tryRedo(&parcels);
+    if (!label) {
+        *console << GRAY << " [!] Nothing to redo.\n" << RESET;
+        return;
+    }
+    *console << GOLD << " [Redo] " << label << " reapplied";
+    if (parcels > 1) *console << " (" << parcels << " parcels)";
+    *console << ".\n" << RESET;
+}
+
+void LogisticsEngine::updateRealTime() {
+    if (!isWarm()) continueWarmup(WARMUP_SLICE_MICROS);
+    if (readOnly) {
+        if (nextIds) continueIdRebuild(ID_REBUILD_SLICE_MICROS);
+        return;
+    }
+    long long now = static_cast<long long>(time(0));
+    ParcelArrayList leftRoad;
+    shippingList.updateLifecycle(now, &leftRoad);
+    for (int i = 0; i < leftRoad.size(); i++) {
+        Parcel* p = leftRoad.get(i);
+        routeIndex.remove(p);
+        // A failed delivery sends the parcel round again; its road leg was
+        // counted when it first ended
+        if (p->deliveryAttempts > 0) continue;
+        analytics.routeFinished(p->routeCode, p->status != STATUS_MISSING, now - p->dispatchTime);
+    }
+    if (hubLink.handoff) handOffArrivals(leftRoad);
+
+    // The sweep frees parcels, and the backlog still points at some
+    if (isWarm() && now - lastArchiveSweep >= ARCHIVE_SWEEP_SECONDS) {
+        lastArchiveSweep = now;
+        archiveExpired(now);
+    }
+    if (nextIds) continueIdRebuild(ID_REBUILD_SLICE_MICROS);
+    publishChanges();
+}
+
+void LogisticsEngine::setRetention(long long seconds) {
+    retentionSeconds = seconds > 0 ? seconds : 0;
+}
+
+void LogisticsEngine::setDispatchPolicy(const DispatchPolicy& policy) {
+    sortingQueue.setPolicy(policy);
+}
+
+struct ArchiveSweep {
+    long long cutoff;
+    ParcelArrayList* expired;
+};
+
+static void collectExpired(Parcel* p, void* ctx) {
+    ArchiveSweep* sweep = (ArchiveSweep*)ctx;
+    bool final = p->status == STATUS_DELIVERED || p->status == STATUS_RETURNED || p->status == STATUS_CANCELLED;
+    if (final && p->lastUpdateTime <= sweep->cutoff) sweep->expired->add(p);
+}
+
+static bool isLeaving(const Parcel* p, void*) {
+    return p->leaving;
+}
+
+// Moves expired final-state parcels to the cold tier and frees them. The
+// archive is written first; if that fails everything stays hot and the
+// next sweep tries again.
+void LogisticsEngine::archiveExpired(long long now) {
+    ParcelArrayList expired;
+    ArchiveSweep sweep = { now - retentionSeconds, &expired };
+    database.forEach(collectExpired, &sweep);
+    int n = expired.size();
+    if (n == 0) return;
+
+    Parcel** rows = new Parcel*[n];
+    for (int i = 0; i < n; i++) rows[i] = expired.get(i);
+    if (!cold.archive(rows, n)) {
+        delete[] rows;
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        rows[i]->leaving = true;
+        if (publisher) publisher->archive(rows[i]->id);
+    }
+    journal.forget(isLeaving, nullptr);
+    for (int i = 0; i < n; i++) {
+        detach(rows[i]);
+        delete rows[i];
+    }
+    delete[] rows;
+}
+
+// Drops every reference this engine holds to the parcel; the caller decides
+// what becomes of it
+void LogisticsEngine::detach(Parcel* p) {
+    database.remove(p->id);
+    geoStale = true;
+    if (sortingQueue.contains(p)) sortingQueue.remove(p);
+    if (p->shipRow >= 0) {
+        routeIndex.remove(p);
+        shippingList.remove(p);
+    }
+    store.untrack(p);
+    if (p->publishPending) {
+        for (int i = 0; i < changed.size(); i++) {
+            if (changed.get(i) != p) continue;
+            changed.swap(i, changed.size() - 1);
+            changed.removeLast();
+            break;
+        }
+        p->publishPending = false;
+    }
+}
+
+// Parcels that reached the hub of a zone this engine does not own change
+// hands there. The journal lets go of them first: undo cannot reach into
+// another hub.
+void LogisticsEngine::handOffArrivals(ParcelArrayList& leftRoad) {
+    int moving = 0;
+    for (int i = 0; i < leftRoad.size(); i++) {
+        Parcel* p = leftRoad.get(i);
+        if (p->status == STATUS_DELIVERY_ATTEMPT && transferHub(p)) {
+            p->leaving = true;
+            moving++;
+        }
+    }
+    if (moving == 0) return;
+
+    journal.forget(isLeaving, nullptr);
+    for (int i = 0; i < leftRoad.size(); i++) {
+        Parcel* p = leftRoad.get(i);
+        if (!p->leaving) continue;
+        detach(p);
+        if (publisher) publisher->remove(p->id);
+        p->leaving = false;
+        hubLink.handoff(p, hubLink.ctx);
+    }
+}
+
+// The ID stays remembered by the hub that issued it as well; a lookup there
+// finds nothing and falls through, which is what a false positive costs
+void LogisticsEngine::adoptParcel(Parcel* p) {
+    p->queueSlot = -1;
+    p->shipRow = -1;
+    p->storeSegment = -1;
+    p->leaving = false;
+    p->deliveryAttempts = 0;
+    p->assignedRider = "";
+    p->clearRoute();
+    p->routeCode.clear();   // the sending hub counted that leg
+
+    database.insert(p->id, p);
+    store.track(p);
+    rememberId(p->id);
+    p->updateStatus(STATUS_WAREHOUSE, "Received at " + hubCity + " Hub", hubCity);
+    // Its time here counts from arrival at this hub
+    p->queuedSince = time(0);
+    sortingQueue.insert(p);
+    publishChanges();
+}
+
+// Incremental rerouting after a road closes: only parcels whose stored route
+// uses the closed edge are touched. Each one finishes the edge it is on, then
+// takes the fastest open route from the next city.
+void LogisticsEngine::rerouteAffected(int blockedEdge) {
+    analytics.roadClosed(blockedEdge);
+    int n = routeIndex.countOf(blockedEdge);
+    if (n == 0) return;
+
+    Parcel** affected = new Parcel * [n];
+    n = routeIndex.usersOf(blockedEdge, affected, n);
+    long long now = static_cast<long long>(time(0));
+    int rerouted = 0;
+
+    for (int a = 0; a < n; a++) {
+        Parcel* p = affected[a];
+        if (p->status != STATUS_LOADING && p->status != STATUS_IN_TRANSIT) {
+            routeIndex.remove(p);
+            continue;
+        }
+
+        // Locate the parcel on its route by replaying the road clock
+        double elapsed = (double)(now - p->dispatchTime) / SIM_SECONDS_PER_ROAD_HOUR;
+        double t = p->routeDepartHour;
+        int pos = 0;
+        while (pos < p->routeLength) {
+            double dt = map.edgeTravelHours(map.getEdge(p->routeEdges[pos]), t);
+            if (t + dt - p->routeDepartHour > elapsed) break;
+            t += dt;
+            pos++;
+        }
+        if (pos >= p->routeLength) continue;
+
+        int blockedAt = -1;
+        for (int i = pos + 1; i < p->routeLength; i++)
+            if (p->routeEdges[i] == blockedEdge) blockedAt = i;
+        if (blockedAt == -1) continue;   // already on or past the closed road
+
+        // Finish the current edge, then search from the city it ends at
+        Edge& current = map.getEdge(p->routeEdges[pos]);
+        double atNext = t + map.edgeTravelHours(current, t);
+        int from = current.dest;
+        int dest = map.getCityIndex(p->destination);
+
+        IntArrayList detour;
+        double arrive = map.fastestArrival(from, dest, atNext, &detour);
+        routeIndex.remove(p);
+        analytics.routeBlocked(p->routeCode, blockedEdge);
+
+        if (arrive < 0) {
+            p->updateStatus(STATUS_RETURNED, "No Open Route - Returning to Sender", map.cities[from].name);
+            shippingList.refresh(p);
+            continue;
+        }
+
+        markChanged(p);
+        int* edges = new int[pos + 1 + detour.size()];
+        for (int i = 0; i <= pos; i++) edges[i] = p->routeEdges[i];
+        int count = pos + 1 + map.pathToEdges(detour, edges + pos + 1);
+        changeRoute(p, edges, count, p->routeDepartHour);
+        delete[] edges;
+        routeIndex.add(p);
+
+        p->arrivalTime = p->dispatchTime +
+            (long long)ceil((arrive - p->routeDepartHour) * SIM_SECONDS_PER_ROAD_HOUR);
+        shippingList.refresh(p);
+        p->history->addEvent("Rerouted Around Road Block", map.cities[from].name);
+        rerouted++;
+    }
+    delete[] affected;
+
+    if (rerouted > 0)
+        *console << GOLD << " [!] " << rerouted << " in-transit parcel(s) rerouted around the closure.\n" << RESET;
+}
+
+// Terminal lines around the tables: titles, frames, the pager and prompt
+const int MONITOR_CHROME_LINES = 10;
+const int LIST_CHROME_LINES = 12;
+const int MIN_TABLE_ROWS = 5;
+
+static int tableRows(int chrome) {
+    int rows = TerminalFrame::rows() - chrome;
+    return rows < MIN_TABLE_ROWS ? MIN_TABLE_ROWS : rows;
+}
+
+void LogisticsEngine::liveMonitor() {
+    finishWarmup();
+    char cmd = 'r';
+    while (cmd == 'r' || cmd == 'R') {
+        clearScreen();
+        *console << BG_BLUE << "   LIVE TRANSIT MONITOR   " << RESET << "\n\n";
+        updateRealTime();
+        shippingList.showTransitStatus(*console, static_cast<long long>(time(0)), tableRows(MONITOR_CHROME_LINES));
+        *console << GRAY << "\n ──────────────────────────────────────────" << RESET << "\n";
+        *console << " [r] Refresh Data   [x] Main Menu » ";
+        cin >> cmd;
+    }
+}
+
+void LogisticsEngine::viewParcel(string_view id) {
+    Parcel* p = findParcel(id);
+    Parcel* archivedCopy = nullptr;
+    if (!p) p = archivedCopy = loadArchived(id);
+    if (p) {
+        *console << "\n" << BOLD << CYAN << " ════════════ TRACKING: " << p->id << " ════════════" << RESET << "\n";
+        if (archivedCopy) *console << GRAY << " (from the archive)" << RESET << "\n";
+        *console << *p << "\n";
+
+        *console << " Progress: [";
+        for (int i = 0; i < 6; i++) {
+            if (i <= p->status) *console << GREEN << "■" << RESET;
+            else *console << GRAY << "□" << RESET;
+        }
+        *console << "]\n";
+        if (!p->routeCode.empty()) {
+            *console << " Route: ";
+            printRoute(*console, map, p->routeCode);
+            *console << "\n";
+        }
+        *console << "\n";
+
+        p->history->printTimeline(*console);
+
+        if (p->status == STATUS_IN_TRANSIT) {
+            long long rem = p->arrivalTime - static_cast<long long>(time(0));
+            if (rem > 0)
+                *console << CYAN << "\n >>> LIVE ETA: " << rem << " seconds (~"
+                     << formatHours((double)rem / SIM_SECONDS_PER_ROAD_HOUR) << " h on the road)" << RESET << "\n";
+        }
+    }
+    else {
+        *console << RED << " [!] Tracking ID not found in database.\n" << RESET;
+    }
+    delete archivedCopy;
+}
+
+// A screenful at a time: only the page on show is formatted, however many
+// parcels the table holds
+void LogisticsEngine::listAll() {
+    int rows = tableRows(LIST_CHROME_LINES);
+    int total = database.size();
+    int pages = total > 0 ? (total + rows - 1) / rows : 1;
+    // Table slot each page seen so far starts at, for paging back
+    IntArrayList pageStarts;
+    pageStarts.add(0);
+    int page = 0;
+    char cmd;
+    while (true) {
+        clearScreen();
+        *console << CYAN << "\n [ COMPLETE INVENTORY RECORDS ]\n" << RESET;
+        int next = database.printPage(*console, pageStarts[page], rows);
+        *console << GRAY << " Page " << page + 1 << " of " << pages << " (" << total << " parcels)" << RESET << "\n";
+        if (next >= 0) *console << " [n] Next  ";
+        if (page > 0) *console << " [p] Previous  ";
+        *console << " [x] Main Menu » ";
+        if (!(cin >> cmd) || cmd == 'x' || cmd == 'X') return;
+
+        if ((cmd == 'n' || cmd == 'N') && next >= 0) {
+            if (page + 1 == pageStarts.size()) pageStarts.add(next);
+            page++;
+        }
+        else if ((cmd == 'p' || cmd == 'P') && page > 0) {
+            page--;
+        }
+    }
+}
+
+// Only segments with changed parcels are snapshotted; the store's writer
+// thread puts them on disk in the background
+void LogisticsEngine::saveToFile() {
+    int segments = store.flush();
+    *console << GREEN << " [✓] Data synced to " << store.directory() << " (" << segments << " changed segment"
+         << (segments == 1 ? "" : "s") << ")\n" << RESET;
+    if (!analytics.save(map, store.directory() + ANALYTICS_FILE))
+        *console << RED << " [!] Could not save the route analytics.\n" << RESET;
+}
+
+// Export streams through one reusable buffer, written out in ~1 MB chunks
+const size_t EXPORT_CHUNK_BYTES = 1 << 20;
+
+template <class Writer>
+struct ExportContext {
+    Writer* w;
+    OutBuffer* buf;
+    ofstream* file;
+    long long now;
+};
+
+template <class Writer>
+static void exportOne(Parcel* p, void* ctx) {
+    ExportContext<Writer>* ec = (ExportContext<Writer>*)ctx;
+    writeParcel(*ec->w, *p, true, ec->now);
+    if (ec->buf->size() >= EXPORT_CHUNK_BYTES) {
+        ec->file->write(ec->buf->data(), (streamsize)ec->buf->size());
+        ec->buf->clear();
+    }
+}
+
+template <class Writer>
+static void exportAll(ParcelHashTable& database, OutBuffer& buf, ofstream& file) {
+    int total = database.size();   // MessagePack wants the length up front
+
+    Writer w(buf);
+    ExportContext<Writer> ctx = { &w, &buf, &file, (long long)time(0) };
+    w.beginObject(2);
+    w.key("exportedAt"); w.value(ctx.now);
+    w.key("parcels");
+    w.beginArray(total);
+    database.forEach(exportOne<Writer>, &ctx);
+    w.endArray();
+    w.endObject();
+    file.write(buf.data(), (streamsize)buf.size());
+}
+
+bool LogisticsEngine::exportParcels(const string& path, bool msgpack) {
+    ofstream f(path, ios::binary);
+    if (!f.is_open()) return false;
+
+    OutBuffer buf(EXPORT_CHUNK_BYTES + 64 * 1024);
+    if (msgpack) exportAll<MsgPackWriter>(database, buf, f);
+    else exportAll<JsonWriter>(database, buf, f);
+    return f.good();
+}
+
+// Numbers are short; a missing field reads as 0
+static double fieldNumber(string_view f) {
+    char buf[32];
+    size_t n = f.size() < sizeof(buf) - 1 ? f.size() : sizeof(buf) - 1;
+    if (n > 0) memcpy(buf, f.data(), n);
+    buf[n] = '\0';
+    return strtod(buf, nullptr);
+}
+
+// One stored line: id,dest,weight,priority,status,zone[,route code]. Builds
+// the parcel and nothing else; the snapshot is parsed on several threads at
+// once.
+Parcel* LogisticsEngine::parseRecord(const string& text) {
+    string_view line = text;
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);   // files saved on Windows
+    string_view field[7];
+    for (int i = 0; i < 7; i++) {
+        size_t comma = i < 6 ? line.find(',') : string_view::npos;
+        field[i] = line.substr(0, comma);
+        line = comma == string_view::npos ? string_view() : line.substr(comma + 1);
+    }
+    if (field[2].empty()) return nullptr;
+
+    double w = fieldNumber(field[2]);
+    int p = (int)fieldNumber(field[3]);
+    int s = (int)fieldNumber(field[4]);
+    Parcel* newP = new Parcel(string(field[0]), string(field[1]), w, p, string(field[5]));
+    newP->status = s;
+    newP->routeCode = string(field[6]);
+    // Saved records carry no times; waiting parcels start their wait now
+    newP->queuedSince = time(0);
+    return newP;
+}
+
+// First run after the switch to segments: import the old flat file; the
+// next save writes it out as segments
+void LogisticsEngine::importFlatFile() {
+    ifstream f("parcels.txt");
+    string line;
+    while (getline(f, line)) {
+        Parcel* p = parseRecord(line);
+        if (!p) continue;
+        // A hub shard imports only its own zone's share
+        if (!ownsZone(p->zone)) {
+            delete p;
+            continue;
+        }
+        database.insert(p->id, p);
+        store.track(p);
+        warmBacklog.add(p);
+    }
+}
+
+// =====================================================
+// Startup Warm-up (queues filled after "ready")
+// =====================================================
+void LogisticsEngine::continueWarmup(long long budgetMicros) {
+    auto start = chrono::steady_clock::now();
+    long long now = time(0);
+    while (warmNext < warmBacklog.size()) {
+        Parcel* p = warmBacklog[warmNext++];
+        if (!analyticsRestored) analytics.routeTaken(map, p->routeCode);
+        restoreRoute(p, now);
+        if (p->status == STATUS_WAREHOUSE) sortingQueue.insert(p);
+        if (p->status >= STATUS_LOADING && p->status <= STATUS_DELIVERY_ATTEMPT) shippingList.pushBack(p);
+        if ((warmNext & 255) == 0) {
+            auto spent = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+            if (spent.count() >= budgetMicros) return;
+        }
+    }
+    warmBacklog = ParcelArrayList();
+    warmNext = 0;
+    startup.warmMs = msSince(startedAt);
+    // Until now knownIds was nullptr and every ID counted as possibly known
+    if (!knownIds && !nextIds) startIdRebuild();
+}
+
+// A stored parcel has its route code only; the edges come back from the
+// map. Like a waiting parcel's wait, a parcel still travelling starts its
+// leg again now, with the ETA the route gives at this hour.
+void LogisticsEngine::restoreRoute(Parcel* p, long long now) {
+    if (p->routeCode.empty() || p->routeLength > 0) return;
+    IntArrayList cities;
+    if (!decodeRoute(p->routeCode, cities) || cities.size() < 2) return;
+    int* edges = new int[cities.size()];
+    int n = map.pathToEdges(cities, edges);
+    // A road the map no longer has leaves the parcel without a route
+    if (n == cities.size() - 1) {
+        double departHour = currentHourOfDay();
+        p->setRoute(edges, n, departHour);
+        if (p->status == STATUS_LOADING || p->status == STATUS_IN_TRANSIT) {
+            long long travelSecs = (long long)ceil(map.routeTravelHours(cities, departHour) * SIM_SECONDS_PER_ROAD_HOUR);
+            p->dispatchTime = now;
+            p->arrivalTime = now + (travelSecs < 1 ? 1 : travelSecs);
+            routeIndex.add(p);
+        }
+    }
+    delete[] edges;
+}
+
+// For the actions that take parcels out of the queues or reorder them: a
+// half-filled queue would hand out the wrong parcel or lose one on undo
+void LogisticsEngine::finishWarmup() {
+    if (!isWarm()) continueWarmup(LLONG_MAX);
+}
+
+bool LogisticsEngine::isWarm() const {
+    return warmNext >= warmBacklog.size();
+}
+
+const LogisticsEngine::StartupStats& LogisticsEngine::startupStats() const {
+    return startup;
+}
+
+bool LogisticsEngine::tryCancel(string_view id) {
+    finishWarmup();
+    Parcel* p = database.search(id);
+    if (!p || p->status > STATUS_WAREHOUSE) return false;
+
+    journal.begin("Cancel");
+    // A cancelled parcel must not be dispatched later
+    if (sortingQueue.contains(p)) {
+        journal.recordValue(p, UF_IN_QUEUE, 1, 0);
+        sortingQueue.remove(p);
+    }
+    journal.recordValue(p, UF_STATUS, p->status, STATUS_CANCELLED);
+    p->updateStatus(STATUS_CANCELLED, "Cancelled by Admin", "Warehouse");
+    journal.commit();
+    publishChanges();
+    return true;
+}
+
+Parcel* LogisticsEngine::findParcel(string_view id) {
+    if (!maybeKnownId(id)) return nullptr;
+    return database.search(id);
+}
+
+Parcel* LogisticsEngine::loadArchived(string_view id) {
+    if (!maybeKnownId(id)) return nullptr;
+    return cold.load(id);
+}
+
+// =====================================================
+// Known-ID Filter (online rebuild)
+// =====================================================
+bool LogisticsEngine::maybeKnownId(string_view id) const {
+    return !knownIds || knownIds->mayContain(id);
+}
+
+void LogisticsEngine::rememberId(string_view id) {
+    if (knownIds) knownIds->add(id);
+    if (nextIds) nextIds->add(id);
+    if (knownIds && knownIds->saturated() && !nextIds) startIdRebuild();
+}
+
+static void addHotId(Parcel* p, void* ctx) {
+    ((BloomFilter*)ctx)->add(p->id);
+}
+
+static void addColdId(string_view id, void* ctx) {
+    ((BloomFilter*)ctx)->add(id);
+}
+
+// The hot IDs go in at once (the hot set is bounded by the retention); the
+// archive is folded in a block at a time by continueIdRebuild(). The old
+// filter keeps answering meanwhile: it may be over-full, but it has no
+// false negatives.
+void LogisticsEngine::startIdRebuild() {
+    delete nextIds;
+    nextIds = new BloomFilter((database.size() + cold.size()) * 2, idFalsePositiveRate);
+    database.forEach(addHotId, nextIds);
+    nextIdsBlock = 0;
+    continueIdRebuild(ID_REBUILD_SLICE_MICROS);
+}
+
+void LogisticsEngine::continueIdRebuild(long long budgetMicros) {
+    if (!nextIds) return;
+    auto start = chrono::steady_clock::now();
+    while (nextIdsBlock < cold.blocksWritten()) {
+        if (!cold.forEachId(nextIdsBlock, addColdId, nextIds)) {
+            // An unreadable block would leave holes; keep the old filter
+            delete nextIds;
+            nextIds = nullptr;
+            return;
+        }
+        nextIdsBlock++;
+        auto spent = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        if (spent.count() >= budgetMicros) return;
+    }
+    delete knownIds;
+    knownIds = nextIds;
+    nextIds = nullptr;
+}
+
+void LogisticsEngine::setIdFalsePositiveRate(double rate) {
+    idFalsePositiveRate = rate;
+    startIdRebuild();
+}
+
+void LogisticsEngine::forEachParcel(void (*visit)(Parcel*, void*), void* ctx) {
+    database.forEach(visit, ctx);
+}
+
+int LogisticsEngine::parcelCount() const {
+    return database.size();
+}
+
+long long LogisticsEngine::archivedCount() const {
+    return cold.size();
+}
+
+bool LogisticsEngine::closeRoad(int edgeId) {
+    if (!map.blockRoad(edgeId)) return false;
+    if (readOnly) {
+        analytics.roadClosed(edgeId);
+        return true;
+    }
+    rerouteAffected(edgeId);
+    publishChanges();
+    return true;
+}
+
+MapGraph& LogisticsEngine::getMap() {
+    return map;
+}
+
+// A closure costs about the road's length again in detour, so each road
+// adds its km times the share of its parcels a closure turned back
+double LogisticsEngine::routeRiskKm(int pathIndex) {
+    if (pathIndex < 0 || pathIndex >= map.pathCount) return 0;
+    const IntArrayList& path = map.availablePaths[pathIndex];
+    double km = 0;
+    for (int i = 0; i + 1 < path.size(); i++) {
+        int e = map.findEdgeId(path[i], path[i + 1]);
+        if (e >= 0) km += map.getEdge(e).weight * analytics.closureShare(e);
+    }
+    return km;
+}
+
+int LogisticsEngine::recommendedRoute() {
+    int best = map.getMinRouteIndex();
+    if (best < 0) return best;
+    double bestKm = map.availablePathDistances[best] + routeRiskKm(best);
+    for (int i = 0; i < map.pathCount; i++) {
+        double km = map.availablePathDistances[i] + routeRiskKm(i);
+        if (km < bestKm) {
+            best = i;
+            bestKm = km;
+        }
+    }
+    return best;
+}
+
+const RouteAnalytics& LogisticsEngine::routeAnalytics() const {
+    return analytics;
+}
+
+// =====================================================
+// Parcel Positions (Radius Queries)
+// =====================================================
+bool LogisticsEngine::parcelPosition(const Parcel* p, long long now, double& lat, double& lon) {
+    int city = -1;
+    switch (p->status) {
+    case STATUS_IN_TRANSIT:
+        return map.routePosition(p->routeEdges, p->routeLength, p->routeDepartHour,
+                                 (double)(now - p->dispatchTime) / SIM_SECONDS_PER_ROAD_HOUR, lat, lon);
+    case STATUS_DELIVERY_ATTEMPT:
+    case STATUS_DELIVERED:
+        city = map.getCityIndex(p->destination);
+        break;
+    case STATUS_MISSING:
+        return false;
+    case STATUS_LOADING:
+        // Still in the bay its route leaves from
+        if (p->routeLength > 0) city = map.edgeSource(p->routeEdges[0]);
+        else city = map.getCityIndex(hubCity);
+        break;
+    default:
+        city = map.getCityIndex(hubCity);
+        break;
+    }
+    if (city < 0 || std::isnan(map.cities[city].lat)) return false;
+    lat = map.cities[city].lat;
+    lon = map.cities[city].lon;
+    return true;
+}
+
+struct GeoCollect {
+    LogisticsEngine* engine;
+    long long now;
+    ParcelArrayList* parcels;
+    double* lat;
+    double* lon;
+};
+
+static void collectPosition(Parcel* p, void* ctx) {
+    GeoCollect* gc = (GeoCollect*)ctx;
+    int i = gc->parcels->size();
+    if (gc->engine->parcelPosition(p, gc->now, gc->lat[i], gc->lon[i])) gc->parcels->add(p);
+}
+
+void LogisticsEngine::refreshParcelGeo(long long now) {
+    if (!geoStale && now == geoBuiltAt) return;
+    int n = database.size();
+    double* lat = new double[n + 1];
+    double* lon = new double[n + 1];
+    geoParcels.clear();
+    GeoCollect gc = { this, now, &geoParcels, lat, lon };
+    database.forEach(collectPosition, &gc);
+    parcelGeo.build(lat, lon, geoParcels.size());
+    delete[] lat;
+    delete[] lon;
+    geoBuiltAt = now;
+    geoStale = false;
+}
+
+void LogisticsEngine::parcelsNear(double lat, double lon, double km, ParcelArrayList& out) {
+    refreshParcelGeo(static_cast<long long>(time(0)));
+    IntArrayList hits;
+    parcelGeo.within(lat, lon, km, hits);
+    for (int i = 0; i < hits.size(); i++) out.add(geoParcels[hits[i]]);
+}
+
+// Roads have no shape, so "near the road" is near the straight line
+// between its cities, measured on a flat projection around its middle
+void LogisticsEngine::parcelsNearRoad(int edgeId, double km, ParcelArrayList& out) {
+    if (edgeId < 0 || edgeId >= map.edgeCount) return;
+    const CityNode& a = map.cities[map.edgeSource(edgeId)];
+    const CityNode& b = map.cities[map.getEdge(edgeId).dest];
+    if (std::isnan(a.lat) || std::isnan(b.lat)) return;
+
+    double midLat = (a.lat + b.lat) / 2, midLon = (a.lon + b.lon) / 2;
+    double half = geoDistanceKm(a.lat, a.lon, b.lat, b.lon) / 2;
+    ParcelArrayList candidates;
+    parcelsNear(midLat, midLon, half + km, candidates);
+
+    const double kmPerDegree = 111.195;
+    double xScale = kmPerDegree * cos(midLat * 3.14159265358979323846 / 180.0);
+    double ax = (a.lon - midLon) * xScale, ay = (a.lat - midLat) * kmPerDegree;
+    double bx = (b.lon - midLon) * xScale, by = (b.lat - midLat) * kmPerDegree;
+    double dx = bx - ax, dy = by - ay;
+    double lengthSquared = dx * dx + dy * dy;
+    long long now = static_cast<long long>(time(0));
+    for (int i = 0; i < candidates.size(); i++) {
+        double lat, lon;
+        if (!parcelPosition(candidates[i], now, lat, lon)) continue;
+        double px = (lon - midLon) * xScale, py = (lat - midLat) * kmPerDegree;
+        double t = lengthSquared > 0 ? ((px - ax) * dx + (py - ay) * dy) / lengthSquared : 0;
+        if (t < 0) t = 0;
+        if (t > 1) t = 1;
+        double ex = px - (ax + t * dx), ey = py - (ay + t * dy);
+        if (ex * ex + ey * ey <= km * km) out.add(candidates[i]);
+    }
+}
+
+// =====================================================
+// Replication (primary stream, standby replica)
+// =====================================================
+void LogisticsEngine::setPublisher(ReplicationPublisher* pub) {
+    if (publisher) removeStatusListener(onStatusChange, this);
+    publisher = pub;
+    closuresPublished = map.closures.size();   // a standby's snapshot carries the older ones
+    if (publisher) addStatusListener(onStatusChange, this);
+}
+
+void LogisticsEngine::onStatusChange(const Parcel& p, int, void* ctx) {
+    ((LogisticsEngine*)ctx)->markChanged(const_cast<Parcel*>(&p));
+}
+
+void LogisticsEngine::markChanged(Parcel* p) {
+    if (!publisher || p->publishPending) return;
+    p->publishPending = true;
+    changed.add(p);
+}
+
+static void snapshotOne(Parcel* p, void* ctx) {
+    ((ReplicationPublisher*)ctx)->snapshotRow(*p);
+}
+
+// Sends the final image of each touched parcel, once, however many times
+// the action changed it; a standby that just attached gets everything
+void LogisticsEngine::publishChanges() {
+    if (!publisher) return;
+    for (int i = 0; i < changed.size(); i++) {
+        Parcel* p = changed.get(i);
+        p->publishPending = false;
+        publisher->upsert(*p);
+    }
+    changed.clear();
+    while (closuresPublished < map.closures.size())
+        publisher->closeRoad(map.closures.get(closuresPublished++));
+
+    if (publisher->wantsSnapshot()) {
+        publisher->beginSnapshot();
+        database.forEach(snapshotOne, publisher);
+        for (int i = 0; i < map.closures.size(); i++) publisher->snapshotClosure(map.closures.get(i));
+    }
+    publisher->commit();
+}
+
+void LogisticsEngine::setReadOnly(bool on) {
+    readOnly = on;
+}
+
+bool LogisticsEngine::isReadOnly() const {
+    return readOnly;
+}
+
+// Container membership follows the status, as when loading from disk:
+// warehouse parcels wait in the sorting queue, parcels between loading and the
+// delivery attempt are on the road, and moving ones are in the route index
+void LogisticsEngine::placeReplica(Parcel* p) {
+    bool queued = p->status == STATUS_WAREHOUSE;
+    if (queued && !sortingQueue.contains(p)) sortingQueue.insert(p);
+    else if (!queued && sortingQueue.contains(p)) sortingQueue.remove(p);
+
+    bool onRoad = p->status >= STATUS_LOADING && p->status <= STATUS_DELIVERY_ATTEMPT;
+    if (onRoad && p->shipRow < 0) shippingList.pushBack(p);
+    else if (!onRoad && p->shipRow >= 0) shippingList.remove(p);
+    else if (onRoad) shippingList.refresh(p);
+    if (onRoad && p->status != STATUS_DELIVERY_ATTEMPT) routeIndex.add(p);
+}
+
+void LogisticsEngine::applyReplicated(Parcel* image) {
+    finishWarmup();
+    Parcel* p = database.search(image->id);
+    if (!p) {
+        database.insert(image->id, image);
+        store.track(image);
+        rememberId(image->id);
+        changeRoute(image, image->routeEdges, image->routeLength, image->routeDepartHour);
+        placeReplica(image);
+        return;
+    }
+
+    // Update in place so the queue and table positions stay valid; the route
+    // index is keyed by the old route, so leave it before the route changes
+    if (p->shipRow >= 0) routeIndex.remove(p);
+    p->destination = move(image->destination);
+    p->zone = move(image->zone);
+    p->assignedRider = move(image->assignedRider);
+    p->status = image->status;
+    p->deliveryAttempts = image->deliveryAttempts;
+    p->dispatchTime = image->dispatchTime;
+    p->lastUpdateTime = image->lastUpdateTime;
+    p->arrivalTime = image->arrivalTime;
+    p->queuedSince = image->queuedSince;
+    changeRoute(p, image->routeEdges, image->routeLength, image->routeDepartHour);
+    TrackingHistory* history = p->history;
+    p->history = image->history;
+    image->history = history;
+    delete image;
+
+    store.markDirty(p);
+    placeReplica(p);
+}
+
+void LogisticsEngine::removeReplicated(string_view id) {
+    finishWarmup();
+    Parcel* p = database.search(id);
+    if (!p) return;
+    detach(p);
+    delete p;
+}
+
+// If the archive cannot be written the parcels stay hot (and saved in the
+// segments); the primary has them archived either way
+void LogisticsEngine::archiveReplicated(ParcelArrayList& parcels) {
+    finishWarmup();
+    int n = parcels.size();
+    Parcel** rows = new Parcel*[n];
+    for (int i = 0; i < n; i++) rows[i] = parcels.get(i);
+    if (cold.archive(rows, n)) {
+        for (int i = 0; i < n; i++) {
+            detach(rows[i]);
+            delete rows[i];
+        }
+    }
+    delete[] rows;
+}
+
+static void collectAll(Parcel* p, void* ctx) {
+    ((ParcelArrayList*)ctx)->add(p);
+}
+
+void LogisticsEngine::clearReplica() {
+    finishWarmup();
+    ParcelArrayList all;
+    database.forEach(collectAll, &all);
+    for (int i = 0; i < all.size(); i++) {
+        analytics.routeDropped(map, all.get(i)->routeCode);
+        detach(all.get(i));
+        delete all.get(i);
+    }
+}
+
+void LogisticsEngine::cancelParcel(string_view id) {
+    if (tryCancel(id)) {
+        *console << GREEN << " [✓] Parcel " << id << " cancelled successfully.\n" << RESET;
+    }
+    else {
+        *console << RED << " [!] Cannot cancel: Parcel is already in transit or missing.\n" << RESET;
+    }
 }
\ No newline at end of file
@@ -1,37 +1,247 @@
-#ifndef LOGISTICSENGINE_H
-#define LOGISTICSENGINE_H
-
-#include <string>
-#include "datastructures.h"
-#include "parcellinkedlist.h"
-#include "mapgraph.h"
-
-class LogisticsEngine {
-private:
-    ParcelHashTable database;
-    ParcelHeap sortingQueue;
-    ParcelLinkedList shippingList;
-    StringQueue riderQueue;
-    MapGraph map;
-    ActionStack undoStack;
-
-    void setupMap();
-    void setupRiders();
-    void loadFromFile();
-
-public:
-    LogisticsEngine();
-
-    void requestPickup(std::string id, std::string dest, double w, int p);
-    void processNext();
-    void showMap();
-    void undoLast();
-    void updateRealTime();
-    void liveMonitor();
-    void viewParcel(std::string id);
-    void listAll();
-    void saveToFile();
-    void cancelParcel(std::string id);
-};
-
+#ifndef LOGISTICSENGINE_H
+#define LOGISTICSENGINE_H
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <chrono>
+#include "datastructures.h"
+#include "dispatchscheduler.h"
+#include "transittable.h"
+#include "mapgraph.h"
+#include "routeindex.h"
+#include "routeanalytics.h"
+#include "undojournal.h"
+#include "parcelstore.h"
+#include "coldstore.h"
+#include "bloomfilter.h"
+#include "serializer.h"
+
+class ReplicationPublisher;
+
+// Local wall-clock time as fractional hours since midnight
+double currentHourOfDay();
+
+// Result codes for the non-printing API (used by the HTTP server)
+enum PickupResult {
+    PICKUP_OK = 0,
+    PICKUP_UNKNOWN_CITY,
+    PICKUP_DUPLICATE_ID
+};
+
+class LogisticsEngine {
+public:
+    // Wiring for an engine that is one hub of several (see HubCluster).
+    // hubFor names the hub city serving a zone this engine does not own;
+    // handoff receives parcels that reached that hub. Both are called on
+    // the engine's own thread.
+    struct HubLink {
+        const char* (*hubFor)(const std::string& zone, void* ctx);
+        void (*handoff)(Parcel* p, void* ctx);
+        void* ctx;
+    };
+
+    // Milliseconds spent in each startup stage. The map, the riders with
+    // the archive index, and the parcel snapshot load side by side; the
+    // hot table is indexed next, and from then (readyMs after the start)
+    // parcels can be tracked. The queues and the transit table fill in
+    // afterwards, a slice per tick (warmMs after the start, 0 until done).
+    struct StartupStats {
+        double mapMs;
+        double ridersMs;
+        double archiveMs;
+        double snapshotMs;
+        double indexMs;
+        double readyMs;
+        double warmMs;
+        int parcels;
+    };
+
+private:
+    ParcelHashTable database;
+    DispatchScheduler sortingQueue;
+    TransitTable shippingList;
+    StringQueue riderQueue;
+    MapGraph map;
+    UndoJournal journal;
+    RouteIndex routeIndex;
+    RouteAnalytics analytics;
+    bool analyticsRestored;     // from the last save, which counted the saved parcels' routes
+    OutBuffer routeScratch;     // packed route images for the journal
+    ParcelStore store;
+    ColdStore cold;
+    long long retentionSeconds;    // how long final-state parcels stay hot
+    long long lastArchiveSweep;
+
+    // Every tracking ID ever issued, hot and archived, so most misses never
+    // reach the hash table or the disk. nextIds is a replacement being
+    // filled a slice at a time; until the first one is done, knownIds is
+    // nullptr and every ID counts as possibly known.
+    BloomFilter* knownIds;
+    BloomFilter* nextIds;
+    int nextIdsBlock;           // next cold block to fold into nextIds
+    double idFalsePositiveRate;
+
+    // Hub this engine dispatches from; with an empty hubZone it owns every
+    // zone (the single-engine setup)
+    std::string hubCity;
+    std::string hubZone;
+    HubLink hubLink;
+    int roadEventPercent;       // chance per dispatch of a simulated road block
+    FastRandom dice;            // road events; seeds the map's and the transit table's
+    std::ostream* console;
+
+    // Replication: a primary sends standbys every parcel an action touched
+    // (gathered in changed, sent by publishChanges); a read-only engine is
+    // a standby's replica and only changes through the apply calls
+    ReplicationPublisher* publisher;
+    ParcelArrayList changed;
+    int closuresPublished;
+    bool readOnly;
+
+    // Where the hot parcels are, for the radius queries: rebuilt at most
+    // once a second, and before the next query after a parcel leaves
+    GeoIndex parcelGeo;
+    ParcelArrayList geoParcels;     // index entry -> parcel
+    long long geoBuiltAt;
+    bool geoStale;
+
+    // Loaded parcels not yet in the sorting queue or the transit table:
+    // [warmNext, size) of warmBacklog
+    ParcelArrayList warmBacklog;
+    int warmNext;
+    StartupStats startup;
+    std::chrono::steady_clock::time_point startedAt;
+
+    // Passed through UndoJournal::undo/redo to the apply callback
+    struct UndoContext {
+        LogisticsEngine* engine;
+        Parcel* lastParcel;
+        int parcels;
+    };
+    static void applyUndoStep(const UndoStep& step, void* ctx);
+    void recordRoute(Parcel* p, const int* edges, int n, double departHour);
+    void changeRoute(Parcel* p, const int* edges, int n, double departHour);
+
+    void setupMap();
+    void setupRiders();
+    void importFlatFile();
+    static Parcel* parseRecord(const std::string& line);
+    void restoreRoute(Parcel* p, long long now);
+    void continueWarmup(long long budgetMicros);
+    void finishWarmup();
+    void showDistanceMatrix();
+    void rerouteAffected(int blockedEdge);
+    void archiveExpired(long long now);
+    void detach(Parcel* p);
+    bool ownsZone(const std::string& zone) const;
+    const char* transferHub(const Parcel* p) const;
+    void handOffArrivals(ParcelArrayList& leftRoad);
+    bool maybeKnownId(std::string_view id) const;
+    void rememberId(std::string_view id);
+    void startIdRebuild();
+    void continueIdRebuild(long long budgetMicros);
+    Parcel* dispatchNext(bool askRoute, int routeChoice);
+    Parcel* returnUnroutable(Parcel* p);
+    static void onStatusChange(const Parcel& p, int oldStatus, void* ctx);
+    void markChanged(Parcel* p);
+    void publishChanges();
+    void placeReplica(Parcel* p);
+    void refreshParcelGeo(long long now);
+
+public:
+    // dataDir holds the segments and the archive; each hub shard gets its
+    // own, and owns only ownZone's parcels (empty: every zone)
+    LogisticsEngine(const std::string& dataDir = "parcels.d", std::string_view ownZone = "");
+    ~LogisticsEngine();
+
+    // Where the console actions print (the hub shards run without one)
+    void setConsole(std::ostream& os);
+    void setHub(std::string_view city, const HubLink& link);
+    const std::string& getHubCity() const;
+    // Percent chance that a dispatch runs into a road block (default 20)
+    void setRoadEventRate(int percent);
+    // Replaces the clock seed, so the same actions roll the same road
+    // events and lifecycle dice (benchmarks, reproductions)
+    void setSeed(unsigned long long seed);
+    // Takes ownership of a parcel handed over by another hub and queues it
+    // for the next leg
+    void adoptParcel(Parcel* p);
+
+    void requestPickup(std::string_view id, std::string_view dest, double w, int p);
+    void processNext();
+    Parcel* processNextAuto(int routeChoice = -1);
+    void showMap();
+    void undoLast();
+    void redoLast();
+    void updateRealTime();
+    // Delivered / returned / cancelled parcels move to the cold tier once
+    // they have been untouched this long
+    void setRetention(long long seconds);
+    // Order of the warehouse sorting queue (see DispatchPolicy); parcels
+    // already waiting are re-ordered
+    void setDispatchPolicy(const DispatchPolicy& policy);
+    // Target false-positive rate of the known-ID filter; rebuilds it
+    void setIdFalsePositiveRate(double rate);
+    void liveMonitor();
+    void viewParcel(std::string_view id);
+    void listAll();
+    void saveToFile();
+    void cancelParcel(std::string_view id);
+    // Full inventory (with timelines) as JSON or MessagePack; false if the
+    // file cannot be written
+    bool exportParcels(const std::string& path, bool msgpack);
+
+    // Quiet counterparts of the console actions: they report through return
+    // values instead of printing
+    PickupResult addParcel(std::string_view id, std::string_view dest, double w, int p, Parcel** created = nullptr);
+    Parcel* findParcel(std::string_view id);
+    // Cold-tier copy of an archived parcel (caller deletes), or nullptr
+    Parcel* loadArchived(std::string_view id);
+    bool tryCancel(std::string_view id);
+    // Dispatches up to count parcels as one undo unit; returns how many left
+    int dispatchBatch(int count);
+    // Revert / reapply the newest undo unit; its label, or nullptr if none.
+    // parcels receives how many parcels it touched.
+    const char* tryUndo(int* parcels = nullptr);
+    const char* tryRedo(int* parcels = nullptr);
+    void forEachParcel(void (*visit)(Parcel*, void*), void* ctx);
+    int parcelCount() const;
+    long long archivedCount() const;
+    // Where the parcel is now: the hub while it waits, a point on its road
+    // while moving, the destination once it got there. False for missing
+    // parcels and cities without a position.
+    bool parcelPosition(const Parcel* p, long long now, double& lat, double& lon);
+    // Hot parcels within km of a point, or of a road (directed edge id)
+    void parcelsNear(double lat, double lon, double km, ParcelArrayList& out);
+    void parcelsNearRoad(int edgeId, double km, ParcelArrayList& out);
+    // Applies a road closure reported by another node and reroutes around
+    // it; false if the road was already closed
+    bool closeRoad(int edgeId);
+    MapGraph& getMap();
+    // After map.findAllPaths: the route to suggest, the shortest once each
+    // road's closure record is priced in, and that price for one route
+    int recommendedRoute();
+    double routeRiskKm(int pathIndex);
+    const RouteAnalytics& routeAnalytics() const;
+    const StartupStats& startupStats() const;
+    // False until every loaded parcel is back in its queue
+    bool isWarm() const;
+
+    // Primary side of replication (see replication.h); every action ends
+    // by publishing what it changed. Call on the engine's thread.
+    void setPublisher(ReplicationPublisher* pub);
+    // Standby side: the clock no longer moves parcels along, and closeRoad
+    // only marks the road (the primary sends the reroutes)
+    void setReadOnly(bool on);
+    bool isReadOnly() const;
+    // Replaces (or adds) a parcel with the primary's image; takes ownership
+    void applyReplicated(Parcel* image);
+    void removeReplicated(std::string_view id);
+    // Moves replica parcels to this engine's cold tier
+    void archiveReplicated(ParcelArrayList& parcels);
+    // Drops every hot parcel ahead of a fresh snapshot
+    void clearReplica();
+};
+
 #endif
\ No newline at end of file
@@ -1,152 +1,496 @@
-﻿#include <iostream>
-#include <string>
-#include <iomanip>
-#include "logisticsengine.h"
-
-using namespace std;
-
-#ifdef _WIN32
-#define CLEAR_CMD "cls"
-#else
-#define CLEAR_CMD "clear"
-#endif
-
-// ANSI Styles for a beautiful UI
-#define CYAN    "\033[1;36m"
-#define GOLD    "\033[1;33m"
-#define RED     "\033[1;31m"
-#define GREEN   "\033[1;32m"
-#define GRAY    "\033[90m"
-#define RESET   "\033[0m"
-#define BOLD    "\033[1m"
-
-void clearScreen() {
-    system(CLEAR_CMD);
-}
-
-void displayHeader() {
-    cout << CYAN;
-    cout << "                                           ____           _  __ _   _______  __\n";
-    cout << "                                          / ___|_      __(_)/ _| |_| ____\\ \\/ /\n";
-    cout << "                                          \\___ \\ \\ /\\ / /| | |_| __|  _|  \\  / \n";
-    cout << "                                           ___) \\ V  V / | |  _| |_| |___ /  \\ \n";
-    cout << "                                          |____/ \\_/\\_/  |_|_|  \\__|_____/_/\\_\\\n";
-    cout << RESET;
-    cout << GRAY << "                               ──────────────────────────────────────────────────────────\n" << RESET;
-    cout << BOLD << "                                  S W I F T E X   L O G I S T I C S   T E R M I N A L\n" << RESET;
-    cout << GRAY << "                               ──────────────────────────────────────────────────────────\n" << RESET;
-}
-
-void pauseFunc() {
-    cout << GRAY << "\n  (Press Enter to return to Dashboard)" << RESET;
-    cin.ignore(1000, '\n');
-    cin.get();
-}
-
-int main() {
-    LogisticsEngine engine;
-    int choice;
-
-    while (true) {
-        clearScreen();
-        displayHeader();
-
-        // System Status Bar
-        cout << GREEN << " [ONLINE]" << RESET << "  " << GRAY << "Location: Central Hub" << RESET << "\n\n";
-
-        // Dashboard Menu - Clean 2-Column Layout
-        cout << "  " << GOLD << "1." << RESET << " Add New Parcel          " << GOLD << "5." << RESET << " View Map Details\n";
-        cout << "  " << GOLD << "2." << RESET << " Dispatch Warehouse      " << GOLD << "6." << RESET << " Live Transit Monitor\n";
-        cout << "  " << GOLD << "3." << RESET << " Track Parcel            " << GOLD << "7." << RESET << " Cancel Parcel\n";
-        cout << "  " << GOLD << "4." << RESET << " List All Inventory      " << GOLD << "8." << RESET << " Undo Last Action\n";
-
-        cout << "\n  " << RED << "9. Save & Exit Terminal" << RESET << "\n";
-        cout << GRAY << " ──────────────────────────────────────────────────────────\n" << RESET;
-        cout << "  Enter Selection " << CYAN << "» " << RESET;
-
-        if (!(cin >> choice)) {
-            cin.clear();
-            cin.ignore(1000, '\n');
-            continue;
-        }
-
-        if (choice == 9) {
-            cout << "\n  " << CYAN << "Syncing database... Shutdown complete." << RESET << endl;
-            engine.saveToFile();
-            break;
-        }
-
-        switch (choice) {
-        case 1: {
-            string id, dest;
-            double w;
-            int p;
-            clearScreen();
-            cout << BOLD << CYAN << "[ PARCEL REGISTRATION ]\n" << RESET;
-            cout << "  ID Code: "; cin >> id;
-            cin.ignore(1000, '\n');
-            cout << "  Destination: "; getline(cin, dest);
-            cout << "  Weight (kg): "; cin >> w;
-            cout << "  Priority (1-High, 3-Low): "; cin >> p;
-            engine.requestPickup(id, dest, w, p);
-            cout << GREEN << "\n  ✔ Parcel successfully logged." << RESET << endl;
-            pauseFunc();
-            break;
-        }
-
-        case 2:
-            clearScreen();
-            cout << BOLD << CYAN << "[ WAREHOUSE DISPATCH ]\n" << RESET;
-            engine.processNext();
-            pauseFunc();
-            break;
-
-        case 3: {
-            string id;
-            clearScreen();
-            cout << "Enter Tracking ID: "; cin >> id;
-            engine.viewParcel(id);
-            pauseFunc();
-            break;
-        }
-
-        case 4:
-            clearScreen();
-            cout << BOLD << CYAN << "[ TOTAL INVENTORY LIST ]\n" << RESET;
-            engine.listAll();
-            pauseFunc();
-            break;
-
-        case 5:
-            clearScreen();
-            engine.showMap();
-            pauseFunc();
-            break;
-
-        case 6:
-            clearScreen();
-            engine.liveMonitor(); // Live monitors usually handle their own exit
-            break;
-
-        case 7: {
-            string id;
-            clearScreen();
-            cout << "Enter ID to Cancel: "; cin >> id;
-            engine.cancelParcel(id);
-            pauseFunc();
-            break;
-        }
-
-        case 8:
-            clearScreen();
-            engine.undoLast();
-            cout << GREEN << "\n  ✔ Last action reverted." << RESET << endl;
-            pauseFunc();
-            break;
-        }
-
-        engine.updateRealTime();
-    }
-
-    return 0;
+﻿#include <iostream>
+#include <string>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include "logisticsengine.h"
+#include "httpserver.h"
+#include "hubcluster.h"
+#include "cluster.h"
+#include "replication.h"
+#include "terminalframe.h"
+#include "nullbuffer.h"
+
+using namespace std;
+
+// ANSI Styles for a beautiful UI
+#define CYAN    "\033[1;36m"
+#define GOLD    "\033[1;33m"
+#define RED     "\033[1;31m"
+#define GREEN   "\033[1;32m"
+#define GRAY    "\033[90m"
+#define RESET   "\033[0m"
+#define BOLD    "\033[1m"
+
+// The interactive terminal's frame while the menu runs (see TerminalFrame)
+static TerminalFrame* frame = nullptr;
+
+// Clearing is an escape sequence at the head of the next frame, not a
+// shell spawned to run clear
+void clearScreen() {
+    if (frame) frame->clear();
+    else cout << "\033[H\033[2J\033[3J";
+}
+
+void displayHeader() {
+    cout << CYAN;
+    cout << "                                           ____           _  __ _   _______  __\n";
+    cout << "                                          / ___|_      __(_)/ _| |_| ____\\ \\/ /\n";
+    cout << "                                          \\___ \\ \\ /\\ / /| | |_| __|  _|  \\  / \n";
+    cout << "                                           ___) \\ V  V / | |  _| |_| |___ /  \\ \n";
+    cout << "                                          |____/ \\_/\\_/  |_|_|  \\__|_____/_/\\_\\\n";
+    cout << RESET;
+    cout << GRAY << "                               ──────────────────────────────────────────────────────────\n" << RESET;
+    cout << BOLD << "                                  S W I F T E X   L O G I S T I C S   T E R M I N A L\n" << RESET;
+    cout << GRAY << "                               ──────────────────────────────────────────────────────────\n" << RESET;
+}
+
+void pauseFunc() {
+    cout << GRAY << "\n  (Press Enter to return to Dashboard)" << RESET;
+    cin.ignore(1000, '\n');
+    cin.get();
+}
+
+// swiftex --serve [port]: run the JSON API instead of the terminal menu
+int runServer(LogisticsEngine& engine, const string& host, int port, ReplicationPublisher* publisher,
+              ReplicationFollower* follower) {
+    NullBuffer sink;
+    streambuf* console = cout.rdbuf(&sink);
+
+    const LogisticsEngine::StartupStats& st = engine.startupStats();
+    char stages[160];
+    snprintf(stages, sizeof(stages), "map %.1f, riders %.1f, archive %.1f, snapshot %.1f, index %.1f ms",
+             st.mapMs, st.ridersMs, st.archiveMs, st.snapshotMs, st.indexMs);
+    cerr << "swiftex: " << st.parcels << " parcels ready for tracking in " << (long long)st.readyMs
+         << " ms (" << stages << ")" << (engine.isWarm() ? "" : "; queues fill in the background") << "\n";
+
+    HttpServer server(engine, port, host);
+    server.setReplication(publisher, follower);
+    bool ok = server.run();
+
+    cout.rdbuf(console);
+    engine.saveToFile();
+    cerr << "swiftex: server stopped, database saved\n";
+    return ok ? 0 : 1;
+}
+
+// swiftex --hubs: one engine per zone hub, fed pickup orders on stdin as
+// "origin hub,id,destination,weight,priority" lines until end of input
+int runHubs(long long retention, double idFpr, int roadEvents, const DispatchPolicy& policy) {
+    HubCluster cluster;
+    cluster.addDefaultHubs();
+    cluster.setDispatchPolicy(policy);
+    if (retention >= 0) cluster.setRetention(retention);
+    if (idFpr > 0) cluster.setIdFalsePositiveRate(idFpr);
+    if (roadEvents >= 0) cluster.setRoadEventRate(roadEvents);
+    cluster.start();
+    cerr << "swiftex: " << cluster.hubCount() << " hubs running, reading pickups from stdin\n";
+
+    string line;
+    long long unrouted = 0;
+    while (getline(cin, line)) {
+        stringstream ss(line);
+        string origin, id, dest, w, p;
+        if (!getline(ss, origin, ',') || !getline(ss, id, ',') || !getline(ss, dest, ',')) continue;
+        getline(ss, w, ',');
+        getline(ss, p, ',');
+        double weight = atof(w.c_str());
+        int priority = atoi(p.c_str());
+
+        bool known = false;
+        for (int i = 0; i < cluster.hubCount(); i++)
+            if (cluster.hubCity(i) == origin) known = true;
+        if (!known) {
+            unrouted++;
+            continue;
+        }
+        // A full order queue just means that hub is behind; wait for it
+        while (!cluster.submitPickup(origin, id, dest, weight, priority))
+            this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    cluster.stop();
+    for (int i = 0; i < cluster.hubCount(); i++) {
+        HubCluster::HubStats st = cluster.stats(i);
+        cerr << "  " << left << setw(10) << cluster.hubCity(i) << " (" << cluster.hubZone(i) << ")"
+             << "  pickups " << st.pickups << ", rejected " << st.rejected
+             << ", dispatched " << st.dispatched << ", handed out " << st.handedOut
+             << ", received " << st.received << ", on hand " << st.hotParcels << "\n";
+    }
+    if (unrouted > 0) cerr << "swiftex: " << unrouted << " line(s) named no known hub\n";
+    cerr << "swiftex: hubs stopped, data saved under parcels.d/hub-*\n";
+    return 0;
+}
+
+// swiftex --node <i>/<n> <address>: one process of an n-node cluster,
+// serving the tracking IDs that hash to node i
+int runNode(LogisticsEngine& engine, int index, int count, const string& address) {
+    NullBuffer sink;
+    streambuf* console = cout.rdbuf(&sink);
+
+    ClusterNode node(engine, index, count, address);
+    bool ok = node.run();
+
+    cout.rdbuf(console);
+    engine.saveToFile();
+    cerr << "swiftex: node " << index << " stopped, database saved\n";
+    return ok ? 0 : 1;
+}
+
+// swiftex --router <address> <node address>...: the cluster's front door
+int runRouter(const string& address, char** nodeArgs, int count) {
+    string* nodeAddresses = new string[count];
+    for (int i = 0; i < count; i++) nodeAddresses[i] = nodeArgs[i];
+    bool ok;
+    {
+        ClusterRouter router(address, nodeAddresses, count);
+        ok = router.run();
+    }
+    delete[] nodeAddresses;
+    cerr << "swiftex: router stopped\n";
+    return ok ? 0 : 1;
+}
+
+static const char* rpcStatusName(unsigned int status) {
+    switch (status) {
+    case RPC_OK: return "ok";
+    case RPC_NOT_FOUND: return "not found";
+    case RPC_REJECTED: return "rejected";
+    case RPC_NOT_OWNER: return "wrong node for this id";
+    case RPC_BAD_REQUEST: return "bad request";
+    case RPC_UNAVAILABLE: return "owner node unavailable";
+    default: return "unknown status";
+    }
+}
+
+// swiftex --rpc <address> <command> [args]: one call against a node or
+// the router, printed as plain text
+int runRpcClient(const string& address, int argc, char** argv) {
+    RpcClient client;
+    if (argc < 1 || !client.connect(address)) {
+        cerr << "swiftex: cannot reach " << address << "\n";
+        return 1;
+    }
+    string cmd = argv[0];
+    if (cmd == "track" && argc > 1) {
+        client.request(RPC_TRACK).str(argv[1]);
+    }
+    else if (cmd == "pickup" && argc > 2) {
+        RpcWriter& w = client.request(RPC_PICKUP);
+        w.str(argv[1]);
+        w.str(argv[2]);
+        w.f64(argc > 3 ? atof(argv[3]) : 1.0);
+        w.u32(argc > 4 ? (unsigned int)atoi(argv[4]) : 2);
+    }
+    else if (cmd == "cancel" && argc > 1) {
+        client.request(RPC_CANCEL).str(argv[1]);
+    }
+    else if (cmd == "dispatch") {
+        client.request(RPC_DISPATCH).u32(argc > 1 ? (unsigned int)atoi(argv[1]) : 1);
+    }
+    else if (cmd == "stats") {
+        client.request(RPC_STATS);
+    }
+    else if (cmd == "closures") {
+        client.request(RPC_MAP_SYNC).u32(0);
+    }
+    else if (cmd == "close" && argc > 1) {
+        RpcWriter& w = client.request(RPC_MAP_APPLY);
+        w.u32((unsigned int)(argc - 1));
+        for (int i = 1; i < argc; i++) w.u32((unsigned int)atoi(argv[i]));
+    }
+    else {
+        cerr << "usage: swiftex --rpc <address> track <id> | pickup <id> <dest> [weight] [priority]\n"
+             << "       | cancel <id> | dispatch [n] | stats | closures | close <edge id>...\n";
+        return 1;
+    }
+
+    string reply;
+    if (!client.call(reply)) {
+        cerr << "swiftex: connection to " << address << " failed\n";
+        return 1;
+    }
+    RpcReader r(reply.data(), reply.size());
+    if (r.op() != RPC_OK) {
+        cout << cmd << ": " << rpcStatusName(r.op()) << "\n";
+        return 1;
+    }
+
+    if (cmd == "track") {
+        string id(r.str()), dest(r.str()), zone(r.str());
+        r.u8();
+        string status(r.str()), rider(r.str());
+        double weight = r.f64();
+        unsigned int priority = r.u32();
+        r.i64();
+        long long arrival = r.i64();
+        r.u32();
+        bool archived = r.u8() != 0;
+        cout << id << " -> " << dest << " (" << zone << "), " << weight << " kg, priority " << priority
+             << ": " << status << (archived ? " [archived]" : "") << "\n";
+        if (!rider.empty()) cout << "  rider: " << rider << "\n";
+        long long eta = arrival - (long long)time(0);
+        if (status == "In Transit" && eta > 0) cout << "  eta: " << eta << " s\n";
+        unsigned int events = r.u32();
+        for (unsigned int i = 0; i < events && r.ok(); i++) {
+            string desc(r.str()), when(r.str()), where(r.str());
+            cout << "  " << when << "  " << desc << " @ " << where << "\n";
+        }
+    }
+    else if (cmd == "pickup") cout << "pickup: ok\n";
+    else if (cmd == "cancel") cout << "cancel: ok\n";
+    else if (cmd == "dispatch") cout << "dispatched " << r.u32() << "\n";
+    else if (cmd == "stats") {
+        unsigned int hot = r.u32();
+        cout << hot << " hot parcels, " << r.i64() << " archived\n";
+    }
+    else if (cmd == "closures") {
+        r.u32();
+        unsigned int n = r.u32();
+        cout << n << " closed road(s):";
+        for (unsigned int i = 0; i < n; i++) cout << " " << r.u32();
+        cout << "\n";
+    }
+    else if (cmd == "close") cout << r.u32() << " newly closed\n";
+    return 0;
+}
+
+static void applyTuning(LogisticsEngine& engine, long long retention, double idFpr, int roadEvents,
+                        const DispatchPolicy& policy) {
+    engine.setDispatchPolicy(policy);
+    if (retention >= 0) engine.setRetention(retention);
+    if (idFpr > 0) engine.setIdFalsePositiveRate(idFpr);
+    if (roadEvents >= 0) engine.setRoadEventRate(roadEvents);
+}
+
+// --replicate <address>: stream the engine's changes to standbys
+static bool startReplication(LogisticsEngine& engine, ReplicationPublisher& publisher) {
+    if (publisher.getAddress().empty()) return true;
+    if (!publisher.start()) {
+        cerr << "swiftex: cannot serve replication on " << publisher.getAddress() << "\n";
+        return false;
+    }
+    engine.setPublisher(&publisher);
+    cerr << "swiftex: standbys can follow on " << publisher.getAddress() << "\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int choice;
+
+    // Tuning options may precede any of the modes below:
+    //   --retention <seconds>  how long finished parcels stay hot
+    //   --id-fpr <rate>        false-positive rate of the known-ID filter
+    //   --road-events <pct>    chance a dispatch meets a road block
+    //   --replicate <address>  let standbys (--follow) replicate this engine
+    //   --policy <file>        dispatch order: SLAs, zone allowances, affinity
+    //   --bind <address>       where the API listens (default 127.0.0.1; it
+    //                          has no authentication, so 0.0.0.0 exposes it)
+    long long retention = -1;
+    double idFpr = 0;
+    int roadEvents = -1;
+    string replicateTo;
+    string bindHost = "127.0.0.1";
+    DispatchPolicy policy;
+    while (argc > 2 && strncmp(argv[1], "--", 2) == 0) {
+        if (strcmp(argv[1], "--retention") == 0) retention = atoll(argv[2]);
+        else if (strcmp(argv[1], "--id-fpr") == 0) idFpr = atof(argv[2]);
+        else if (strcmp(argv[1], "--road-events") == 0) roadEvents = atoi(argv[2]);
+        else if (strcmp(argv[1], "--replicate") == 0) replicateTo = argv[2];
+        else if (strcmp(argv[1], "--bind") == 0) bindHost = argv[2];
+        else if (strcmp(argv[1], "--policy") == 0) {
+            string error;
+            if (!policy.load(argv[2], error)) {
+                cerr << "swiftex: " << argv[2] << ": " << error << "\n";
+                return 1;
+            }
+        }
+        else break;
+        argv += 2;
+        argc -= 2;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--hubs") == 0) return runHubs(retention, idFpr, roadEvents, policy);
+    if (argc > 2 && strcmp(argv[1], "--rpc") == 0) return runRpcClient(argv[2], argc - 3, argv + 3);
+    if (argc > 3 && strcmp(argv[1], "--router") == 0) return runRouter(argv[2], argv + 3, argc - 3);
+
+    // Declared ahead of the engines so it outlives them
+    ReplicationPublisher publisher(replicateTo);
+
+    if (argc > 3 && strcmp(argv[1], "--node") == 0) {
+        int index = atoi(argv[2]);
+        const char* slash = strchr(argv[2], '/');
+        int count = slash ? atoi(slash + 1) : 0;
+        if (index < 0 || count < 1 || index >= count) {
+            cerr << "usage: swiftex --node <index>/<count> <address>\n";
+            return 1;
+        }
+        // Nodes start from their own directory; importing the flat
+        // parcels.txt belongs to the single-engine setup
+        string dir = "parcels.d/node-" + to_string(index);
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+        LogisticsEngine engine(dir);
+        applyTuning(engine, retention, idFpr, roadEvents, policy);
+        if (!startReplication(engine, publisher)) return 1;
+        return runNode(engine, index, count, argv[3]);
+    }
+
+    // swiftex --follow <primary address> [port]: hot standby. Keeps a replica
+    // of the primary in parcels.d/standby, answers tracking over the API and
+    // takes over when sent POST /api/promote.
+    if (argc > 2 && strcmp(argv[1], "--follow") == 0) {
+        string dir = "parcels.d/standby";
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+        LogisticsEngine engine(dir);
+        applyTuning(engine, retention, idFpr, roadEvents, policy);
+        engine.setReadOnly(true);
+        if (!startReplication(engine, publisher)) return 1;
+        ReplicationFollower follower(argv[2]);
+        follower.start();
+        int port = (argc > 3) ? atoi(argv[3]) : 8081;
+        return runServer(engine, bindHost, port > 0 ? port : 8081, replicateTo.empty() ? nullptr : &publisher, &follower);
+    }
+
+    LogisticsEngine engine;
+    applyTuning(engine, retention, idFpr, roadEvents, policy);
+    if (!startReplication(engine, publisher)) return 1;
+
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+        int port = (argc > 2) ? atoi(argv[2]) : 8080;
+        return runServer(engine, bindHost, port > 0 ? port : 8080, replicateTo.empty() ? nullptr : &publisher, nullptr);
+    }
+
+    // swiftex --export <file> [json|msgpack]
+    if (argc > 2 && strcmp(argv[1], "--export") == 0) {
+        bool msgpack = (argc > 3 && strcmp(argv[3], "msgpack") == 0);
+        if (!engine.exportParcels(argv[2], msgpack)) {
+            cerr << "swiftex: cannot write " << argv[2] << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // Each screen is composed in memory and written when the program next
+    // waits for input
+    TerminalFrame screen;
+    streambuf* plain = cout.rdbuf(&screen);
+    frame = &screen;
+
+    while (true) {
+        clearScreen();
+        displayHeader();
+
+        // System Status Bar
+        cout << GREEN << " [ONLINE]" << RESET << "  " << GRAY << "Location: Central Hub" << RESET << "\n\n";
+
+        // Dashboard Menu - Clean 2-Column Layout
+        cout << "  " << GOLD << "1." << RESET << " Add New Parcel          " << GOLD << "5." << RESET << " View Map Details\n";
+        cout << "  " << GOLD << "2." << RESET << " Dispatch Warehouse      " << GOLD << "6." << RESET << " Live Transit Monitor\n";
+        cout << "  " << GOLD << "3." << RESET << " Track Parcel            " << GOLD << "7." << RESET << " Cancel Parcel\n";
+        cout << "  " << GOLD << "4." << RESET << " List All Inventory      " << GOLD << "8." << RESET << " Undo Last Action\n";
+
+        cout << "  " << GOLD << "0." << RESET << " Redo Last Undo\n";
+
+        cout << "\n  " << RED << "9. Save & Exit Terminal" << RESET << "\n";
+        cout << GRAY << " ──────────────────────────────────────────────────────────\n" << RESET;
+        cout << "  Enter Selection " << CYAN << "» " << RESET;
+
+        if (!(cin >> choice)) {
+            cin.clear();
+            cin.ignore(1000, '\n');
+            continue;
+        }
+
+        if (choice == 9) {
+            cout << "\n  " << CYAN << "Syncing database... Shutdown complete." << RESET << "\n";
+            engine.saveToFile();
+            break;
+        }
+
+        switch (choice) {
+        case 1: {
+            string id, dest;
+            double w;
+            int p;
+            clearScreen();
+            cout << BOLD << CYAN << "[ PARCEL REGISTRATION ]\n" << RESET;
+            cout << "  ID Code: "; cin >> id;
+            cin.ignore(1000, '\n');
+            cout << "  Destination: "; getline(cin, dest);
+            cout << "  Weight (kg): "; cin >> w;
+            cout << "  Priority (1-High, 3-Low): "; cin >> p;
+            engine.requestPickup(id, dest, w, p);
+            cout << GREEN << "\n  ✔ Parcel successfully logged." << RESET << "\n";
+            pauseFunc();
+            break;
+        }
+
+        case 2:
+            clearScreen();
+            cout << BOLD << CYAN << "[ WAREHOUSE DISPATCH ]\n" << RESET;
+            engine.processNext();
+            pauseFunc();
+            break;
+
+        case 3: {
+            string id;
+            clearScreen();
+            cout << "Enter Tracking ID: "; cin >> id;
+            engine.viewParcel(id);
+            pauseFunc();
+            break;
+        }
+
+        case 4:
+            clearScreen();
+            engine.listAll(); // Pages until the operator returns to the menu
+            break;
+
+        case 5:
+            clearScreen();
+            engine.showMap();
+            pauseFunc();
+            break;
+
+        case 6:
+            clearScreen();
+            engine.liveMonitor(); // Live monitors usually handle their own exit
+            break;
+
+        case 7: {
+            string id;
+            clearScreen();
+            cout << "Enter ID to Cancel: "; cin >> id;
+            engine.cancelParcel(id);
+            pauseFunc();
+            break;
+        }
+
+        case 8:
+            clearScreen();
+            engine.undoLast();
+            pauseFunc();
+            break;
+
+        case 0:
+            clearScreen();
+            engine.redoLast();
+            pauseFunc();
+            break;
+        }
+
+        engine.updateRealTime();
+    }
+
+    cout.flush();
+    cout.rdbuf(plain);
+    frame = nullptr;
+    return 0;
 }
\ No newline at end of file
@@ -1,206 +1,638 @@
-﻿#include "mapgraph.h"
-#include <iostream>
-#include <iomanip>
-#include <climits>
-#include <cstdlib>
-#include <ctime>
-#include <string>
-
-using namespace std;
-
-// UI Color Palette for the Terminal GUI
-#define RESET   "\033[0m"
-#define CYAN    "\033[1;36m"
-#define RED     "\033[1;31m"
-#define GREEN   "\033[1;32m"
-#define GOLD    "\033[1;33m"
-#define GRAY    "\033[90m"
-
-// =====================================================
-// Edge Implementation
-// =====================================================
-Edge::Edge(int d, int w) : dest(d), weight(w), blocked(false) {}
-
-// =====================================================
-// EdgeArrayList Implementation
-// =====================================================
-void EdgeArrayList::resize(int newCapacity) {
-    Edge* newData = new Edge[newCapacity];
-    for (int i = 0; i < count; i++)
-        newData[i] = data[i];
-    delete[] data;
-    data = newData;
-    capacity = newCapacity;
-}
-
-EdgeArrayList::EdgeArrayList() : capacity(5), count(0) {
-    data = new Edge[capacity];
-}
-
-EdgeArrayList::EdgeArrayList(const EdgeArrayList& other) {
-    capacity = other.capacity;
-    count = other.count;
-    data = new Edge[capacity];
-    for (int i = 0; i < count; i++)
-        data[i] = other.data[i];
-}
-
-EdgeArrayList& EdgeArrayList::operator=(const EdgeArrayList& other) {
-    if (this != &other) {
-        delete[] data;
-        capacity = other.capacity;
-        count = other.count;
-        data = new Edge[capacity];
-        for (int i = 0; i < count; i++)
-            data[i] = other.data[i];
-    }
-    return *this;
-}
-
-EdgeArrayList::~EdgeArrayList() {
-    delete[] data;
-}
-
-void EdgeArrayList::add(Edge val) {
-    if (count >= capacity)
-        resize(capacity * 2);
-    data[count++] = val;
-}
-
-int EdgeArrayList::size() const { return count; }
-Edge& EdgeArrayList::getRef(int i) { return data[i]; }
-
-// =====================================================
-// MapGraph Implementation
-// =====================================================
-CityNode::CityNode(string n, string z) : name(n), zone(z) {}
-
-MapGraph::MapGraph() : cityCount(0), cityCapacity(15), visited(nullptr) {
-    cities = new CityNode[cityCapacity];
-}
-
-MapGraph::~MapGraph() {
-    delete[] cities;
-    if (visited) delete[] visited;
-}
-
-int MapGraph::addCity(string name, string zone) {
-    if (cityCount >= cityCapacity) return -1;
-    cities[cityCount] = CityNode(name, zone);
-    return cityCount++;
-}
-
-void MapGraph::addRoad(int u, int v, int dist) {
-    if (u < cityCount && v < cityCount) {
-        cities[u].edges.add(Edge(v, dist));
-        cities[v].edges.add(Edge(u, dist));
-    }
-}
-
-int MapGraph::getCityIndex(string name) {
-    for (int i = 0; i < cityCount; i++)
-        if (cities[i].name == name) return i;
-    return -1;
-}
-
-string MapGraph::getZone(string name) {
-    int idx = getCityIndex(name);
-    return (idx != -1) ? cities[idx].zone : "Unknown";
-}
-
-void MapGraph::blockRandomRoad() {
-    if (cityCount < 2) return;
-    int u = rand() % cityCount;
-    if (cities[u].edges.size() > 0) {
-        int eIdx = rand() % cities[u].edges.size();
-        cities[u].edges.getRef(eIdx).blocked = true;
-
-        cout << RED << "\n [!] LIVE TRAFFIC ALERT: Road near " << cities[u].name
-             << " is now BLOCKED due to weather/construction!" << RESET << endl;
-    }
-}
-
-// GUI-Style Network Display using Universal ASCII Symbols
-void MapGraph::displayNetwork() {
-    cout << "\n" << CYAN << "+==========================================================+" << RESET << endl;
-    cout << CYAN << "|" << RESET << "                SWIFT-EX GEOGRAPHIC NETWORK               " << CYAN << "|" << RESET << endl;
-    cout << CYAN << "+----------------------------------------------------------+" << RESET << endl;
-
-    for (int i = 0; i < cityCount; i++) {
-        // Formatting the city header line
-        cout << CYAN << "|" << RESET << " [" << GOLD << cities[i].zone << RESET << "] "
-             << left << setw(15) << cities[i].name << " connects to:" << right << setw(20) << CYAN << "|" << RESET << endl;
-
-        EdgeArrayList& edges = cities[i].edges;
-        for (int k = 0; k < edges.size(); k++) {
-            Edge& e = edges.getRef(k);
-            
-            // Fixed String Concatenation logic
-            string status = e.blocked ? (string(RED) + "[BLOCKED]" + RESET) : (string(GREEN) + "[OPEN]   " + RESET);
-
-            cout << CYAN << "|" << RESET << "    >> " << left << setw(15) << cities[e.dest].name
-                 << " | " << right << setw(4) << e.weight << " km | " << status << right << setw(11) << CYAN << "   |" << RESET << endl;
-        }
-        
-        // Horizontal separator between different cities
-        if (i < cityCount - 1)
-            cout << CYAN << "|----------------------------------------------------------|" << RESET << endl;
-    }
-    cout << CYAN << "+==========================================================+" << RESET << endl;
-}
-
-// =====================================================
-// Pathfinding Logic (DFS with Backtracking)
-// =====================================================
-
-
-
-void MapGraph::findAllPaths(int start, int end) {
-    // Correct memory management for visited array
-    if (visited) delete[] visited;
-    visited = new bool[cityCount];
-    for (int i = 0; i < cityCount; i++) visited[i] = false;
-
-    pathCount = 0;
-    IntArrayList currentPath;
-    solveDFS(start, end, currentPath, 0);
-}
-
-void MapGraph::solveDFS(int u, int d, IntArrayList currentPath, int currentDist) {
-    visited[u] = true;
-    currentPath.add(u);
-
-    if (u == d) {
-        // Prevent buffer overflow (assuming availablePaths size is 5)
-        if (pathCount < 5) {
-            availablePaths[pathCount] = currentPath;
-            availablePathDistances[pathCount] = currentDist;
-            pathCount++;
-        }
-    }
-    else {
-        EdgeArrayList& edges = cities[u].edges;
-        for (int i = 0; i < edges.size(); i++) {
-            Edge& e = edges.getRef(i);
-            // Only traverse if destination is not visited and road is not blocked
-            if (!visited[e.dest] && !e.blocked) {
-                solveDFS(e.dest, d, currentPath, currentDist + e.weight);
-            }
-        }
-    }
-    // Backtracking: mark as unvisited for other potential paths
-    visited[u] = false;
-}
-
-int MapGraph::getMinRouteIndex() {
-    if (pathCount == 0) return -1;
-    int minIdx = 0;
-    int minDist = availablePathDistances[0];
-    for (int i = 1; i < pathCount; i++) {
-        if (availablePathDistances[i] < minDist) {
-            minDist = availablePathDistances[i];
-            minIdx = i;
-        }
-    }
-    return minIdx;
-}
\ No newline at end of file
+﻿#include "mapgraph.h"
+#include "minheap.h"
+#include <iostream>
+#include <iomanip>
+#include <climits>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cmath>
+
+using namespace std;
+
+// UI Color Palette for the Terminal GUI
+#define RESET   "\033[0m"
+#define CYAN    "\033[1;36m"
+#define RED     "\033[1;31m"
+#define GREEN   "\033[1;32m"
+#define GOLD    "\033[1;33m"
+#define GRAY    "\033[90m"
+
+// =====================================================
+// Edge Implementation
+// =====================================================
+Edge::Edge(int d, int w, int prof, int eid) : id(eid), dest(d), weight(w), blocked(false), profile((unsigned char)prof) {}
+
+// =====================================================
+// DistanceMatrix Implementation (Cache-Aligned Buffer)
+// =====================================================
+DistanceMatrix::DistanceMatrix() : raw(nullptr), data(nullptr), rows(0), cols(0), stride(0) {}
+
+DistanceMatrix::~DistanceMatrix() {
+    delete[] raw;
+}
+
+void DistanceMatrix::resize(int r, int c) {
+    delete[] raw;
+    rows = r;
+    cols = c;
+    // 16 ints per 64-byte line
+    stride = (c + 15) & ~15;
+    size_t bytes = (size_t)rows * stride * sizeof(int);
+    raw = new char[bytes + 64];
+    data = (int*)(((size_t)raw + 63) & ~(size_t)63);
+}
+
+int* DistanceMatrix::row(int r) { return data + (size_t)r * stride; }
+const int* DistanceMatrix::row(int r) const { return data + (size_t)r * stride; }
+int DistanceMatrix::get(int r, int c) const { return data[(size_t)r * stride + c]; }
+int DistanceMatrix::rowCount() const { return rows; }
+int DistanceMatrix::colCount() const { return cols; }
+
+// =====================================================
+// MapGraph Implementation
+// =====================================================
+CityNode::CityNode(string n, string z, double la, double lo) : name(n), zone(z), lat(la), lon(lo) {}
+
+MapGraph::MapGraph() : cityCount(0), cityCapacity(15), visited(nullptr),
+profileCount(0), profileCapacity(4), edgeCount(0), geoStale(true), hoursPerKmBound(0), cityPoints(nullptr), dice(1) {
+    cities = new CityNode[cityCapacity];
+    profiles = new SpeedProfile[profileCapacity];
+
+    // Fallback profile: flat 60 km/h all day
+    unsigned char flat[24];
+    for (int h = 0; h < 24; h++) flat[h] = 60;
+    addSpeedProfile("Default", flat);
+}
+
+MapGraph::~MapGraph() {
+    delete[] cities;
+    delete[] profiles;
+    delete[] cityPoints;
+    if (visited) delete[] visited;
+}
+
+int MapGraph::addCity(string name, string zone, double lat, double lon) {
+    if (cityCount >= cityCapacity) {
+        int newCapacity = cityCapacity * 2;
+        CityNode* newCities = new CityNode[newCapacity];
+        for (int i = 0; i < cityCount; i++)
+            newCities[i] = cities[i];
+        delete[] cities;
+        cities = newCities;
+        cityCapacity = newCapacity;
+    }
+    cities[cityCount] = CityNode(name, zone, lat, lon);
+    geoStale = true;
+    overlay.invalidate();
+    cityIndex.insert(name, cityCount);
+    cityTrie.insert(name, cityCount);
+    return cityCount++;
+}
+
+void MapGraph::addRoad(int u, int v, int dist, int profile) {
+    if (profile < 0 || profile >= profileCount) profile = 0;
+    if (u < cityCount && v < cityCount) {
+        edgeOwner.add(u);
+        edgeSlot.add(cities[u].edges.size());
+        cities[u].edges.add(Edge(v, dist, profile, edgeCount++));
+
+        edgeOwner.add(v);
+        edgeSlot.add(cities[v].edges.size());
+        cities[v].edges.add(Edge(u, dist, profile, edgeCount++));
+        geoStale = true;
+        overlay.invalidate();
+    }
+}
+
+Edge& MapGraph::getEdge(int edgeId) {
+    return cities[edgeOwner[edgeId]].edges[edgeSlot[edgeId]];
+}
+
+const Edge& MapGraph::getEdge(int edgeId) const {
+    return cities[edgeOwner[edgeId]].edges[edgeSlot[edgeId]];
+}
+
+int MapGraph::edgeSource(int edgeId) {
+    return edgeOwner[edgeId];
+}
+
+int MapGraph::findEdgeId(int u, int v) {
+    if (u < 0 || u >= cityCount) return -1;
+    for (const Edge& e : cities[u].edges)
+        if (e.dest == v) return e.id;
+    return -1;
+}
+
+int MapGraph::pathToEdges(const IntArrayList& path, int* out) {
+    int n = 0;
+    for (int i = 0; i + 1 < path.size(); i++) {
+        int id = findEdgeId(path[i], path[i + 1]);
+        if (id != -1) out[n++] = id;
+    }
+    return n;
+}
+
+void MapGraph::edgesToPath(const int* edges, int n, IntArrayList& path) {
+    if (n <= 0) return;
+    path.add(edgeOwner[edges[0]]);
+    for (int i = 0; i < n; i++) path.add(getEdge(edges[i]).dest);
+}
+
+int MapGraph::shortestDistance(int start, int end, IntArrayList* pathOut) {
+    return overlay.distance(*this, start, end, pathOut);
+}
+
+int MapGraph::getCityIndex(string_view name) {
+    return cityIndex.find(name);
+}
+
+int MapGraph::resolveCity(string_view name, const string** zoneOut) {
+    int idx = cityIndex.find(name);
+    if (zoneOut) *zoneOut = (idx != -1) ? &cities[idx].zone : nullptr;
+    return idx;
+}
+
+string MapGraph::getZone(string_view name) {
+    int idx = getCityIndex(name);
+    return (idx != -1) ? cities[idx].zone : "Unknown";
+}
+
+int MapGraph::suggestCity(string_view name) {
+    int idx = cityTrie.completePrefix(name);
+    if (idx != -1) return idx;
+    return cityTrie.closest(name, 2);
+}
+
+void MapGraph::setSeed(unsigned long long seed) {
+    dice.reseed(seed);
+}
+
+// Returns the id of the directed edge that was closed, or -1
+// The caller announces the closure (edgeSource() names the city); MapGraph
+// may be driven from a hub shard's thread, away from the console
+int MapGraph::blockRandomRoad() {
+    if (cityCount < 2) return -1;
+    int u = dice.below(cityCount);
+    if (cities[u].edges.size() > 0) {
+        int eIdx = dice.below(cities[u].edges.size());
+        Edge& e = cities[u].edges[eIdx];
+        if (!e.blocked) {
+            e.blocked = true;
+            closures.add(e.id);
+            overlay.roadClosed(*this, e.id);
+        }
+        return e.id;
+    }
+    return -1;
+}
+
+bool MapGraph::blockRoad(int edgeId) {
+    if (edgeId < 0 || edgeId >= edgeCount) return false;
+    Edge& e = getEdge(edgeId);
+    if (e.blocked) return false;
+    e.blocked = true;
+    closures.add(edgeId);
+    overlay.roadClosed(*this, edgeId);
+    return true;
+}
+
+// GUI-Style Network Display using Universal ASCII Symbols
+void MapGraph::displayNetwork(ostream& out) {
+    out << "\n" << CYAN << "+==========================================================+" << RESET << "\n";
+    out << CYAN << "|" << RESET << "                SWIFT-EX GEOGRAPHIC NETWORK               " << CYAN << "|" << RESET << "\n";
+    out << CYAN << "+----------------------------------------------------------+" << RESET << "\n";
+
+    for (int i = 0; i < cityCount; i++) {
+        // Formatting the city header line
+        out << CYAN << "|" << RESET << " [" << GOLD << cities[i].zone << RESET << "] "
+             << left << setw(15) << cities[i].name << " connects to:" << right << setw(20) << CYAN << "|" << RESET << "\n";
+
+        for (const Edge& e : cities[i].edges) {
+
+            // Fixed String Concatenation logic
+            string status = e.blocked ? (string(RED) + "[BLOCKED]" + RESET) : (string(GREEN) + "[OPEN]   " + RESET);
+
+            out << CYAN << "|" << RESET << "    >> " << left << setw(15) << cities[e.dest].name
+                 << " | " << right << setw(4) << e.weight << " km | " << status << right << setw(11) << CYAN << "   |" << RESET << "\n";
+        }
+        
+        // Horizontal separator between different cities
+        if (i < cityCount - 1)
+            out << CYAN << "|----------------------------------------------------------|" << RESET << "\n";
+    }
+    out << CYAN << "+==========================================================+" << RESET << "\n";
+}
+
+// =====================================================
+// Pathfinding Logic (DFS with Backtracking)
+// =====================================================
+
+
+
+void MapGraph::findAllPaths(int start, int end) {
+    // Correct memory management for visited array
+    if (visited) delete[] visited;
+    visited = new bool[cityCount];
+    for (int i = 0; i < cityCount; i++) visited[i] = false;
+
+    // The overlay supplies the true shortest route; the DFS only adds
+    // alternatives, and the first ones it happens upon at that
+    pathCount = 0;
+    int shortestKm = shortestDistance(start, end, &availablePaths[0]);
+    if (shortestKm != DIST_INFINITY) {
+        availablePathDistances[0] = shortestKm;
+        pathCount = 1;
+    }
+    IntArrayList currentPath;
+    solveDFS(start, end, currentPath, 0);
+}
+
+static bool samePath(const IntArrayList& a, const IntArrayList& b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.size(); i++)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+// One path is extended and backtracked in place; only finished paths are
+// copied out
+void MapGraph::solveDFS(int u, int d, IntArrayList& currentPath, int currentDist) {
+    // All five slots are taken; nothing further down would be kept
+    if (pathCount >= 5) return;
+    visited[u] = true;
+    currentPath.add(u);
+
+    if (u == d) {
+        // Prevent buffer overflow (assuming availablePaths size is 5)
+        if (pathCount < 5 && !(pathCount > 0 && samePath(currentPath, availablePaths[0]))) {
+            availablePaths[pathCount] = currentPath;
+            availablePathDistances[pathCount] = currentDist;
+            pathCount++;
+        }
+    }
+    else {
+        for (const Edge& e : cities[u].edges) {
+            // Only traverse if destination is not visited and road is not blocked
+            if (!visited[e.dest] && !e.blocked) {
+                solveDFS(e.dest, d, currentPath, currentDist + e.weight);
+            }
+        }
+    }
+    // Backtracking: mark as unvisited for other potential paths
+    visited[u] = false;
+    currentPath.removeLast();
+}
+
+int MapGraph::getMinRouteIndex() {
+    if (pathCount == 0) return -1;
+    int minIdx = 0;
+    int minDist = availablePathDistances[0];
+    for (int i = 1; i < pathCount; i++) {
+        if (availablePathDistances[i] < minDist) {
+            minDist = availablePathDistances[i];
+            minIdx = i;
+        }
+    }
+    return minIdx;
+}
+// =====================================================
+// Many-to-Many Distance Kernel (Parallel Dijkstra)
+// =====================================================
+
+// Open roads packed into flat arrays (CSR) so the search loops stay on
+// contiguous memory instead of hopping through per-city edge lists.
+struct RoadSnapshot {
+    int* offset;
+    int* dest;
+    int* weight;
+    int nodes;
+    int edges;
+};
+
+typedef MinHeapItem<int> DistHeapItem;
+
+static void distanceWorker(const RoadSnapshot* g, const int* sources, int sourceCount,
+                           const int* targets, int targetCount,
+                           DistanceMatrix* out, atomic<int>* nextSource) {
+    int* dist = new int[g->nodes];
+    bool* settled = new bool[g->nodes];
+    int* targetHits = new int[g->nodes];
+    DistHeapItem* heap = new DistHeapItem[g->edges + 1];
+
+    for (int i = 0; i < g->nodes; i++) targetHits[i] = 0;
+    for (int t = 0; t < targetCount; t++)
+        if (targets[t] >= 0 && targets[t] < g->nodes) targetHits[targets[t]]++;
+
+    while (true) {
+        int s = nextSource->fetch_add(1);
+        if (s >= sourceCount) break;
+
+        for (int i = 0; i < g->nodes; i++) {
+            dist[i] = DIST_INFINITY;
+            settled[i] = false;
+        }
+
+        int src = sources[s];
+        int remaining = targetCount;
+        int heapSize = 0;
+        if (src >= 0 && src < g->nodes) {
+            dist[src] = 0;
+            minHeapPush(heap, heapSize, 0, src);
+        }
+
+        // Stop as soon as every requested target is settled
+        while (heapSize > 0 && remaining > 0) {
+            DistHeapItem top = minHeapPop(heap, heapSize);
+            int u = top.node;
+            if (settled[u]) continue;
+            settled[u] = true;
+            remaining -= targetHits[u];
+
+            for (int k = g->offset[u]; k < g->offset[u + 1]; k++) {
+                int v = g->dest[k];
+                int nd = top.key + g->weight[k];
+                if (nd < dist[v]) {
+                    dist[v] = nd;
+                    minHeapPush(heap, heapSize, nd, v);
+                }
+            }
+        }
+
+        int* outRow = out->row(s);
+        for (int t = 0; t < targetCount; t++) {
+            int v = targets[t];
+            outRow[t] = (v >= 0 && v < g->nodes) ? dist[v] : DIST_INFINITY;
+        }
+    }
+
+    delete[] dist;
+    delete[] settled;
+    delete[] targetHits;
+    delete[] heap;
+}
+
+void MapGraph::computeDistanceMatrix(const int* sources, int sourceCount,
+                                     const int* targets, int targetCount,
+                                     DistanceMatrix& out, int threads) {
+    out.resize(sourceCount, targetCount);
+    if (sourceCount == 0 || targetCount == 0) return;
+
+    RoadSnapshot g;
+    g.nodes = cityCount;
+    g.offset = new int[cityCount + 1];
+    g.edges = 0;
+    for (int u = 0; u < cityCount; u++) {
+        g.offset[u] = g.edges;
+        for (const Edge& e : cities[u].edges)
+            if (!e.blocked) g.edges++;
+    }
+    g.offset[cityCount] = g.edges;
+    g.dest = new int[g.edges + 1];
+    g.weight = new int[g.edges + 1];
+    int pos = 0;
+    for (int u = 0; u < cityCount; u++) {
+        for (const Edge& e : cities[u].edges) {
+            if (e.blocked) continue;
+            g.dest[pos] = e.dest;
+            g.weight[pos] = e.weight;
+            pos++;
+        }
+    }
+
+    if (threads <= 0) threads = (int)thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    if (threads > sourceCount) threads = sourceCount;
+
+    atomic<int> nextSource(0);
+    if (threads == 1) {
+        distanceWorker(&g, sources, sourceCount, targets, targetCount, &out, &nextSource);
+    }
+    else {
+        thread* workers = new thread[threads];
+        for (int i = 0; i < threads; i++)
+            workers[i] = thread(distanceWorker, &g, sources, sourceCount, targets, targetCount, &out, &nextSource);
+        for (int i = 0; i < threads; i++)
+            workers[i].join();
+        delete[] workers;
+    }
+
+    delete[] g.offset;
+    delete[] g.dest;
+    delete[] g.weight;
+}
+
+// =====================================================
+// Time-Dependent Travel Model
+// =====================================================
+int MapGraph::addSpeedProfile(string name, const unsigned char kmh[24]) {
+    // Edge::profile is a single byte
+    if (profileCount >= 256) return 0;
+    if (profileCount >= profileCapacity) {
+        int newCapacity = profileCapacity * 2;
+        SpeedProfile* newProfiles = new SpeedProfile[newCapacity];
+        for (int i = 0; i < profileCount; i++)
+            newProfiles[i] = profiles[i];
+        delete[] profiles;
+        profiles = newProfiles;
+        profileCapacity = newCapacity;
+    }
+
+    SpeedProfile& sp = profiles[profileCount];
+    sp.name = name;
+    sp.cumKm[0] = 0;
+    for (int h = 0; h < 24; h++) {
+        sp.kmh[h] = kmh[h] > 0 ? kmh[h] : 1;
+        sp.cumKm[h + 1] = sp.cumKm[h] + sp.kmh[h];
+    }
+    geoStale = true;
+    return profileCount++;
+}
+
+// Piecewise-constant speeds integrate to a monotone "distance since midnight"
+// curve, so the arrival time is found by inverting that curve. Later departures
+// never arrive earlier (FIFO), which keeps the Dijkstra below exact.
+double MapGraph::edgeTravelHours(const Edge& e, double departHour) const {
+    const SpeedProfile& sp = profiles[e.profile];
+    double dayKm = sp.cumKm[24];
+
+    double tod = fmod(departHour, 24.0);
+    if (tod < 0) tod += 24.0;
+    int h = (int)tod;
+    if (h > 23) h = 23;
+
+    double target = sp.cumKm[h] + sp.kmh[h] * (tod - h) + e.weight;
+    double fullDays = floor(target / dayKm);
+    target -= fullDays * dayKm;
+
+    int k = 0;
+    while (k < 23 && sp.cumKm[k + 1] <= target) k++;
+    double arriveTod = k + (target - sp.cumKm[k]) / sp.kmh[k];
+
+    return fullDays * 24.0 + arriveTod - tod;
+}
+
+double MapGraph::routeTravelHours(const IntArrayList& path, double departHour) {
+    double t = departHour;
+    for (int i = 0; i + 1 < path.size(); i++) {
+        int u = path[i];
+        int v = path[i + 1];
+        for (const Edge& e : cities[u].edges) {
+            if (e.dest == v) {
+                t += edgeTravelHours(e, t);
+                break;
+            }
+        }
+    }
+    return t - departHour;
+}
+
+double MapGraph::fastestArrival(int start, int end, double departHour, IntArrayList* pathOut) {
+    if (start < 0 || end < 0 || start >= cityCount || end >= cityCount) return -1;
+
+    double* arrive = new double[cityCount];
+    int* parent = new int[cityCount];
+    bool* done = new bool[cityCount];
+    for (int i = 0; i < cityCount; i++) {
+        arrive[i] = -1;
+        parent[i] = -1;
+        done[i] = false;
+    }
+    arrive[start] = departHour;
+
+    int edgeTotal = 0;
+    for (int i = 0; i < cityCount; i++) edgeTotal += cities[i].edges.size();
+    MinHeapItem<double>* heap = new MinHeapItem<double>[edgeTotal + 1];
+    int heapSize = 0;
+    refreshGeo();
+    minHeapPush(heap, heapSize, departHour, start);
+
+    while (heapSize > 0) {
+        MinHeapItem<double> top = minHeapPop(heap, heapSize);
+        int u = top.node;
+        if (done[u]) continue;
+        done[u] = true;
+        if (u == end) break;
+
+        for (const Edge& e : cities[u].edges) {
+            if (e.blocked || done[e.dest]) continue;
+            double t = arrive[u] + edgeTravelHours(e, arrive[u]);
+            if (arrive[e.dest] < 0 || t < arrive[e.dest]) {
+                arrive[e.dest] = t;
+                parent[e.dest] = u;
+                // Ordered by arrival plus a bound on the hours still to go;
+                // the bound never overestimates, so the first time 'end'
+                // comes off the heap it is still the earliest arrival
+                double toGo = 0;
+                if (hoursPerKmBound > 0) {
+                    const double* a = cityPoints + 3 * e.dest;
+                    const double* b = cityPoints + 3 * end;
+                    double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+                    toGo = hoursPerKmBound * sqrt(dx * dx + dy * dy + dz * dz);
+                }
+                minHeapPush(heap, heapSize, t + toGo, e.dest);
+            }
+        }
+    }
+    delete[] heap;
+
+    double result = arrive[end];
+    if (pathOut && result >= 0) {
+        // Walk parents back, then emit in travel order
+        int hops = 0;
+        for (int v = end; v != -1; v = parent[v]) hops++;
+        int* rev = new int[hops];
+        int i = 0;
+        for (int v = end; v != -1; v = parent[v]) rev[i++] = v;
+        *pathOut = IntArrayList();
+        for (int j = hops - 1; j >= 0; j--) pathOut->add(rev[j]);
+        delete[] rev;
+    }
+
+    delete[] arrive;
+    delete[] parent;
+    delete[] done;
+    return result;
+}
+
+// =====================================================
+// Geography (City Positions, Nearest Cities, A* Bound)
+// =====================================================
+void MapGraph::refreshGeo() {
+    if (!geoStale) return;
+    geoStale = false;
+
+    // Cities with a position, by index
+    double* lat = new double[cityCount > 0 ? cityCount : 1];
+    double* lon = new double[cityCount > 0 ? cityCount : 1];
+    int* cityOf = new int[cityCount > 0 ? cityCount : 1];
+    int located = 0;
+    for (int i = 0; i < cityCount; i++) {
+        if (std::isnan(cities[i].lat) || std::isnan(cities[i].lon)) continue;
+        lat[located] = cities[i].lat;
+        lon[located] = cities[i].lon;
+        cityOf[located++] = i;
+    }
+    cityGeo.build(lat, lon, located);
+    geoCityOf.clear();
+    for (int i = 0; i < located; i++) geoCityOf.add(cityOf[i]);
+    delete[] lat;
+    delete[] lon;
+    delete[] cityOf;
+
+    // A road is never driven faster than the fastest hour of any profile,
+    // nor shorter than (its km / straight-line km) times the straight line
+    hoursPerKmBound = 0;
+    if (located < cityCount || cityCount == 0) return;
+    int fastest = 0;
+    for (int p = 0; p < profileCount; p++)
+        for (int h = 0; h < 24; h++)
+            if (profiles[p].kmh[h] > fastest) fastest = profiles[p].kmh[h];
+    double shortest = 1.0;
+    for (int u = 0; u < cityCount; u++) {
+        for (const Edge& e : cities[u].edges) {
+            double straight = geoDistanceKm(cities[u].lat, cities[u].lon, cities[e.dest].lat, cities[e.dest].lon);
+            if (straight > 0 && e.weight / straight < shortest) shortest = e.weight / straight;
+        }
+    }
+    if (fastest == 0) return;
+    hoursPerKmBound = shortest / fastest;
+    delete[] cityPoints;
+    cityPoints = new double[3 * cityCount];
+    for (int i = 0; i < cityCount; i++) geoPointKm(cities[i].lat, cities[i].lon, cityPoints + 3 * i);
+}
+
+int MapGraph::nearestCities(double lat, double lon, int k, int* out, double* kmOut) {
+    refreshGeo();
+    int found = cityGeo.nearest(lat, lon, k, out, kmOut);
+    for (int i = 0; i < found; i++) out[i] = geoCityOf[out[i]];
+    return found;
+}
+
+bool MapGraph::routePosition(const int* edges, int n, double departHour, double elapsedHours, double& lat, double& lon) {
+    if (n <= 0) return false;
+    double t = departHour;
+    int pos = 0;
+    double fraction = 1.0;
+    while (pos < n) {
+        double dt = edgeTravelHours(getEdge(edges[pos]), t);
+        if (t + dt - departHour > elapsedHours) {
+            fraction = dt > 0 ? (elapsedHours - (t - departHour)) / dt : 1.0;
+            if (fraction < 0) fraction = 0;
+            break;
+        }
+        t += dt;
+        pos++;
+    }
+    if (pos == n) pos = n - 1;
+
+    // Straight between the two cities; roads carry no shape
+    const CityNode& a = cities[edgeSource(edges[pos])];
+    const CityNode& b = cities[getEdge(edges[pos]).dest];
+    if (std::isnan(a.lat) || std::isnan(b.lat)) return false;
+    lat = a.lat + (b.lat - a.lat) * fraction;
+    lon = a.lon + (b.lon - a.lon) * fraction;
+    return true;
+}
@@ -1,64 +1,176 @@
-#ifndef MAPGRAPH_H
-#define MAPGRAPH_H
-
-#include <string>
-#include "datastructures.h"
-
-struct Edge {
-    int dest;
-    int weight;
-    bool blocked;
-    Edge(int d = 0, int w = 0);
-};
-
-class EdgeArrayList {
-private:
-    Edge* data;
-    int capacity;
-    int count;
-    void resize(int newCapacity);
-public:
-    EdgeArrayList();
-    EdgeArrayList(const EdgeArrayList& other);
-    EdgeArrayList& operator=(const EdgeArrayList& other);
-    ~EdgeArrayList();
-    void add(Edge val);
-    int size() const;
-    Edge& getRef(int i);
-};
-
-struct CityNode {
-    std::string name;
-    std::string zone;
-    EdgeArrayList edges;
-    CityNode(std::string n = "", std::string z = "");
-};
-
-class MapGraph {
-public:
-    CityNode* cities;
-    int cityCount;
-    int cityCapacity;
-
-    bool* visited;
-    void solveDFS(int u, int d, IntArrayList currentPath, int currentDist);
-
-    // Store found paths for user selection (Max 5 paths)
-    IntArrayList availablePaths[5];
-    int availablePathDistances[5];
-    int pathCount;
-
-    MapGraph();
-    ~MapGraph();
-
-    int addCity(std::string name, std::string zone);
-    void addRoad(int u, int v, int dist);
-    int getCityIndex(std::string name);
-    std::string getZone(std::string name);
-    void blockRandomRoad();
-    void displayNetwork();
-    void findAllPaths(int start, int end);
-    int getMinRouteIndex();
-};
-
-#endif
+#ifndef MAPGRAPH_H
+#define MAPGRAPH_H
+
+#include <string>
+#include <string_view>
+#include <climits>
+#include <cmath>
+#include "datastructures.h"
+#include "cityindex.h"
+#include "geoindex.h"
+#include "routeoverlay.h"
+#include "fastrandom.h"
+
+const int DIST_INFINITY = INT_MAX;
+
+// Hour-of-day speed table shared by many roads. cumKm[h] is the distance
+// covered from midnight up to hour h, which turns "how long does d km take
+// starting at time t" into two table lookups instead of an hour-by-hour walk.
+struct SpeedProfile {
+    std::string name;
+    unsigned char kmh[24];
+    float cumKm[25];
+};
+
+// Each road is stored as two directed edges with their own ids
+// (2r for u->v, 2r+1 for v->u) so a block can close one direction only.
+struct Edge {
+    int id;
+    int dest;
+    int weight;
+    bool blocked;
+    unsigned char profile;
+    Edge(int d = 0, int w = 0, int prof = 0, int eid = -1);
+};
+
+// A city's roads; four covers every city on the default map
+typedef SmallVector<Edge, 4> EdgeArrayList;
+
+// Dense row-major distance table (sources x targets).
+// The buffer is 64-byte aligned and every row is padded to a whole cache line
+// so worker threads filling different rows never share a line.
+class DistanceMatrix {
+private:
+    char* raw;
+    int* data;
+    int rows;
+    int cols;
+    int stride;
+public:
+    DistanceMatrix();
+    ~DistanceMatrix();
+    DistanceMatrix(const DistanceMatrix&) = delete;
+    DistanceMatrix& operator=(const DistanceMatrix&) = delete;
+    void resize(int r, int c);
+    int* row(int r);
+    const int* row(int r) const;
+    int get(int r, int c) const;
+    int rowCount() const;
+    int colCount() const;
+};
+
+struct CityNode {
+    std::string name;
+    std::string zone;
+    double lat;             // degrees; NaN when the city has no position
+    double lon;
+    EdgeArrayList edges;
+    CityNode(std::string n = "", std::string z = "", double la = NAN, double lo = NAN);
+};
+
+class MapGraph {
+public:
+    CityNode* cities;
+    int cityCount;
+    int cityCapacity;
+
+    bool* visited;
+    void solveDFS(int u, int d, IntArrayList& currentPath, int currentDist);
+
+    // Store found paths for user selection (Max 5 paths)
+    IntArrayList availablePaths[5];
+    int availablePathDistances[5];
+    int pathCount;
+
+    MapGraph();
+    ~MapGraph();
+
+    // Time-dependent travel (profile 0 is the default for new roads)
+    SpeedProfile* profiles;
+    int profileCount;
+    int profileCapacity;
+
+    // Directed edge id -> owning city and slot in that city's edge list
+    IntArrayList edgeOwner;
+    IntArrayList edgeSlot;
+    int edgeCount;
+
+    // Edge ids in the order they were closed; a replica catches up by
+    // applying everything past the length it last saw
+    IntArrayList closures;
+
+    // Name lookup (case-insensitive hash probe + typo trie)
+    CityHashIndex cityIndex;
+    CityTrie cityTrie;
+
+    // Where cities are (see nearestCities); rebuilt when cities are added
+    GeoIndex cityGeo;
+    IntArrayList geoCityOf;     // index entry -> city
+    bool geoStale;
+    // A* lower bound on hours per straight-line km to the target: the
+    // fastest speed on the map, scaled down by the road that is shortest
+    // against the straight line between its cities. 0 (plain Dijkstra)
+    // while any city has no position.
+    double hoursPerKmBound;
+    double* cityPoints;         // geoPointKm of each city, for the bound
+    void refreshGeo();
+
+    // Zone cells with precomputed boundary-to-boundary distances; a road
+    // closure re-customizes only the cells around it (see RouteOverlay)
+    RouteOverlay overlay;
+
+    // Picks the road blockRandomRoad closes. Per map, not rand(): hub shards
+    // drive their maps from their own threads.
+    FastRandom dice;
+
+    int addCity(std::string name, std::string zone, double lat = NAN, double lon = NAN);
+    void addRoad(int u, int v, int dist, int profile = 0);
+    int addSpeedProfile(std::string name, const unsigned char kmh[24]);
+    double edgeTravelHours(const Edge& e, double departHour) const;
+    double routeTravelHours(const IntArrayList& path, double departHour);
+    // Time-dependent A* (Dijkstra when cities lack positions): earliest arrival
+    // hour at 'end' when leaving 'start' at departHour, or -1 if unreachable.
+    // Optionally returns the city sequence.
+    double fastestArrival(int start, int end, double departHour, IntArrayList* pathOut = nullptr);
+    // Up to k cities nearest the point, nearest first (km in kmOut when
+    // given); cities without a position are left out
+    int nearestCities(double lat, double lon, int k, int* out, double* kmOut = nullptr);
+    // Where a vehicle is elapsedHours after leaving on the given directed
+    // edges at departHour, between the two cities of its current road.
+    // False if those cities have no position.
+    bool routePosition(const int* edges, int n, double departHour, double elapsedHours, double& lat, double& lon);
+    // Shortest open-road km from start to end over the zone overlay, or
+    // DIST_INFINITY. Optionally returns the city sequence.
+    int shortestDistance(int start, int end, IntArrayList* pathOut = nullptr);
+    int getCityIndex(std::string_view name);
+    // One probe for both answers: returns the index and points zoneOut at the zone
+    int resolveCity(std::string_view name, const std::string** zoneOut);
+    std::string getZone(std::string_view name);
+    // Closest known city for a mistyped name (prefix or <= 2 edits), or -1
+    int suggestCity(std::string_view name);
+    int blockRandomRoad();
+    void setSeed(unsigned long long seed);
+    // Closes one directed road; false if it was already closed
+    bool blockRoad(int edgeId);
+    Edge& getEdge(int edgeId);
+    const Edge& getEdge(int edgeId) const;
+    int edgeSource(int edgeId);
+    int findEdgeId(int u, int v);
+    // Converts a city path to directed edge ids; returns the count written
+    int pathToEdges(const IntArrayList& path, int* out);
+    // And back: the cities a run of directed edges passes, appended to path
+    void edgesToPath(const int* edges, int n, IntArrayList& path);
+    void displayNetwork(std::ostream& out);
+    // Up to five open routes, the shortest first
+    void findAllPaths(int start, int end);
+    int getMinRouteIndex();
+
+    // Many-to-many shortest distances (km). One Dijkstra per source over a
+    // packed snapshot of the open roads, sources spread across threads.
+    // threads <= 0 uses every hardware thread.
+    void computeDistanceMatrix(const int* sources, int sourceCount,
+                               const int* targets, int targetCount,
+                               DistanceMatrix& out, int threads = 0);
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef MINHEAP_H
+#define MINHEAP_H
+
+// Binary min-heap over a caller-owned array, for the searches (Dijkstra,
+// A*, nearest neighbours) that push a node several times and skip the
+// stale copies when they come off ("lazy deletion"). Callers size the
+// array for every push they can make.
+template <typename Key>
+struct MinHeapItem {
+    Key key;
+    int node;
+};
+
+template <typename Key>
+inline void minHeapPush(MinHeapItem<Key>* h, int& n, Key key, int node) {
+    int i = n++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (h[parent].key <= key) break;
+        h[i] = h[parent];
+        i = parent;
+    }
+    h[i].key = key;
+    h[i].node = node;
+}
+
+template <typename Key>
+inline MinHeapItem<Key> minHeapPop(MinHeapItem<Key>* h, int& n) {
+    MinHeapItem<Key> top = h[0];
+    MinHeapItem<Key> last = h[--n];
+    int i = 0;
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && h[child + 1].key < h[child].key) child++;
+        if (last.key <= h[child].key) break;
+        h[i] = h[child];
+        i = child;
+    }
+    h[i] = last;
+    return top;
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for any number of producer and consumer threads.
+// Every slot carries a sequence number saying whose turn it is: a producer
+// may fill slot i when its sequence equals the ticket i it claimed, a
+// consumer may empty it when the sequence is i + 1. Claiming a ticket is a
+// single compare-and-swap on head or tail, so threads only wait on each
+// other for the slot they are both after. Capacity is rounded up to a
+// power of two. Costs a little more per operation than SpscQueue; use that
+// when there is one thread at each end.
+template <typename T>
+class MpmcQueue {
+private:
+    static const size_t CACHE_LINE = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    Slot* slots;
+    size_t mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> tail;   // next ticket to write
+    alignas(CACHE_LINE) std::atomic<size_t> head;   // next ticket to read
+
+public:
+    explicit MpmcQueue(size_t capacity) : tail(0), head(0) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots = new Slot[cap];
+        for (size_t i = 0; i < cap; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+        mask = cap - 1;
+    }
+    ~MpmcQueue() { delete[] slots; }
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // Any thread; false when full
+    bool push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& s = slots[t & mask];
+            long long lag = (long long)(s.sequence.load(std::memory_order_acquire) - t);
+            if (lag == 0) {
+                if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed)) {
+                    s.value = value;
+                    s.sequence.store(t + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lag < 0) return false;     // a lap behind: still unread
+            else t = tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Any thread; false when empty
+    bool pop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& s = slots[h & mask];
+            long long lag = (long long)(s.sequence.load(std::memory_order_acquire) - (h + 1));
+            if (lag == 0) {
+                if (head.compare_exchange_weak(h, h + 1, std::memory_order_relaxed)) {
+                    out = s.value;
+                    s.sequence.store(h + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lag < 0) return false;     // not written yet
+            else h = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Approximate
+    size_t size() const {
+        size_t t = tail.load(std::memory_order_acquire);
+        size_t h = head.load(std::memory_order_acquire);
+        return t > h ? t - h : 0;
+    }
+    size_t capacity() const { return mask + 1; }
+};
+
+#endif
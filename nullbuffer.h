@@ -0,0 +1,15 @@
+#ifndef NULLBUFFER_H
+#define NULLBUFFER_H
+
+#include <streambuf>
+
+// Swallows everything written to it. Put under cout (rdbuf) or behind an
+// ostream, it silences the engine's console rendering when nothing is
+// looking: the server, the benchmarks, the load generator.
+class NullBuffer : public std::streambuf {
+protected:
+    int_type overflow(int_type c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+#endif
@@ -1,42 +1,84 @@
-
-#ifndef PARCEL_H
-#define PARCEL_H
-
-#include <string>
-#include "trackinghistory.h"
-
-const int STATUS_PICKUP_QUEUE = 0;
-const int STATUS_WAREHOUSE = 1;
-const int STATUS_LOADING = 2;
-const int STATUS_IN_TRANSIT = 3;
-const int STATUS_DELIVERY_ATTEMPT = 4;
-const int STATUS_DELIVERED = 5;
-const int STATUS_RETURNED = 6;
-const int STATUS_MISSING = 7;
-const int STATUS_CANCELLED = 8;
-
-struct Parcel {
-    std::string id;
-    std::string destination;
-    double weight;
-    int priority;
-    int status;
-    int priorityScore;
-    std::string assignedRider;
-    std::string weightCategory;
-    std::string zone;
-    int deliveryAttempts;
-    long long dispatchTime;
-    long long lastUpdateTime;
-    long long arrivalTime;
-    TrackingHistory* history;
-
-    Parcel();
-    Parcel(std::string pid, std::string dest, double w, int p, std::string z);
-    void updateStatus(int newStatus, std::string desc, std::string loc);
-    std::string getStatusString() const;
-};
-
-std::ostream& operator<<(std::ostream& os, const Parcel& p);
-
+
+#ifndef PARCEL_H
+#define PARCEL_H
+
+#include <string>
+#include "trackinghistory.h"
+
+const int STATUS_PICKUP_QUEUE = 0;
+const int STATUS_WAREHOUSE = 1;
+const int STATUS_LOADING = 2;
+const int STATUS_IN_TRANSIT = 3;
+const int STATUS_DELIVERY_ATTEMPT = 4;
+const int STATUS_DELIVERED = 5;
+const int STATUS_RETURNED = 6;
+const int STATUS_MISSING = 7;
+const int STATUS_CANCELLED = 8;
+
+struct Parcel {
+    std::string id;
+    std::string destination;
+    double weight;
+    int priority;
+    int status;
+    std::string assignedRider;
+    std::string weightCategory;
+    std::string zone;
+    int deliveryAttempts;
+    long long dispatchTime;
+    long long lastUpdateTime;
+    long long arrivalTime;
+    TrackingHistory* history;
+
+    // Dispatched route as directed edge ids (see MapGraph::getEdge)
+    int* routeEdges;
+    int routeLength;
+    double routeDepartHour;
+    // The same route as delta-encoded city ids (see encodeRoute): what is
+    // saved with the parcel and archived with it, and the key the route
+    // analytics count it under
+    std::string routeCode;
+
+    // When the parcel joined this hub's sorting queue, and the due time the
+    // dispatch policy gave it (see DispatchScheduler)
+    long long queuedSince;
+    long long dueTime;
+
+    // Container bookkeeping: place in the sorting queue (queueSlot -1 when
+    // not queued) and row in the transit table (-1 when not on the road)
+    int queueBucket;
+    int queueSlot;
+    int shipRow;
+    // Storage segment this parcel is saved in (see ParcelStore)
+    int storeSegment;
+    // Set while the parcel is leaving this engine (to the cold tier, or
+    // handed to another hub)
+    bool leaving;
+    // Queued for the replication stream (see LogisticsEngine::publishChanges)
+    bool publishPending;
+
+    Parcel();
+    Parcel(std::string pid, std::string dest, double w, int p, std::string z);
+    ~Parcel();
+    Parcel(const Parcel&) = delete;
+    Parcel& operator=(const Parcel&) = delete;
+    void updateStatus(int newStatus, std::string desc, std::string loc);
+    void setRoute(const int* edges, int n, double departHour);
+    void clearRoute();
+    // Points into a static badge table; nothing is built per call
+    const std::string& getStatusString() const;
+    // Plain status label without terminal colours (API / export use)
+    const char* getStatusName() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const Parcel& p);
+
+// Status change observers, called after every updateStatus().
+// The API server's push feed subscribes here; listeners must not block.
+// Registrations are per thread: a listener only hears about updates made on
+// the thread that added it.
+typedef void (*StatusListener)(const Parcel& p, int oldStatus, void* ctx);
+void addStatusListener(StatusListener fn, void* ctx);
+void removeStatusListener(StatusListener fn, void* ctx);
+
 #endif
\ No newline at end of file
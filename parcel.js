@@ -277,3 +277,106 @@ function trackParcelLogic(id) {
         errorMsg.style.display = "block";
     }
 }
+
+// --- Engine API Bridge --- //
+// When the pages are served by the engine itself (swiftex --serve), the
+// live C++ state is mirrored into the local cache and every write goes to
+// the API. Opened straight from disk, the pages keep the LocalStorage demo.
+const SwiftExApi = {
+    enabled: location.protocol.startsWith('http'),
+
+    // Engine status names -> labels the pages already style
+    localStatus: function (statusText) {
+        if (statusText === "Pickup Queue" || statusText === "Warehouse") return "Booked";
+        if (statusText === "Loading") return "In Transit";
+        return statusText;
+    },
+
+    toLocal: function (p) {
+        return {
+            id: p.id, sender: "Lahore", receiver: p.destination, weight: p.weight,
+            priority: p.priority, status: this.localStatus(p.statusText), date: getCurrentDate()
+        };
+    },
+
+    send: function (method, path, params) {
+        const body = params ? new URLSearchParams(params).toString() : null;
+        return fetch(path, {
+            method: method, body: body,
+            headers: body ? { 'Content-Type': 'application/x-www-form-urlencoded' } : {}
+        }).then(r => r.json().then(json => ({ ok: r.ok, json: json })));
+    },
+
+    // Live push feed (server-sent events); filter is an optional
+    // { id, zone, status } object, e.g. { status: "5,6" }
+    watch: function (filter, onStatus, onResync) {
+        if (!this.enabled || !window.EventSource) return null;
+        const query = filter ? '?' + new URLSearchParams(filter).toString() : '';
+        const source = new EventSource('/api/events' + query);
+        source.addEventListener('status', e => onStatus(JSON.parse(e.data)));
+        if (onResync) source.addEventListener('resync', onResync);
+        return source;
+    },
+
+    // Pulls the engine's inventory into the cache, then re-renders
+    sync: function (render) {
+        if (!this.enabled) return;
+        fetch('/api/parcels').then(r => r.json()).then(json => {
+            const data = {};
+            json.parcels.forEach(p => { data[p.id] = this.toLocal(p); });
+            SwiftExApp.saveAll(data);
+            if (render) render();
+        }).catch(() => { this.enabled = false; });
+    }
+};
+
+// Mirror writes to the engine; the local cache still answers immediately
+(function () {
+    const localAdd = SwiftExApp.addParcel;
+    const localCancel = SwiftExApp.cancelParcel;
+    const localNext = SwiftExApp.processNext;
+
+    SwiftExApp.addParcel = function (parcel) {
+        if (!localAdd.call(this, parcel)) return false;
+        if (SwiftExApi.enabled) {
+            SwiftExApi.send('POST', '/api/parcels', {
+                id: parcel.id, dest: parcel.receiver, weight: parcel.weight, priority: parcel.priority
+            }).then(res => {
+                if (!res.ok) alert("Engine rejected " + parcel.id + ": " + res.json.error +
+                    (res.json.suggestion ? " (did you mean " + res.json.suggestion + "?)" : ""));
+            });
+        }
+        return true;
+    };
+
+    SwiftExApp.cancelParcel = function (id) {
+        if (SwiftExApi.enabled) SwiftExApi.send('POST', '/api/parcels/' + encodeURIComponent(id) + '/cancel');
+        return localCancel.call(this, id);
+    };
+
+    SwiftExApp.processNext = function () {
+        if (SwiftExApi.enabled) SwiftExApi.send('POST', '/api/dispatch').then(() => SwiftExApi.sync(loadDashboardStats));
+        return localNext.call(this);
+    };
+})();
+
+function refreshPage() {
+    if (document.getElementById('inventoryBody')) loadInventory();
+    else loadDashboardStats();
+}
+
+document.addEventListener('DOMContentLoaded', function () {
+    SwiftExApi.sync(refreshPage);
+
+    // Apply pushed deltas to the cache instead of polling the engine
+    SwiftExApi.watch(null, function (delta) {
+        const data = SwiftExApp.getAll();
+        if (!data[delta.id]) {
+            SwiftExApi.sync(refreshPage);   // new parcel: fetch its full record
+            return;
+        }
+        data[delta.id].status = SwiftExApi.localStatus(delta.statusText);
+        SwiftExApp.saveAll(data);
+        refreshPage();
+    }, function () { SwiftExApi.sync(refreshPage); });
+});
@@ -0,0 +1,312 @@
+#include "parcelstore.h"
+#include "filesync.h"
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// =====================================================
+// ParcelStore Implementation (Segmented, Dirty-Tracked Saves)
+// =====================================================
+ParcelStore::ParcelStore(const string& directory)
+    : dir(directory), segments(nullptr), dirty(nullptr), segmentCount(0), segmentCapacity(0),
+      pending(nullptr), hasPending(nullptr), failed(nullptr), pendingOrder(nullptr), pendingCount(0),
+      pendingCapacity(0), failures(0), writing(false), stopping(false) {
+    growSegments(16);
+    growPending(16);
+    addStatusListener(onStatusChange, this);
+    writer = thread(&ParcelStore::writerLoop, this);
+}
+
+ParcelStore::~ParcelStore() {
+    removeStatusListener(onStatusChange, this);
+    {
+        lock_guard<mutex> g(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();   // the writer drains the queue before it exits
+
+    for (int i = 0; i < segmentCount; i++) delete segments[i];
+    delete[] segments;
+    delete[] dirty;
+    delete[] pending;
+    delete[] hasPending;
+    delete[] failed;
+    delete[] pendingOrder;
+}
+
+void ParcelStore::growSegments(int needed) {
+    if (needed <= segmentCapacity) return;
+    int newCap = segmentCapacity ? segmentCapacity : 16;
+    while (newCap < needed) newCap *= 2;
+
+    ParcelArrayList** newSegs = new ParcelArrayList*[newCap];
+    bool* newDirty = new bool[newCap];
+    for (int i = 0; i < segmentCapacity; i++) {
+        newSegs[i] = segments[i];
+        newDirty[i] = dirty[i];
+    }
+    for (int i = segmentCapacity; i < newCap; i++) {
+        newSegs[i] = nullptr;
+        newDirty[i] = false;
+    }
+    delete[] segments;
+    delete[] dirty;
+    segments = newSegs;
+    dirty = newDirty;
+    segmentCapacity = newCap;
+}
+
+// Caller holds the lock (or the writer is not running yet)
+void ParcelStore::growPending(int needed) {
+    if (needed <= pendingCapacity) return;
+    int newCap = pendingCapacity ? pendingCapacity : 16;
+    while (newCap < needed) newCap *= 2;
+
+    string* newPending = new string[newCap];
+    bool* newHas = new bool[newCap];
+    bool* newFailed = new bool[newCap];
+    int* newOrder = new int[newCap];
+    for (int i = 0; i < pendingCapacity; i++) {
+        newPending[i].swap(pending[i]);
+        newHas[i] = hasPending[i];
+        newFailed[i] = failed[i];
+    }
+    for (int i = pendingCapacity; i < newCap; i++) newHas[i] = newFailed[i] = false;
+    for (int i = 0; i < pendingCount; i++) newOrder[i] = pendingOrder[i];
+    delete[] pending;
+    delete[] hasPending;
+    delete[] failed;
+    delete[] pendingOrder;
+    pending = newPending;
+    hasPending = newHas;
+    failed = newFailed;
+    pendingOrder = newOrder;
+    pendingCapacity = newCap;
+}
+
+void ParcelStore::place(Parcel* p, int segment) {
+    growSegments(segment + 1);
+    while (segmentCount <= segment) segments[segmentCount++] = new ParcelArrayList();
+    segments[segment]->add(p);
+    p->storeSegment = segment;
+}
+
+string ParcelStore::segmentPath(int segment) const {
+    char name[32];
+    snprintf(name, sizeof(name), "seg-%05d.txt", segment);
+    return (fs::path(dir) / name).string();
+}
+
+bool ParcelStore::load(ParseFn parse, ParcelArrayList& loaded, int threads) {
+    error_code ec;
+    if (!fs::is_directory(dir, ec)) return false;
+
+    IntArrayList ids;
+    string* paths = nullptr;
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir, ec)) {
+        string name = entry.path().filename().string();
+        // Leftovers from a save that was cut short; the real file is intact
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+            fs::remove(entry.path(), ec);
+            continue;
+        }
+        if (name.compare(0, 4, "seg-") != 0) continue;
+        int n = ids.size();
+        if (n == 0 || (n >= 16 && (n & (n - 1)) == 0)) {
+            string* bigger = new string[n < 16 ? 16 : n * 2];
+            for (int i = 0; i < n; i++) bigger[i].swap(paths[i]);
+            delete[] paths;
+            paths = bigger;
+        }
+        paths[n] = entry.path().string();
+        ids.add(atoi(name.c_str() + 4));
+    }
+
+    // Reading and parsing is most of the work and needs nothing shared, so
+    // the files are handed out to workers; placing them stays serial
+    int files = ids.size();
+    ParcelArrayList* parsed = new ParcelArrayList[files > 0 ? files : 1];
+    atomic<int> nextFile(0);
+    auto work = [&]() {
+        string line;
+        for (int i = nextFile++; i < files; i = nextFile++) {
+            ifstream f(paths[i]);
+            while (getline(f, line)) {
+                Parcel* p = parse(line);
+                if (p) parsed[i].add(p);
+            }
+        }
+    };
+    if (threads <= 0) threads = (int)thread::hardware_concurrency();
+    if (threads > files) threads = files;
+    thread* workers = new thread[threads > 1 ? threads - 1 : 1];
+    for (int t = 0; t + 1 < threads; t++) workers[t] = thread(work);
+    work();
+    for (int t = 0; t + 1 < threads; t++) workers[t].join();
+    delete[] workers;
+    delete[] paths;
+
+    for (int i = 0; i < files; i++) {
+        int segment = ids[i];
+        // Make sure the segment exists even if every line was skipped
+        growSegments(segment + 1);
+        while (segmentCount <= segment) segments[segmentCount++] = new ParcelArrayList();
+        for (int j = 0; j < parsed[i].size(); j++) {
+            place(parsed[i][j], segment);
+            loaded.add(parsed[i][j]);
+        }
+    }
+    delete[] parsed;
+    return true;
+}
+
+void ParcelStore::track(Parcel* p) {
+    int segment = segmentCount - 1;
+    if (segment < 0 || segments[segment]->size() >= PARCELS_PER_SEGMENT) segment = segmentCount;
+    place(p, segment);
+    dirty[segment] = true;
+}
+
+void ParcelStore::untrack(Parcel* p) {
+    int s = p->storeSegment;
+    if (s < 0 || s >= segmentCount) return;
+    ParcelArrayList* seg = segments[s];
+    for (int i = 0; i < seg->size(); i++) {
+        if (seg->get(i) == p) {
+            seg->swap(i, seg->size() - 1);
+            seg->removeLast();
+            break;
+        }
+    }
+    dirty[s] = true;
+    p->storeSegment = -1;
+}
+
+void ParcelStore::markDirty(const Parcel* p) {
+    if (p->storeSegment >= 0 && p->storeSegment < segmentCount) dirty[p->storeSegment] = true;
+}
+
+void ParcelStore::onStatusChange(const Parcel& p, int, void* ctx) {
+    ((ParcelStore*)ctx)->markDirty(&p);
+}
+
+// Same line format parcels.txt always used: id,dest,weight,priority,status,zone
+void ParcelStore::appendRecord(string& out, const Parcel& p) {
+    char weight[32];
+    snprintf(weight, sizeof(weight), "%g", p.weight);
+    out += p.id;
+    out += ',';
+    out += p.destination;
+    out += ',';
+    out += weight;
+    out += ',';
+    out += to_string(p.priority);
+    out += ',';
+    out += to_string(p.status);
+    out += ',';
+    out += p.zone;
+    if (!p.routeCode.empty()) {
+        out += ',';
+        out += p.routeCode;
+    }
+    out += '\n';
+}
+
+int ParcelStore::flush() {
+    {
+        // Segments the writer gave up on are saved again from current state
+        lock_guard<mutex> g(lock);
+        for (int s = 0; s < pendingCapacity && failures > 0; s++) {
+            if (!failed[s]) continue;
+            failed[s] = false;
+            failures--;
+            if (s < segmentCount) dirty[s] = true;
+        }
+    }
+
+    int queued = 0;
+    string snapshot;
+    for (int s = 0; s < segmentCount; s++) {
+        if (!dirty[s]) continue;
+        dirty[s] = false;
+
+        snapshot.clear();
+        ParcelArrayList* seg = segments[s];
+        for (int i = 0; i < seg->size(); i++) appendRecord(snapshot, *seg->get(i));
+
+        lock_guard<mutex> g(lock);
+        growPending(s + 1);
+        if (!hasPending[s]) {
+            hasPending[s] = true;
+            pendingOrder[pendingCount++] = s;
+        }
+        pending[s].swap(snapshot);   // replaces any older snapshot not yet written
+        queued++;
+    }
+    if (queued) wake.notify_one();
+    return queued;
+}
+
+bool ParcelStore::waitIdle() {
+    unique_lock<mutex> g(lock);
+    idle.wait(g, [this] { return pendingCount == 0 && !writing; });
+    return failures == 0;
+}
+
+bool ParcelStore::writeSegment(int segment, const string& data) {
+    error_code ec;
+    fs::create_directories(dir, ec);
+
+    string path = segmentPath(segment);
+    string temp = path + ".tmp";
+    {
+        ofstream f(temp, ios::binary | ios::trunc);
+        if (!f.is_open()) return false;
+        f.write(data.data(), (streamsize)data.size());
+        f.flush();
+        if (!f) return false;
+    }
+    // Synced before the rename, so the name never points at a segment
+    // whose bytes did not make it; the directory sync keeps the rename
+    if (!syncFile(temp)) return false;
+    fs::rename(temp, path, ec);
+    return !ec && syncDirectory(dir);
+}
+
+void ParcelStore::writerLoop() {
+    string data;
+    unique_lock<mutex> g(lock);
+    for (;;) {
+        wake.wait(g, [this] { return pendingCount > 0 || stopping; });
+        if (pendingCount == 0) break;   // stopping, and nothing left to write
+
+        int segment = pendingOrder[0];
+        for (int i = 1; i < pendingCount; i++) pendingOrder[i - 1] = pendingOrder[i];
+        pendingCount--;
+        hasPending[segment] = false;
+        data.swap(pending[segment]);
+        writing = true;
+
+        g.unlock();
+        bool ok = writeSegment(segment, data);
+        g.lock();
+
+        writing = false;
+        if (!ok && !failed[segment]) {
+            failed[segment] = true;
+            failures++;
+        }
+        else if (ok && failed[segment]) {
+            failed[segment] = false;
+            failures--;
+        }
+        if (pendingCount == 0) idle.notify_all();
+    }
+    idle.notify_all();
+}
@@ -0,0 +1,85 @@
+#ifndef PARCELSTORE_H
+#define PARCELSTORE_H
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "parcel.h"
+#include "datastructures.h"
+
+// Segmented on-disk parcel database. Parcels are packed into fixed-size
+// segments (one text file each, same line format as the old parcels.txt)
+// and a segment is only rewritten after one of its parcels changed.
+//
+// flush() snapshots the dirty segments on the caller's thread - cheap, and
+// proportional to what changed - and hands the bytes to a background writer
+// that replaces each file atomically (write temp, fsync, rename, fsync the
+// directory). The console never waits on the disk.
+class ParcelStore {
+public:
+    static const int PARCELS_PER_SEGMENT = 256;
+
+    // Called once per stored line; returns the parcel it created, or
+    // nullptr to skip the line. Segments are parsed on several threads at
+    // once, so it must not touch anything shared.
+    typedef Parcel* (*ParseFn)(const std::string& line);
+
+private:
+    std::string dir;
+    ParcelArrayList** segments;
+    bool* dirty;
+    int segmentCount;
+    int segmentCapacity;
+
+    // Writer side, guarded by lock
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::string* pending;        // latest snapshot per segment, newest wins
+    bool* hasPending;
+    bool* failed;                // write failed; the next flush() retries it
+    int* pendingOrder;           // segment ids waiting to be written
+    int pendingCount;
+    int pendingCapacity;         // size of the four arrays above
+    int failures;
+    bool writing;
+    bool stopping;
+    std::thread writer;
+
+    void growSegments(int needed);
+    void growPending(int needed);
+    void place(Parcel* p, int segment);
+    void writerLoop();
+    bool writeSegment(int segment, const std::string& data);
+    std::string segmentPath(int segment) const;
+    static void onStatusChange(const Parcel& p, int oldStatus, void* ctx);
+
+public:
+    ParcelStore(const std::string& directory = "parcels.d");
+    ~ParcelStore();
+    ParcelStore(const ParcelStore&) = delete;
+    ParcelStore& operator=(const ParcelStore&) = delete;
+
+    // Reads every segment file, up to 'threads' at a time (0: one per
+    // core), and appends the parcels to loaded, a segment at a time; false
+    // if the store does not exist yet
+    bool load(ParseFn parse, ParcelArrayList& loaded, int threads = 0);
+    // Assigns a new parcel to a segment and marks it for saving
+    void track(Parcel* p);
+    // Drops a parcel that moved to the archive; its segment is rewritten
+    // without it on the next flush
+    void untrack(Parcel* p);
+    void markDirty(const Parcel* p);
+
+    // Queues the changed segments for writing; returns how many there were
+    int flush();
+    const std::string& directory() const { return dir; }
+    // Blocks until the writer has worked through everything queued so far;
+    // false if some segment could not be written
+    bool waitIdle();
+
+    static void appendRecord(std::string& out, const Parcel& p);
+};
+
+#endif
@@ -0,0 +1,546 @@
+#include "replication.h"
+#include "logisticsengine.h"
+#include <iostream>
+#include <cstring>
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+using namespace std;
+
+// Heartbeats keep the standby's view of the primary's sequence current
+// while nothing changes; a standby hearing nothing for LINK_TIMEOUT_MS
+// assumes the link is dead and reconnects
+static const long long HEARTBEAT_MS = 100;
+static const long long LINK_TIMEOUT_MS = 1000;
+static const long long RECONNECT_MS = 250;
+// A standby this far behind is cut off; it reconnects for a fresh snapshot
+static const size_t MAX_BACKLOG_BYTES = 64 << 20;
+
+// Wall clock, not monotonic: lag compares the primary's clock with the
+// standby's, which agree on one machine (and under NTP, closely enough)
+static long long wallMs() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// =====================================================
+// Row Images (platform neutral)
+// =====================================================
+// id, dest, zone, rider, weight, priority, status, attempts, dispatch /
+// update / arrival times, route (depart hour, edges), then the timeline
+static void writeRow(RpcWriter& w, const Parcel& p) {
+    w.str(p.id);
+    w.str(p.destination);
+    w.str(p.zone);
+    w.str(p.assignedRider);
+    w.f64(p.weight);
+    w.u32((unsigned int)p.priority);
+    w.u8((unsigned int)p.status);
+    w.u32((unsigned int)p.deliveryAttempts);
+    w.i64(p.dispatchTime);
+    w.i64(p.lastUpdateTime);
+    w.i64(p.arrivalTime);
+    w.i64(p.queuedSince);
+    w.f64(p.routeDepartHour);
+    w.u32((unsigned int)p.routeLength);
+    for (int i = 0; i < p.routeLength; i++) w.u32((unsigned int)p.routeEdges[i]);
+
+    int events = 0;
+    for (const HistoryEvent* e = p.history->first(); e; e = e->next) events++;
+    w.u32((unsigned int)events);
+    for (const HistoryEvent* e = p.history->first(); e; e = e->next) {
+        w.str(e->description);
+        w.str(e->time);
+        w.str(e->location);
+    }
+}
+
+// A new parcel owned by the caller, or nullptr if the frame is malformed
+static Parcel* readRow(RpcReader& r) {
+    string id(r.str()), dest(r.str()), zone(r.str()), rider(r.str());
+    double weight = r.f64();
+    int priority = (int)r.u32();
+    if (!r.ok() || id.empty()) return nullptr;
+
+    Parcel* p = new Parcel(move(id), move(dest), weight, priority, move(zone));
+    p->assignedRider = move(rider);
+    p->status = (int)r.u8();
+    p->deliveryAttempts = (int)r.u32();
+    p->dispatchTime = r.i64();
+    p->lastUpdateTime = r.i64();
+    p->arrivalTime = r.i64();
+    p->queuedSince = r.i64();
+    double departHour = r.f64();
+    unsigned int edges = r.u32();
+    if (edges > 0 && edges <= RPC_MAX_FRAME / 4) {
+        int* route = new int[edges];
+        for (unsigned int i = 0; i < edges; i++) route[i] = (int)r.u32();
+        p->setRoute(route, (int)edges, departHour);
+        delete[] route;
+    }
+
+    // Swap the fresh "Pickup Request Created" timeline for the primary's
+    delete p->history;
+    p->history = new TrackingHistory();
+    unsigned int events = r.u32();
+    for (unsigned int e = 0; e < events && r.ok(); e++) {
+        string_view d = r.str();
+        string_view t = r.str();
+        string_view l = r.str();
+        p->history->restoreEvent(string(d), string(t), string(l));
+    }
+
+    if (!r.ok()) {
+        delete p;
+        return nullptr;
+    }
+    return p;
+}
+
+// =====================================================
+// ReplicationPublisher Implementation (engine side)
+// =====================================================
+ReplicationPublisher::ReplicationPublisher(const string& listenAddress)
+    : address(listenAddress), listenFd(-1), wakeFd(-1), batch(16384), batchWriter(batch), snapshot(16384),
+      snapshotWriter(snapshot), snapshotBuilt(false), lastSeq(0), followerCount(0), seq(0), joining(0),
+      stopping(false) {}
+
+void ReplicationPublisher::upsert(const Parcel& p) {
+    batchWriter.begin(REPL_ROW, 0);
+    writeRow(batchWriter, p);
+    batchWriter.end();
+}
+
+void ReplicationPublisher::remove(string_view id) {
+    batchWriter.begin(REPL_REMOVE, 0);
+    batchWriter.str(id);
+    batchWriter.end();
+}
+
+void ReplicationPublisher::archive(string_view id) {
+    batchWriter.begin(REPL_ARCHIVE, 0);
+    batchWriter.str(id);
+    batchWriter.end();
+}
+
+void ReplicationPublisher::closeRoad(int edgeId) {
+    batchWriter.begin(REPL_CLOSE, 0);
+    batchWriter.u32((unsigned int)edgeId);
+    batchWriter.end();
+}
+
+void ReplicationPublisher::beginSnapshot() {
+    snapshot.clear();
+    snapshotWriter.begin(REPL_SNAPSHOT, 0);
+    snapshotWriter.end();
+    snapshotBuilt = true;
+}
+
+void ReplicationPublisher::snapshotRow(const Parcel& p) {
+    snapshotWriter.begin(REPL_ROW, 0);
+    writeRow(snapshotWriter, p);
+    snapshotWriter.end();
+}
+
+void ReplicationPublisher::snapshotClosure(int edgeId) {
+    snapshotWriter.begin(REPL_CLOSE, 0);
+    snapshotWriter.u32((unsigned int)edgeId);
+    snapshotWriter.end();
+}
+
+// Standbys that are live get the batch; standbys still joining get the
+// snapshot instead, which was built after the batch and so already holds it
+void ReplicationPublisher::commit() {
+    if (batch.size() == 0 && !snapshotBuilt) return;
+    long long now = wallMs();
+    if (batch.size() > 0) {
+        lastSeq++;
+        batchWriter.begin(REPL_COMMIT, 0);
+        batchWriter.i64(lastSeq);
+        batchWriter.i64(now);
+        batchWriter.end();
+    }
+    if (snapshotBuilt) {
+        snapshotWriter.begin(REPL_COMMIT, 0);
+        snapshotWriter.i64(lastSeq);
+        snapshotWriter.i64(now);
+        snapshotWriter.end();
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        seq = lastSeq;
+        for (int i = 0; i < followerCount; i++) {
+            Follower& f = followers[i];
+            if (f.live) {
+                f.out.append(batch.data(), batch.size());
+            }
+            else if (snapshotBuilt) {
+                f.out.append(snapshot.data(), snapshot.size());
+                f.live = true;
+                joining--;
+            }
+        }
+    }
+    batch.clear();
+    snapshot.clear();
+    snapshotBuilt = false;
+    wake();
+}
+
+ReplicationStatus ReplicationPublisher::status() {
+    ReplicationStatus st = {};
+    st.primary = true;
+    st.promoteMs = -1;
+    lock_guard<mutex> guard(lock);
+    st.seq = seq;
+    for (int i = 0; i < followerCount; i++) {
+        if (followers[i].live) st.followers++;
+        long long backlog = (long long)(followers[i].out.size() - followers[i].sent);
+        if (backlog > st.backlogBytes) st.backlogBytes = backlog;
+    }
+    return st;
+}
+
+// =====================================================
+// ReplicationFollower Implementation (engine side)
+// =====================================================
+ReplicationFollower::ReplicationFollower(const string& primaryAddress)
+    : address(primaryAddress), wakeFd(-1), stopping(false), connected(false), primarySeq(0), lastContactMs(0),
+      appliedSeq(0), appliedCommitMs(0), applyDelayMs(0), promoteMs(-1), promoted(false) {}
+
+int ReplicationFollower::applyPending(LogisticsEngine& engine) {
+#ifdef __linux__
+    unsigned long long ticks;
+    if (wakeFd >= 0 && read(wakeFd, &ticks, sizeof(ticks)) < 0) {}
+#endif
+    if (promoted) return 0;
+    {
+        lock_guard<mutex> guard(lock);
+        applying.swap(inbox);
+    }
+    if (applying.empty()) return 0;
+
+    // Archive moves are done together at their commit, one cold block each
+    ParcelArrayList toArchive;
+    int commits = 0;
+    size_t pos = 0;
+    while (pos < applying.size()) {
+        size_t frame = rpcFrameSize(applying.data() + pos, applying.size() - pos);
+        if (frame == 0 || frame == (size_t)-1) break;   // the receiver only queues whole frames
+        RpcReader r(applying.data() + pos, frame);
+        pos += frame;
+
+        switch (r.op()) {
+        case REPL_SNAPSHOT:
+            engine.clearReplica();
+            break;
+        case REPL_ROW: {
+            Parcel* p = readRow(r);
+            if (p) engine.applyReplicated(p);
+            break;
+        }
+        case REPL_REMOVE:
+            engine.removeReplicated(r.str());
+            break;
+        case REPL_ARCHIVE: {
+            Parcel* p = engine.findParcel(r.str());
+            if (p) toArchive.add(p);
+            break;
+        }
+        case REPL_CLOSE:
+            engine.closeRoad((int)r.u32());
+            break;
+        case REPL_COMMIT: {
+            if (!toArchive.isEmpty()) {
+                engine.archiveReplicated(toArchive);
+                toArchive.clear();
+            }
+            appliedSeq = r.i64();
+            appliedCommitMs = r.i64();
+            applyDelayMs = wallMs() - appliedCommitMs;
+            commits++;
+            break;
+        }
+        }
+    }
+    applying.clear();
+    return commits;
+}
+
+// Nothing waits on the receiver: once promoted, whatever it still queues
+// is never applied, and it notices the stop flag within one poll
+long long ReplicationFollower::promote(LogisticsEngine& engine) {
+    if (promoted) return promoteMs;
+    auto start = chrono::steady_clock::now();
+    stopping = true;
+    applyPending(engine);
+    promoted = true;
+    engine.setReadOnly(false);
+    promoteMs = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    cerr << "swiftex: promoted to primary in " << promoteMs << " ms at commit " << appliedSeq << "\n";
+    return promoteMs;
+}
+
+ReplicationStatus ReplicationFollower::status() {
+    ReplicationStatus st = {};
+    long long now = wallMs();
+    st.primary = promoted;
+    st.connected = !promoted && connected.load();
+    st.seq = appliedSeq;
+    st.primarySeq = primarySeq.load();
+    if (!promoted && st.primarySeq > appliedSeq)
+        st.lagMs = appliedCommitMs > 0 ? now - appliedCommitMs : -1;
+    st.applyDelayMs = applyDelayMs;
+    long long contact = lastContactMs.load();
+    st.sinceContactMs = contact > 0 ? now - contact : -1;
+    st.promoteMs = promoteMs;
+    lock_guard<mutex> guard(lock);
+    st.backlogBytes = (long long)inbox.size();
+    return st;
+}
+
+#ifdef __linux__
+// =====================================================
+// Sender / Receiver Threads (Linux)
+// =====================================================
+ReplicationPublisher::~ReplicationPublisher() {
+    stopping = true;
+    if (sender.joinable()) {
+        wake();
+        sender.join();
+    }
+    for (int i = 0; i < followerCount; i++) close(followers[i].fd);
+    if (listenFd >= 0) close(listenFd);
+    if (wakeFd >= 0) close(wakeFd);
+}
+
+bool ReplicationPublisher::start() {
+    listenFd = rpcListen(address);
+    if (listenFd < 0) return false;
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) return false;
+    sender = thread(&ReplicationPublisher::senderLoop, this);
+    return true;
+}
+
+void ReplicationPublisher::wake() {
+    unsigned long long one = 1;
+    if (wakeFd >= 0 && write(wakeFd, &one, sizeof(one)) < 0) {}
+}
+
+// New standbys wait (not live) until the engine builds their snapshot
+void ReplicationPublisher::acceptFollowers() {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        lock_guard<mutex> guard(lock);
+        if (followerCount == MAX_FOLLOWERS) {
+            close(fd);
+            continue;
+        }
+        Follower& f = followers[followerCount++];
+        f.fd = fd;
+        f.out.clear();
+        f.sent = 0;
+        f.live = false;
+        joining++;
+        cerr << "swiftex: standby attached to replication on " << address << "\n";
+    }
+}
+
+// Caller holds lock
+void ReplicationPublisher::dropFollower(int i) {
+    close(followers[i].fd);
+    if (!followers[i].live) joining--;
+    followerCount--;
+    if (i != followerCount) followers[i] = move(followers[followerCount]);
+    followers[followerCount].out = string();
+}
+
+void ReplicationPublisher::senderLoop() {
+    pollfd fds[2 + MAX_FOLLOWERS];
+    long long lastBeat = 0;
+    char scratch[4096];
+    OutBuffer beatFrame(32);
+    RpcWriter beatWriter(beatFrame);
+
+    while (!stopping) {
+        int watched;
+        {
+            lock_guard<mutex> guard(lock);
+            fds[0] = { wakeFd, POLLIN, 0 };
+            fds[1] = { listenFd, POLLIN, 0 };
+            for (int i = 0; i < followerCount; i++) {
+                short events = POLLIN;
+                if (followers[i].sent < followers[i].out.size()) events |= POLLOUT;
+                fds[2 + i] = { followers[i].fd, events, 0 };
+            }
+            watched = 2 + followerCount;
+        }
+        poll(fds, watched, (int)HEARTBEAT_MS);
+        if (fds[0].revents & POLLIN) {
+            unsigned long long ticks;
+            if (read(wakeFd, &ticks, sizeof(ticks)) < 0) {}
+        }
+
+        long long now = wallMs();
+        unique_lock<mutex> guard(lock);
+        bool beat = now - lastBeat >= HEARTBEAT_MS;
+        if (beat) lastBeat = now;
+
+        // Only this thread adds or drops standbys, so fds[2 + i] still
+        // matches followers[i]; walk down so a drop does not skip one
+        for (int i = watched - 3; i >= 0; i--) {
+            Follower& f = followers[i];
+            if (fds[2 + i].revents & (POLLIN | POLLERR | POLLHUP)) {
+                ssize_t n = recv(f.fd, scratch, sizeof(scratch), 0);   // standbys send nothing
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    cerr << "swiftex: standby detached from replication\n";
+                    dropFollower(i);
+                    continue;
+                }
+            }
+            if (beat && f.live) {
+                beatFrame.clear();
+                beatWriter.begin(REPL_HEARTBEAT, 0);
+                beatWriter.i64(seq);
+                beatWriter.i64(now);
+                beatWriter.end();
+                f.out.append(beatFrame.data(), beatFrame.size());
+            }
+
+            bool broken = false;
+            while (f.sent < f.out.size()) {
+                ssize_t n = send(f.fd, f.out.data() + f.sent, f.out.size() - f.sent, MSG_NOSIGNAL);
+                if (n < 0) {
+                    broken = errno != EAGAIN && errno != EWOULDBLOCK;
+                    break;
+                }
+                f.sent += (size_t)n;
+            }
+            if (f.sent == f.out.size()) {
+                f.out.clear();
+                f.sent = 0;
+            }
+            else if (f.sent >= (1 << 20)) {
+                f.out.erase(0, f.sent);
+                f.sent = 0;
+            }
+            if (broken || f.out.size() - f.sent > MAX_BACKLOG_BYTES) {
+                cerr << "swiftex: standby " << (broken ? "connection failed" : "fell too far behind")
+                     << "; dropped from replication\n";
+                dropFollower(i);
+            }
+        }
+        guard.unlock();
+        if (fds[1].revents & POLLIN) acceptFollowers();
+    }
+}
+
+ReplicationFollower::~ReplicationFollower() {
+    stopping = true;
+    if (receiver.joinable()) receiver.join();
+    if (wakeFd >= 0) close(wakeFd);
+}
+
+void ReplicationFollower::start() {
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    receiver = thread(&ReplicationFollower::receiverLoop, this);
+}
+
+void ReplicationFollower::receiverLoop() {
+    bool announced = false;
+    while (!stopping) {
+        int fd = rpcConnect(address, true);
+        if (fd < 0) {
+            if (!announced) cerr << "swiftex: waiting for the primary at " << address << "\n";
+            announced = true;
+            this_thread::sleep_for(chrono::milliseconds(RECONNECT_MS));
+            continue;
+        }
+        cerr << "swiftex: following the primary at " << address << "\n";
+        announced = false;
+        connected = true;
+        receive(fd);
+        connected = false;
+        close(fd);
+        if (!stopping) cerr << "swiftex: lost the primary; reconnecting\n";
+    }
+}
+
+// Queues each commit once it has fully arrived; heartbeats are read here
+// and never queued. Returns when the link fails or the standby stops.
+bool ReplicationFollower::receive(int fd) {
+    string in;
+    string partial;      // frames of the commit still arriving
+    char buf[65536];
+    lastContactMs = wallMs();
+
+    while (!stopping) {
+        pollfd pfd = { fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, (int)HEARTBEAT_MS);
+        if (ready == 0) {
+            if (wallMs() - lastContactMs.load() > LINK_TIMEOUT_MS) return false;
+            continue;
+        }
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return false;
+        lastContactMs = wallMs();
+        in.append(buf, (size_t)n);
+
+        bool queued = false;
+        size_t pos = 0;
+        for (;;) {
+            size_t frame = rpcFrameSize(in.data() + pos, in.size() - pos);
+            if (frame == (size_t)-1) return false;
+            if (frame == 0) break;
+            RpcReader r(in.data() + pos, frame);
+            if (r.op() == REPL_HEARTBEAT) {
+                primarySeq = r.i64();
+            }
+            else {
+                partial.append(in, pos, frame);
+                if (r.op() == REPL_COMMIT) {
+                    primarySeq = r.i64();
+                    lock_guard<mutex> guard(lock);
+                    inbox += partial;
+                    partial.clear();
+                    queued = true;
+                }
+            }
+            pos += frame;
+        }
+        in.erase(0, pos);
+        if (queued) {
+            unsigned long long one = 1;
+            if (write(wakeFd, &one, sizeof(one)) < 0) {}
+        }
+    }
+    return true;
+}
+
+#else
+
+ReplicationPublisher::~ReplicationPublisher() {}
+
+bool ReplicationPublisher::start() {
+    cerr << "swiftex: replication needs Linux; not available on this platform\n";
+    return false;
+}
+
+void ReplicationPublisher::wake() {}
+
+ReplicationFollower::~ReplicationFollower() {}
+
+void ReplicationFollower::start() {
+    cerr << "swiftex: replication needs Linux; not available on this platform\n";
+}
+
+#endif
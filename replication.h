@@ -0,0 +1,166 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "parcel.h"
+#include "rpc.h"
+
+class LogisticsEngine;
+
+// Primary -> standby replication.
+//
+// The primary ships row images: after each engine action, every parcel it
+// touched is sent whole (fields, route and timeline), along with removals,
+// archive moves and new road closures, and the lot is sealed by a COMMIT
+// carrying a sequence number and the primary's clock. A standby applies a
+// commit all at once, so its readers never see half a batch dispatch.
+// A standby that connects first gets a snapshot of every hot parcel, sealed
+// the same way, then the stream from there on.
+//
+// Frames use the RPC framing (see rpc.h) with these ops; the tag is unused.
+enum ReplOp {
+    REPL_SNAPSHOT = 1,      //                               (drop the replica)
+    REPL_ROW = 2,           // parcel row image (see writeRow)
+    REPL_REMOVE = 3,        // str id                        (left this engine)
+    REPL_ARCHIVE = 4,       // str id                        (moved to the cold tier)
+    REPL_CLOSE = 5,         // u32 edge                      (road closed)
+    REPL_COMMIT = 6,        // i64 seq, i64 primary ms
+    REPL_HEARTBEAT = 7      // i64 seq, i64 primary ms
+};
+
+// Replication health, for the API and the console
+struct ReplicationStatus {
+    bool primary;
+    bool connected;          // standby: attached to the primary
+    int followers;           // primary: standbys attached
+    long long seq;           // primary: newest commit; standby: newest applied
+    long long primarySeq;    // standby: newest commit the primary announced
+    long long lagMs;         // standby: how far behind the primary's clock the
+                             // replica is (0 when caught up)
+    long long applyDelayMs;  // standby: commit-to-apply time of the last commit
+    long long sinceContactMs;// standby: time since anything arrived
+    long long backlogBytes;  // primary: largest unsent stream; standby: unapplied
+    long long promoteMs;     // time the last promotion took (-1: never)
+};
+
+// Primary side. The engine calls the encoding methods on its own thread; a
+// background thread accepts standbys and writes the stream out.
+class ReplicationPublisher {
+private:
+    static const int MAX_FOLLOWERS = 8;
+
+    struct Follower {
+        int fd;
+        std::string out;
+        size_t sent;
+        bool live;               // has had its snapshot
+    };
+
+    std::string address;
+    int listenFd;
+    int wakeFd;
+
+    // Engine-thread side: frames of the open batch and of a snapshot
+    OutBuffer batch;
+    RpcWriter batchWriter;
+    OutBuffer snapshot;
+    RpcWriter snapshotWriter;
+    bool snapshotBuilt;
+    long long lastSeq;           // engine thread's copy of seq
+
+    // Shared with the sender thread, guarded by lock
+    std::mutex lock;
+    Follower followers[MAX_FOLLOWERS];
+    int followerCount;
+    long long seq;
+    std::atomic<int> joining;    // attached standbys still owed a snapshot
+    std::atomic<bool> stopping;
+    std::thread sender;
+
+    void senderLoop();
+    void acceptFollowers();
+    void dropFollower(int i);
+    void wake();
+
+public:
+    ReplicationPublisher(const std::string& listenAddress);
+    ~ReplicationPublisher();
+    ReplicationPublisher(const ReplicationPublisher&) = delete;
+    ReplicationPublisher& operator=(const ReplicationPublisher&) = delete;
+
+    // Opens the listening socket and starts the sender; false if the
+    // address cannot be used
+    bool start();
+    const std::string& getAddress() const { return address; }
+
+    // Engine thread: add to the open batch, then commit() it
+    void upsert(const Parcel& p);
+    void remove(std::string_view id);
+    void archive(std::string_view id);
+    void closeRoad(int edgeId);
+    // A standby is waiting; build one with beginSnapshot() and
+    // snapshotRow() / snapshotClosure() before the next commit()
+    bool wantsSnapshot() const { return joining.load(std::memory_order_relaxed) > 0; }
+    void beginSnapshot();
+    void snapshotRow(const Parcel& p);
+    void snapshotClosure(int edgeId);
+    // Seals the batch and hands it (or the snapshot, to new standbys) to
+    // the sender; nothing happens if there is nothing to send
+    void commit();
+
+    ReplicationStatus status();
+};
+
+// Standby side. A background thread keeps a connection to the primary and
+// queues whole commits; the engine's own thread applies them with
+// applyPending(), so the engine is never shared between threads.
+class ReplicationFollower {
+private:
+    std::string address;
+    int wakeFd;
+    std::thread receiver;
+    std::atomic<bool> stopping;
+    std::atomic<int> socketFd;
+    std::atomic<bool> connected;
+    std::atomic<long long> primarySeq;
+    std::atomic<long long> lastContactMs;
+
+    // Complete commits waiting to be applied, guarded by lock
+    std::mutex lock;
+    std::string inbox;
+
+    // Engine thread only
+    std::string applying;
+    long long appliedSeq;
+    long long appliedCommitMs;   // primary clock of the newest applied commit
+    long long applyDelayMs;
+    long long promoteMs;
+    bool promoted;
+
+    void receiverLoop();
+    bool receive(int fd);
+
+public:
+    ReplicationFollower(const std::string& primaryAddress);
+    ~ReplicationFollower();
+    ReplicationFollower(const ReplicationFollower&) = delete;
+    ReplicationFollower& operator=(const ReplicationFollower&) = delete;
+
+    void start();
+    // Readable whenever commits are waiting (for the caller's event loop)
+    int notifyFd() const { return wakeFd; }
+    // Applies every queued commit to the replica; returns how many
+    int applyPending(LogisticsEngine& engine);
+    // Cuts the link, applies what already arrived and makes the engine
+    // writable. Returns the milliseconds it took.
+    long long promote(LogisticsEngine& engine);
+    bool isPromoted() const { return promoted; }
+
+    ReplicationStatus status();
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+#include <utility>
+
+// FIFO queue in one contiguous ring of slots (capacity a power of two, so
+// positions wrap with a mask). Slots are reused as the queue cycles: once
+// it has grown to its working size, enqueue / dequeue allocate nothing,
+// and moving a std::string through it hands its buffer along.
+// Single-threaded; see SpscQueue / MpmcQueue for cross-thread use.
+template <typename T>
+class RingQueue {
+private:
+    T* slots;
+    int mask;
+    int head;       // next slot to read
+    int count;
+
+    void grow() {
+        int capacity = (mask + 1) * 2;
+        T* bigger = new T[capacity];
+        for (int i = 0; i < count; i++) bigger[i] = std::move(slots[(head + i) & mask]);
+        delete[] slots;
+        slots = bigger;
+        mask = capacity - 1;
+        head = 0;
+    }
+
+public:
+    explicit RingQueue(int initialCapacity = 8) : head(0), count(0) {
+        int capacity = 2;
+        while (capacity < initialCapacity) capacity <<= 1;
+        slots = new T[capacity];
+        mask = capacity - 1;
+    }
+    ~RingQueue() { delete[] slots; }
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    void enqueue(const T& val) {
+        if (count > mask) grow();
+        slots[(head + count) & mask] = val;
+        count++;
+    }
+    void enqueue(T&& val) {
+        if (count > mask) grow();
+        slots[(head + count) & mask] = std::move(val);
+        count++;
+    }
+    // Empty queue: returns a default value
+    T dequeue() {
+        if (count == 0) return T();
+        T val = std::move(slots[head]);
+        head = (head + 1) & mask;
+        count--;
+        return val;
+    }
+    // Oldest element; the queue must not be empty
+    T& front() { return slots[head]; }
+    // Sends the front element to the back (round-robin). With every slot
+    // in use that is just the read position moving on.
+    void rotate() {
+        if (count == 0) return;
+        if (count <= mask) slots[(head + count) & mask] = std::move(slots[head]);
+        head = (head + 1) & mask;
+    }
+
+    bool isEmpty() const { return count == 0; }
+    int size() const { return count; }
+};
+
+#endif
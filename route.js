@@ -30,6 +30,7 @@ const marker = document.getElementById("parcelMarker");
 const statusLabel = document.getElementById("routeStatus");
 
 let simulationInterval = null;
+let liveFeed = null;
 
 // UI Toggles
 function toggleMode() {
@@ -157,6 +158,13 @@ function startIdSimulation() {
 
     statusLabel.innerHTML = `Found Parcel <b>${id}</b>. tracking from ${parcel.sender} to ${parcel.receiver}...`;
 
+    // Live feed for this parcel when served by the engine
+    if (liveFeed) liveFeed.close();
+    liveFeed = SwiftExApi.watch({ id: id }, function (delta) {
+        const eta = delta.etaSeconds > 0 ? ` &middot; ETA ${delta.etaSeconds}s` : "";
+        statusLabel.innerHTML = `<b>${delta.id}</b>: ${delta.statusText} &mdash; ${delta.event} (${delta.location})${eta}`;
+    });
+
     // small delay to read status
     setTimeout(() => {
         runSimulation(parcel.sender, parcel.receiver);
@@ -0,0 +1,332 @@
+#include "routeanalytics.h"
+#include "mapgraph.h"
+#include "filesync.h"
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// =====================================================
+// Route Codes (delta-encoded city ids)
+// =====================================================
+static const char CODE_END = '0';    // '0' + 0..31: last five bits of a number
+static const char CODE_MORE = 'P';   // 'P' + 0..31: five bits, more follow
+
+static void putNumber(string& out, unsigned int v) {
+    while (v >= 32) {
+        out += (char)(CODE_MORE + (v & 31));
+        v >>= 5;
+    }
+    out += (char)(CODE_END + v);
+}
+
+static bool getNumber(string_view code, size_t& at, unsigned int& v) {
+    v = 0;
+    for (int shift = 0; at < code.size() && shift < 32; shift += 5) {
+        char c = code[at++];
+        if (c >= CODE_MORE && c < CODE_MORE + 32) {
+            v |= (unsigned int)(c - CODE_MORE) << shift;
+        }
+        else if (c >= CODE_END && c < CODE_END + 32) {
+            v |= (unsigned int)(c - CODE_END) << shift;
+            return true;
+        }
+        else {
+            return false;
+        }
+    }
+    return false;
+}
+
+void encodeRoute(const IntArrayList& cities, string& out) {
+    out.clear();
+    for (int i = 0; i < cities.size(); i++) {
+        if (i == 0) {
+            putNumber(out, (unsigned int)cities[0]);
+            continue;
+        }
+        int d = cities[i] - cities[i - 1];
+        putNumber(out, ((unsigned int)d << 1) ^ (unsigned int)(d >> 31));
+    }
+}
+
+bool decodeRoute(string_view code, IntArrayList& cities) {
+    size_t at = 0;
+    int city = 0;
+    while (at < code.size()) {
+        unsigned int v;
+        if (!getNumber(code, at, v)) return false;
+        if (cities.size() == 0) city = (int)v;
+        else city += (int)(v >> 1) ^ -(int)(v & 1);
+        cities.add(city);
+    }
+    return true;
+}
+
+// =====================================================
+// RouteAnalytics Implementation (running totals)
+// =====================================================
+RouteAnalytics::RouteAnalytics()
+    : roads(nullptr), roadCapacity(0), routes(nullptr), routeUsed(nullptr), routeCapacity(0), routeCount(0) {}
+
+RouteAnalytics::~RouteAnalytics() {
+    delete[] roads;
+    delete[] routes;
+    delete[] routeUsed;
+}
+
+void RouteAnalytics::ensureRoad(int edgeId) {
+    if (edgeId < roadCapacity) return;
+    int newCapacity = roadCapacity > 0 ? roadCapacity : 64;
+    while (newCapacity <= edgeId) newCapacity *= 2;
+
+    RoadStats* bigger = new RoadStats[newCapacity];
+    for (int i = 0; i < newCapacity; i++)
+        bigger[i] = (i < roadCapacity) ? roads[i] : RoadStats{ 0, 0, 0 };
+    delete[] roads;
+    roads = bigger;
+    roadCapacity = newCapacity;
+}
+
+// FNV-1a over the code
+static unsigned int hashCode(string_view code) {
+    unsigned int h = 2166136261u;
+    for (char c : code) {
+        h ^= (unsigned char)c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+int RouteAnalytics::findRoute(string_view code) const {
+    if (routeCapacity == 0) return -1;
+    int i = (int)(hashCode(code) & (unsigned int)(routeCapacity - 1));
+    while (routeUsed[i]) {
+        if (routes[i].code == code) return i;
+        i = (i + 1) & (routeCapacity - 1);
+    }
+    return -1;
+}
+
+// Power-of-two table kept at most half full
+void RouteAnalytics::growRoutes() {
+    int oldCapacity = routeCapacity;
+    RouteStats* oldRoutes = routes;
+    bool* oldUsed = routeUsed;
+
+    routeCapacity = oldCapacity > 0 ? oldCapacity * 2 : 64;
+    routes = new RouteStats[routeCapacity];
+    routeUsed = new bool[routeCapacity];
+    for (int i = 0; i < routeCapacity; i++) routeUsed[i] = false;
+
+    for (int k = 0; k < oldCapacity; k++) {
+        if (!oldUsed[k]) continue;
+        int i = (int)(hashCode(oldRoutes[k].code) & (unsigned int)(routeCapacity - 1));
+        while (routeUsed[i]) i = (i + 1) & (routeCapacity - 1);
+        routes[i] = move(oldRoutes[k]);
+        routeUsed[i] = true;
+    }
+    delete[] oldRoutes;
+    delete[] oldUsed;
+}
+
+RouteStats& RouteAnalytics::routeFor(string_view code) {
+    int found = findRoute(code);
+    if (found >= 0) return routes[found];
+
+    if ((routeCount + 1) * 2 > routeCapacity) growRoutes();
+    int i = (int)(hashCode(code) & (unsigned int)(routeCapacity - 1));
+    while (routeUsed[i]) i = (i + 1) & (routeCapacity - 1);
+    routeUsed[i] = true;
+    routeCount++;
+    RouteStats& r = routes[i];
+    r.code.assign(code.data(), code.size());
+    r.shipments = r.arrived = r.lost = r.blocked = 0;
+    r.roadSeconds = 0;
+    return r;
+}
+
+void RouteAnalytics::countRoads(MapGraph& map, string_view code, int delta) {
+    IntArrayList cities;
+    decodeRoute(code, cities);
+    for (int i = 0; i + 1 < cities.size(); i++) {
+        int e = map.findEdgeId(cities[i], cities[i + 1]);
+        if (e < 0) continue;
+        ensureRoad(e);
+        roads[e].shipments += delta;
+    }
+}
+
+void RouteAnalytics::routeTaken(MapGraph& map, string_view code) {
+    if (code.empty()) return;
+    routeFor(code).shipments++;
+    countRoads(map, code, 1);
+}
+
+void RouteAnalytics::routeDropped(MapGraph& map, string_view code) {
+    if (code.empty()) return;
+    routeFor(code).shipments--;
+    countRoads(map, code, -1);
+}
+
+void RouteAnalytics::roadClosed(int edgeId) {
+    if (edgeId < 0) return;
+    ensureRoad(edgeId);
+    roads[edgeId].closures++;
+}
+
+void RouteAnalytics::routeBlocked(string_view code, int edgeId) {
+    if (!code.empty()) routeFor(code).blocked++;
+    if (edgeId < 0) return;
+    ensureRoad(edgeId);
+    roads[edgeId].disrupted++;
+}
+
+void RouteAnalytics::routeFinished(string_view code, bool arrived, long long seconds) {
+    if (code.empty()) return;
+    RouteStats& r = routeFor(code);
+    if (arrived) {
+        r.arrived++;
+        r.roadSeconds += seconds;
+    }
+    else {
+        r.lost++;
+    }
+}
+
+RoadStats RouteAnalytics::road(int edgeId) const {
+    if (edgeId < 0 || edgeId >= roadCapacity) return RoadStats{ 0, 0, 0 };
+    return roads[edgeId];
+}
+
+const RouteStats* RouteAnalytics::route(string_view code) const {
+    int i = findRoute(code);
+    return i >= 0 ? &routes[i] : nullptr;
+}
+
+// The two directions of a road are ids 2r and 2r+1. The +1 keeps a single
+// unlucky parcel from pricing a road at certain closure.
+double RouteAnalytics::closureShare(int edgeId) const {
+    if (edgeId < 0) return 0;
+    RoadStats a = road(edgeId), b = road(edgeId ^ 1);
+    int disrupted = a.disrupted + b.disrupted;
+    if (disrupted == 0) return 0;
+    return (double)disrupted / (a.shipments + b.shipments + disrupted + 1);
+}
+
+// Insertion into a short sorted list; maxOut is a screenful
+int RouteAnalytics::busiestRoads(int* out, int maxOut) const {
+    int n = 0;
+    for (int e = 0; e < roadCapacity; e++) {
+        const RoadStats& r = roads[e];
+        if (r.shipments <= 0 && r.closures == 0) continue;
+        int i = n < maxOut ? n++ : maxOut;
+        while (i > 0 && roads[out[i - 1]].shipments < r.shipments) {
+            if (i < maxOut) out[i] = out[i - 1];
+            i--;
+        }
+        if (i < maxOut) out[i] = e;
+    }
+    return n;
+}
+
+int RouteAnalytics::busiestRoutes(const RouteStats** out, int maxOut) const {
+    int n = 0;
+    for (int k = 0; k < routeCapacity; k++) {
+        if (!routeUsed[k]) continue;
+        const RouteStats* r = &routes[k];
+        int volume = r->shipments + r->blocked;
+        int i = n < maxOut ? n++ : maxOut;
+        while (i > 0 && out[i - 1]->shipments + out[i - 1]->blocked < volume) {
+            if (i < maxOut) out[i] = out[i - 1];
+            i--;
+        }
+        if (i < maxOut) out[i] = r;
+    }
+    return n;
+}
+
+// =====================================================
+// RouteAnalytics Implementation (totals file)
+// =====================================================
+bool RouteAnalytics::save(MapGraph& map, const string& path) const {
+    string out;
+    char line[96];
+    for (int e = 0; e < roadCapacity && e < map.edgeCount; e++) {
+        const RoadStats& r = roads[e];
+        if (r.shipments == 0 && r.closures == 0 && r.disrupted == 0) continue;
+        snprintf(line, sizeof(line), "road,%d,%d,%d,%d,%d\n", map.edgeSource(e), map.getEdge(e).dest,
+                 r.shipments, r.closures, r.disrupted);
+        out += line;
+    }
+    for (int k = 0; k < routeCapacity; k++) {
+        if (!routeUsed[k]) continue;
+        const RouteStats& r = routes[k];
+        out += "route,";
+        out += r.code;
+        snprintf(line, sizeof(line), ",%d,%d,%d,%lld,%d\n", r.shipments, r.arrived, r.lost, r.roadSeconds, r.blocked);
+        out += line;
+    }
+
+    error_code ec;
+    fs::path parent = fs::path(path).parent_path();
+    if (!parent.empty()) fs::create_directories(parent, ec);
+    string temp = path + ".tmp";
+    {
+        ofstream f(temp, ios::binary | ios::trunc);
+        if (!f.is_open()) return false;
+        f.write(out.data(), (streamsize)out.size());
+        f.flush();
+        if (!f) return false;
+    }
+    if (!syncFile(temp)) return false;
+    fs::rename(temp, path, ec);
+    return !ec && syncDirectory(parent.empty() ? string(".") : parent.string());
+}
+
+// A field as a number (0 if it is not one); fields are short
+static long long fieldValue(string_view f) {
+    char buf[32];
+    size_t n = f.size() < sizeof(buf) - 1 ? f.size() : sizeof(buf) - 1;
+    if (n > 0) memcpy(buf, f.data(), n);
+    buf[n] = '\0';
+    return strtoll(buf, nullptr, 10);
+}
+
+bool RouteAnalytics::load(MapGraph& map, const string& path) {
+    ifstream f(path, ios::binary);
+    if (!f.is_open()) return false;
+    string text;
+    while (getline(f, text)) {
+        string_view line = text;
+        string_view field[7];
+        int n = 0;
+        while (n < 7) {
+            size_t comma = line.find(',');
+            field[n++] = line.substr(0, comma);
+            if (comma == string_view::npos) break;
+            line.remove_prefix(comma + 1);
+        }
+        if (n == 6 && field[0] == "road") {
+            int e = map.findEdgeId((int)fieldValue(field[1]), (int)fieldValue(field[2]));
+            if (e < 0) continue;
+            ensureRoad(e);
+            roads[e].shipments += (int)fieldValue(field[3]);
+            roads[e].closures += (int)fieldValue(field[4]);
+            roads[e].disrupted += (int)fieldValue(field[5]);
+        }
+        else if (n == 7 && field[0] == "route" && !field[1].empty()) {
+            RouteStats& r = routeFor(field[1]);
+            r.shipments += (int)fieldValue(field[2]);
+            r.arrived += (int)fieldValue(field[3]);
+            r.lost += (int)fieldValue(field[4]);
+            r.roadSeconds += fieldValue(field[5]);
+            r.blocked += (int)fieldValue(field[6]);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef ROUTEANALYTICS_H
+#define ROUTEANALYTICS_H
+
+#include <string>
+#include <string_view>
+#include "datastructures.h"
+
+class MapGraph;
+
+// A route as the city ids it passes, delta-encoded: the first id, then each
+// hop as the zigzag difference from the city before. Numbers are written
+// five bits to a character ('0'..'O' ends a number, 'P'..'o' carries on),
+// so a code is plain text with no commas or line breaks and goes into the
+// snapshot records as it is. A hop of up to 15 ids is one character, up to
+// 511 two; the edge id array it summarizes takes four bytes a road.
+void encodeRoute(const IntArrayList& cities, std::string& out);
+// False if the code is malformed; cities holds what decoded before that
+bool decodeRoute(std::string_view code, IntArrayList& cities);
+
+// Totals for one directed road (see Edge)
+struct RoadStats {
+    int shipments;      // routes over it, as dispatched or rerouted
+    int closures;       // times it was closed
+    int disrupted;      // parcels a closure turned off it
+};
+
+// Totals for one exact route, keyed by its code
+struct RouteStats {
+    std::string code;
+    int shipments;              // parcels on it (a reroute moves them off)
+    int arrived;                // reached the end of the route
+    int lost;                   // went missing on the road
+    long long roadSeconds;      // dispatch to arrival, summed over arrived
+    int blocked;                // parcels a closure forced off it
+};
+
+// Road and route analytics kept up to date as things happen - dispatch,
+// reroute, undo, arrival, closure - so every query reads totals and none
+// walks the parcels. Dropping a route takes back exactly what taking it
+// added; closures and arrivals are history and stay counted.
+class RouteAnalytics {
+private:
+    RoadStats* roads;           // by directed edge id, grown on demand
+    int roadCapacity;
+    RouteStats* routes;         // open addressing on the code, never shrinks
+    bool* routeUsed;
+    int routeCapacity;
+    int routeCount;
+
+    void ensureRoad(int edgeId);
+    int findRoute(std::string_view code) const;
+    RouteStats& routeFor(std::string_view code);
+    void growRoutes();
+    void countRoads(MapGraph& map, std::string_view code, int delta);
+
+public:
+    RouteAnalytics();
+    ~RouteAnalytics();
+    RouteAnalytics(const RouteAnalytics&) = delete;
+    RouteAnalytics& operator=(const RouteAnalytics&) = delete;
+
+    void routeTaken(MapGraph& map, std::string_view code);
+    void routeDropped(MapGraph& map, std::string_view code);
+    void roadClosed(int edgeId);
+    // A closure of edgeId forced a parcel off the route it was on
+    void routeBlocked(std::string_view code, int edgeId);
+    // A parcel's road leg ended: arrived after seconds on the road, or lost
+    void routeFinished(std::string_view code, bool arrived, long long seconds);
+
+    // Zeros for a road nothing has used yet
+    RoadStats road(int edgeId) const;
+    // nullptr for a route never taken
+    const RouteStats* route(std::string_view code) const;
+    int routesKnown() const { return routeCount; }
+    // Share of the parcels planned over this road, either direction, that a
+    // closure turned back; closing one direction says the road is prone
+    double closureShare(int edgeId) const;
+    // Most-used roads / routes first, up to maxOut; returns how many
+    int busiestRoads(int* out, int maxOut) const;
+    int busiestRoutes(const RouteStats** out, int maxOut) const;
+
+    // The totals as text lines, roads by the city ids at their two ends so
+    // a map built again finds them under whatever edge ids it gives them:
+    //   road,<from>,<to>,<shipments>,<closures>,<disrupted>
+    //   route,<code>,<shipments>,<arrived>,<lost>,<road seconds>,<blocked>
+    // save writes a temp file and renames it over the old one; false if
+    // that failed. load adds the file to what is held, skipping roads the
+    // map does not have; false if there was no file to read.
+    bool save(MapGraph& map, const std::string& path) const;
+    bool load(MapGraph& map, const std::string& path);
+};
+
+#endif
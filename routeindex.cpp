@@ -0,0 +1,68 @@
+#include "routeindex.h"
+
+using namespace std;
+
+// =====================================================
+// RouteIndex Implementation (Edge -> Parcel Buckets)
+// =====================================================
+RouteIndex::RouteIndex() : buckets(nullptr), capacity(0) {}
+
+RouteIndex::~RouteIndex() {
+    for (int i = 0; i < capacity; i++)
+        delete buckets[i];
+    delete[] buckets;
+}
+
+void RouteIndex::ensure(int edgeId) {
+    if (edgeId < capacity) return;
+    int newCapacity = capacity > 0 ? capacity : 32;
+    while (newCapacity <= edgeId) newCapacity *= 2;
+
+    ParcelArrayList** newBuckets = new ParcelArrayList * [newCapacity];
+    for (int i = 0; i < newCapacity; i++)
+        newBuckets[i] = (i < capacity) ? buckets[i] : nullptr;
+    delete[] buckets;
+    buckets = newBuckets;
+    capacity = newCapacity;
+}
+
+void RouteIndex::add(Parcel* p) {
+    for (int i = 0; i < p->routeLength; i++) {
+        int e = p->routeEdges[i];
+        if (e < 0) continue;
+        ensure(e);
+        if (!buckets[e]) buckets[e] = new ParcelArrayList();
+        buckets[e]->add(p);
+    }
+}
+
+// Swap-with-last removal; buckets are unordered
+void RouteIndex::remove(Parcel* p) {
+    for (int i = 0; i < p->routeLength; i++) {
+        int e = p->routeEdges[i];
+        if (e < 0 || e >= capacity || !buckets[e]) continue;
+        ParcelArrayList* b = buckets[e];
+        for (int k = 0; k < b->size(); k++) {
+            if (b->get(k) == p) {
+                b->swap(k, b->size() - 1);
+                b->removeLast();
+                break;
+            }
+        }
+    }
+}
+
+// Copies the users out so callers can reroute (and re-index) while iterating
+int RouteIndex::usersOf(int edgeId, Parcel** out, int maxOut) {
+    if (edgeId < 0 || edgeId >= capacity || !buckets[edgeId]) return 0;
+    ParcelArrayList* b = buckets[edgeId];
+    int n = 0;
+    for (int k = 0; k < b->size() && n < maxOut; k++)
+        out[n++] = b->get(k);
+    return n;
+}
+
+int RouteIndex::countOf(int edgeId) const {
+    if (edgeId < 0 || edgeId >= capacity || !buckets[edgeId]) return 0;
+    return buckets[edgeId]->size();
+}
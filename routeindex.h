@@ -0,0 +1,22 @@
+#ifndef ROUTEINDEX_H
+#define ROUTEINDEX_H
+
+#include "datastructures.h"
+
+// Reverse index: directed edge id -> parcels whose stored route uses it.
+// Buckets are created lazily, so untouched roads cost one null pointer.
+class RouteIndex {
+private:
+    ParcelArrayList** buckets;
+    int capacity;
+    void ensure(int edgeId);
+public:
+    RouteIndex();
+    ~RouteIndex();
+    void add(Parcel* p);
+    void remove(Parcel* p);
+    int usersOf(int edgeId, Parcel** out, int maxOut);
+    int countOf(int edgeId) const;
+};
+
+#endif
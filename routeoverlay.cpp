@@ -0,0 +1,507 @@
+#include "routeoverlay.h"
+#include "mapgraph.h"
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+static const double DEG = 3.14159265358979323846 / 180.0;
+
+static double msSince(chrono::steady_clock::time_point t) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t).count();
+}
+
+// Shell sort of cities by key; key[i] belongs to arr[i] and moves with it
+static void sortByKey(int* arr, double* key, int n) {
+    for (int gap = n / 2; gap > 0; gap /= 2) {
+        for (int i = gap; i < n; i++) {
+            int city = arr[i];
+            double k = key[i];
+            int j = i;
+            for (; j >= gap && key[j - gap] > k; j -= gap) {
+                arr[j] = arr[j - gap];
+                key[j] = key[j - gap];
+            }
+            arr[j] = city;
+            key[j] = k;
+        }
+    }
+}
+
+// Breadth-first order of a cell's cities over its own roads, so that
+// cutting the order in two keeps each half mostly in one piece
+static void bfsRank(const MapGraph& g, const int* cellOf, int cell, const int* arr, int len, int* rank, int* queue) {
+    for (int i = 0; i < len; i++) rank[arr[i]] = -1;
+    int ranked = 0;
+    for (int i = 0; i < len; i++) {
+        if (rank[arr[i]] != -1) continue;
+        int head = 0, tail = 0;
+        queue[tail++] = arr[i];
+        rank[arr[i]] = ranked++;
+        while (head < tail) {
+            int u = queue[head++];
+            for (const Edge& e : g.cities[u].edges) {
+                if (cellOf[e.dest] != cell || rank[e.dest] != -1) continue;
+                rank[e.dest] = ranked++;
+                queue[tail++] = e.dest;
+            }
+        }
+    }
+}
+
+// Halves arr across its longer side (or its BFS order) until every piece
+// has at most target cities; each piece becomes a new cell
+static void bisect(const MapGraph& g, int* arr, int len, int target, bool located, const int* rank,
+                   double* key, int* cellOut, int& nextCell) {
+    if (len <= target) {
+        for (int i = 0; i < len; i++) cellOut[arr[i]] = nextCell;
+        nextCell++;
+        return;
+    }
+    if (located) {
+        double latLo = 90, latHi = -90, lonLo = 180, lonHi = -180, latSum = 0;
+        for (int i = 0; i < len; i++) {
+            const CityNode& c = g.cities[arr[i]];
+            if (c.lat < latLo) latLo = c.lat;
+            if (c.lat > latHi) latHi = c.lat;
+            if (c.lon < lonLo) lonLo = c.lon;
+            if (c.lon > lonHi) lonHi = c.lon;
+            latSum += c.lat;
+        }
+        // A degree of longitude shrinks towards the poles
+        bool byLat = latHi - latLo >= (lonHi - lonLo) * cos(latSum / len * DEG);
+        for (int i = 0; i < len; i++)
+            key[i] = byLat ? g.cities[arr[i]].lat : g.cities[arr[i]].lon;
+    }
+    else {
+        for (int i = 0; i < len; i++) key[i] = rank[arr[i]];
+    }
+    sortByKey(arr, key, len);
+    int half = len / 2;
+    bisect(g, arr, half, target, located, rank, key, cellOut, nextCell);
+    bisect(g, arr + half, len - half, target, located, rank, key + half, cellOut, nextCell);
+}
+
+// =====================================================
+// RouteOverlay Implementation (Partition and Customization)
+// =====================================================
+RouteOverlay::RouteOverlay()
+    : levelTotal(0), cityCount(0), stale(true), dist(nullptr), via(nullptr), viaLevel(nullptr),
+      touched(nullptr), touchedCount(0), heap(nullptr), heapSize(0), heapCapacity(0),
+      buildMs(0), customizeMs(0), customizedCells(0) {}
+
+RouteOverlay::~RouteOverlay() {
+    clear();
+}
+
+void RouteOverlay::clear() {
+    for (int l = 0; l < levelTotal; l++) {
+        Level& L = levels[l];
+        delete[] L.cellOf;
+        delete[] L.boundaryStart;
+        delete[] L.boundary;
+        delete[] L.boundarySlot;
+        delete[] L.cliqueStart;
+        delete[] L.clique;
+    }
+    levelTotal = 0;
+    delete[] dist;
+    delete[] via;
+    delete[] viaLevel;
+    delete[] touched;
+    delete[] heap;
+    dist = nullptr;
+    via = nullptr;
+    viaLevel = nullptr;
+    touched = nullptr;
+    heap = nullptr;
+    touchedCount = 0;
+    heapSize = 0;
+    heapCapacity = 0;
+    cityCount = 0;
+}
+
+void RouteOverlay::invalidate() {
+    stale = true;
+}
+
+// Cuts every cell of one level into pieces of at most max(LEAF_CELL_CITIES,
+// size / SPLIT_FANOUT) cities; returns city -> piece
+int* RouteOverlay::splitCells(const MapGraph& g, const int* cellOf, int cellCount, int& nextCount) {
+    int n = cityCount;
+    // Cities grouped by cell
+    int* start = new int[cellCount + 1]();
+    for (int v = 0; v < n; v++) start[cellOf[v] + 1]++;
+    for (int c = 0; c < cellCount; c++) start[c + 1] += start[c];
+    int* fill = new int[cellCount];
+    for (int c = 0; c < cellCount; c++) fill[c] = start[c];
+    int* order = new int[n];
+    for (int v = 0; v < n; v++) order[fill[cellOf[v]]++] = v;
+
+    int* next = new int[n];
+    double* key = new double[n];
+    int* rank = new int[n];
+    int* queue = new int[n];
+    nextCount = 0;
+    for (int c = 0; c < cellCount; c++) {
+        int* arr = order + start[c];
+        int len = start[c + 1] - start[c];
+        if (len == 0) continue;
+        int target = (len + SPLIT_FANOUT - 1) / SPLIT_FANOUT;
+        if (target < LEAF_CELL_CITIES) target = LEAF_CELL_CITIES;
+        bool located = true;
+        for (int i = 0; i < len && located; i++)
+            located = !std::isnan(g.cities[arr[i]].lat) && !std::isnan(g.cities[arr[i]].lon);
+        if (!located) bfsRank(g, cellOf, c, arr, len, rank, queue);
+        bisect(g, arr, len, target, located, rank, key, next, nextCount);
+    }
+
+    delete[] start;
+    delete[] fill;
+    delete[] order;
+    delete[] key;
+    delete[] rank;
+    delete[] queue;
+    return next;
+}
+
+void RouteOverlay::build(const MapGraph& g) {
+    auto began = chrono::steady_clock::now();
+    clear();
+    stale = false;
+    cityCount = g.cityCount;
+    int n = cityCount;
+    if (n == 0) return;
+
+    dist = new int[n];
+    via = new int[n];
+    viaLevel = new signed char[n];
+    touched = new int[n];
+    for (int v = 0; v < n; v++) dist[v] = DIST_INFINITY;
+    heapCapacity = 64;
+    heap = new MinHeapItem<int>[heapCapacity];
+
+    // Top level: one cell per zone (a map has a handful)
+    int* zoneCell = new int[n];
+    const string** zoneNames = new const string*[n];
+    int zoneCount = 0;
+    for (int v = 0; v < n; v++) {
+        int z = 0;
+        while (z < zoneCount && *zoneNames[z] != g.cities[v].zone) z++;
+        if (z == zoneCount) zoneNames[zoneCount++] = &g.cities[v].zone;
+        zoneCell[v] = z;
+    }
+    delete[] zoneNames;
+
+    // Then cut down until the cells are small, coarsest level first
+    int* topDown[MAX_LEVELS];
+    int counts[MAX_LEVELS];
+    int made = 0;
+    int* current = zoneCell;
+    int currentCount = zoneCount;
+    // A single zone is no partition; it is only the place to start cutting
+    if (zoneCount >= 2) {
+        topDown[made] = current;
+        counts[made++] = currentCount;
+    }
+    while (made < MAX_LEVELS) {
+        int* size = new int[currentCount]();
+        int largest = 0;
+        for (int v = 0; v < n; v++)
+            if (++size[current[v]] > largest) largest = size[current[v]];
+        delete[] size;
+        if (largest <= LEAF_CELL_CITIES) break;
+
+        int nextCount;
+        int* next = splitCells(g, current, currentCount, nextCount);
+        if (made == 0) delete[] current;
+        topDown[made] = next;
+        counts[made++] = nextCount;
+        current = next;
+        currentCount = nextCount;
+    }
+    if (made == 0) delete[] current;
+
+    levelTotal = made;
+    for (int l = 0; l < levelTotal; l++) {
+        Level& L = levels[l];
+        L.cellOf = topDown[made - 1 - l];
+        L.cellCount = counts[made - 1 - l];
+    }
+
+    for (int l = 0; l < levelTotal; l++) {
+        Level& L = levels[l];
+        int cells = L.cellCount;
+
+        // Boundary cities: any road out of the cell, open or not, so a
+        // closure never changes the shape of a clique
+        L.boundarySlot = new int[n];
+        L.boundaryStart = new int[cells + 1]();
+        for (int v = 0; v < n; v++) {
+            L.boundarySlot[v] = -1;
+            for (const Edge& e : g.cities[v].edges) {
+                if (L.cellOf[e.dest] != L.cellOf[v]) {
+                    L.boundarySlot[v] = 0;
+                    L.boundaryStart[L.cellOf[v] + 1]++;
+                    break;
+                }
+            }
+        }
+        for (int c = 0; c < cells; c++) L.boundaryStart[c + 1] += L.boundaryStart[c];
+        L.boundary = new int[L.boundaryStart[cells] + 1];
+        int* fill = new int[cells];
+        for (int c = 0; c < cells; c++) fill[c] = L.boundaryStart[c];
+        for (int v = 0; v < n; v++) {
+            if (L.boundarySlot[v] < 0) continue;
+            int c = L.cellOf[v];
+            L.boundarySlot[v] = fill[c] - L.boundaryStart[c];
+            L.boundary[fill[c]++] = v;
+        }
+        delete[] fill;
+
+        L.cliqueStart = new int[cells + 1];
+        L.cliqueStart[0] = 0;
+        for (int c = 0; c < cells; c++) {
+            int k = L.boundaryStart[c + 1] - L.boundaryStart[c];
+            L.cliqueStart[c + 1] = L.cliqueStart[c] + k * k;
+        }
+        L.clique = new int[L.cliqueStart[cells] + 1];
+    }
+    buildMs = msSince(began);
+
+    // Finest first: a cell's clique is searched over the cliques below it
+    began = chrono::steady_clock::now();
+    customizedCells = 0;
+    for (int l = 0; l < levelTotal; l++) {
+        for (int c = 0; c < levels[l].cellCount; c++) customize(g, l, c, nullptr);
+        customizedCells += levels[l].cellCount;
+    }
+    customizeMs = msSince(began);
+}
+
+void RouteOverlay::refresh(const MapGraph& g) {
+    if (stale || cityCount != g.cityCount) build(g);
+}
+
+// Searches again from the boundary cities whose row is set in 'rows' (all
+// of them when null); row i holds the distances to the others. Returns
+// whether any distance changed.
+bool RouteOverlay::customize(const MapGraph& g, int level, int cell, const bool* rows) {
+    Level& L = levels[level];
+    int first = L.boundaryStart[cell];
+    int k = L.boundaryStart[cell + 1] - first;
+    int* row = L.clique + L.cliqueStart[cell];
+    bool changed = false;
+    for (int i = 0; i < k; i++) {
+        if (rows && !rows[i]) continue;
+        searchCell(g, level, cell, level - 1, L.boundary[first + i], -1, false);
+        for (int j = 0; j < k; j++) {
+            int d = dist[L.boundary[first + j]];
+            if (row[i * k + j] != d) changed = true;
+            row[i * k + j] = d;
+        }
+        resetSearch();
+    }
+    return changed;
+}
+
+// Closing a road only lengthens the trips whose shortest path ran over it.
+// In each cell holding the road, smallest first, two searches over the
+// cell's roads give every boundary city's distance to the road's start and
+// from its end; the rows where start + road + end matches a clique entry
+// are searched again, the rest stand. A cell whose clique did not move
+// leaves the cells above it as they were.
+//
+// Known limitation: the test cannot tell a road that every shortest path
+// needs from one that merely lies on one of several equally short paths.
+// On maps with many ties (a grid of equal roads) it marks rows that come
+// out unchanged, and each marked row at a zone-sized cell is a search over
+// the whole zone. Most closures stop within the fine levels in a few
+// milliseconds; one near a zone boundary can take about a hundred at 40k
+// cities (bench overlay), so a closure is not bounded by one small cell.
+void RouteOverlay::roadClosed(const MapGraph& g, int edgeId) {
+    if (stale || edgeId < 0 || edgeId >= g.edgeCount) return;
+    const Edge& road = g.getEdge(edgeId);
+    int a = g.edgeOwner[edgeId];
+    int b = road.dest;
+    if (a >= cityCount || b >= cityCount) return;
+
+    auto began = chrono::steady_clock::now();
+    int cells = 0;
+    for (int l = 0; l < levelTotal; l++) {
+        Level& L = levels[l];
+        int c = L.cellOf[a];
+        if (L.cellOf[b] != c) continue;     // a cut road; no clique of this level holds it
+
+        int first = L.boundaryStart[c];
+        int k = L.boundaryStart[c + 1] - first;
+        int* toA = new int[k + 1];
+        int* fromB = new int[k + 1];
+        bool* rows = new bool[k + 1];
+        searchCell(g, l, c, -1, a, -1, true);
+        for (int i = 0; i < k; i++) toA[i] = dist[L.boundary[first + i]];
+        resetSearch();
+        searchCell(g, l, c, -1, b, -1, false);
+        for (int j = 0; j < k; j++) fromB[j] = dist[L.boundary[first + j]];
+        resetSearch();
+
+        const int* clique = L.clique + L.cliqueStart[c];
+        bool marked = false;
+        for (int i = 0; i < k; i++) {
+            rows[i] = false;
+            if (toA[i] == DIST_INFINITY) continue;
+            for (int j = 0; j < k && !rows[i]; j++)
+                rows[i] = fromB[j] != DIST_INFINITY && toA[i] + road.weight + fromB[j] == clique[i * k + j];
+            if (rows[i]) marked = true;
+        }
+        bool changed = marked && customize(g, l, c, rows);
+        delete[] toA;
+        delete[] fromB;
+        delete[] rows;
+        if (marked) cells++;
+        if (!changed) break;
+    }
+    customizeMs = msSince(began);
+    customizedCells = cells;
+}
+
+int RouteOverlay::levelCount() const { return levelTotal; }
+
+int RouteOverlay::cellCount(int level) const {
+    return (level >= 0 && level < levelTotal) ? levels[level].cellCount : 0;
+}
+
+int RouteOverlay::boundaryCount(int level) const {
+    return (level >= 0 && level < levelTotal) ? levels[level].boundaryStart[levels[level].cellCount] : 0;
+}
+
+// =====================================================
+// Overlay Searches (Cell Dijkstra, Queries, Path Unpacking)
+// =====================================================
+void RouteOverlay::push(int v, int d, int from, int level) {
+    if (dist[v] == DIST_INFINITY) touched[touchedCount++] = v;
+    dist[v] = d;
+    via[v] = from;
+    viaLevel[v] = (signed char)level;
+    if (heapSize == heapCapacity) {
+        MinHeapItem<int>* bigger = new MinHeapItem<int>[heapCapacity * 2];
+        for (int i = 0; i < heapSize; i++) bigger[i] = heap[i];
+        delete[] heap;
+        heap = bigger;
+        heapCapacity *= 2;
+    }
+    minHeapPush(heap, heapSize, d, v);
+}
+
+void RouteOverlay::resetSearch() {
+    for (int i = 0; i < touchedCount; i++) dist[touched[i]] = DIST_INFINITY;
+    touchedCount = 0;
+    heapSize = 0;
+}
+
+// From boundary city u to every other boundary city of its cell at 'level'
+void RouteOverlay::relaxClique(int level, int u, int d) {
+    const Level& L = levels[level];
+    int slot = L.boundarySlot[u];
+    if (slot < 0) return;
+    int c = L.cellOf[u];
+    int first = L.boundaryStart[c];
+    int k = L.boundaryStart[c + 1] - first;
+    const int* row = L.clique + L.cliqueStart[c] + slot * k;
+    for (int j = 0; j < k; j++) {
+        if (j == slot || row[j] == DIST_INFINITY) continue;
+        int v = L.boundary[first + j];
+        int nd = d + row[j];
+        if (nd < dist[v]) push(v, nd, u, level);
+    }
+}
+
+void RouteOverlay::searchCell(const MapGraph& g, int level, int cell, int below, int source, int stopAt, bool reverse) {
+    const int* cellOf = levels[level].cellOf;
+    const int* belowOf = below >= 0 ? levels[below].cellOf : nullptr;
+    push(source, 0, -1, -1);
+    while (heapSize > 0) {
+        MinHeapItem<int> top = minHeapPop(heap, heapSize);
+        int u = top.node;
+        if (top.key != dist[u]) continue;
+        if (u == stopAt) break;
+        if (belowOf) relaxClique(below, u, top.key);
+        for (const Edge& e : g.cities[u].edges) {
+            int v = e.dest;
+            // Backwards, u is reached from v over the other direction of
+            // the same road (ids 2r and 2r+1)
+            bool closed = reverse ? g.getEdge(e.id ^ 1).blocked : e.blocked;
+            if (closed || cellOf[v] != cell) continue;
+            // Roads inside a cell below are already in its clique
+            if (belowOf && belowOf[v] == belowOf[u]) continue;
+            int nd = top.key + e.weight;
+            if (nd < dist[v]) push(v, nd, u, -1);
+        }
+    }
+}
+
+// The overlay level to leave u by: just below the finest cell u shares
+// with either end (-1: drive the plain roads)
+int RouteOverlay::searchLevel(int u, int s, int t) const {
+    for (int l = 0; l < levelTotal; l++) {
+        int c = levels[l].cellOf[u];
+        if (c == levels[l].cellOf[s] || c == levels[l].cellOf[t]) return l - 1;
+    }
+    return levelTotal - 1;
+}
+
+int RouteOverlay::distance(const MapGraph& g, int start, int end, IntArrayList* pathOut) {
+    if (pathOut) pathOut->clear();
+    if (start < 0 || end < 0 || start >= g.cityCount || end >= g.cityCount) return DIST_INFINITY;
+    refresh(g);
+
+    push(start, 0, -1, -1);
+    while (heapSize > 0) {
+        MinHeapItem<int> top = minHeapPop(heap, heapSize);
+        int u = top.node;
+        if (top.key != dist[u]) continue;
+        if (u == end) break;
+
+        // Above level 0 only boundary cities are ever reached; driving
+        // the roads is the safe answer should that not hold
+        int m = searchLevel(u, start, end);
+        if (m >= 0 && levels[m].boundarySlot[u] < 0) m = -1;
+        if (m >= 0) relaxClique(m, u, top.key);
+        for (const Edge& e : g.cities[u].edges) {
+            int v = e.dest;
+            if (e.blocked) continue;
+            if (m >= 0 && levels[m].cellOf[v] == levels[m].cellOf[u]) continue;
+            int nd = top.key + e.weight;
+            if (nd < dist[v]) push(v, nd, u, -1);
+        }
+    }
+
+    int result = dist[end];
+    if (pathOut && result != DIST_INFINITY) {
+        // Hops back from the end; each clique hop is then driven again
+        // inside its own cell to recover the roads it stands for
+        IntArrayList hopCity, hopLevel;
+        for (int v = end; v != -1; v = via[v]) {
+            hopCity.add(v);
+            hopLevel.add(viaLevel[v]);
+        }
+        resetSearch();
+        pathOut->add(start);
+        for (int i = hopCity.size() - 2; i >= 0; i--) {
+            int a = hopCity[i + 1];
+            int b = hopCity[i];
+            int level = hopLevel[i];
+            if (level < 0) {
+                pathOut->add(b);
+                continue;
+            }
+            searchCell(g, level, levels[level].cellOf[a], -1, a, b, false);
+            IntArrayList leg;
+            for (int v = b; v != a; v = via[v]) leg.add(v);
+            for (int j = leg.size() - 1; j >= 0; j--) pathOut->add(leg[j]);
+            resetSearch();
+        }
+    }
+    resetSearch();
+    return result;
+}
@@ -0,0 +1,101 @@
+#ifndef ROUTEOVERLAY_H
+#define ROUTEOVERLAY_H
+
+#include "datastructures.h"
+#include "minheap.h"
+
+class MapGraph;
+
+// Multi-level overlay for shortest road distances (km). The cities are
+// split into cells: the zones at the top level, then pieces cut out of
+// each zone by geographic bisection (breadth-first order for cities with
+// no position) until no cell holds more than LEAF_CELL_CITIES. Every cell
+// keeps a clique: the shortest distance inside the cell between each pair
+// of its boundary cities, the ones with a road leaving it. A query drives
+// the plain roads only inside the cells of its two ends and crosses every
+// other cell by its clique, at the coarsest level that leaves both ends
+// outside.
+//
+// The partition depends only on which roads exist (build); the cliques on
+// which of them are open (customization). Closing a road re-customizes
+// only the cells holding both of its cities, and in each only the rows
+// whose shortest paths ran over it. Ties defeat that test, so on a map of
+// many equally short paths a closure can still reach a whole zone (see
+// roadClosed).
+class RouteOverlay {
+public:
+    static const int MAX_LEVELS = 8;
+    static const int LEAF_CELL_CITIES = 64;
+    // Pieces a cell is cut into on the level below
+    static const int SPLIT_FANOUT = 8;
+
+private:
+    struct Level {
+        int cellCount;
+        int* cellOf;            // city -> cell
+        int* boundaryStart;     // cell -> [boundaryStart[c], boundaryStart[c + 1]) in boundary
+        int* boundary;
+        int* boundarySlot;      // city -> position among its cell's boundary cities, or -1
+        int* cliqueStart;       // cell -> k x k distances, row-major by boundary slot
+        int* clique;
+    };
+
+    Level levels[MAX_LEVELS];   // finest first
+    int levelTotal;
+    int cityCount;
+    bool stale;
+
+    // Search scratch, sized to the map; only touched cities are reset
+    int* dist;
+    int* via;                   // city the best path came from
+    signed char* viaLevel;      // -1: a road; otherwise the level of the clique hop
+    int* touched;
+    int touchedCount;
+    MinHeapItem<int>* heap;
+    int heapSize;
+    int heapCapacity;
+
+    void clear();
+    void build(const MapGraph& g);
+    int* splitCells(const MapGraph& g, const int* cellOf, int cellCount, int& nextCount);
+    bool customize(const MapGraph& g, int level, int cell, const bool* rows);
+
+    void push(int v, int d, int from, int level);
+    void resetSearch();
+    void relaxClique(int level, int u, int d);
+    // Dijkstra from source over the cities of one cell at 'level', on the
+    // plain roads (below == -1) or across the cells of level 'below' by
+    // their cliques; stops once stopAt is settled. Reverse follows the
+    // roads into each city, giving distances to the source.
+    void searchCell(const MapGraph& g, int level, int cell, int below, int source, int stopAt, bool reverse);
+    int searchLevel(int u, int s, int t) const;
+
+public:
+    // How long the last partition and the last customization took, and in
+    // how many cells the last closure searched rows again
+    double buildMs;
+    double customizeMs;
+    int customizedCells;
+
+    RouteOverlay();
+    ~RouteOverlay();
+    RouteOverlay(const RouteOverlay&) = delete;
+    RouteOverlay& operator=(const RouteOverlay&) = delete;
+
+    // A city or road was added: partition again on the next query
+    void invalidate();
+    // Directed road edgeId was just closed
+    void roadClosed(const MapGraph& g, int edgeId);
+    // Partitions and customizes again if cities or roads were added
+    void refresh(const MapGraph& g);
+
+    // Shortest open-road km from start to end, or DIST_INFINITY.
+    // Optionally returns the city sequence.
+    int distance(const MapGraph& g, int start, int end, IntArrayList* pathOut = nullptr);
+
+    int levelCount() const;
+    int cellCount(int level) const;
+    int boundaryCount(int level) const;
+};
+
+#endif
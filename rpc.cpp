@@ -0,0 +1,343 @@
+#include "rpc.h"
+#include <cstring>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+using namespace std;
+
+// =====================================================
+// RpcWriter / RpcReader Implementation (Frame Codec)
+// =====================================================
+void RpcWriter::begin(int opOrStatus, unsigned int tag) {
+    start = out.size();
+    u32(0);   // length, filled in by end()
+    u8((unsigned int)opOrStatus);
+    u32(tag);
+}
+
+void RpcWriter::u8(unsigned int v) {
+    out.put((char)(v & 0xff));
+}
+
+void RpcWriter::u16(unsigned int v) {
+    char* b = out.reserve(2);
+    b[0] = (char)(v & 0xff);
+    b[1] = (char)((v >> 8) & 0xff);
+    out.commit(2);
+}
+
+void RpcWriter::u32(unsigned int v) {
+    char* b = out.reserve(4);
+    for (int i = 0; i < 4; i++) b[i] = (char)((v >> (8 * i)) & 0xff);
+    out.commit(4);
+}
+
+void RpcWriter::i64(long long v) {
+    unsigned long long u = (unsigned long long)v;
+    char* b = out.reserve(8);
+    for (int i = 0; i < 8; i++) b[i] = (char)((u >> (8 * i)) & 0xff);
+    out.commit(8);
+}
+
+void RpcWriter::f64(double v) {
+    long long bits;
+    memcpy(&bits, &v, sizeof(bits));
+    i64(bits);
+}
+
+// Longer strings are cut at 64 KB; nothing the engine stores comes close
+void RpcWriter::str(string_view s) {
+    size_t n = s.size() > 0xffff ? 0xffff : s.size();
+    u16((unsigned int)n);
+    out.append(s.data(), n);
+}
+
+void RpcWriter::end() {
+    unsigned int len = (unsigned int)(out.size() - start - 4);
+    char b[4];
+    for (int i = 0; i < 4; i++) b[i] = (char)((len >> (8 * i)) & 0xff);
+    out.patch(start, b, 4);
+}
+
+RpcReader::RpcReader(const char* frame, size_t frameLen)
+    : p((const unsigned char*)frame), endp((const unsigned char*)frame + frameLen), good(true),
+      opOrStatus(0), frameTag(0) {
+    if (!need(RPC_HEADER_BYTES)) return;
+    p += 4;
+    opOrStatus = u8();
+    frameTag = u32();
+}
+
+bool RpcReader::need(size_t n) {
+    if (good && (size_t)(endp - p) >= n) return true;
+    good = false;
+    return false;
+}
+
+unsigned int RpcReader::u8() {
+    if (!need(1)) return 0;
+    return *p++;
+}
+
+unsigned int RpcReader::u16() {
+    if (!need(2)) return 0;
+    unsigned int v = p[0] | (p[1] << 8);
+    p += 2;
+    return v;
+}
+
+unsigned int RpcReader::u32() {
+    if (!need(4)) return 0;
+    unsigned int v = 0;
+    for (int i = 0; i < 4; i++) v |= (unsigned int)p[i] << (8 * i);
+    p += 4;
+    return v;
+}
+
+long long RpcReader::i64() {
+    if (!need(8)) return 0;
+    unsigned long long v = 0;
+    for (int i = 0; i < 8; i++) v |= (unsigned long long)p[i] << (8 * i);
+    p += 8;
+    return (long long)v;
+}
+
+double RpcReader::f64() {
+    long long bits = i64();
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+string_view RpcReader::str() {
+    unsigned int n = u16();
+    if (!need(n)) return string_view();
+    string_view s((const char*)p, n);
+    p += n;
+    return s;
+}
+
+size_t rpcFrameSize(const char* data, size_t n) {
+    if (n < 4) return 0;
+    const unsigned char* b = (const unsigned char*)data;
+    size_t len = (size_t)b[0] | ((size_t)b[1] << 8) | ((size_t)b[2] << 16) | ((size_t)b[3] << 24);
+    if (len < RPC_HEADER_BYTES - 4 || len > RPC_MAX_FRAME) return (size_t)-1;
+    return n >= len + 4 ? len + 4 : 0;
+}
+
+// FNV-1a; only has to spread IDs evenly and agree between every process
+int rpcOwner(string_view id, int nodes) {
+    if (nodes <= 1) return 0;
+    unsigned int h = 2166136261u;
+    for (unsigned char c : id) {
+        h ^= c;
+        h *= 16777619u;
+    }
+    return (int)(h % (unsigned int)nodes);
+}
+
+#ifdef __linux__
+// =====================================================
+// Socket Helpers (Linux): TCP and Unix domain
+// =====================================================
+static bool isUnixAddress(const string& address) {
+    return address.compare(0, 5, "unix:") == 0;
+}
+
+static bool unixAddress(const string& address, sockaddr_un& sa) {
+    string path = address.substr(5);
+    if (path.empty() || path.size() >= sizeof(sa.sun_path)) return false;
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    memcpy(sa.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// "host:port" or ":port"; an empty host is the loopback address. RPC has no
+// authentication, so listening wider takes an explicit host (0.0.0.0 for
+// every interface).
+static bool tcpAddress(const string& address, sockaddr_in& sa) {
+    size_t colon = address.rfind(':');
+    if (colon == string::npos) return false;
+    string host = address.substr(0, colon);
+    int port = atoi(address.c_str() + colon + 1);
+    if (port <= 0 || port > 65535) return false;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons((unsigned short)port);
+    if (host.empty()) {
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return true;
+    }
+    if (inet_pton(AF_INET, host.c_str(), &sa.sin_addr) == 1) return true;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || !found) return false;
+    sa.sin_addr = ((sockaddr_in*)found->ai_addr)->sin_addr;
+    freeaddrinfo(found);
+    return true;
+}
+
+int rpcListen(const string& address) {
+    int fd;
+    if (isUnixAddress(address)) {
+        sockaddr_un sa;
+        if (!unixAddress(address, sa)) return -1;
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        unlink(sa.sun_path);   // a socket file left by an earlier run
+        if (bind(fd, (sockaddr*)&sa, sizeof(sa)) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    else {
+        sockaddr_in sa;
+        if (!tcpAddress(address, sa)) return -1;
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, (sockaddr*)&sa, sizeof(sa)) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    if (listen(fd, 1024) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// A non-blocking connect is started and left in progress; the caller sees
+// the socket turn writable and checks the outcome with rpcConnectFinished
+int rpcConnect(const string& address, bool blocking) {
+    int flags = SOCK_CLOEXEC | (blocking ? 0 : SOCK_NONBLOCK);
+    int fd;
+    int rc;
+    if (isUnixAddress(address)) {
+        sockaddr_un sa;
+        if (!unixAddress(address, sa)) return -1;
+        fd = socket(AF_UNIX, SOCK_STREAM | flags, 0);
+        if (fd < 0) return -1;
+        rc = ::connect(fd, (sockaddr*)&sa, sizeof(sa));
+    }
+    else {
+        sockaddr_in sa;
+        if (!tcpAddress(address, sa)) return -1;
+        fd = socket(AF_INET, SOCK_STREAM | flags, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        rc = ::connect(fd, (sockaddr*)&sa, sizeof(sa));
+    }
+    // A full Unix socket backlog (EAGAIN) is a failure; retry later
+    if (rc < 0 && (blocking || errno != EINPROGRESS)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool rpcConnectFinished(int fd) {
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0) return false;
+    return error == 0;
+}
+
+// =====================================================
+// RpcClient Implementation (Blocking)
+// =====================================================
+RpcClient::RpcClient() : fd(-1), out(256), writer(out), nextTag(1) {}
+
+RpcClient::~RpcClient() {
+    if (fd >= 0) close(fd);
+}
+
+bool RpcClient::connect(const string& address) {
+    if (fd >= 0) close(fd);
+    fd = rpcConnect(address, true);
+    return fd >= 0;
+}
+
+RpcWriter& RpcClient::request(int op) {
+    out.clear();
+    writer.begin(op, nextTag++);
+    return writer;
+}
+
+bool RpcClient::call(string& reply) {
+    if (fd < 0) return false;
+    writer.end();
+    size_t sent = 0;
+    while (sent < out.size()) {
+        ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+
+    char buf[16384];
+    for (;;) {
+        size_t frame = rpcFrameSize(in.data(), in.size());
+        if (frame == (size_t)-1) return false;
+        if (frame > 0) {
+            reply.assign(in, 0, frame);
+            in.erase(0, frame);
+            return true;
+        }
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return false;
+        in.append(buf, (size_t)n);
+    }
+}
+
+#else
+
+int rpcListen(const string&) {
+    return -1;
+}
+
+int rpcConnect(const string&, bool) {
+    return -1;
+}
+
+bool rpcConnectFinished(int) {
+    return false;
+}
+
+RpcClient::RpcClient() : fd(-1), out(256), writer(out), nextTag(1) {}
+RpcClient::~RpcClient() {}
+
+bool RpcClient::connect(const string&) {
+    return false;
+}
+
+RpcWriter& RpcClient::request(int op) {
+    out.clear();
+    writer.begin(op, nextTag++);
+    return writer;
+}
+
+bool RpcClient::call(string&) {
+    return false;
+}
+
+#endif
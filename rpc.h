@@ -0,0 +1,121 @@
+#ifndef RPC_H
+#define RPC_H
+
+#include <string>
+#include <string_view>
+#include "serializer.h"
+
+// Binary RPC spoken between cluster nodes, the router and clients.
+//
+// Every message is one frame: a little-endian u32 length of what follows,
+// a u8 op (requests) or status (replies), a u32 tag the reply echoes, then
+// the payload. Payload fields are fixed-width little-endian integers,
+// doubles as their 8 raw bytes, and strings as a u16 length plus bytes.
+// A node answers the requests on one connection in order, which is how the
+// router matches its replies. A client of the router must match by tag:
+// requests for different nodes are answered as each node replies, so
+// replies on the client's connection can come back in any order.
+enum RpcOp {
+    RPC_TRACK = 1,          // str id                        -> parcel
+    RPC_PICKUP = 2,         // str id, str dest, f64 w, u32 p -> u32 PickupResult
+    RPC_CANCEL = 3,         // str id                        -> (status only)
+    RPC_DISPATCH = 4,       // u32 max (split over the nodes) -> u32 dispatched
+    RPC_STATS = 5,          //                               -> u32 hot, i64 archived
+    RPC_MAP_SYNC = 6,       // u32 since                     -> u32 version, u32 n, n x u32 edge
+    RPC_MAP_APPLY = 7       // u32 n, n x u32 edge           -> u32 newly closed
+};
+
+enum RpcStatus {
+    RPC_OK = 0,
+    RPC_NOT_FOUND = 1,
+    RPC_REJECTED = 2,       // pickup refused or cancel not allowed
+    RPC_NOT_OWNER = 3,      // the ID hashes to another node
+    RPC_BAD_REQUEST = 4,
+    RPC_UNAVAILABLE = 5     // router could not reach the owner
+};
+
+const size_t RPC_HEADER_BYTES = 9;          // length + op/status + tag
+const size_t RPC_MAX_FRAME = 1 << 20;
+
+// Appends frames to an OutBuffer; end() fills in the length
+class RpcWriter {
+private:
+    OutBuffer& out;
+    size_t start;
+public:
+    RpcWriter(OutBuffer& buffer) : out(buffer), start(0) {}
+    void begin(int opOrStatus, unsigned int tag);
+    void u8(unsigned int v);
+    void u16(unsigned int v);
+    void u32(unsigned int v);
+    void i64(long long v);
+    void f64(double v);
+    void str(std::string_view s);
+    void end();
+};
+
+// Reads one frame's payload; any overrun sets ok() to false and returns
+// zeros / empty strings from then on
+class RpcReader {
+private:
+    const unsigned char* p;
+    const unsigned char* endp;
+    bool good;
+    unsigned int opOrStatus;
+    unsigned int frameTag;
+    bool need(size_t n);
+public:
+    // frame points at a whole frame, header included
+    RpcReader(const char* frame, size_t frameLen);
+    unsigned int op() const { return opOrStatus; }
+    unsigned int tag() const { return frameTag; }
+    unsigned int u8();
+    unsigned int u16();
+    unsigned int u32();
+    long long i64();
+    double f64();
+    std::string_view str();
+    bool ok() const { return good; }
+    bool atEnd() const { return p == endp; }
+};
+
+// Size of the frame at the front of a byte stream: 0 if it has not fully
+// arrived yet, (size_t)-1 if the length is out of bounds
+size_t rpcFrameSize(const char* data, size_t n);
+
+// Node that owns a tracking ID when IDs are split over `nodes` processes
+int rpcOwner(std::string_view id, int nodes);
+
+// Addresses are "host:port", ":port" (localhost; "0.0.0.0:port" listens on
+// every interface) or "unix:/path/to/socket". Both return a file descriptor
+// or -1; sockets are non-blocking unless blocking is asked for.
+int rpcListen(const std::string& address);
+// A non-blocking connect returns at once, usually still in progress: wait
+// for the socket to become writable, then ask rpcConnectFinished
+int rpcConnect(const std::string& address, bool blocking);
+// False if the connection attempt on fd failed
+bool rpcConnectFinished(int fd);
+
+// Blocking request / reply over one connection (the command line client)
+class RpcClient {
+private:
+    int fd;
+    std::string in;
+    OutBuffer out;
+    RpcWriter writer;
+    unsigned int nextTag;
+public:
+    RpcClient();
+    ~RpcClient();
+    RpcClient(const RpcClient&) = delete;
+    RpcClient& operator=(const RpcClient&) = delete;
+
+    bool connect(const std::string& address);
+    // Starts a request frame; fill the payload through the writer, then call()
+    RpcWriter& request(int op);
+    // Sends the request and waits for its reply frame; false if the
+    // connection failed. reply holds the whole frame.
+    bool call(std::string& reply);
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include "serializer.h"
+#include <charconv>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+// =====================================================
+// OutBuffer Implementation
+// =====================================================
+OutBuffer::OutBuffer(size_t initialCapacity) : len(0), cap(initialCapacity ? initialCapacity : 64) {
+    buf = new char[cap];
+}
+
+OutBuffer::~OutBuffer() {
+    delete[] buf;
+}
+
+void OutBuffer::grow(size_t need) {
+    size_t newCap = cap * 2;
+    while (newCap < need) newCap *= 2;
+    char* bigger = new char[newCap];
+    memcpy(bigger, buf, len);
+    delete[] buf;
+    buf = bigger;
+    cap = newCap;
+}
+
+// =====================================================
+// JsonWriter Implementation
+// =====================================================
+// Bytes that need escaping inside a JSON string
+static bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+JsonWriter::JsonWriter(OutBuffer& o) : out(o), hasItems(0), depth(0), afterKey(false) {}
+
+void JsonWriter::separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    unsigned long long bit = 1ULL << (depth & 63);
+    if (hasItems & bit) out.put(',');
+    hasItems |= bit;
+}
+
+// Copies clean runs in one memcpy and only escapes the odd byte
+void JsonWriter::writeString(string_view s) {
+    out.put('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (!needsEscape(c)) continue;
+
+        out.append(s.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+        case '"': out.append("\\\"", 2); break;
+        case '\\': out.append("\\\\", 2); break;
+        case '\n': out.append("\\n", 2); break;
+        case '\r': out.append("\\r", 2); break;
+        case '\t': out.append("\\t", 2); break;
+        default: {
+            static const char hex[] = "0123456789abcdef";
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+            out.append(esc, 6);
+        }
+        }
+    }
+    out.append(s.data() + runStart, s.size() - runStart);
+    out.put('"');
+}
+
+void JsonWriter::beginObject(int) {
+    separator();
+    out.put('{');
+    depth++;
+    hasItems &= ~(1ULL << (depth & 63));
+}
+
+void JsonWriter::endObject() {
+    depth--;
+    out.put('}');
+}
+
+void JsonWriter::beginArray(int) {
+    separator();
+    out.put('[');
+    depth++;
+    hasItems &= ~(1ULL << (depth & 63));
+}
+
+void JsonWriter::endArray() {
+    depth--;
+    out.put(']');
+}
+
+void JsonWriter::key(string_view k) {
+    separator();
+    writeString(k);
+    out.put(':');
+    afterKey = true;
+}
+
+void JsonWriter::value(string_view s) {
+    separator();
+    writeString(s);
+}
+
+void JsonWriter::value(long long v) {
+    separator();
+    char* p = out.reserve(24);
+    out.commit(to_chars(p, p + 24, v).ptr - p);
+}
+
+// Shortest round-trip form; NaN/inf are not valid JSON and become null
+void JsonWriter::value(double v) {
+    separator();
+    if (v != v || v > 1.7976931348623157e308 || v < -1.7976931348623157e308) {
+        out.append("null", 4);
+        return;
+    }
+    char* p = out.reserve(32);
+    out.commit(to_chars(p, p + 32, v).ptr - p);
+}
+
+void JsonWriter::value(bool v) {
+    separator();
+    if (v) out.append("true", 4);
+    else out.append("false", 5);
+}
+
+void JsonWriter::null() {
+    separator();
+    out.append("null", 4);
+}
+
+// =====================================================
+// MsgPackWriter Implementation
+// =====================================================
+static const size_t NO_PATCH = (size_t)-1;
+
+MsgPackWriter::MsgPackWriter(OutBuffer& o) : out(o), depth(0) {
+    isArray[0] = false;
+    arrayItems[0] = 0;
+    arrayHeader[0] = NO_PATCH;
+}
+
+// Big-endian marker + value, the layout every MessagePack int/len uses
+void MsgPackWriter::writeUInt(unsigned char marker, unsigned long long v, int bytes) {
+    char* p = out.reserve(1 + bytes);
+    p[0] = (char)marker;
+    for (int i = 0; i < bytes; i++)
+        p[1 + i] = (char)(v >> (8 * (bytes - 1 - i)));
+    out.commit(1 + bytes);
+}
+
+void MsgPackWriter::countItem() {
+    if (isArray[depth]) arrayItems[depth]++;
+}
+
+void MsgPackWriter::beginObject(int fields) {
+    countItem();
+    if (fields < 16) out.put((char)(0x80 | fields));
+    else if (fields < 65536) writeUInt(0xde, (unsigned)fields, 2);
+    else writeUInt(0xdf, (unsigned)fields, 4);
+    depth++;
+    isArray[depth] = false;
+}
+
+void MsgPackWriter::endObject() {
+    depth--;
+}
+
+void MsgPackWriter::beginArray(int items) {
+    countItem();
+    depth++;
+    isArray[depth] = true;
+    arrayItems[depth] = 0;
+    arrayHeader[depth] = NO_PATCH;
+
+    if (items < 0) {
+        arrayHeader[depth] = out.size();
+        writeUInt(0xdd, 0, 4);
+    }
+    else if (items < 16) out.put((char)(0x90 | items));
+    else if (items < 65536) writeUInt(0xdc, (unsigned)items, 2);
+    else writeUInt(0xdd, (unsigned)items, 4);
+}
+
+void MsgPackWriter::endArray() {
+    if (arrayHeader[depth] != NO_PATCH) {
+        unsigned int n = arrayItems[depth];
+        char len[4] = { (char)(n >> 24), (char)(n >> 16), (char)(n >> 8), (char)n };
+        out.patch(arrayHeader[depth] + 1, len, 4);
+    }
+    depth--;
+}
+
+void MsgPackWriter::key(string_view k) {
+    // Keys are strings but do not count as array items
+    size_t n = k.size();
+    if (n < 32) out.put((char)(0xa0 | n));
+    else if (n < 256) writeUInt(0xd9, n, 1);
+    else writeUInt(0xda, n, 2);
+    out.append(k);
+}
+
+void MsgPackWriter::value(string_view s) {
+    countItem();
+    size_t n = s.size();
+    if (n < 32) out.put((char)(0xa0 | n));
+    else if (n < 256) writeUInt(0xd9, n, 1);
+    else if (n < 65536) writeUInt(0xda, n, 2);
+    else writeUInt(0xdb, n, 4);
+    out.append(s);
+}
+
+void MsgPackWriter::value(long long v) {
+    countItem();
+    if (v >= 0) {
+        if (v < 128) out.put((char)v);
+        else if (v < 256) writeUInt(0xcc, (unsigned long long)v, 1);
+        else if (v < 65536) writeUInt(0xcd, (unsigned long long)v, 2);
+        else if (v <= 0xffffffffLL) writeUInt(0xce, (unsigned long long)v, 4);
+        else writeUInt(0xcf, (unsigned long long)v, 8);
+    }
+    else {
+        if (v >= -32) out.put((char)(0xe0 | (v + 32)));
+        else if (v >= -128) writeUInt(0xd0, (unsigned long long)v, 1);
+        else if (v >= -32768) writeUInt(0xd1, (unsigned long long)v, 2);
+        else if (v >= -2147483648LL) writeUInt(0xd2, (unsigned long long)v, 4);
+        else writeUInt(0xd3, (unsigned long long)v, 8);
+    }
+}
+
+void MsgPackWriter::value(double v) {
+    countItem();
+    unsigned long long bits;
+    memcpy(&bits, &v, sizeof(bits));
+    writeUInt(0xcb, bits, 8);
+}
+
+void MsgPackWriter::value(bool v) {
+    countItem();
+    out.put(v ? (char)0xc3 : (char)0xc2);
+}
+
+void MsgPackWriter::null() {
+    countItem();
+    out.put((char)0xc0);
+}
@@ -0,0 +1,153 @@
+#ifndef SERIALIZER_H
+#define SERIALIZER_H
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include "parcel.h"
+
+// Growable byte buffer the serializers write into. Meant to be kept and
+// reused (clear() keeps the capacity), so steady-state encoding never
+// allocates and never builds intermediate strings.
+class OutBuffer {
+private:
+    char* buf;
+    size_t len;
+    size_t cap;
+    void grow(size_t need);
+public:
+    OutBuffer(size_t initialCapacity = 4096);
+    ~OutBuffer();
+    OutBuffer(const OutBuffer&) = delete;
+    OutBuffer& operator=(const OutBuffer&) = delete;
+
+    void clear() { len = 0; }
+    size_t size() const { return len; }
+    const char* data() const { return buf; }
+    std::string_view view() const { return std::string_view(buf, len); }
+
+    // Room for n more bytes; write through the pointer, then commit()
+    char* reserve(size_t n) {
+        if (len + n > cap) grow(len + n);
+        return buf + len;
+    }
+    void commit(size_t n) { len += n; }
+
+    void put(char c) {
+        if (len == cap) grow(len + 1);
+        buf[len++] = c;
+    }
+    void append(const char* s, size_t n) {
+        memcpy(reserve(n), s, n);
+        len += n;
+    }
+    void append(std::string_view s) { append(s.data(), s.size()); }
+
+    // Overwrites bytes already written (MessagePack length back-patching)
+    void patch(size_t offset, const char* bytes, size_t n) { memcpy(buf + offset, bytes, n); }
+};
+
+// Streaming JSON writer. Commas and quoting are handled here; callers only
+// describe structure. Field/item counts are accepted for API parity with
+// MsgPackWriter and ignored.
+class JsonWriter {
+private:
+    OutBuffer& out;
+    unsigned long long hasItems;   // bit per nesting level
+    int depth;
+    bool afterKey;
+    void separator();
+    void writeString(std::string_view s);
+public:
+    explicit JsonWriter(OutBuffer& o);
+    void beginObject(int fields = -1);
+    void endObject();
+    void beginArray(int items = -1);
+    void endArray();
+    void key(std::string_view k);
+    void value(std::string_view s);
+    void value(const char* s) { value(std::string_view(s)); }
+    void value(const std::string& s) { value(std::string_view(s)); }
+    void value(long long v);
+    void value(int v) { value((long long)v); }
+    void value(double v);
+    void value(bool v);
+    void null();
+};
+
+// MessagePack writer with the same interface. Objects need their exact
+// field count up front; arrays may pass -1 and get their length patched
+// in by endArray().
+class MsgPackWriter {
+private:
+    static const int MAX_DEPTH = 32;
+    OutBuffer& out;
+    size_t arrayHeader[MAX_DEPTH];   // offset of a patchable array32 header, or -1
+    unsigned int arrayItems[MAX_DEPTH];
+    bool isArray[MAX_DEPTH];
+    int depth;
+    void countItem();
+    void writeUInt(unsigned char marker, unsigned long long v, int bytes);
+public:
+    explicit MsgPackWriter(OutBuffer& o);
+    void beginObject(int fields);
+    void endObject();
+    void beginArray(int items = -1);
+    void endArray();
+    void key(std::string_view k);
+    void value(std::string_view s);
+    void value(const char* s) { value(std::string_view(s)); }
+    void value(const std::string& s) { value(std::string_view(s)); }
+    void value(long long v);
+    void value(int v) { value((long long)v); }
+    void value(double v);
+    void value(bool v);
+    void null();
+};
+
+// =====================================================
+// Parcel / Timeline Encoders (shared by both formats)
+// =====================================================
+template <class Writer>
+void writeTimeline(Writer& w, const TrackingHistory& history) {
+    int events = 0;
+    for (const HistoryEvent* e = history.first(); e; e = e->next) events++;
+
+    w.beginArray(events);
+    for (const HistoryEvent* e = history.first(); e; e = e->next) {
+        w.beginObject(3);
+        w.key("time"); w.value(e->time);
+        w.key("description"); w.value(e->description);
+        w.key("location"); w.value(e->location);
+        w.endObject();
+    }
+    w.endArray();
+}
+
+// `now` is passed in so bulk exports read the clock once
+template <class Writer>
+void writeParcel(Writer& w, const Parcel& p, bool withHistory, long long now) {
+    long long eta = (p.status == STATUS_IN_TRANSIT || p.status == STATUS_LOADING) ? p.arrivalTime - now : 0;
+
+    w.beginObject(withHistory ? 14 : 13);
+    w.key("id"); w.value(p.id);
+    w.key("destination"); w.value(p.destination);
+    w.key("zone"); w.value(p.zone);
+    w.key("weight"); w.value(p.weight);
+    w.key("weightCategory"); w.value(p.weightCategory);
+    w.key("priority"); w.value(p.priority);
+    w.key("status"); w.value(p.status);
+    w.key("statusText"); w.value(p.getStatusName());
+    w.key("rider"); w.value(p.assignedRider);
+    w.key("dispatchTime"); w.value(p.dispatchTime);
+    w.key("arrivalTime"); w.value(p.arrivalTime);
+    w.key("etaSeconds"); w.value(eta > 0 ? eta : 0LL);
+    w.key("deliveryAttempts"); w.value(p.deliveryAttempts);
+    if (withHistory) {
+        w.key("history");
+        writeTimeline(w, *p.history);
+    }
+    w.endObject();
+}
+
+#endif
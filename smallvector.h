@@ -0,0 +1,125 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <cstring>
+#include <type_traits>
+
+// Growable array that keeps its first N elements inside the object, so the
+// short lists the engine is full of (a route's cities, a city's roads, an
+// edge's parcels) never touch the heap. Past N it moves to a heap buffer
+// that doubles as it fills.
+//
+// Elements must be trivially copyable: growing, copying and moving are a
+// memcpy, and nothing is destroyed. Indexing is unchecked; callers stay
+// below size().
+template <typename T, int N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector holds trivially copyable types only");
+    static_assert(N >= 0, "inline capacity cannot be negative");
+
+private:
+    T* items;
+    int count;
+    int capacity;
+    alignas(T) unsigned char local[(N > 0 ? N : 1) * sizeof(T)];
+
+    T* localItems() { return reinterpret_cast<T*>(local); }
+    bool onHeap() const { return items != reinterpret_cast<const T*>(local); }
+
+    void grow(int needed) {
+        int newCapacity = capacity > 0 ? capacity * 2 : 8;
+        while (newCapacity < needed) newCapacity *= 2;
+        T* bigger = new T[newCapacity];
+        if (count > 0) memcpy((void*)bigger, items, sizeof(T) * count);
+        if (onHeap()) delete[] items;
+        items = bigger;
+        capacity = newCapacity;
+    }
+
+    void copyFrom(const SmallVector& other) {
+        count = 0;
+        reserve(other.count);
+        if (other.count > 0) memcpy((void*)items, other.items, sizeof(T) * other.count);
+        count = other.count;
+    }
+
+    // Takes other's heap buffer, or copies its inline elements; other is
+    // left empty and inline
+    void takeFrom(SmallVector& other) {
+        if (other.onHeap()) {
+            items = other.items;
+            capacity = other.capacity;
+            count = other.count;
+            other.items = other.localItems();
+            other.capacity = N;
+        }
+        else {
+            if (other.count > 0) memcpy((void*)items, other.items, sizeof(T) * other.count);
+            count = other.count;
+        }
+        other.count = 0;
+    }
+
+    void release() {
+        if (onHeap()) delete[] items;
+        items = localItems();
+        capacity = N;
+        count = 0;
+    }
+
+public:
+    SmallVector() : items(localItems()), count(0), capacity(N) {}
+    SmallVector(const SmallVector& other) : items(localItems()), count(0), capacity(N) { copyFrom(other); }
+    SmallVector(SmallVector&& other) noexcept : items(localItems()), count(0), capacity(N) { takeFrom(other); }
+    ~SmallVector() {
+        if (onHeap()) delete[] items;
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) copyFrom(other);
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    void add(const T& val) {
+        if (count == capacity) {
+            T copy = val;   // val may live in the buffer being replaced
+            grow(count + 1);
+            items[count++] = copy;
+            return;
+        }
+        items[count++] = val;
+    }
+    void removeLast() {
+        if (count > 0) count--;
+    }
+    void clear() { count = 0; }
+    void reserve(int n) {
+        if (n > capacity) grow(n);
+    }
+
+    T& operator[](int i) { return items[i]; }
+    const T& operator[](int i) const { return items[i]; }
+    T get(int i) const { return items[i]; }
+    void set(int i, const T& val) { items[i] = val; }
+    void swap(int i, int j) {
+        T temp = items[i];
+        items[i] = items[j];
+        items[j] = temp;
+    }
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+};
+
+#endif
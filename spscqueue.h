@@ -0,0 +1,67 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Capacity is rounded up to a power of two so positions wrap with a
+// mask. Each side keeps a cached copy of the other side's index and only
+// re-reads the shared one when the cache says full / empty, so the two
+// cores rarely touch the same cache line.
+template <typename T>
+class SpscQueue {
+private:
+    static const size_t CACHE_LINE = 64;
+
+    T* slots;
+    size_t mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> head;   // next slot to read
+    size_t cachedTail;                              // consumer's view of tail
+    alignas(CACHE_LINE) std::atomic<size_t> tail;   // next slot to write
+    size_t cachedHead;                              // producer's view of head
+
+public:
+    explicit SpscQueue(size_t capacity) : head(0), cachedTail(0), tail(0), cachedHead(0) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots = new T[cap];
+        mask = cap - 1;
+    }
+    ~SpscQueue() { delete[] slots; }
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side; false when full
+    bool push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) return false;
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false when empty
+    bool pop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        out = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate from any thread other than the two ends
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return mask + 1; }
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "terminalframe.h"
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/ioctl.h>
+#endif
+
+using namespace std;
+
+// Cursor home, erase the screen, erase the scrollback
+static const char CLEAR_SEQUENCE[] = "\033[H\033[2J\033[3J";
+
+// =====================================================
+// TerminalFrame Implementation (one write per screen)
+// =====================================================
+TerminalFrame::TerminalFrame(int fileDescriptor) : cap(INITIAL_BYTES), fd(fileDescriptor) {
+    buf = new char[cap];
+    setp(buf, buf + cap);
+#ifdef _WIN32
+    // The colours were always escape codes; the cursor control needs the
+    // console to interpret them too
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(out, &mode)) SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+}
+
+TerminalFrame::~TerminalFrame() {
+    present();
+    delete[] buf;
+}
+
+// The put area is the whole buffer; when it fills, the buffer doubles
+// rather than sending half a frame
+void TerminalFrame::grow(size_t need) {
+    size_t used = pptr() - pbase();
+    size_t newCap = cap * 2;
+    while (newCap < used + need) newCap *= 2;
+    char* bigger = new char[newCap];
+    memcpy(bigger, buf, used);
+    delete[] buf;
+    buf = bigger;
+    cap = newCap;
+    setp(buf, buf + cap);
+    pbump((int)used);
+}
+
+TerminalFrame::int_type TerminalFrame::overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    grow(1);
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+}
+
+streamsize TerminalFrame::xsputn(const char* s, streamsize n) {
+    if (epptr() - pptr() < n) grow((size_t)n);
+    memcpy(pptr(), s, (size_t)n);
+    pbump((int)n);
+    return n;
+}
+
+int TerminalFrame::sync() {
+    return present() ? 0 : -1;
+}
+
+void TerminalFrame::clear() {
+    setp(buf, buf + cap);
+    xsputn(CLEAR_SEQUENCE, sizeof(CLEAR_SEQUENCE) - 1);
+}
+
+bool TerminalFrame::present() {
+    const char* p = pbase();
+    size_t left = pptr() - pbase();
+    bool ok = true;
+    while (left > 0) {
+#ifdef _WIN32
+        int n = _write(fd, p, (unsigned int)left);
+#else
+        ssize_t n = ::write(fd, p, left);
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    setp(buf, buf + cap);
+    return ok;
+}
+
+size_t TerminalFrame::pending() const {
+    return pptr() - pbase();
+}
+
+int TerminalFrame::rows() {
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+        return info.srWindow.Bottom - info.srWindow.Top + 1;
+#else
+    struct winsize ws;
+    if (ioctl(1, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0) return ws.ws_row;
+#endif
+    return 24;
+}
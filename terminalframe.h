@@ -0,0 +1,49 @@
+#ifndef TERMINALFRAME_H
+#define TERMINALFRAME_H
+
+#include <streambuf>
+#include <cstddef>
+
+// Composes a whole screen in memory and puts it on the terminal with one
+// write(). Installed under cout (rdbuf), it collects everything the menus
+// and the engine print; a flush sends the frame. cin is tied to cout, so
+// the frame goes out just before the program waits for a key - lines end
+// in '\n' rather than endl, which would send a frame per line.
+class TerminalFrame : public std::streambuf {
+public:
+    static const size_t INITIAL_BYTES = 256 * 1024;
+
+private:
+    char* buf;
+    size_t cap;
+    int fd;
+
+    void grow(size_t need);
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+public:
+    // fd 1 is standard output
+    explicit TerminalFrame(int fd = 1);
+    // Sends what is still pending
+    ~TerminalFrame();
+    TerminalFrame(const TerminalFrame&) = delete;
+    TerminalFrame& operator=(const TerminalFrame&) = delete;
+
+    // Starts the frame on an empty screen: whatever is pending would be
+    // erased anyway, so it is dropped, and the erase is an escape sequence
+    // at the head of the frame instead of a separate process
+    void clear();
+    // Writes the frame out in one call (more only if the terminal takes it
+    // piecemeal); false if it could not be written
+    bool present();
+    size_t pending() const;
+
+    // Height of the terminal in lines, or 24 when it cannot be told
+    static int rows();
+};
+
+#endif
@@ -1,95 +1,144 @@
-#include "trackinghistory.h"
-#include <iostream>
-#include <iomanip>
-#include <sstream>
-#include <ctime>
-#include <string>
-
-using namespace std;
-
-// --- THEME COLORS ---
-#define RESET     "\033[0m"
-#define CYAN      "\033[1;36m"
-#define WHITE     "\033[1;37m"
-#define GOLD      "\033[1;33m"
-#define GRAY      "\033[90m"
-#define BG_NAVY   "\033[48;5;18m"
-#define BOLD      "\033[1m"
-
-string getCurrentTimestamp() {
-    time_t now = time(nullptr);
-    tm localTime;
-
-#ifdef _WIN32
-    localtime_s(&localTime, &now);
-#else
-    localtime_r(&now, &localTime);
-#endif
-
-    stringstream ss;
-    ss << setfill('0') << setw(2) << localTime.tm_hour << ":"
-        << setw(2) << localTime.tm_min << ":"
-        << setw(2) << localTime.tm_sec;
-
-    return ss.str();
-}
-
-HistoryEvent::HistoryEvent(string d, string t, string l)
-    : description(d), time(t), location(l), next(nullptr) {
-}
-
-TrackingHistory::TrackingHistory() : head(nullptr), tail(nullptr) {}
-
-TrackingHistory::TrackingHistory(const TrackingHistory& other) : head(nullptr), tail(nullptr) {
-    HistoryEvent* curr = other.head;
-    while (curr) {
-        addEvent(curr->description, curr->location);
-        curr = curr->next;
-    }
-}
-
-void TrackingHistory::addEvent(string desc, string loc) {
-    HistoryEvent* newEvent = new HistoryEvent(desc, getCurrentTimestamp(), loc);
-    if (!head) {
-        head = tail = newEvent;
-    }
-    else {
-        tail->next = newEvent;
-        tail = newEvent;
-    }
-}
-
-// GUI: Renders a vertical GPS-style timeline within the Navy Theme
-void TrackingHistory::printTimeline() {
-    string bg = BG_NAVY;
-
-    cout << "\n" << bg << CYAN << "+==========================================================+" << RESET << endl;
-    cout << bg << CYAN << "| " << WHITE << BOLD << "              PARCEL JOURNEY TIMELINE                   " << CYAN << "|" << RESET << endl;
-    cout << bg << CYAN << "+----------------------------------------------------------+" << RESET << endl;
-
-    HistoryEvent* curr = head;
-    if (!curr) {
-        cout << bg << "  " << GRAY << "      (No history available for this parcel)            " << RESET << endl;
-    }
-
-    while (curr) {
-        // Node symbol: (O) for latest, (o) for previous
-        string node = (curr->next == nullptr) ? " (O) " : " (o) ";
-        string nodeColor = (curr->next == nullptr) ? GOLD : CYAN;
-
-        // Time and Event description
-        cout << bg << "  " << GOLD << curr->time << RESET << bg << CYAN << " | " << nodeColor << node << WHITE << left << setw(35) << curr->description << CYAN << "|" << RESET << endl;
-
-        // Location details
-        cout << bg << "           " << CYAN << "| " << GRAY << "     L> " << left << setw(33) << curr->location << CYAN << "|" << RESET << endl;
-
-        // Drawing the connector line if there is another event below
-        if (curr->next) {
-            cout << bg << "           " << CYAN << "| " << GRAY << "      | " << string(34, ' ') << CYAN << "|" << RESET << endl;
-        }
-
-        curr = curr->next;
-    }
-
-    cout << bg << CYAN << "+==========================================================+" << RESET << endl;
+#include "trackinghistory.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <ctime>
+#include <string>
+#include <cstdio>
+#include <utility>
+
+using namespace std;
+
+// --- THEME COLORS ---
+#define RESET     "\033[0m"
+#define CYAN      "\033[1;36m"
+#define WHITE     "\033[1;37m"
+#define GOLD      "\033[1;33m"
+#define GRAY      "\033[90m"
+#define BG_NAVY   "\033[48;5;18m"
+#define BOLD      "\033[1m"
+
+static string formatTimestamp(time_t when) {
+    tm localTime;
+
+#ifdef _WIN32
+    localtime_s(&localTime, &when);
+#else
+    localtime_r(&when, &localTime);
+#endif
+
+    // "HH:MM:SS" fits the small-string buffer, so this never hits the heap
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%02d:%02d:%02d", localTime.tm_hour, localTime.tm_min, localTime.tm_sec);
+    return string(buf);
+}
+
+string getCurrentTimestamp() {
+    return formatTimestamp(time(nullptr));
+}
+
+HistoryEvent::HistoryEvent(string d, string t, string l)
+    : description(move(d)), time(move(t)), location(move(l)), next(nullptr) {
+}
+
+TrackingHistory::TrackingHistory()
+    : head(nullptr), tail(nullptr), laterDesc(nullptr), laterLoc(nullptr), laterTime(0) {}
+
+TrackingHistory::TrackingHistory(const TrackingHistory& other)
+    : head(nullptr), tail(nullptr), laterDesc(nullptr), laterLoc(nullptr), laterTime(0) {
+    other.materialize();
+    HistoryEvent* curr = other.head;
+    while (curr) {
+        addEvent(curr->description, curr->location);
+        curr = curr->next;
+    }
+}
+
+TrackingHistory::~TrackingHistory() {
+    while (head) {
+        HistoryEvent* next = head->next;
+        delete head;
+        head = next;
+    }
+}
+
+void TrackingHistory::addEvent(string desc, string loc) {
+    restoreEvent(move(desc), getCurrentTimestamp(), move(loc));
+}
+
+void TrackingHistory::addEventLater(const char* desc, const char* loc) {
+    materialize();
+    if (head) {
+        addEvent(desc, loc);
+        return;
+    }
+    laterDesc = desc;
+    laterLoc = loc;
+    laterTime = (long long)time(nullptr);
+}
+
+// The deferred event always opens the timeline: anything appended after
+// it materializes it first
+void TrackingHistory::materialize() const {
+    if (!laterDesc) return;
+    head = tail = new HistoryEvent(laterDesc, formatTimestamp((time_t)laterTime), laterLoc);
+    laterDesc = laterLoc = nullptr;
+}
+
+void TrackingHistory::restoreEvent(string desc, string time, string loc) {
+    materialize();
+    HistoryEvent* newEvent = new HistoryEvent(move(desc), move(time), move(loc));
+    if (!head) {
+        head = tail = newEvent;
+    }
+    else {
+        tail->next = newEvent;
+        tail = newEvent;
+    }
+}
+
+const HistoryEvent* TrackingHistory::first() const {
+    materialize();
+    return head;
+}
+
+const HistoryEvent* TrackingHistory::last() const {
+    materialize();
+    return tail;
+}
+
+// GUI: Renders a vertical GPS-style timeline within the Navy Theme
+void TrackingHistory::printTimeline(ostream& out) const {
+    const char* bg = BG_NAVY;
+
+    out << "\n" << bg << CYAN << "+==========================================================+" << RESET << "\n";
+    out << bg << CYAN << "| " << WHITE << BOLD << "              PARCEL JOURNEY TIMELINE                   " << CYAN << "|" << RESET << "\n";
+    out << bg << CYAN << "+----------------------------------------------------------+" << RESET << "\n";
+
+    materialize();
+    HistoryEvent* curr = head;
+    if (!curr) {
+        out << bg << "  " << GRAY << "      (No history available for this parcel)            " << RESET << "\n";
+    }
+
+    while (curr) {
+        // Node symbol: (O) for latest, (o) for previous
+        const char* node = (curr->next == nullptr) ? " (O) " : " (o) ";
+        const char* nodeColor = (curr->next == nullptr) ? GOLD : CYAN;
+
+        // Time and Event description
+        out << bg << "  " << GOLD << curr->time << RESET << bg << CYAN << " | " << nodeColor << node << WHITE << left << setw(35) << curr->description << CYAN << "|" << RESET << "\n";
+
+        // Location details
+        out << bg << "           " << CYAN << "| " << GRAY << "     L> " << left << setw(33) << curr->location << CYAN << "|" << RESET << "\n";
+
+        // Drawing the connector line if there is another event below
+        if (curr->next) {
+            out << bg << "           " << CYAN << "| " << GRAY << "      | " << setw(34) << "" << CYAN << "|" << RESET << "\n";
+        }
+
+        curr = curr->next;
+    }
+
+    out << bg << CYAN << "+==========================================================+" << RESET << "\n";
 }
\ No newline at end of file
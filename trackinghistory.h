@@ -1,25 +1,40 @@
-#ifndef TRACKINGHISTORY_H
-#define TRACKINGHISTORY_H
-
-#include <string>
-
-struct HistoryEvent {
-    std::string description;
-    std::string time;
-    std::string location;
-    HistoryEvent* next;
-    HistoryEvent(std::string d, std::string t, std::string l);
-};
-
-class TrackingHistory {
-private:
-    HistoryEvent* head;
-    HistoryEvent* tail;
-public:
-    TrackingHistory();
-    TrackingHistory(const TrackingHistory& other);
-    void addEvent(std::string desc, std::string loc);
-    void printTimeline();
-};
-
+#ifndef TRACKINGHISTORY_H
+#define TRACKINGHISTORY_H
+
+#include <string>
+#include <ostream>
+
+struct HistoryEvent {
+    std::string description;
+    std::string time;
+    std::string location;
+    HistoryEvent* next;
+    HistoryEvent(std::string d, std::string t, std::string l);
+};
+
+class TrackingHistory {
+private:
+    // A deferred opening event only becomes a node when the timeline is
+    // first read or extended; most parcels loaded at startup never are
+    mutable HistoryEvent* head;
+    mutable HistoryEvent* tail;
+    mutable const char* laterDesc;
+    mutable const char* laterLoc;
+    long long laterTime;
+    void materialize() const;
+public:
+    TrackingHistory();
+    TrackingHistory(const TrackingHistory& other);
+    ~TrackingHistory();
+    void addEvent(std::string desc, std::string loc);
+    // addEvent for an empty timeline, stamped now but built on first use;
+    // desc and loc must be literals (they are kept as pointers)
+    void addEventLater(const char* desc, const char* loc);
+    // Appends with a stored timestamp instead of the current time
+    void restoreEvent(std::string desc, std::string time, std::string loc);
+    void printTimeline(std::ostream& out) const;
+    const HistoryEvent* first() const;
+    const HistoryEvent* last() const;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,338 @@
+#include "transittable.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <climits>
+#include <ctime>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSIT_SSE2
+#endif
+
+using namespace std;
+
+// UI Color Palette
+#define RESET     "\033[0m"
+#define BOLD      "\033[1m"
+#define CYAN      "\033[1;36m"
+#define GREEN     "\033[1;32m"
+#define GOLD      "\033[1;33m"
+#define WHITE     "\033[1;37m"
+#define GRAY      "\033[90m"
+#define BG_NAVY   "\033[48;5;18m"
+
+// =====================================================
+// Philox2x32-10 (Counter-Based Dice)
+// =====================================================
+// Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (SC '11).
+// Ten rounds of a 32x32->64 multiply and xor turn (counter, key) into two
+// independent 32-bit numbers; no state is carried from one call to the
+// next, so every row of a sweep can roll at once.
+static const uint32_t PHILOX_M = 0xD256D193u;
+static const uint32_t PHILOX_W = 0x9E3779B9u;
+
+static inline void philox2x32(uint32_t c0, uint32_t c1, uint32_t key, uint32_t& r0, uint32_t& r1) {
+    for (int round = 0; round < 10; round++) {
+        uint64_t prod = (uint64_t)PHILOX_M * c0;
+        uint32_t hi = (uint32_t)(prod >> 32);
+        uint32_t lo = (uint32_t)prod;
+        c0 = hi ^ key ^ c1;
+        c1 = lo;
+        key += PHILOX_W;
+    }
+    r0 = c0;
+    r1 = c1;
+}
+
+#ifdef TRANSIT_SSE2
+// Four counters at once. SSE2 multiplies lanes 0 and 2 into 64 bits, so
+// the odd lanes go through a second multiply and the halves are regrouped.
+static inline void philox2x32x4(__m128i c0, __m128i c1, uint32_t key, __m128i& r0, __m128i& r1) {
+    const __m128i m = _mm_set1_epi32((int)PHILOX_M);
+    for (int round = 0; round < 10; round++) {
+        __m128i even = _mm_mul_epu32(c0, m);                       // lo0 hi0 lo2 hi2
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(c0, 32), m);    // lo1 hi1 lo3 hi3
+        even = _mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0));   // lo0 lo2 hi0 hi2
+        odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0));     // lo1 lo3 hi1 hi3
+        __m128i lo = _mm_unpacklo_epi32(even, odd);
+        __m128i hi = _mm_unpackhi_epi32(even, odd);
+        c0 = _mm_xor_si128(_mm_xor_si128(hi, _mm_set1_epi32((int)key)), c1);
+        c1 = lo;
+        key += PHILOX_W;
+    }
+    r0 = c0;
+    r1 = c1;
+}
+
+// Unsigned a < b, lane by lane: SSE2 only compares signed
+static inline __m128i lessUnsigned(__m128i a, __m128i b) {
+    const __m128i flip = _mm_set1_epi32((int)0x80000000u);
+    return _mm_cmplt_epi32(_mm_xor_si128(a, flip), _mm_xor_si128(b, flip));
+}
+#endif
+
+// 0.1% of parcels on the road go missing per sweep; 80% of delivery
+// attempts succeed. Compared against a uniform 32-bit number.
+static const uint32_t LOSE_BELOW = 4294967u;
+static const uint32_t DELIVER_BELOW = 3435973837u;
+
+// =====================================================
+// TransitTable Implementation (Column Store + Sweep Kernel)
+// =====================================================
+TransitTable::TransitTable() : parcels(nullptr), states(nullptr), deadlines(nullptr), epoch(0), rows(0), capacity(0),
+    seed(0), sweeps(0), pending(nullptr), pendingCapacity(0) {}
+
+TransitTable::~TransitTable() {
+    delete[] parcels;
+    delete[] states;
+    delete[] deadlines;
+    delete[] pending;
+}
+
+void TransitTable::setSeed(unsigned int s) {
+    seed = s;
+    sweeps = 0;
+}
+
+void TransitTable::grow() {
+    int newCapacity = capacity ? capacity * 2 : 64;
+    Parcel** p = new Parcel*[newCapacity];
+    int* s = new int[newCapacity];
+    int* d = new int[newCapacity];
+    for (int i = 0; i < rows; i++) {
+        p[i] = parcels[i];
+        s[i] = states[i];
+        d[i] = deadlines[i];
+    }
+    delete[] parcels;
+    delete[] states;
+    delete[] deadlines;
+    parcels = p;
+    states = s;
+    deadlines = d;
+    capacity = newCapacity;
+}
+
+// Seconds from epoch; anything past 68 years either way saturates
+static int sinceEpoch(long long t, long long epoch) {
+    long long d = t - epoch;
+    if (d > INT_MAX) return INT_MAX;
+    if (d < INT_MIN) return INT_MIN;
+    return (int)d;
+}
+
+void TransitTable::load(int row) {
+    const Parcel* p = parcels[row];
+    states[row] = p->status;
+    long long due = p->status == STATUS_LOADING ? p->lastUpdateTime + 5 : p->arrivalTime;
+    deadlines[row] = sinceEpoch(due, epoch);
+}
+
+// The last row fills the hole
+void TransitTable::dropRow(int row) {
+    parcels[row]->shipRow = -1;
+    int last = --rows;
+    if (row == last) return;
+    parcels[row] = parcels[last];
+    states[row] = states[last];
+    deadlines[row] = deadlines[last];
+    parcels[row]->shipRow = row;
+}
+
+void TransitTable::pushBack(Parcel* val) {
+    if (rows == capacity) grow();
+    // An empty road starts a new epoch
+    if (rows == 0) epoch = time(0);
+    parcels[rows] = val;
+    val->shipRow = rows;
+    load(rows++);
+}
+
+void TransitTable::remove(Parcel* val) {
+    if (contains(val)) dropRow(val->shipRow);
+}
+
+void TransitTable::refresh(Parcel* val) {
+    if (contains(val)) load(val->shipRow);
+}
+
+bool TransitTable::contains(const Parcel* val) const {
+    return val->shipRow >= 0 && val->shipRow < rows && parcels[val->shipRow] == val;
+}
+
+int TransitTable::size() const { return rows; }
+
+int TransitTable::sweep(long long currentTime, Transition* out) {
+    int found = 0;
+    uint32_t tick = sweeps++;
+    int now = sinceEpoch(currentTime, epoch);
+    int outcome[BLOCK];
+    for (int base = 0; base < rows; base += BLOCK) {
+        int n = rows - base < BLOCK ? rows - base : BLOCK;
+        const int* s = states + base;
+        const int* d = deadlines + base;
+        int j = 0;
+
+#ifdef TRANSIT_SSE2
+        // Each test is an all-ones lane mask; the states exclude each
+        // other, so the outcome is the OR of the masked codes
+        const __m128i nowV = _mm_set1_epi32(now);
+        const __m128i loadingV = _mm_set1_epi32(STATUS_LOADING);
+        const __m128i movingV = _mm_set1_epi32(STATUS_IN_TRANSIT);
+        const __m128i attemptV = _mm_set1_epi32(STATUS_DELIVERY_ATTEMPT);
+        const __m128i loseV = _mm_set1_epi32((int)LOSE_BELOW);
+        const __m128i deliverV = _mm_set1_epi32((int)DELIVER_BELOW);
+        const __m128i tickV = _mm_set1_epi32((int)tick);
+        for (; j + 4 <= n; j += 4) {
+            __m128i r0, r1;
+            __m128i counter = _mm_add_epi32(_mm_set1_epi32(base + j), _mm_setr_epi32(0, 1, 2, 3));
+            philox2x32x4(counter, tickV, seed, r0, r1);
+            __m128i sv = _mm_loadu_si128((const __m128i*)(s + j));
+            __m128i dv = _mm_loadu_si128((const __m128i*)(d + j));
+            __m128i due = _mm_andnot_si128(_mm_cmpgt_epi32(dv, nowV), _mm_set1_epi32(-1));
+            __m128i loading = _mm_cmpeq_epi32(sv, loadingV);
+            __m128i moving = _mm_cmpeq_epi32(sv, movingV);
+            __m128i attempt = _mm_cmpeq_epi32(sv, attemptV);
+            __m128i lost = _mm_and_si128(moving, lessUnsigned(r0, loseV));
+            __m128i arrived = _mm_andnot_si128(lost, _mm_and_si128(moving, due));
+            // RETRY, or DELIVER when the mask adds -1
+            __m128i settled = _mm_add_epi32(_mm_set1_epi32(RETRY), lessUnsigned(r1, deliverV));
+            __m128i o = _mm_and_si128(_mm_and_si128(loading, due), _mm_set1_epi32(DEPART));
+            o = _mm_or_si128(o, _mm_and_si128(lost, _mm_set1_epi32(LOSE)));
+            o = _mm_or_si128(o, _mm_and_si128(arrived, _mm_set1_epi32(ARRIVE)));
+            o = _mm_or_si128(o, _mm_and_si128(attempt, settled));
+            _mm_storeu_si128((__m128i*)(outcome + j), o);
+        }
+#endif
+        // The same decision a row at a time: each test is a 0/1 and the
+        // outcome is their weighted sum
+        for (; j < n; j++) {
+            uint32_t r0, r1;
+            philox2x32((uint32_t)(base + j), tick, seed, r0, r1);
+            int due = now >= d[j];
+            int loading = s[j] == STATUS_LOADING;
+            int moving = s[j] == STATUS_IN_TRANSIT;
+            int attempt = s[j] == STATUS_DELIVERY_ATTEMPT;
+            int lost = moving & (r0 < LOSE_BELOW);
+            int delivered = r1 < DELIVER_BELOW;
+            outcome[j] = (loading & due) * DEPART + lost * LOSE + (moving & !lost & due) * ARRIVE +
+                         attempt * (RETRY - delivered);
+        }
+
+        // Compact: always write, advance only past rows that change
+        for (j = 0; j < n; j++) {
+            out[found].row = base + j;
+            out[found].outcome = outcome[j];
+            found += outcome[j] != STAY;
+        }
+    }
+    return found;
+}
+
+void TransitTable::updateLifecycle(long long currentTime, ParcelArrayList* leftRoad) {
+    if (pendingCapacity < rows) {
+        delete[] pending;
+        pendingCapacity = capacity;
+        pending = new Transition[pendingCapacity];
+    }
+    int n = sweep(currentTime, pending);
+
+    for (int i = 0; i < n; i++) {
+        int row = pending[i].row;
+        Parcel* p = parcels[row];
+        switch (pending[i].outcome) {
+        case DEPART:
+            p->updateStatus(STATUS_IN_TRANSIT, "Vehicle Departed", "On Road");
+            break;
+        case LOSE:
+            p->updateStatus(STATUS_MISSING, "Signal Lost - Investigation Started", "Unknown");
+            if (leftRoad) leftRoad->add(p);
+            break;
+        case ARRIVE:
+            p->updateStatus(STATUS_DELIVERY_ATTEMPT, "Arrived at Destination Hub", p->destination);
+            if (leftRoad) leftRoad->add(p);
+            break;
+        case DELIVER:
+            p->updateStatus(STATUS_DELIVERED, "Handed to Recipient", "Doorstep");
+            break;
+        case RETRY:
+            p->deliveryAttempts++;
+            if (p->deliveryAttempts >= 3) {
+                p->updateStatus(STATUS_RETURNED, "Max Attempts Reached - RTS", "Local Hub");
+            }
+            else {
+                p->updateStatus(STATUS_IN_TRANSIT, "Recipient Unavailable - Retrying", "Local Hub");
+                p->arrivalTime = currentTime + 5; // Re-schedule transit time
+            }
+            break;
+        }
+        load(row);
+    }
+
+    // Finished parcels leave, highest row first: the row moved into a hole
+    // always comes from above it, so none still waiting is disturbed
+    for (int i = n - 1; i >= 0; i--) {
+        int s = states[pending[i].row];
+        if (s == STATUS_DELIVERED || s == STATUS_RETURNED || s == STATUS_MISSING) dropRow(pending[i].row);
+    }
+}
+
+// GUI: Displays the progress bars for active deliveries, at most maxRows of
+// them; a busy fleet is thousands of parcels and a screen is fifty lines
+void TransitTable::showTransitStatus(ostream& out, long long currentTime, int maxRows) {
+    bool headerPrinted = false;
+    int shown = 0;
+    int hidden = 0;
+    const char* bg = BG_NAVY;
+
+    for (int i = 0; i < rows; i++) {
+        Parcel* p = parcels[i];
+        // Only show parcels that are actually moving or being loaded
+        if (p->status == STATUS_IN_TRANSIT || p->status == STATUS_LOADING) {
+            if (shown == maxRows) {
+                hidden++;
+                continue;
+            }
+            shown++;
+            if (!headerPrinted) {
+                out << bg << CYAN << "+==========================================================+" << RESET << "\n";
+                out << bg << CYAN << "| " << WHITE << BOLD << "              LIVE FLEET TRANSIT MONITOR                " << CYAN << "|" << RESET << "\n";
+                out << bg << CYAN << "+----------------------------------------------------------+" << RESET << "\n";
+                headerPrinted = true;
+            }
+
+            long long total = p->arrivalTime - p->dispatchTime;
+            long long elapsed = currentTime - p->dispatchTime;
+
+            const char* state = (p->status == STATUS_LOADING) ?
+                GOLD "[LOADING]" WHITE :
+                GREEN "[MOVING ]" WHITE;
+
+            if (total <= 0) total = 1;
+            double pct = (double)elapsed / total;
+            if (pct > 1.0) pct = 1.0;
+            if (pct < 0.0) pct = 0.0;
+
+            // Render the Bar
+            out << bg << "  " << state << " " << left << setw(8) << p->id << " » "
+                << left << setw(12) << p->destination << " " << CYAN << "[";
+
+            int bars = (int)(pct * 15);
+            for (int b = 0; b < 15; b++) {
+                if (b < bars) out << "■";
+                else out << " ";
+            }
+
+            out << "] " << WHITE << setw(3) << (int)(pct * 100) << "% " << CYAN << "|" << RESET << "\n";
+        }
+    }
+
+    if (headerPrinted) {
+        if (hidden > 0)
+            out << bg << GRAY << "  ... and " << hidden << " more on the road" << RESET << "\n";
+        out << bg << CYAN << "+==========================================================+" << RESET << "\n";
+    }
+    else {
+        out << bg << GRAY << "        (No active transit signals detected)              " << RESET << "\n";
+    }
+}
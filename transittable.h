@@ -0,0 +1,92 @@
+#ifndef TRANSITTABLE_H
+#define TRANSITTABLE_H
+
+#include <ostream>
+#include "parcel.h"
+#include "smallvector.h"
+
+typedef SmallVector<Parcel*, 8> ParcelArrayList;
+
+// Parcels between loading and the delivery attempt, kept as columns so the
+// lifecycle sweep reads two small arrays instead of chasing a node and a
+// Parcel per entry. Row i holds the parcel's status and the time it next
+// falls due: leaving the bay for LOADING, arrival for IN_TRANSIT, in
+// seconds from the table's epoch so four rows fit one 128-bit register.
+// The columns are a copy; whoever changes the status or arrival time of a
+// parcel on the road outside a sweep calls refresh().
+//
+// A sweep runs in two steps. The kernel decides the outcome of four rows
+// at a time with SSE2 compares (plain C++ where SSE2 is missing); the dice
+// come from a counter-based generator (Philox2x32), a pure function of
+// (row, sweep, seed), so all four roll at once and both paths roll the
+// same numbers. Rows with something to do go into a compact list, and
+// only those Parcels are touched when it is applied.
+class TransitTable {
+public:
+    // What the kernel decided for a row
+    enum Outcome {
+        STAY = 0,
+        DEPART,         // LOADING -> IN_TRANSIT
+        ARRIVE,         // IN_TRANSIT -> DELIVERY_ATTEMPT
+        LOSE,           // IN_TRANSIT -> MISSING
+        DELIVER,        // DELIVERY_ATTEMPT -> DELIVERED
+        RETRY           // DELIVERY_ATTEMPT failed: retry or return
+    };
+
+    struct Transition {
+        int row;
+        int outcome;
+    };
+
+private:
+    static const int BLOCK = 256;
+
+    Parcel** parcels;
+    int* states;
+    int* deadlines;             // seconds from epoch, clamped to int
+    long long epoch;
+    int rows;
+    int capacity;
+    unsigned int seed;
+    unsigned int sweeps;
+
+    Transition* pending;        // the kernel's compact output
+    int pendingCapacity;
+
+    void grow();
+    void load(int row);
+    void dropRow(int row);
+
+public:
+    TransitTable();
+    ~TransitTable();
+    TransitTable(const TransitTable&) = delete;
+    TransitTable& operator=(const TransitTable&) = delete;
+
+    // Seeds the dice; sweeps with the same seed from the same table roll
+    // the same numbers
+    void setSeed(unsigned int s);
+
+    void pushBack(Parcel* val);
+    // O(1): the last row moves into the hole
+    void remove(Parcel* val);
+    // Re-reads the parcel's status and times into its row
+    void refresh(Parcel* val);
+    bool contains(const Parcel* val) const;
+    int size() const;
+
+    // The kernel alone: fills out (capacity for size() entries) with the
+    // rows that change at currentTime and returns how many, in row order.
+    // Touches no Parcel; every call rolls fresh dice.
+    int sweep(long long currentTime, Transition* out);
+
+    // Runs the kernel and applies its outcome. Parcels that finish their
+    // road leg (arrive or go missing) are appended to leftRoad when it is
+    // given, so route bookkeeping can drop them. Delivered, returned and
+    // missing parcels leave the table.
+    void updateLifecycle(long long currentTime, ParcelArrayList* leftRoad = nullptr);
+    // Moving and loading parcels, at most maxRows; the rest are counted
+    void showTransitStatus(std::ostream& out, long long currentTime, int maxRows);
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "undojournal.h"
+#include <cstring>
+
+using namespace std;
+
+// =====================================================
+// UndoJournal Implementation (Ring-Buffered Undo/Redo)
+// =====================================================
+UndoJournal::UndoJournal(int maxEntries, size_t arenaBytes, int maxTxns)
+    : entryCapacity(maxEntries), arenaCapacity(arenaBytes), txnCapacity(maxTxns), openDepth(0), openOverflow(false) {
+    entries = new Entry[entryCapacity];
+    arena = new char[arenaCapacity];
+    txns = new Txn[txnCapacity];
+    clear();
+}
+
+UndoJournal::~UndoJournal() {
+    delete[] entries;
+    delete[] arena;
+    delete[] txns;
+}
+
+void UndoJournal::clear() {
+    entryHead = entryTail = 0;
+    arenaHead = arenaTail = 0;
+    txnHead = txnTail = txnCursor = 0;
+}
+
+// Forgets the oldest committed transaction; false if there is none left
+bool UndoJournal::evictOldest() {
+    if (txnTail == txnHead) return false;
+    const Txn& t = txns[txnTail % txnCapacity];
+    entryTail = t.entryEnd;
+    arenaTail = t.arenaEnd;
+    txnTail++;
+    if (txnCursor < txnTail) txnCursor = txnTail;
+    return true;
+}
+
+// Byte images are kept contiguous: an image that would straddle the end of
+// the arena starts over at the front and the tail gap is skipped
+char* UndoJournal::allocBytes(size_t n, unsigned long long& at) {
+    if (n > arenaCapacity) return nullptr;
+    size_t pos = (size_t)(arenaHead % arenaCapacity);
+    size_t pad = (pos + n > arenaCapacity) ? arenaCapacity - pos : 0;
+    while (arenaHead + pad + n - arenaTail > arenaCapacity) {
+        if (!evictOldest()) return nullptr;
+    }
+    arenaHead += pad;
+    at = arenaHead;
+    arenaHead += n;
+    return arena + (size_t)(at % arenaCapacity);
+}
+
+// Releases the undone transactions past the cursor
+void UndoJournal::dropRedo() {
+    txnHead = txnCursor;
+    if (txnCursor > txnTail) {
+        const Txn& last = txns[(txnCursor - 1) % txnCapacity];
+        entryHead = last.entryEnd;
+        arenaHead = last.arenaEnd;
+    }
+    else {
+        entryHead = entryTail;
+        arenaHead = arenaTail;
+    }
+}
+
+void UndoJournal::begin(const char* label) {
+    if (openDepth++ > 0) return;
+
+    // A new edit makes the undone transactions unreachable; reclaim them
+    dropRedo();
+
+    open.firstEntry = entryHead;
+    open.arenaEnd = arenaHead;   // start of this transaction's bytes, until commit
+    strncpy(open.label, label, sizeof(open.label) - 1);
+    open.label[sizeof(open.label) - 1] = '\0';
+    openOverflow = false;
+}
+
+void UndoJournal::commit() {
+    if (openDepth == 0 || --openDepth > 0) return;
+
+    if (openOverflow) {
+        // Part of this change went unrecorded, so nothing before it can be
+        // undone safely either
+        clear();
+        return;
+    }
+    if (entryHead == open.firstEntry) return;   // nothing changed
+
+    while (txnHead - txnTail >= (unsigned long long)txnCapacity) evictOldest();
+    open.entryEnd = entryHead;
+    open.arenaEnd = arenaHead;
+    txns[txnHead % txnCapacity] = open;
+    txnHead++;
+    txnCursor = txnHead;
+}
+
+// Claims the next entry slot in the open transaction, or nullptr if the
+// transaction has already overflowed
+UndoJournal::Entry* UndoJournal::appendEntry(Parcel* p, UndoField field) {
+    if (openOverflow) return nullptr;
+    while (entryHead - entryTail >= (unsigned long long)entryCapacity) {
+        if (!evictOldest()) {
+            openOverflow = true;
+            return nullptr;
+        }
+    }
+
+    Entry* e = &entries[entryHead % entryCapacity];
+    e->parcel = p;
+    e->field = field;
+    e->before = 0;
+    e->after = 0;
+    e->bytesAt = 0;
+    e->beforeLen = 0;
+    e->afterLen = 0;
+    return e;
+}
+
+void UndoJournal::recordValue(Parcel* p, UndoField field, long long before, long long after) {
+    if (openDepth == 0) {
+        // Stray edits become their own one-entry transaction
+        begin("EDIT");
+        recordValue(p, field, before, after);
+        commit();
+        return;
+    }
+    Entry* e = appendEntry(p, field);
+    if (!e) return;
+    e->before = before;
+    e->after = after;
+    entryHead++;
+}
+
+void UndoJournal::recordBytes(Parcel* p, UndoField field, string_view before, string_view after) {
+    if (openDepth == 0) {
+        begin("EDIT");
+        recordBytes(p, field, before, after);
+        commit();
+        return;
+    }
+    Entry* e = appendEntry(p, field);
+    if (!e) return;
+
+    size_t total = before.size() + after.size();
+    if (total > 0) {
+        char* dst = allocBytes(total, e->bytesAt);
+        if (!dst) {
+            openOverflow = true;
+            return;
+        }
+        memcpy(dst, before.data(), before.size());
+        memcpy(dst + before.size(), after.data(), after.size());
+    }
+    e->beforeLen = (unsigned int)before.size();
+    e->afterLen = (unsigned int)after.size();
+    entryHead++;
+}
+
+void UndoJournal::applyTxn(const Txn& t, bool undoing, UndoApplyFn apply, void* ctx) {
+    unsigned long long n = t.entryEnd - t.firstEntry;
+    for (unsigned long long k = 0; k < n; k++) {
+        // Undo walks newest-first, redo replays oldest-first
+        unsigned long long pos = undoing ? t.entryEnd - 1 - k : t.firstEntry + k;
+        const Entry& e = entries[pos % entryCapacity];
+
+        UndoStep step;
+        step.parcel = e.parcel;
+        step.field = e.field;
+        step.value = undoing ? e.before : e.after;
+        const char* bytes = arena + (size_t)(e.bytesAt % arenaCapacity);
+        step.bytes = undoing ? string_view(bytes, e.beforeLen) : string_view(bytes + e.beforeLen, e.afterLen);
+        step.undoing = undoing;
+        step.label = t.label;
+        apply(step, ctx);
+    }
+}
+
+void UndoJournal::forget(bool (*doomed)(const Parcel*, void*), void* ctx) {
+    if (openDepth > 0) return;
+    bool hitUndo = false, hitRedo = false;
+    unsigned long long newestHit = 0;
+    for (unsigned long long t = txnTail; t < txnHead; t++) {
+        const Txn& x = txns[t % txnCapacity];
+        for (unsigned long long e = x.firstEntry; e < x.entryEnd; e++) {
+            if (!doomed(entries[e % entryCapacity].parcel, ctx)) continue;
+            if (t < txnCursor) {
+                hitUndo = true;
+                newestHit = t;
+            }
+            else hitRedo = true;
+            break;
+        }
+    }
+    if (hitRedo) dropRedo();
+    if (hitUndo)
+        while (txnTail <= newestHit && evictOldest()) {}
+}
+
+bool UndoJournal::canUndo() const {
+    return openDepth == 0 && txnCursor > txnTail;
+}
+
+bool UndoJournal::canRedo() const {
+    return openDepth == 0 && txnCursor < txnHead;
+}
+
+const char* UndoJournal::undo(UndoApplyFn apply, void* ctx) {
+    if (!canUndo()) return nullptr;
+    txnCursor--;
+    const Txn& t = txns[txnCursor % txnCapacity];
+    applyTxn(t, true, apply, ctx);
+    return t.label;
+}
+
+const char* UndoJournal::redo(UndoApplyFn apply, void* ctx) {
+    if (!canRedo()) return nullptr;
+    const Txn& t = txns[txnCursor % txnCapacity];
+    txnCursor++;
+    applyTxn(t, false, apply, ctx);
+    return t.label;
+}
@@ -0,0 +1,97 @@
+#ifndef UNDOJOURNAL_H
+#define UNDOJOURNAL_H
+
+#include <cstddef>
+#include <string_view>
+#include "parcel.h"
+
+// Parcel state the journal can put back. The membership "fields" stand for
+// the engine's containers (sorting queue; transit table + route index) and
+// are restored by the engine's apply callback like any other field.
+enum UndoField : unsigned char {
+    UF_STATUS,
+    UF_DISPATCH_TIME,
+    UF_ARRIVAL_TIME,
+    UF_RIDER,        // bytes: rider name
+    UF_ROUTE,        // bytes: depart hour + directed edge ids
+    UF_IN_QUEUE,     // 0/1
+    UF_ON_ROAD       // 0/1
+};
+
+// One value handed to the apply callback
+struct UndoStep {
+    Parcel* parcel;
+    UndoField field;
+    long long value;        // scalar fields
+    std::string_view bytes; // byte fields (rider, route)
+    bool undoing;           // false while redoing
+    const char* label;      // transaction label, e.g. "DISPATCH"
+};
+
+typedef void (*UndoApplyFn)(const UndoStep& step, void* ctx);
+
+// Undo/redo log of before/after images, grouped into transactions.
+// Memory is fixed at construction: entries, byte images and transactions
+// each live in their own ring, and the oldest transactions are dropped when
+// a new one needs the room. Undo and redo touch only the recorded fields.
+class UndoJournal {
+private:
+    struct Entry {
+        Parcel* parcel;
+        UndoField field;
+        long long before;
+        long long after;
+        unsigned long long bytesAt;   // arena position of before bytes; after bytes follow
+        unsigned int beforeLen;
+        unsigned int afterLen;
+    };
+    struct Txn {
+        unsigned long long firstEntry;
+        unsigned long long entryEnd;
+        unsigned long long arenaEnd;
+        char label[24];
+    };
+
+    Entry* entries;
+    int entryCapacity;
+    char* arena;
+    size_t arenaCapacity;
+    Txn* txns;
+    int txnCapacity;
+
+    // Monotonic positions; ring slot = position % capacity
+    unsigned long long entryHead, entryTail;
+    unsigned long long arenaHead, arenaTail;
+    unsigned long long txnHead, txnTail, txnCursor;   // [tail, cursor) undoable, [cursor, head) redoable
+
+    int openDepth;
+    bool openOverflow;   // the open transaction outgrew the journal
+    Txn open;
+
+    bool evictOldest();
+    void dropRedo();
+    Entry* appendEntry(Parcel* p, UndoField field);
+    char* allocBytes(size_t n, unsigned long long& at);
+    void applyTxn(const Txn& t, bool undoing, UndoApplyFn apply, void* ctx);
+public:
+    UndoJournal(int maxEntries = 4096, size_t arenaBytes = 64 * 1024, int maxTxns = 512);
+    ~UndoJournal();
+
+    // Transactions nest; inner begin/commit pairs join the outermost one
+    void begin(const char* label);
+    void commit();
+    void recordValue(Parcel* p, UndoField field, long long before, long long after);
+    void recordBytes(Parcel* p, UndoField field, std::string_view before, std::string_view after);
+
+    bool canUndo() const;
+    bool canRedo() const;
+    // Reverts / reapplies the newest unit; returns its label or nullptr
+    const char* undo(UndoApplyFn apply, void* ctx);
+    const char* redo(UndoApplyFn apply, void* ctx);
+    void clear();
+    // Forgets every unit that touches a parcel doomed() picks (and all undo
+    // history older than it), so the parcel can be freed
+    void forget(bool (*doomed)(const Parcel*, void*), void* ctx);
+};
+
+#endif